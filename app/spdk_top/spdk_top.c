@@ -87,10 +87,11 @@
 #define MAX_TIME_STR_LEN 12
 #define MAX_POLLER_RUN_COUNT 20
 #define MAX_PERIOD_STR_LEN 12
+#define MAX_MSG_BACKLOG_STR_LEN 12
 #define WINDOW_HEADER 12
 #define FROM_HEX 16
 #define THREAD_WIN_WIDTH 69
-#define THREAD_WIN_HEIGHT 9
+#define THREAD_WIN_HEIGHT 10
 #define THREAD_WIN_FIRST_COL 2
 #define CORE_WIN_FIRST_COL 16
 #define CORE_WIN_WIDTH 48
@@ -162,6 +163,7 @@ static struct col_desc g_col_desc[NUMBER_OF_TABS][TABS_COL_COUNT] = {
 		{.name = "Paused pollers", .max_data_string = MAX_POLLER_COUNT_STR_LEN},
 		{.name = "Idle [us]", .max_data_string = MAX_TIME_STR_LEN},
 		{.name = "Busy [us]", .max_data_string = MAX_TIME_STR_LEN},
+		{.name = "Msg backlog", .max_data_string = MAX_MSG_BACKLOG_STR_LEN},
 		{.name = (char *)NULL}
 	},
 	{	{.name = "Poller name", .max_data_string = MAX_POLLER_NAME_LEN},
@@ -193,6 +195,9 @@ struct rpc_thread_info {
 	uint64_t active_pollers_count;
 	uint64_t timed_pollers_count;
 	uint64_t paused_pollers_count;
+	uint64_t msg_count;
+	uint64_t msg_backlog;
+	uint64_t msg_backlog_max;
 };
 
 struct rpc_threads {
@@ -308,6 +313,9 @@ static const struct spdk_json_object_decoder rpc_thread_info_decoders[] = {
 	{"active_pollers_count", offsetof(struct rpc_thread_info, active_pollers_count), spdk_json_decode_uint64},
 	{"timed_pollers_count", offsetof(struct rpc_thread_info, timed_pollers_count), spdk_json_decode_uint64},
 	{"paused_pollers_count", offsetof(struct rpc_thread_info, paused_pollers_count), spdk_json_decode_uint64},
+	{"msg_count", offsetof(struct rpc_thread_info, msg_count), spdk_json_decode_uint64},
+	{"msg_backlog", offsetof(struct rpc_thread_info, msg_backlog), spdk_json_decode_uint64},
+	{"msg_backlog_max", offsetof(struct rpc_thread_info, msg_backlog_max), spdk_json_decode_uint64},
 };
 
 static int
@@ -825,6 +833,10 @@ sort_threads(const void *p1, const void *p2)
 		count1 = thread_info1->busy - thread_info1->last_busy;
 		count2 = thread_info2->busy - thread_info2->last_busy;
 		break;
+	case 7: /* Sort by message backlog */
+		count1 = thread_info1->msg_backlog;
+		count2 = thread_info2->msg_backlog;
+		break;
 	default:
 		return 0;
 	}
@@ -861,7 +873,8 @@ refresh_threads_tab(uint8_t current_page)
 	uint8_t max_pages, item_index;
 	static uint8_t last_page = 0;
 	char pollers_number[MAX_POLLER_COUNT_STR_LEN], idle_time[MAX_TIME_STR_LEN],
-	     busy_time[MAX_TIME_STR_LEN], core_str[MAX_CORE_MASK_STR_LEN];
+	     busy_time[MAX_TIME_STR_LEN], core_str[MAX_CORE_MASK_STR_LEN],
+	     msg_backlog[MAX_MSG_BACKLOG_STR_LEN];
 	struct rpc_thread_info *thread_info[g_threads_stats.threads.threads_count];
 
 	threads_count = g_threads_stats.threads.threads_count;
@@ -965,6 +978,13 @@ refresh_threads_tab(uint8_t current_page)
 			}
 			print_max_len(g_tabs[THREADS_TAB], TABS_DATA_START_ROW + item_index, col,
 				      col_desc[6].max_data_string, ALIGN_RIGHT, busy_time);
+			col += col_desc[6].max_data_string + 2;
+		}
+
+		if (!col_desc[7].disabled) {
+			snprintf(msg_backlog, MAX_MSG_BACKLOG_STR_LEN, "%" PRIu64, thread_info[i]->msg_backlog);
+			print_max_len(g_tabs[THREADS_TAB], TABS_DATA_START_ROW + item_index, col,
+				      col_desc[7].max_data_string, ALIGN_RIGHT, msg_backlog);
 		}
 
 		if (item_index == g_selected_row) {
@@ -1965,14 +1985,23 @@ display_thread(struct rpc_thread_info *thread_info)
 	mvwprintw(thread_win, 4, THREAD_WIN_FIRST_COL + 59, "%" PRIu64,
 		  thread_info->paused_pollers_count);
 
-	mvwhline(thread_win, 5, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
+	print_left(thread_win, 5, THREAD_WIN_FIRST_COL, THREAD_WIN_WIDTH,
+		   "Messages:            Backlog:              Max backlog:", COLOR_PAIR(5));
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 10, "%" PRIu64,
+		  thread_info->msg_count);
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 30, "%" PRIu64,
+		  thread_info->msg_backlog);
+	mvwprintw(thread_win, 5, THREAD_WIN_FIRST_COL + 56, "%" PRIu64,
+		  thread_info->msg_backlog_max);
+
+	mvwhline(thread_win, 6, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
 
-	print_in_middle(thread_win, 6, 0, THREAD_WIN_WIDTH,
+	print_in_middle(thread_win, 7, 0, THREAD_WIN_WIDTH,
 			"Pollers                          Type    Total run count   Period", COLOR_PAIR(5));
 
-	mvwhline(thread_win, 7, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
+	mvwhline(thread_win, 8, 1, ACS_HLINE, THREAD_WIN_WIDTH - 2);
 
-	current_row = 8;
+	current_row = 9;
 
 	for (i = 0; i < g_pollers_stats.pollers_threads.threads_count; i++) {
 		thread = &g_pollers_stats.pollers_threads.threads[i];
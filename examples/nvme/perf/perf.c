@@ -264,6 +264,7 @@ static bool g_warn;
 static bool g_header_digest;
 static bool g_data_digest;
 static bool g_no_shn_notification;
+static bool g_batch_submit;
 static bool g_mix_specified;
 /* The flag is used to exit the program while keep alive fails on the transport */
 static bool g_exit;
@@ -898,12 +899,29 @@ static int64_t
 nvme_check_io(struct ns_worker_ctx *ns_ctx)
 {
 	int64_t rc;
+	int i;
+
+	/* The I/O resubmitted by the completion callbacks is submitted to each queue
+	 * with a single doorbell write.
+	 */
+	if (g_batch_submit) {
+		for (i = 0; i < ns_ctx->u.nvme.num_active_qpairs; i++) {
+			spdk_nvme_qpair_submit_batch_start(ns_ctx->u.nvme.qpair[i]);
+		}
+	}
 
 	rc = spdk_nvme_poll_group_process_completions(ns_ctx->u.nvme.group, 0, perf_disconnect_cb);
 	if (rc < 0) {
 		fprintf(stderr, "NVMe io qpair process completion error\n");
 		exit(1);
 	}
+
+	if (g_batch_submit) {
+		for (i = 0; i < ns_ctx->u.nvme.num_active_qpairs; i++) {
+			spdk_nvme_qpair_submit_batch_end(ns_ctx->u.nvme.qpair[i]);
+		}
+	}
+
 	return rc;
 }
 
@@ -1605,6 +1623,7 @@ static void usage(char *program_name)
 	printf("\t[-c core mask for I/O submission/completion.]\n");
 	printf("\t\t(default: 1)\n");
 	printf("\t[-D disable submission queue in controller memory buffer, default: enabled]\n");
+	printf("\t[-B batch the submissions of each completion poll, default: disabled]\n");
 	printf("\t[-H enable header digest for TCP transport, default: disabled]\n");
 	printf("\t[-I enable data digest for TCP transport, default: disabled]\n");
 	printf("\t[-N no shutdown notification process for controllers, default: disabled]\n");
@@ -2075,7 +2094,7 @@ parse_args(int argc, char **argv)
 	int rc;
 
 	while ((op = getopt(argc, argv,
-			    "a:b:c:e:gi:lmo:q:r:k:s:t:w:z:A:C:DGHILM:NO:P:Q:RS:T:U:VZ:")) != -1) {
+			    "a:b:c:e:gi:lmo:q:r:k:s:t:w:z:A:BC:DGHILM:NO:P:Q:RS:T:U:VZ:")) != -1) {
 		switch (op) {
 		case 'a':
 		case 'A':
@@ -2182,6 +2201,9 @@ parse_args(int argc, char **argv)
 		case 'w':
 			g_workload_type = optarg;
 			break;
+		case 'B':
+			g_batch_submit = true;
+			break;
 		case 'D':
 			g_disable_sq_cmb = 1;
 			break;
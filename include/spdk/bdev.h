@@ -140,6 +140,7 @@ enum spdk_bdev_io_type {
 	SPDK_BDEV_IO_TYPE_COMPARE,
 	SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE,
 	SPDK_BDEV_IO_TYPE_ABORT,
+	SPDK_BDEV_IO_TYPE_COPY,
 	SPDK_BDEV_NUM_IO_TYPES /* Keep last */
 };
 
@@ -197,6 +198,13 @@ struct spdk_bdev_opts {
 
 	uint32_t small_buf_pool_size;
 	uint32_t large_buf_pool_size;
+
+	/**
+	 * Number of small and large data buffers each thread may keep cached for
+	 * itself after returning them, instead of putting them back to the pools.
+	 */
+	uint32_t small_buf_cache_size;
+	uint32_t large_buf_cache_size;
 };
 
 /**
@@ -1300,6 +1308,34 @@ int spdk_bdev_write_zeroes_blocks(struct spdk_bdev_desc *desc, struct spdk_io_ch
 				  uint64_t offset_blocks, uint64_t num_blocks,
 				  spdk_bdev_io_completion_cb cb, void *cb_arg);
 
+/**
+ * Submit a copy request to the bdev on the given channel. This copies the data
+ * of num_blocks blocks starting at src_offset_blocks to dst_offset_blocks. If
+ * the bdev module does not support copy natively, the bdev layer emulates it
+ * with a series of reads and writes.
+ *
+ * \ingroup bdev_io_submit_functions
+ *
+ * \param desc Block device descriptor.
+ * \param ch I/O channel. Obtained by calling spdk_bdev_get_io_channel().
+ * \param dst_offset_blocks The destination offset, in blocks, from the start of the block device.
+ * \param src_offset_blocks The source offset, in blocks, from the start of the block device.
+ * \param num_blocks The number of blocks to copy.
+ * \param cb Called when the request is complete.
+ * \param cb_arg Argument passed to cb.
+ *
+ * \return 0 on success. On success, the callback will always
+ * be called (even if the request ultimately failed). Return
+ * negated errno on failure, in which case the callback will not be called.
+ *   * -EINVAL - offsets and/or num_blocks are out of range, or the ranges overlap
+ *   * -ENOMEM - spdk_bdev_io buffer cannot be allocated
+ *   * -EBADF - desc not open for writing
+ *   * -ENOTSUP - the bdev supports neither copy nor read and write
+ */
+int spdk_bdev_copy_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			  uint64_t dst_offset_blocks, uint64_t src_offset_blocks,
+			  uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg);
+
 /**
  * Submit an unmap request to the block device. Unmap is sometimes also called trim or
  * deallocate. This notifies the device that the data in the blocks described is no
@@ -1724,6 +1760,64 @@ void spdk_bdev_histogram_get(struct spdk_bdev *bdev, struct spdk_histogram_data
 			     spdk_bdev_histogram_data_cb cb_fn,
 			     void *cb_arg);
 
+/**
+ * Stages of an I/O on a bdev that latency can be broken down into.
+ *
+ * An I/O that a bdev module submits to its base bdevs is tracked on each base bdev
+ * separately, so the time spent in a layer of a stacked bdev is its MODULE stage minus
+ * the total latency of the I/O it submitted to the layer below.
+ */
+enum spdk_bdev_io_stage {
+	/** From submission by the user until the I/O is passed to the bdev module. */
+	SPDK_BDEV_IO_STAGE_QUEUE,
+
+	/** From the I/O being passed to the bdev module until the module completes it. */
+	SPDK_BDEV_IO_STAGE_MODULE,
+
+	/** From the module completing the I/O until the user's completion callback is called. */
+	SPDK_BDEV_IO_STAGE_COMPLETE,
+
+	SPDK_BDEV_IO_NUM_STAGES,
+};
+
+typedef void (*spdk_bdev_stage_histogram_data_cb)(void *cb_arg, int status,
+		struct spdk_histogram_data **histograms);
+
+/**
+ * Get the name of an I/O stage.
+ *
+ * \param stage I/O stage.
+ * \return Name of the stage or NULL if it is invalid.
+ */
+const char *spdk_bdev_io_stage_get_name(enum spdk_bdev_io_stage stage);
+
+/**
+ * Enable or disable collecting per-stage latency histograms on a bdev.
+ *
+ * \param bdev Block device.
+ * \param cb_fn Callback function to be called when histograms are enabled.
+ * \param cb_arg Argument to pass to cb_fn.
+ * \param enable Enable/disable flag
+ */
+void spdk_bdev_stage_histogram_enable(struct spdk_bdev *bdev,
+				      spdk_bdev_histogram_status_cb cb_fn,
+				      void *cb_arg, bool enable);
+
+/**
+ * Get aggregated per-stage latency histograms from a bdev. Callback provides
+ * histograms merged from all channels of the bdev.
+ *
+ * \param bdev Block device.
+ * \param histograms Array of SPDK_BDEV_IO_NUM_STAGES histograms for aggregated data,
+ * indexed by enum spdk_bdev_io_stage.
+ * \param cb_fn Callback function to be called with data collected on bdev.
+ * \param cb_arg Argument to pass to cb_fn.
+ */
+void spdk_bdev_stage_histogram_get(struct spdk_bdev *bdev,
+				   struct spdk_histogram_data **histograms,
+				   spdk_bdev_stage_histogram_data_cb cb_fn,
+				   void *cb_arg);
+
 /**
  * Retrieves media events.  Can only be called from the context of
  * SPDK_BDEV_EVENT_MEDIA_MANAGEMENT event callback.  These events are sent by
@@ -310,6 +310,13 @@ struct spdk_bdev {
 	/* Maximum number of segments in a I/O */
 	uint32_t max_num_segments;
 
+	/**
+	 * Maximum number of blocks in a single COPY request, or 0 for no limit.
+	 * The bdev layer splits larger COPY I/O before submitting them to the
+	 * bdev module.
+	 */
+	uint32_t max_copy;
+
 	/**
 	 * UUID for this bdev.
 	 *
@@ -445,6 +452,9 @@ struct spdk_bdev {
 		bool	histogram_enabled;
 		bool	histogram_in_progress;
 
+		/** per-stage latency histograms enabled on this bdev */
+		bool	stage_histogram_enabled;
+
 		/** Currently locked ranges for this bdev.  Used to populate new channels. */
 		lba_range_tailq_t locked_ranges;
 
@@ -544,6 +554,13 @@ struct spdk_bdev_io {
 				uint8_t start : 1;
 			} zcopy;
 
+			struct {
+				/** Starting source offset (in blocks) of the bdev for copy I/O.
+				 *  offset_blocks holds the destination offset.
+				 */
+				uint64_t src_offset_blocks;
+			} copy;
+
 			struct {
 				/** The callback argument for the outstanding request which this abort
 				 *  attempts to cancel.
@@ -616,6 +633,13 @@ struct spdk_bdev_io {
 		/** Current tsc at submit time. Used to calculate latency at completion. */
 		uint64_t submit_tsc;
 
+		/**
+		 * Tsc when the I/O was passed to the bdev module and when the module completed it.
+		 * Only set while per-stage latency histograms are enabled.
+		 */
+		uint64_t module_submit_tsc;
+		uint64_t module_complete_tsc;
+
 		/** Error information from a device */
 		union {
 			struct {
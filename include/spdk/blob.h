@@ -233,6 +233,13 @@ struct spdk_bs_opts {
 	 * After that, new added fields should be put in the end of the struct.
 	 */
 	size_t opts_size;
+
+	/**
+	 * Group commit window for metadata persists, in microseconds. Persists of
+	 * different blobs started within the window are written together. 0, the
+	 * default, writes each blob's metadata as soon as it is persisted.
+	 */
+	uint32_t md_batch_window_us;
 };
 
 /**
@@ -622,6 +629,14 @@ struct spdk_blob_open_opts {
 	 * New added fields should be put at the end of the struct.
 	 */
 	size_t opts_size;
+
+	/**
+	 * Number of clusters to allocate at once when a thin provisioned blob that is not
+	 * backed by a snapshot is first written to an unallocated cluster. The clusters
+	 * following the written one are claimed up front, so that a sequential fill
+	 * updates the metadata once per run instead of once per cluster. Default is 1.
+	 */
+	uint32_t cluster_alloc_hint;
 };
 
 /**
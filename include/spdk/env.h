@@ -1120,6 +1120,44 @@ int spdk_pci_device_cfg_write32(struct spdk_pci_device *dev, uint32_t value, uin
  */
 bool spdk_pci_device_is_removed(struct spdk_pci_device *dev);
 
+/**
+ * Enable MSI-X interrupts of a PCI device and back each of its vectors with an
+ * event file descriptor.
+ *
+ * Vector 0 is always enabled. \c efd_count additional event file descriptors
+ * are allocated for vectors 1 to \c efd_count. This is only supported for
+ * devices bound to vfio-pci that expose MSI-X.
+ *
+ * \param dev PCI device.
+ * \param efd_count Number of vectors to enable in addition to vector 0.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_pci_device_enable_interrupts(struct spdk_pci_device *dev, uint32_t efd_count);
+
+/**
+ * Disable the interrupts enabled by spdk_pci_device_enable_interrupts() and
+ * release their event file descriptors.
+ *
+ * \param dev PCI device.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_pci_device_disable_interrupts(struct spdk_pci_device *dev);
+
+/**
+ * Get the event file descriptor signalled by an interrupt vector of a PCI device.
+ *
+ * The file descriptor is owned by the PCI device and must not be closed by the
+ * caller. It stays valid until spdk_pci_device_disable_interrupts() is called.
+ *
+ * \param dev PCI device.
+ * \param index Interrupt vector.
+ *
+ * \return the event file descriptor on success, negative errno on failure.
+ */
+int spdk_pci_device_get_interrupt_efd_by_index(struct spdk_pci_device *dev, uint32_t index);
+
 /**
  * Compare two PCI addresses.
  *
@@ -1295,6 +1295,18 @@ struct spdk_nvme_io_qpair_opts {
 	 * poll group and then connect it later.
 	 */
 	bool create_only;
+
+	/**
+	 * Enable completion interrupts on this queue pair. An event file descriptor
+	 * is signalled whenever the controller posts a completion, see
+	 * spdk_nvme_qpair_get_interrupt_fd(). Completions still have to be reaped
+	 * with spdk_nvme_qpair_process_completions().
+	 *
+	 * This only applies to the PCIe transport with the controller bound to
+	 * vfio-pci. If interrupts cannot be enabled, the queue pair is created
+	 * without them.
+	 */
+	bool enable_interrupts;
 };
 
 /**
@@ -1551,6 +1563,49 @@ int spdk_nvme_ctrlr_cmd_io_raw_with_md(struct spdk_nvme_ctrlr *ctrlr,
 int32_t spdk_nvme_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 
+/**
+ * Start a batch of command submissions on a queue pair.
+ *
+ * Commands submitted on the queue pair after this call are placed on the
+ * submission queue, but the controller is only notified of them once, either
+ * by spdk_nvme_qpair_submit_batch_end() or by the next call to
+ * spdk_nvme_qpair_process_completions() (including through
+ * spdk_nvme_poll_group_process_completions()), whichever comes first. This
+ * cuts the number of doorbell writes when many commands are submitted at once.
+ *
+ * Batches do not nest. Transports that do not support batching submit each
+ * command as usual. Currently only the PCIe transport supports batching.
+ *
+ * The caller must ensure that each queue pair is only used from one thread at a
+ * time.
+ *
+ * \param qpair Queue pair to start the batch on.
+ */
+void spdk_nvme_qpair_submit_batch_start(struct spdk_nvme_qpair *qpair);
+
+/**
+ * End a batch of command submissions started by spdk_nvme_qpair_submit_batch_start()
+ * and notify the controller of all commands submitted in it.
+ *
+ * \param qpair Queue pair to end the batch on.
+ */
+void spdk_nvme_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair);
+
+/**
+ * Get the event file descriptor signalled by completions on a queue pair
+ * allocated with spdk_nvme_io_qpair_opts::enable_interrupts.
+ *
+ * The file descriptor is owned by the driver and must not be closed by the
+ * caller. Reading it only acknowledges the interrupt; completions must still be
+ * processed with spdk_nvme_qpair_process_completions().
+ *
+ * \param qpair Queue pair to get the file descriptor of.
+ *
+ * \return the event file descriptor on success, -ENOTSUP if the queue pair has
+ * no completion interrupts.
+ */
+int spdk_nvme_qpair_get_interrupt_fd(struct spdk_nvme_qpair *qpair);
+
 /**
  * Returns the reason the qpair is disconnected.
  *
@@ -2501,6 +2556,7 @@ enum spdk_nvme_ns_flags {
 							      part of the logical block that it is associated with */
 	SPDK_NVME_NS_WRITE_UNCORRECTABLE_SUPPORTED	= 1 << 6, /**< The write uncorrectable command is supported */
 	SPDK_NVME_NS_COMPARE_SUPPORTED		= 1 << 7, /**< The compare command is supported */
+	SPDK_NVME_NS_COPY_SUPPORTED		= 1 << 8, /**< The copy command is supported */
 };
 
 /**
@@ -2909,6 +2965,39 @@ int spdk_nvme_ns_cmd_dataset_management(struct spdk_nvme_ns *ns, struct spdk_nvm
 					spdk_nvme_cmd_cb cb_fn,
 					void *cb_arg);
 
+/**
+ * Submit a simple copy command request to the specified NVMe namespace.
+ *
+ * The command is submitted to a qpair allocated by spdk_nvme_ctrlr_alloc_io_qpair().
+ * The user must ensure that only one thread submits I/O on a given qpair at any
+ * given time.
+ *
+ * This is a convenience wrapper that will automatically allocate and construct
+ * the correct data buffers. Therefore, ranges does not need to be allocated from
+ * pinned memory and can be placed on the stack.
+ *
+ * The number of ranges, the length of each range and the total length are limited by
+ * the MSRC, MSSRL and MCL fields of the namespace's identify data.
+ *
+ * \param ns NVMe namespace to submit the copy request
+ * \param qpair I/O queue pair to submit the request
+ * \param ranges An array of \ref spdk_nvme_scc_source_range elements describing the
+ * source LBAs to copy from.
+ * \param num_ranges The number of elements in the ranges array.
+ * \param dest_lba Destination LBA to copy the data to.
+ * \param cb_fn Callback function to invoke when the I/O is completed
+ * \param cb_arg Argument to pass to the callback function
+ *
+ * \return 0 if successfully submitted, negated errnos on the following error conditions:
+ * -EINVAL: Invalid ranges or number of ranges.
+ * -ENOMEM: The request cannot be allocated.
+ * -ENXIO: The qpair is failed at the transport level.
+ */
+int spdk_nvme_ns_cmd_copy(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			  const struct spdk_nvme_scc_source_range *ranges,
+			  uint16_t num_ranges, uint64_t dest_lba,
+			  spdk_nvme_cmd_cb cb_fn, void *cb_arg);
+
 /**
  * Submit a flush request to the specified NVMe namespace.
  *
@@ -3468,6 +3557,10 @@ struct spdk_nvme_transport_ops {
 			uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 
 	int (*poll_group_destroy)(struct spdk_nvme_transport_poll_group *tgroup);
+
+	void (*qpair_flush_submissions)(struct spdk_nvme_qpair *qpair);
+
+	int (*qpair_get_interrupt_fd)(struct spdk_nvme_qpair *qpair);
 };
 
 /**
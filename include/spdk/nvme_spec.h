@@ -72,6 +72,16 @@ extern "C" {
  */
 #define SPDK_NVME_DATASET_MANAGEMENT_RANGE_MAX_BLOCKS	0xFFFFFFFFu
 
+/**
+ * Maximum number of source ranges that may be specified in a copy command.
+ */
+#define SPDK_NVME_COPY_MAX_RANGES	256
+
+/**
+ * Maximum number of blocks that may be specified in a single copy source range.
+ */
+#define SPDK_NVME_COPY_RANGE_MAX_BLOCKS	0x10000u
+
 union spdk_nvme_cap_register {
 	uint64_t	raw;
 	struct {
@@ -1338,6 +1348,28 @@ struct spdk_nvme_dsm_range {
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_dsm_range) == 16, "Incorrect size");
 
+/**
+ * Copy command source range descriptor format
+ */
+enum spdk_nvme_copy_desc_format {
+	SPDK_NVME_COPY_DESC_FORMAT_0	= 0x0,
+};
+
+/**
+ * Simple Copy Command source range (descriptor format 0)
+ */
+struct spdk_nvme_scc_source_range {
+	uint64_t reserved0;
+	uint64_t slba;		/**< starting LBA */
+	uint16_t nlb;		/**< number of logical blocks, 0's based */
+	uint16_t reserved18;
+	uint32_t eilbrt;	/**< expected initial logical block reference tag */
+	uint16_t elbat;		/**< expected logical block application tag */
+	uint16_t elbatm;	/**< expected logical block application tag mask */
+	uint32_t reserved28;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_scc_source_range) == 32, "Incorrect size");
+
 /**
  * Status code types
  */
@@ -1443,6 +1475,7 @@ enum spdk_nvme_command_specific_status_code {
 	SPDK_NVME_SC_CONFLICTING_ATTRIBUTES		= 0x80,
 	SPDK_NVME_SC_INVALID_PROTECTION_INFO		= 0x81,
 	SPDK_NVME_SC_ATTEMPTED_WRITE_TO_RO_RANGE	= 0x82,
+	SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED	= 0x83,
 };
 
 /**
@@ -1539,6 +1572,8 @@ enum spdk_nvme_nvm_opcode {
 
 	SPDK_NVME_OPC_RESERVATION_ACQUIRE		= 0x11,
 	SPDK_NVME_OPC_RESERVATION_RELEASE		= 0x15,
+
+	SPDK_NVME_OPC_COPY				= 0x19,
 };
 
 /**
@@ -2132,7 +2167,9 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 		uint16_t	set_features_save: 1;
 		uint16_t	reservations: 1;
 		uint16_t	timestamp: 1;
-		uint16_t	reserved: 9;
+		uint16_t	verify: 1;
+		uint16_t	copy: 1;
+		uint16_t	reserved: 7;
 	} oncs;
 
 	/** fused operation support */
@@ -2444,7 +2481,18 @@ struct spdk_nvme_ns_data {
 	/** NVM capacity */
 	uint64_t		nvmcap[2];
 
-	uint8_t			reserved64[28];
+	uint8_t			reserved64[10];
+
+	/** maximum single source range length */
+	uint16_t		mssrl;
+
+	/** maximum copy length */
+	uint32_t		mcl;
+
+	/** maximum source range count, 0's based */
+	uint8_t			msrc;
+
+	uint8_t			reserved81[11];
 
 	/** ANA group identifier */
 	uint32_t		anagrpid;
@@ -66,10 +66,20 @@ struct spdk_json_write_ctx;
 struct spdk_json_val;
 struct spdk_nvmf_transport;
 
+/* How new qpairs are assigned to the target's poll groups */
+enum spdk_nvmf_tgt_qpair_placement {
+	/* Use the transport's preferred poll group, otherwise take the poll groups in turn */
+	SPDK_NVMF_TGT_QPAIR_PLACEMENT_ROUND_ROBIN = 0,
+
+	/* Use the poll group with the lowest load, ignoring the transport's preference */
+	SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED,
+};
+
 struct spdk_nvmf_target_opts {
 	char		name[NVMF_TGT_NAME_MAX_LENGTH];
 	uint32_t	max_subsystems;
 	uint32_t	acceptor_poll_rate;
+	enum spdk_nvmf_tgt_qpair_placement	qpair_placement;
 };
 
 struct spdk_nvmf_transport_opts {
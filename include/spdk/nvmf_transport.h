@@ -79,6 +79,21 @@ struct spdk_nvmf_dif_info {
 	uint32_t				orig_length;
 };
 
+enum spdk_nvmf_zcopy_phase {
+	/* The request is not using zero-copy */
+	NVMF_ZCOPY_PHASE_NONE,
+	/* Requesting the data buffers from the bdev */
+	NVMF_ZCOPY_PHASE_INIT,
+	/* The request holds the bdev's data buffers */
+	NVMF_ZCOPY_PHASE_EXECUTE,
+	/* Releasing the data buffers to the bdev */
+	NVMF_ZCOPY_PHASE_END_PENDING,
+	/* The data buffers were released */
+	NVMF_ZCOPY_PHASE_COMPLETE,
+	/* The data buffers could not be obtained */
+	NVMF_ZCOPY_PHASE_INIT_FAILED,
+};
+
 struct spdk_nvmf_request {
 	struct spdk_nvmf_qpair		*qpair;
 	uint32_t			length;
@@ -97,6 +112,8 @@ struct spdk_nvmf_request {
 	struct spdk_nvmf_request	*req_to_abort;
 	struct spdk_poller		*poller;
 	uint64_t			timeout_tsc;
+	struct spdk_bdev_io		*zcopy_bdev_io;
+	enum spdk_nvmf_zcopy_phase	zcopy_phase;
 
 	STAILQ_ENTRY(spdk_nvmf_request)	buf_link;
 	TAILQ_ENTRY(spdk_nvmf_request)	link;
@@ -162,6 +179,18 @@ struct spdk_nvmf_poll_group {
 	/* Statistics */
 	struct spdk_nvmf_poll_group_stat		stat;
 
+	/* Load of the poll group, used to place new qpairs. The busy percentage
+	 * and outstanding I/O are sampled periodically on the poll group's thread.
+	 */
+	struct spdk_poller				*load_poller;
+	uint64_t					last_busy_tsc;
+	uint64_t					last_idle_tsc;
+	uint32_t					busy_pct;
+	uint64_t					outstanding_io;
+	uint32_t					num_qpairs;
+	/* Qpairs assigned to this poll group, but not added yet */
+	uint32_t					pending_qpairs;
+
 	spdk_nvmf_poll_group_destroy_done_fn		destroy_cb_fn;
 	void						*destroy_cb_arg;
 
@@ -377,6 +406,13 @@ struct spdk_nvmf_transport_ops {
 	 * Free transport poll group statistics previously allocated with poll_group_get_stat()
 	 */
 	void (*poll_group_free_stat)(struct spdk_nvmf_transport_poll_group_stat *stat);
+
+	/*
+	 * Release the zero-copy buffers of the requests still waiting for data from the
+	 * host, so that they don't keep a disconnecting qpair from being destroyed.
+	 * Called when a qpair with outstanding requests starts disconnecting. Optional.
+	 */
+	void (*qpair_abort_zcopy)(struct spdk_nvmf_qpair *qpair);
 };
 
 /**
@@ -433,6 +469,46 @@ void spdk_nvmf_request_exec_fabrics(struct spdk_nvmf_request *req);
 int spdk_nvmf_request_free(struct spdk_nvmf_request *req);
 int spdk_nvmf_request_complete(struct spdk_nvmf_request *req);
 
+/**
+ * Check whether the data buffers of a request are provided by the bdev.
+ *
+ * \param req The NVMe-oF request
+ *
+ * \return true if the request uses zero-copy, false otherwise.
+ */
+static inline bool
+spdk_nvmf_request_using_zcopy(const struct spdk_nvmf_request *req)
+{
+	return req->zcopy_phase != NVMF_ZCOPY_PHASE_NONE;
+}
+
+/**
+ * Get the data buffers of a read or write request from the bdev of its namespace
+ * instead of the transport's buffer pool.
+ *
+ * The request's zcopy_phase must be NVMF_ZCOPY_PHASE_INIT. When the buffers were
+ * obtained, the request's iovecs describe them, its zcopy_phase becomes
+ * NVMF_ZCOPY_PHASE_EXECUTE and the transport's req_complete callback is called
+ * without completing the request. The request is then executed with
+ * spdk_nvmf_request_exec() and its buffers are released with
+ * spdk_nvmf_request_zcopy_end() once the transport no longer needs them. If the
+ * buffers can't be obtained, the request is completed with an error and its
+ * zcopy_phase becomes NVMF_ZCOPY_PHASE_INIT_FAILED.
+ *
+ * \param req The NVMe-oF request
+ */
+void spdk_nvmf_request_zcopy_start(struct spdk_nvmf_request *req);
+
+/**
+ * Release the data buffers of a request obtained by spdk_nvmf_request_zcopy_start().
+ *
+ * The request is completed when the buffers were released.
+ *
+ * \param req The NVMe-oF request
+ * \param commit Whether to write the data in the buffers to the bdev.
+ */
+void spdk_nvmf_request_zcopy_end(struct spdk_nvmf_request *req, bool commit);
+
 /**
  * Remove the given qpair from the poll group.
  *
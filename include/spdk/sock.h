@@ -72,6 +72,8 @@ struct spdk_sock_request {
 	struct __sock_request_internal {
 		TAILQ_ENTRY(spdk_sock_request)	link;
 		uint32_t			offset;
+		/* Set once any part of the request was sent with zero copy */
+		bool				is_zcopy;
 	} internal;
 
 	int				iovcnt;
@@ -118,6 +120,13 @@ struct spdk_sock_impl_opts {
 	 */
 	uint32_t enable_placement_id;
 
+	/**
+	 * Minimum number of bytes a flush has to send to use the zero copy flow when
+	 * enable_zerocopy_send is set. Smaller sends are copied into the kernel and their
+	 * requests complete as soon as they are written. 0 means every send uses zero copy.
+	 * Used by posix socket module.
+	 */
+	uint32_t zerocopy_threshold;
 };
 
 /**
@@ -333,6 +333,26 @@ struct spdk_cpuset *spdk_thread_get_cpumask(struct spdk_thread *thread);
  */
 int spdk_thread_set_cpumask(struct spdk_cpuset *cpumask);
 
+/**
+ * Get the NUMA socket the thread's I/O is local to.
+ *
+ * \param thread The thread to get the socket hint for.
+ *
+ * \return socket id, or SPDK_ENV_SOCKET_ID_ANY if no hint was set.
+ */
+int32_t spdk_thread_get_socket_hint(struct spdk_thread *thread);
+
+/**
+ * Set the NUMA socket the current thread's I/O is local to, for example the
+ * socket of the NIC or SSD that the thread polls. Schedulers use it as a hint
+ * to place the thread on a core of that socket.
+ *
+ * \param socket_id The socket id, or SPDK_ENV_SOCKET_ID_ANY to clear the hint.
+ *
+ * \return 0 on success, negated errno otherwise.
+ */
+int spdk_thread_set_socket_hint(int32_t socket_id);
+
 /**
  * Return the thread object associated with the context handle previously
  * obtained by calling spdk_thread_get_ctx().
@@ -447,6 +467,15 @@ struct spdk_thread *spdk_thread_get_by_id(uint64_t id);
 struct spdk_thread_stats {
 	uint64_t busy_tsc;
 	uint64_t idle_tsc;
+
+	/* Number of messages executed by the thread */
+	uint64_t msg_count;
+
+	/* Number of messages queued to the thread, seen the last time it polled them */
+	uint64_t msg_backlog;
+
+	/* Highest number of messages queued to the thread seen so far */
+	uint64_t msg_backlog_max;
 };
 
 /**
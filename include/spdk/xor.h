@@ -0,0 +1,134 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * XOR and RAID-6 P+Q parity utility functions
+ */
+
+#ifndef SPDK_XOR_H
+#define SPDK_XOR_H
+
+#include "spdk/stdinc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Maximum number of sources accepted by the iovec and P+Q variants. The Q
+ * syndrome is calculated in GF(2^8), so it cannot cover more than 255 sources.
+ */
+#define SPDK_XOR_MAX_SOURCES 255
+
+/**
+ * Get the buffer alignment that gives the best XOR performance.
+ *
+ * Buffers with any alignment are accepted, but aligning them to this value
+ * avoids split loads and stores in the vectorized code paths.
+ *
+ * \return Optimal alignment in bytes.
+ */
+size_t spdk_xor_get_optimal_alignment(void);
+
+/**
+ * XOR the source buffers together and store the result in the destination buffer.
+ *
+ * The destination buffer may be one of the sources.
+ *
+ * \param dest Destination buffer.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers.
+ * \param len Length of each buffer in bytes.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_xor_gen(void *dest, void **sources, uint32_t n, size_t len);
+
+/**
+ * XOR the source iovecs together and store the result in the destination iovecs.
+ *
+ * The iovec arrays of the destination and sources may be split differently.
+ *
+ * \param dest_iovs Destination iovec array.
+ * \param dest_iovcnt Number of elements in dest_iovs.
+ * \param src_iovs Array of n source iovec arrays.
+ * \param src_iovcnts Array of n element counts of the source iovec arrays.
+ * \param n Number of sources, at most SPDK_XOR_MAX_SOURCES.
+ * \param len Number of bytes to process. Every iovec array must cover at least
+ * this many bytes.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_xor_gen_iov(struct iovec *dest_iovs, int dest_iovcnt,
+		     struct iovec **src_iovs, int *src_iovcnts, uint32_t n, size_t len);
+
+/**
+ * Generate the RAID-6 P and Q syndromes of the source buffers.
+ *
+ * P is the XOR of the sources. Q is the sum of g^i * sources[i] in GF(2^8)
+ * with the generator g = 2 and the polynomial 0x11d.
+ *
+ * \param p Destination buffer for the P syndrome.
+ * \param q Destination buffer for the Q syndrome.
+ * \param sources Array of source buffers.
+ * \param n Number of source buffers, at most SPDK_XOR_MAX_SOURCES.
+ * \param len Length of each buffer in bytes.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, size_t len);
+
+/**
+ * Generate the RAID-6 P and Q syndromes of the source iovecs.
+ *
+ * \param p_iovs Destination iovec array for the P syndrome.
+ * \param p_iovcnt Number of elements in p_iovs.
+ * \param q_iovs Destination iovec array for the Q syndrome.
+ * \param q_iovcnt Number of elements in q_iovs.
+ * \param src_iovs Array of n source iovec arrays.
+ * \param src_iovcnts Array of n element counts of the source iovec arrays.
+ * \param n Number of sources, at most SPDK_XOR_MAX_SOURCES.
+ * \param len Number of bytes to process. Every iovec array must cover at least
+ * this many bytes.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_xor_gen_pq_iov(struct iovec *p_iovs, int p_iovcnt, struct iovec *q_iovs, int q_iovcnt,
+			struct iovec **src_iovs, int *src_iovcnts, uint32_t n, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPDK_XOR_H */
@@ -69,6 +69,10 @@ struct spdk_lw_thread {
 	struct spdk_thread_stats	current_stats;
 	struct spdk_thread_stats	snapshot_stats;
 	struct spdk_thread_stats	last_stats;
+	/* Load estimate maintained by the scheduler, in percent */
+	uint32_t			load_avg;
+	/* Number of times the thread was moved to another core by the scheduler */
+	uint64_t			migrations;
 };
 
 /**
@@ -340,12 +344,31 @@ typedef int (*spdk_scheduler_init_fn)(struct spdk_governor *governor);
  */
 typedef int (*spdk_scheduler_deinit_fn)(struct spdk_governor *governor);
 
+/**
+ * Scheduler info function type.
+ * Called to write scheduler specific information, such as its placement decisions,
+ * into the JSON object returned by the framework_get_scheduler RPC. Optional.
+ */
+typedef void (*spdk_scheduler_dump_info_json_fn)(struct spdk_json_write_ctx *w);
+
+/**
+ * Scheduler options function type.
+ * Called with the parameters of the framework_set_scheduler RPC, before the
+ * scheduler is switched to, so that the scheduler can decode its own options
+ * from them. The options must be kept across init and deinit. Optional.
+ *
+ * \return 0 on success, negative errno on invalid options.
+ */
+typedef int (*spdk_scheduler_set_opts_fn)(const struct spdk_json_val *opts);
+
 /** Thread scheduler */
 struct spdk_scheduler {
 	char                        *name;
 	spdk_scheduler_init_fn       init;
 	spdk_scheduler_deinit_fn     deinit;
 	spdk_scheduler_balance_fn    balance;
+	spdk_scheduler_dump_info_json_fn dump_info_json;
+	spdk_scheduler_set_opts_fn   set_opts;
 	TAILQ_ENTRY(spdk_scheduler)  link;
 };
 
@@ -373,6 +396,15 @@ int _spdk_scheduler_set(char *name);
  */
 struct spdk_scheduler *_spdk_scheduler_get(void);
 
+/**
+ * Find a registered scheduler by name.
+ *
+ * \param name Name of the scheduler.
+ *
+ * \return the scheduler, or NULL if there is no scheduler with that name.
+ */
+struct spdk_scheduler *_spdk_scheduler_find(const char *name);
+
 /**
  * Change current scheduling period.
  *
@@ -221,20 +221,32 @@ _update_crc32c_iov(struct iovec *iov, int iovcnt, uint32_t crc32c)
 }
 
 static uint32_t
-nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
+_update_crc32c_iov_range(struct iovec *iov, int iovcnt, uint32_t offset, uint32_t len,
+			 uint32_t crc32c)
 {
-	uint32_t crc32c = SPDK_CRC32C_XOR;
-	uint32_t mod;
+	uint32_t chunk;
+	int i;
 
-	assert(pdu->data_len != 0);
+	for (i = 0; i < iovcnt && len > 0; i++) {
+		if (offset >= iov[i].iov_len) {
+			offset -= iov[i].iov_len;
+			continue;
+		}
 
-	if (spdk_likely(!pdu->dif_ctx)) {
-		crc32c = _update_crc32c_iov(pdu->data_iov, pdu->data_iovcnt, crc32c);
-	} else {
-		spdk_dif_update_crc32c_stream(pdu->data_iov, pdu->data_iovcnt,
-					      0, pdu->data_len, &crc32c, pdu->dif_ctx);
+		chunk = spdk_min(len, iov[i].iov_len - offset);
+		crc32c = spdk_crc32c_update((uint8_t *)iov[i].iov_base + offset, chunk, crc32c);
+		offset = 0;
+		len -= chunk;
 	}
 
+	return crc32c;
+}
+
+static uint32_t
+_nvme_tcp_pdu_finish_data_digest(struct nvme_tcp_pdu *pdu, uint32_t crc32c)
+{
+	uint32_t mod;
+
 	mod = pdu->data_len % SPDK_NVME_TCP_DIGEST_ALIGNMENT;
 	if (mod != 0) {
 		uint32_t pad_length = SPDK_NVME_TCP_DIGEST_ALIGNMENT - mod;
@@ -248,6 +260,62 @@ nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
 	return crc32c;
 }
 
+static uint32_t
+nvme_tcp_pdu_calc_data_digest(struct nvme_tcp_pdu *pdu)
+{
+	uint32_t crc32c = SPDK_CRC32C_XOR;
+
+	assert(pdu->data_len != 0);
+
+	if (spdk_likely(!pdu->dif_ctx)) {
+		crc32c = _update_crc32c_iov(pdu->data_iov, pdu->data_iovcnt, crc32c);
+	} else {
+		spdk_dif_update_crc32c_stream(pdu->data_iov, pdu->data_iovcnt,
+					      0, pdu->data_len, &crc32c, pdu->dif_ctx);
+	}
+
+	return _nvme_tcp_pdu_finish_data_digest(pdu, crc32c);
+}
+
+/*
+ * Accumulate the data digest over the payload bytes just read into the PDU, while
+ * they are still in the cache, instead of walking the whole payload again once it
+ * has been received. offset and len are relative to the start of the payload and
+ * may extend into the received data digest, which is not part of the digest itself.
+ */
+static void
+nvme_tcp_pdu_update_data_digest(struct nvme_tcp_pdu *pdu, uint32_t offset, uint32_t len)
+{
+	if (offset >= pdu->data_len) {
+		return;
+	}
+
+	len = spdk_min(len, pdu->data_len - offset);
+	if (offset == 0) {
+		pdu->data_digest_crc32 = SPDK_CRC32C_XOR;
+	}
+
+	if (spdk_likely(!pdu->dif_ctx)) {
+		pdu->data_digest_crc32 = _update_crc32c_iov_range(pdu->data_iov, pdu->data_iovcnt,
+					 offset, len, pdu->data_digest_crc32);
+	} else {
+		spdk_dif_update_crc32c_stream(pdu->data_iov, pdu->data_iovcnt, offset, len,
+					      &pdu->data_digest_crc32, pdu->dif_ctx);
+	}
+}
+
+/*
+ * Return the data digest accumulated by nvme_tcp_pdu_update_data_digest() once the
+ * whole payload has been received.
+ */
+static uint32_t
+nvme_tcp_pdu_get_data_digest(struct nvme_tcp_pdu *pdu)
+{
+	assert(pdu->data_len != 0);
+
+	return _nvme_tcp_pdu_finish_data_digest(pdu, pdu->data_digest_crc32);
+}
+
 static inline void
 _nvme_tcp_sgl_init(struct _nvme_tcp_sgl *s, struct iovec *iov, int iovcnt,
 		   uint32_t iov_offset)
@@ -156,6 +156,7 @@ spdk_sock_request_put(struct spdk_sock *sock, struct spdk_sock_request *req, int
 	TAILQ_REMOVE(&sock->pending_reqs, req, internal.link);
 
 	req->internal.offset = 0;
+	req->internal.is_zcopy = false;
 
 	closed = sock->flags.closed;
 	sock->cb_cnt++;
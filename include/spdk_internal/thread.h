@@ -69,6 +69,10 @@ struct spdk_poller {
 
 	uint64_t			period_ticks;
 	uint64_t			next_run_tick;
+	/* Breaks the ties of next_run_tick, timed pollers due at the same tick run in FIFO order */
+	uint64_t			timer_seq;
+	/* Position in the timed_pollers heap of the thread */
+	uint32_t			timer_index;
 	uint64_t			run_count;
 	uint64_t			busy_count;
 	spdk_poller_fn			fn;
@@ -103,9 +107,18 @@ struct spdk_thread {
 	 */
 	TAILQ_HEAD(active_pollers_head, spdk_poller)	active_pollers;
 	/**
-	 * Contains pollers running on this thread with a periodic timer.
+	 * Contains pollers running on this thread with a periodic timer, in a
+	 *  binary min-heap keyed on next_run_tick. The first element is the next
+	 *  poller to expire. The array has room for all the timed pollers
+	 *  registered on the thread, so that pollers can be resumed without
+	 *  allocating memory.
 	 */
-	TAILQ_HEAD(timed_pollers_head, spdk_poller)	timed_pollers;
+	struct spdk_poller				**timed_pollers;
+	uint32_t					num_timed_pollers;
+	uint32_t					max_timed_pollers;
+	/* Number of timed pollers registered on this thread, paused ones included */
+	uint32_t					num_registered_timed_pollers;
+	uint64_t					timer_seq;
 	/*
 	 * Contains paused pollers.  Pollers on this queue are waiting until
 	 * they are resumed (in which case they're put onto the active/timer
@@ -116,6 +129,8 @@ struct spdk_thread {
 	int				msg_fd;
 	SLIST_HEAD(, spdk_msg)		msg_cache;
 	size_t				msg_cache_count;
+	/* Number of messages run per poll, adapts to the depth of the messages ring */
+	uint32_t			msg_batch_size;
 	spdk_msg_fn			critical_msg;
 	uint64_t			id;
 	enum spdk_thread_state		state;
@@ -126,6 +141,8 @@ struct spdk_thread {
 
 	char				name[SPDK_MAX_THREAD_NAME_LEN + 1];
 	struct spdk_cpuset		cpumask;
+	/* NUMA socket the thread's I/O is local to, a placement hint for schedulers */
+	int32_t				socket_hint;
 	uint64_t			exit_timeout_tsc;
 
 	bool				interrupt_mode;
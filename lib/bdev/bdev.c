@@ -63,6 +63,8 @@ int __itt_init_ittlib(const char *, __itt_group_id);
 #define SPDK_BDEV_AUTO_EXAMINE			true
 #define BUF_SMALL_POOL_SIZE			8191
 #define BUF_LARGE_POOL_SIZE			1023
+#define BUF_SMALL_CACHE_SIZE			64
+#define BUF_LARGE_CACHE_SIZE			8
 #define NOMEM_THRESHOLD_COUNT			8
 #define ZERO_BUFFER_SIZE			0x100000
 
@@ -136,6 +138,8 @@ static struct spdk_bdev_opts	g_bdev_opts = {
 	.bdev_auto_examine = SPDK_BDEV_AUTO_EXAMINE,
 	.small_buf_pool_size = BUF_SMALL_POOL_SIZE,
 	.large_buf_pool_size = BUF_LARGE_POOL_SIZE,
+	.small_buf_cache_size = BUF_SMALL_CACHE_SIZE,
+	.large_buf_cache_size = BUF_LARGE_CACHE_SIZE,
 };
 
 static spdk_bdev_init_cb	g_init_cb_fn = NULL;
@@ -192,10 +196,32 @@ struct spdk_bdev_qos {
 	struct spdk_poller *poller;
 };
 
+/*
+ * Free data buffers sitting in a per-thread cache are linked through
+ *  their first bytes, so the cache needs no storage of its own.
+ */
+struct bdev_buf_cache_entry {
+	STAILQ_ENTRY(bdev_buf_cache_entry) link;
+};
+
+struct bdev_buf_cache {
+	STAILQ_HEAD(, bdev_buf_cache_entry) bufs;
+	uint32_t count;
+	uint32_t size;
+};
+
 struct spdk_bdev_mgmt_channel {
 	bdev_io_stailq_t need_buf_small;
 	bdev_io_stailq_t need_buf_large;
 
+	/*
+	 * Each thread also keeps a cache of small and large data buffers,
+	 *  so that getting and putting a buffer on the I/O path does not
+	 *  touch the shared buffer pools in the steady state.
+	 */
+	struct bdev_buf_cache small_buf_cache;
+	struct bdev_buf_cache large_buf_cache;
+
 	/*
 	 * Each thread keeps a cache of bdev_io - this allows
 	 *  bdev threads which are *not* DPDK threads to still
@@ -281,6 +307,9 @@ struct spdk_bdev_channel {
 
 	struct spdk_histogram_data *histogram;
 
+	/* Per-stage latency histograms, indexed by enum spdk_bdev_io_stage */
+	struct spdk_histogram_data *stage_histogram[SPDK_BDEV_IO_NUM_STAGES];
+
 #ifdef SPDK_CONFIG_VTUNE
 	uint64_t		start_tsc;
 	uint64_t		interval_tsc;
@@ -339,6 +368,7 @@ struct set_qos_limit_ctx {
 
 static void bdev_write_zero_buffer_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg);
 static void bdev_write_zero_buffer_next(void *_bdev_io);
+static void bdev_copy_next(void *_bdev_io);
 
 static void bdev_enable_qos_msg(struct spdk_io_channel_iter *i);
 static void bdev_enable_qos_done(struct spdk_io_channel_iter *i, int status);
@@ -393,10 +423,12 @@ spdk_bdev_get_opts(struct spdk_bdev_opts *opts, size_t opts_size)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(small_buf_pool_size);
 	SET_FIELD(large_buf_pool_size);
+	SET_FIELD(small_buf_cache_size);
+	SET_FIELD(large_buf_cache_size);
 
 	/* Do not remove this statement, you should always update this statement when you adding a new field,
 	 * and do not forget to add the SET_FIELD statement for your added field. */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 32, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bdev_opts) == 40, "Incorrect size");
 
 #undef SET_FIELD
 }
@@ -405,6 +437,7 @@ int
 spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 {
 	uint32_t min_pool_size;
+	uint32_t small_buf_cache_size, large_buf_cache_size;
 
 	if (!opts) {
 		SPDK_ERRLOG("opts cannot be NULL\n");
@@ -440,6 +473,40 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 		return -1;
 	}
 
+	/*
+	 * The buffer caches are filled on demand, but every thread may end up holding a full
+	 *  cache of each kind, so the pools must be able to cover all of them at once.
+	 *  Callers built against an older spdk_bdev_opts keep the current cache sizes.
+	 */
+	small_buf_cache_size = g_bdev_opts.small_buf_cache_size;
+	large_buf_cache_size = g_bdev_opts.large_buf_cache_size;
+	if (offsetof(struct spdk_bdev_opts, small_buf_cache_size) + sizeof(opts->small_buf_cache_size) <=
+	    opts->opts_size) {
+		small_buf_cache_size = opts->small_buf_cache_size;
+	}
+	if (offsetof(struct spdk_bdev_opts, large_buf_cache_size) + sizeof(opts->large_buf_cache_size) <=
+	    opts->opts_size) {
+		large_buf_cache_size = opts->large_buf_cache_size;
+	}
+
+	min_pool_size = small_buf_cache_size * (spdk_thread_get_count() + 1);
+	if (opts->small_buf_pool_size < min_pool_size) {
+		SPDK_ERRLOG("small_buf_pool_size %" PRIu32 " is not compatible with small_buf_cache_size %" PRIu32
+			    " and %" PRIu32 " threads\n", opts->small_buf_pool_size, small_buf_cache_size,
+			    spdk_thread_get_count());
+		SPDK_ERRLOG("small_buf_pool_size must be at least %" PRIu32 "\n", min_pool_size);
+		return -1;
+	}
+
+	min_pool_size = large_buf_cache_size * (spdk_thread_get_count() + 1);
+	if (opts->large_buf_pool_size < min_pool_size) {
+		SPDK_ERRLOG("large_buf_pool_size %" PRIu32 " is not compatible with large_buf_cache_size %" PRIu32
+			    " and %" PRIu32 " threads\n", opts->large_buf_pool_size, large_buf_cache_size,
+			    spdk_thread_get_count());
+		SPDK_ERRLOG("large_buf_pool_size must be at least %" PRIu32 "\n", min_pool_size);
+		return -1;
+	}
+
 #define SET_FIELD(field) \
         if (offsetof(struct spdk_bdev_opts, field) + sizeof(opts->field) <= opts->opts_size) { \
                 g_bdev_opts.field = opts->field; \
@@ -450,6 +517,8 @@ spdk_bdev_set_opts(struct spdk_bdev_opts *opts)
 	SET_FIELD(bdev_auto_examine);
 	SET_FIELD(small_buf_pool_size);
 	SET_FIELD(large_buf_pool_size);
+	SET_FIELD(small_buf_cache_size);
+	SET_FIELD(large_buf_cache_size);
 
 	g_bdev_opts.opts_size = opts->opts_size;
 
@@ -900,11 +969,63 @@ _bdev_io_set_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t len)
 	bdev_io_get_buf_complete(bdev_io, buf, true);
 }
 
+static void *
+bdev_buf_cache_get(struct bdev_buf_cache *cache, struct spdk_mempool *pool)
+{
+	struct bdev_buf_cache_entry *entry;
+
+	entry = STAILQ_FIRST(&cache->bufs);
+	if (spdk_likely(entry != NULL)) {
+		STAILQ_REMOVE_HEAD(&cache->bufs, link);
+		cache->count--;
+		return entry;
+	}
+
+	return spdk_mempool_get(pool);
+}
+
+static void
+bdev_buf_cache_put(struct bdev_buf_cache *cache, struct spdk_mempool *pool, void *buf)
+{
+	struct bdev_buf_cache_entry *entry = buf;
+
+	if (cache->count < cache->size) {
+		STAILQ_INSERT_HEAD(&cache->bufs, entry, link);
+		cache->count++;
+	} else {
+		spdk_mempool_put(pool, buf);
+	}
+}
+
+static void
+bdev_buf_cache_init(struct bdev_buf_cache *cache, uint32_t size)
+{
+	STAILQ_INIT(&cache->bufs);
+	cache->count = 0;
+	cache->size = size;
+}
+
+static void
+bdev_buf_cache_free(struct bdev_buf_cache *cache, struct spdk_mempool *pool)
+{
+	struct bdev_buf_cache_entry *entry;
+
+	while (!STAILQ_EMPTY(&cache->bufs)) {
+		entry = STAILQ_FIRST(&cache->bufs);
+		STAILQ_REMOVE_HEAD(&cache->bufs, link);
+		cache->count--;
+		spdk_mempool_put(pool, entry);
+	}
+
+	assert(cache->count == 0);
+}
+
 static void
 _bdev_io_put_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t buf_len)
 {
 	struct spdk_bdev *bdev = bdev_io->bdev;
 	struct spdk_mempool *pool;
+	struct bdev_buf_cache *cache;
 	struct spdk_bdev_io *tmp;
 	bdev_io_stailq_t *stailq;
 	struct spdk_bdev_mgmt_channel *ch;
@@ -917,14 +1038,16 @@ _bdev_io_put_buf(struct spdk_bdev_io *bdev_io, void *buf, uint64_t buf_len)
 	if (buf_len + alignment + md_len <= SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_SMALL_BUF_MAX_SIZE) +
 	    SPDK_BDEV_POOL_ALIGNMENT) {
 		pool = g_bdev_mgr.buf_small_pool;
+		cache = &ch->small_buf_cache;
 		stailq = &ch->need_buf_small;
 	} else {
 		pool = g_bdev_mgr.buf_large_pool;
+		cache = &ch->large_buf_cache;
 		stailq = &ch->need_buf_large;
 	}
 
 	if (STAILQ_EMPTY(stailq)) {
-		spdk_mempool_put(pool, buf);
+		bdev_buf_cache_put(cache, pool, buf);
 	} else {
 		tmp = STAILQ_FIRST(stailq);
 		STAILQ_REMOVE_HEAD(stailq, internal.buf_link);
@@ -997,6 +1120,7 @@ bdev_io_get_buf(struct spdk_bdev_io *bdev_io, uint64_t len)
 {
 	struct spdk_bdev *bdev = bdev_io->bdev;
 	struct spdk_mempool *pool;
+	struct bdev_buf_cache *cache;
 	bdev_io_stailq_t *stailq;
 	struct spdk_bdev_mgmt_channel *mgmt_ch;
 	uint64_t alignment, md_len;
@@ -1020,13 +1144,15 @@ bdev_io_get_buf(struct spdk_bdev_io *bdev_io, uint64_t len)
 	if (len + alignment + md_len <= SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_SMALL_BUF_MAX_SIZE) +
 	    SPDK_BDEV_POOL_ALIGNMENT) {
 		pool = g_bdev_mgr.buf_small_pool;
+		cache = &mgmt_ch->small_buf_cache;
 		stailq = &mgmt_ch->need_buf_small;
 	} else {
 		pool = g_bdev_mgr.buf_large_pool;
+		cache = &mgmt_ch->large_buf_cache;
 		stailq = &mgmt_ch->need_buf_large;
 	}
 
-	buf = spdk_mempool_get(pool);
+	buf = bdev_buf_cache_get(cache, pool);
 	if (!buf) {
 		STAILQ_INSERT_TAIL(stailq, bdev_io, internal.buf_link);
 	} else {
@@ -1125,6 +1251,10 @@ spdk_bdev_subsystem_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_uint32(w, "bdev_io_pool_size", g_bdev_opts.bdev_io_pool_size);
 	spdk_json_write_named_uint32(w, "bdev_io_cache_size", g_bdev_opts.bdev_io_cache_size);
 	spdk_json_write_named_bool(w, "bdev_auto_examine", g_bdev_opts.bdev_auto_examine);
+	spdk_json_write_named_uint32(w, "small_buf_pool_size", g_bdev_opts.small_buf_pool_size);
+	spdk_json_write_named_uint32(w, "large_buf_pool_size", g_bdev_opts.large_buf_pool_size);
+	spdk_json_write_named_uint32(w, "small_buf_cache_size", g_bdev_opts.small_buf_cache_size);
+	spdk_json_write_named_uint32(w, "large_buf_cache_size", g_bdev_opts.large_buf_cache_size);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -1166,6 +1296,10 @@ bdev_mgmt_channel_create(void *io_device, void *ctx_buf)
 	STAILQ_INIT(&ch->need_buf_small);
 	STAILQ_INIT(&ch->need_buf_large);
 
+	/* Buffer caches start empty and fill up as this thread returns buffers. */
+	bdev_buf_cache_init(&ch->small_buf_cache, g_bdev_opts.small_buf_cache_size);
+	bdev_buf_cache_init(&ch->large_buf_cache, g_bdev_opts.large_buf_cache_size);
+
 	STAILQ_INIT(&ch->per_thread_cache);
 	ch->bdev_io_cache_size = g_bdev_opts.bdev_io_cache_size;
 
@@ -1198,6 +1332,9 @@ bdev_mgmt_channel_destroy(void *io_device, void *ctx_buf)
 		SPDK_ERRLOG("Module channel list wasn't empty on mgmt channel free\n");
 	}
 
+	bdev_buf_cache_free(&ch->small_buf_cache, g_bdev_mgr.buf_small_pool);
+	bdev_buf_cache_free(&ch->large_buf_cache, g_bdev_mgr.buf_large_pool);
+
 	while (!STAILQ_EMPTY(&ch->per_thread_cache)) {
 		bdev_io = STAILQ_FIRST(&ch->per_thread_cache);
 		STAILQ_REMOVE_HEAD(&ch->per_thread_cache, internal.buf_link);
@@ -1336,7 +1473,6 @@ bdev_modules_init(void)
 void
 spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 {
-	int cache_size;
 	int rc = 0;
 	char mempool_name[32];
 
@@ -1364,18 +1500,17 @@ spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 	}
 
 	/**
-	 * Ensure no more than half of the total buffers end up local caches, by
-	 *   using spdk_env_get_core_count() to determine how many local caches we need
-	 *   to account for.
+	 * Data buffers are cached per thread in the bdev mgmt channel, which works for
+	 *   non-DPDK threads as well, so the buffer pools do not keep per-core caches
+	 *   of their own on top of that.
 	 */
-	cache_size = BUF_SMALL_POOL_SIZE / (2 * spdk_env_get_core_count());
 	snprintf(mempool_name, sizeof(mempool_name), "buf_small_pool_%d", getpid());
 
 	g_bdev_mgr.buf_small_pool = spdk_mempool_create(mempool_name,
 				    g_bdev_opts.small_buf_pool_size,
 				    SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_SMALL_BUF_MAX_SIZE) +
 				    SPDK_BDEV_POOL_ALIGNMENT,
-				    cache_size,
+				    0,
 				    SPDK_ENV_SOCKET_ID_ANY);
 	if (!g_bdev_mgr.buf_small_pool) {
 		SPDK_ERRLOG("create rbuf small pool failed\n");
@@ -1383,14 +1518,13 @@ spdk_bdev_initialize(spdk_bdev_init_cb cb_fn, void *cb_arg)
 		return;
 	}
 
-	cache_size = BUF_LARGE_POOL_SIZE / (2 * spdk_env_get_core_count());
 	snprintf(mempool_name, sizeof(mempool_name), "buf_large_pool_%d", getpid());
 
 	g_bdev_mgr.buf_large_pool = spdk_mempool_create(mempool_name,
 				    g_bdev_opts.large_buf_pool_size,
 				    SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_LARGE_BUF_MAX_SIZE) +
 				    SPDK_BDEV_POOL_ALIGNMENT,
-				    cache_size,
+				    0,
 				    SPDK_ENV_SOCKET_ID_ANY);
 	if (!g_bdev_mgr.buf_large_pool) {
 		SPDK_ERRLOG("create rbuf large pool failed\n");
@@ -1869,6 +2003,14 @@ _bdev_io_complete_in_submit(struct spdk_bdev_channel *bdev_ch,
 	bdev_io->internal.in_submit_request = false;
 }
 
+static inline void
+bdev_io_stage_module_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
+{
+	if (spdk_unlikely(bdev_ch->stage_histogram[0] != NULL)) {
+		bdev_io->internal.module_submit_tsc = spdk_get_ticks();
+	}
+}
+
 static inline void
 bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_io)
 {
@@ -1893,6 +2035,7 @@ bdev_io_do_submit(struct spdk_bdev_channel *bdev_ch, struct spdk_bdev_io *bdev_i
 		bdev_ch->io_outstanding++;
 		shared_resource->io_outstanding++;
 		bdev_io->internal.in_submit_request = true;
+		bdev_io_stage_module_submit(bdev_ch, bdev_io);
 		bdev->fn_table->submit_request(ch, bdev_io);
 		bdev_io->internal.in_submit_request = false;
 	} else {
@@ -2350,6 +2493,7 @@ bdev_io_range_is_locked(struct spdk_bdev_io *bdev_io, struct lba_range *range)
 	case SPDK_BDEV_IO_TYPE_UNMAP:
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
 	case SPDK_BDEV_IO_TYPE_ZCOPY:
+	case SPDK_BDEV_IO_TYPE_COPY:
 		r.offset = bdev_io->u.bdev.offset_blocks;
 		r.length = bdev_io->u.bdev.num_blocks;
 		if (!bdev_lba_range_overlapped(range, &r)) {
@@ -2437,6 +2581,7 @@ bdev_io_init(struct spdk_bdev_io *bdev_io,
 	bdev_io->internal.cb = cb;
 	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
 	bdev_io->internal.in_submit_request = false;
+	bdev_io->internal.module_submit_tsc = 0;
 	bdev_io->internal.buf = NULL;
 	bdev_io->internal.io_submit_ch = NULL;
 	bdev_io->internal.orig_iovs = NULL;
@@ -2472,6 +2617,11 @@ spdk_bdev_io_type_supported(struct spdk_bdev *bdev, enum spdk_bdev_io_type io_ty
 			supported = bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_READ) &&
 				    bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_WRITE);
 			break;
+		case SPDK_BDEV_IO_TYPE_COPY:
+			/* Copy can be emulated with regular read and write */
+			supported = bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_READ) &&
+				    bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_WRITE);
+			break;
 		default:
 			break;
 		}
@@ -2768,6 +2918,37 @@ spdk_bdev_set_timeout(struct spdk_bdev_desc *desc, uint64_t timeout_in_sec,
 	return 0;
 }
 
+static void
+bdev_channel_free_stage_histograms(struct spdk_bdev_channel *ch)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_IO_NUM_STAGES; i++) {
+		if (ch->stage_histogram[i] != NULL) {
+			spdk_histogram_data_free(ch->stage_histogram[i]);
+			ch->stage_histogram[i] = NULL;
+		}
+	}
+}
+
+static int
+bdev_channel_alloc_stage_histograms(struct spdk_bdev_channel *ch)
+{
+	int i;
+
+	for (i = 0; i < SPDK_BDEV_IO_NUM_STAGES; i++) {
+		if (ch->stage_histogram[i] == NULL) {
+			ch->stage_histogram[i] = spdk_histogram_data_alloc();
+			if (ch->stage_histogram[i] == NULL) {
+				bdev_channel_free_stage_histograms(ch);
+				return -ENOMEM;
+			}
+		}
+	}
+
+	return 0;
+}
+
 static int
 bdev_channel_create(void *io_device, void *ctx_buf)
 {
@@ -2792,6 +2973,12 @@ bdev_channel_create(void *io_device, void *ctx_buf)
 		}
 	}
 
+	if (bdev->internal.stage_histogram_enabled) {
+		if (bdev_channel_alloc_stage_histograms(ch) != 0) {
+			SPDK_ERRLOG("Could not allocate stage histograms\n");
+		}
+	}
+
 	mgmt_io_ch = spdk_get_io_channel(&g_bdev_mgr);
 	if (!mgmt_io_ch) {
 		spdk_put_io_channel(ch->channel);
@@ -3070,6 +3257,8 @@ bdev_channel_destroy(void *io_device, void *ctx_buf)
 		spdk_histogram_data_free(ch->histogram);
 	}
 
+	bdev_channel_free_stage_histograms(ch);
+
 	bdev_channel_destroy_resource(ch);
 }
 
@@ -4364,6 +4553,75 @@ spdk_bdev_write_zeroes_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channe
 	return 0;
 }
 
+static int
+bdev_copy_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		 uint64_t dst_offset_blocks, uint64_t src_offset_blocks, uint64_t num_blocks,
+		 spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
+	struct spdk_bdev_io *bdev_io;
+	struct spdk_bdev_channel *channel = spdk_io_channel_get_ctx(ch);
+
+	bdev_io = bdev_channel_get_io(channel);
+	if (!bdev_io) {
+		return -ENOMEM;
+	}
+
+	bdev_io->type = SPDK_BDEV_IO_TYPE_COPY;
+	bdev_io->internal.ch = channel;
+	bdev_io->internal.desc = desc;
+	bdev_io->u.bdev.offset_blocks = dst_offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+	bdev_io->u.bdev.copy.src_offset_blocks = src_offset_blocks;
+	bdev_io_init(bdev_io, bdev, cb_arg, cb);
+
+	if (bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY) &&
+	    (bdev->max_copy == 0 || num_blocks <= bdev->max_copy)) {
+		bdev_io_submit(bdev_io);
+		return 0;
+	}
+
+	/* Either split the request into max_copy sized children, or emulate it
+	 * with a read and a write per data buffer worth of blocks.
+	 */
+	bdev_io->u.bdev.split_remaining_num_blocks = num_blocks;
+	bdev_io->u.bdev.split_current_offset_blocks = dst_offset_blocks;
+	bdev_copy_next(bdev_io);
+
+	return 0;
+}
+
+int
+spdk_bdev_copy_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      uint64_t dst_offset_blocks, uint64_t src_offset_blocks,
+		      uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct spdk_bdev *bdev = spdk_bdev_desc_get_bdev(desc);
+
+	if (!desc->write) {
+		return -EBADF;
+	}
+
+	if (!bdev_io_valid_blocks(bdev, dst_offset_blocks, num_blocks) ||
+	    !bdev_io_valid_blocks(bdev, src_offset_blocks, num_blocks)) {
+		return -EINVAL;
+	}
+
+	/* The emulated copy moves data in chunks, so overlapping ranges are not allowed. */
+	if (num_blocks == 0 ||
+	    (dst_offset_blocks < src_offset_blocks + num_blocks &&
+	     src_offset_blocks < dst_offset_blocks + num_blocks)) {
+		return -EINVAL;
+	}
+
+	if (!spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY)) {
+		return -ENOTSUP;
+	}
+
+	return bdev_copy_blocks(desc, ch, dst_offset_blocks, src_offset_blocks, num_blocks,
+				cb, cb_arg);
+}
+
 int
 spdk_bdev_unmap(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 		uint64_t offset, uint64_t nbytes,
@@ -5027,6 +5285,7 @@ bdev_ch_retry_io(struct spdk_bdev_channel *bdev_ch)
 		bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
 		bdev_io->internal.error.nvme.cdw0 = 0;
 		bdev_io->num_retries++;
+		bdev_io_stage_module_submit(bdev_io->internal.ch, bdev_io);
 		bdev->fn_table->submit_request(spdk_bdev_io_get_io_channel(bdev_io), bdev_io);
 		if (bdev_io->internal.status == SPDK_BDEV_IO_STATUS_NOMEM) {
 			break;
@@ -5034,6 +5293,27 @@ bdev_ch_retry_io(struct spdk_bdev_channel *bdev_ch)
 	}
 }
 
+static void
+bdev_io_tally_stages(struct spdk_bdev_io *bdev_io, uint64_t tsc)
+{
+	struct spdk_bdev_channel *bdev_ch = bdev_io->internal.ch;
+
+	/* The histograms may have been disabled while the I/O was outstanding. */
+	if (bdev_ch->stage_histogram[0] == NULL) {
+		return;
+	}
+
+	/* A stage may take less than a tick, but histograms can't hold zero. */
+	spdk_histogram_data_tally(bdev_ch->stage_histogram[SPDK_BDEV_IO_STAGE_QUEUE],
+				  spdk_max(bdev_io->internal.module_submit_tsc -
+					   bdev_io->internal.submit_tsc, 1));
+	spdk_histogram_data_tally(bdev_ch->stage_histogram[SPDK_BDEV_IO_STAGE_MODULE],
+				  spdk_max(bdev_io->internal.module_complete_tsc -
+					   bdev_io->internal.module_submit_tsc, 1));
+	spdk_histogram_data_tally(bdev_ch->stage_histogram[SPDK_BDEV_IO_STAGE_COMPLETE],
+				  spdk_max(tsc - bdev_io->internal.module_complete_tsc, 1));
+}
+
 static inline void
 bdev_io_complete(void *ctx)
 {
@@ -5070,6 +5350,10 @@ bdev_io_complete(void *ctx)
 		spdk_histogram_data_tally(bdev_io->internal.ch->histogram, tsc_diff);
 	}
 
+	if (spdk_unlikely(bdev_io->internal.module_submit_tsc != 0)) {
+		bdev_io_tally_stages(bdev_io, tsc);
+	}
+
 	if (bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS) {
 		switch (bdev_io->type) {
 		case SPDK_BDEV_IO_TYPE_READ:
@@ -5214,6 +5498,10 @@ spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status sta
 			return;
 		}
 
+		if (spdk_unlikely(bdev_io->internal.module_submit_tsc != 0)) {
+			bdev_io->internal.module_complete_tsc = spdk_get_ticks();
+		}
+
 		if (spdk_unlikely(!TAILQ_EMPTY(&shared_resource->nomem_io))) {
 			bdev_ch_retry_io(bdev_ch);
 		}
@@ -6016,6 +6304,125 @@ bdev_write_zero_buffer_done(struct spdk_bdev_io *bdev_io, bool success, void *cb
 	bdev_write_zero_buffer_next(parent_io);
 }
 
+static void
+bdev_copy_fail(struct spdk_bdev_io *parent_io)
+{
+	parent_io->internal.status = SPDK_BDEV_IO_STATUS_FAILED;
+	parent_io->internal.cb(parent_io, false, parent_io->internal.caller_ctx);
+}
+
+static void
+bdev_copy_child_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *parent_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		bdev_copy_fail(parent_io);
+		return;
+	}
+
+	if (parent_io->u.bdev.split_remaining_num_blocks == 0) {
+		parent_io->internal.status = SPDK_BDEV_IO_STATUS_SUCCESS;
+		parent_io->internal.cb(parent_io, true, parent_io->internal.caller_ctx);
+		return;
+	}
+
+	bdev_copy_next(parent_io);
+}
+
+static void
+bdev_copy_emulated_write_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_bdev_io *read_io = cb_arg;
+	struct spdk_bdev_io *parent_io = read_io->internal.caller_ctx;
+
+	/* Freeing the read releases the data buffer the write was issued from */
+	spdk_bdev_free_io(read_io);
+	bdev_copy_child_done(bdev_io, success, parent_io);
+}
+
+static void
+bdev_copy_emulated_write(void *_bdev_io)
+{
+	struct spdk_bdev_io *read_io = _bdev_io;
+	struct spdk_bdev_io *parent_io = read_io->internal.caller_ctx;
+	uint64_t dst_offset_blocks;
+	int rc;
+
+	dst_offset_blocks = parent_io->u.bdev.offset_blocks + read_io->u.bdev.offset_blocks -
+			    parent_io->u.bdev.copy.src_offset_blocks;
+
+	rc = bdev_writev_blocks_with_md(parent_io->internal.desc,
+					spdk_io_channel_from_ctx(parent_io->internal.ch),
+					read_io->u.bdev.iovs, read_io->u.bdev.iovcnt,
+					read_io->u.bdev.md_buf, dst_offset_blocks,
+					read_io->u.bdev.num_blocks,
+					bdev_copy_emulated_write_done, read_io);
+	if (rc == -ENOMEM) {
+		bdev_queue_io_wait_with_cb(read_io, bdev_copy_emulated_write);
+	} else if (rc != 0) {
+		spdk_bdev_free_io(read_io);
+		bdev_copy_fail(parent_io);
+	}
+}
+
+static void
+bdev_copy_emulated_read_done(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	if (!success) {
+		bdev_copy_child_done(bdev_io, false, cb_arg);
+		return;
+	}
+
+	bdev_copy_emulated_write(bdev_io);
+}
+
+static void
+bdev_copy_next(void *_bdev_io)
+{
+	struct spdk_bdev_io *bdev_io = _bdev_io;
+	struct spdk_bdev *bdev = bdev_io->bdev;
+	struct spdk_io_channel *ch = spdk_io_channel_from_ctx(bdev_io->internal.ch);
+	uint64_t num_blocks, src_offset_blocks, max_blocks;
+	int rc;
+
+	/* The source advances by the same amount as the destination */
+	src_offset_blocks = bdev_io->u.bdev.copy.src_offset_blocks +
+			    bdev_io->u.bdev.split_current_offset_blocks -
+			    bdev_io->u.bdev.offset_blocks;
+
+	if (bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY)) {
+		num_blocks = spdk_min(bdev_io->u.bdev.split_remaining_num_blocks, bdev->max_copy);
+		rc = bdev_copy_blocks(bdev_io->internal.desc, ch,
+				      bdev_io->u.bdev.split_current_offset_blocks,
+				      src_offset_blocks, num_blocks,
+				      bdev_copy_child_done, bdev_io);
+	} else {
+		/* Let the read allocate a data buffer, then write that buffer out. The buffer
+		 * holds the blocks, their separate metadata and the alignment padding.
+		 */
+		max_blocks = (SPDK_BDEV_BUF_SIZE_WITH_MD(SPDK_BDEV_LARGE_BUF_MAX_SIZE) +
+			      SPDK_BDEV_POOL_ALIGNMENT - spdk_bdev_get_buf_align(bdev)) /
+			     _bdev_get_block_size_with_md(bdev);
+		num_blocks = spdk_min(bdev_io->u.bdev.split_remaining_num_blocks,
+				      spdk_max(max_blocks, 1));
+		rc = bdev_read_blocks_with_md(bdev_io->internal.desc, ch, NULL, NULL,
+					      src_offset_blocks, num_blocks,
+					      bdev_copy_emulated_read_done, bdev_io);
+	}
+
+	if (rc == 0) {
+		bdev_io->u.bdev.split_remaining_num_blocks -= num_blocks;
+		bdev_io->u.bdev.split_current_offset_blocks += num_blocks;
+	} else if (rc == -ENOMEM) {
+		bdev_queue_io_wait_with_cb(bdev_io, bdev_copy_next);
+	} else {
+		bdev_copy_fail(bdev_io);
+	}
+}
+
 static void
 bdev_set_qos_limit_done(struct set_qos_limit_ctx *ctx, int status)
 {
@@ -6269,6 +6676,8 @@ struct spdk_bdev_histogram_ctx {
 	void *cb_arg;
 	struct spdk_bdev *bdev;
 	int status;
+	/* true for the per-stage histograms, false for the total latency histogram */
+	bool stages;
 };
 
 static void
@@ -6288,8 +6697,11 @@ bdev_histogram_disable_channel(struct spdk_io_channel_iter *i)
 {
 	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
 	struct spdk_bdev_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bdev_histogram_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
 
-	if (ch->histogram != NULL) {
+	if (ctx->stages) {
+		bdev_channel_free_stage_histograms(ch);
+	} else if (ch->histogram != NULL) {
 		spdk_histogram_data_free(ch->histogram);
 		ch->histogram = NULL;
 	}
@@ -6303,7 +6715,11 @@ bdev_histogram_enable_channel_cb(struct spdk_io_channel_iter *i, int status)
 
 	if (status != 0) {
 		ctx->status = status;
-		ctx->bdev->internal.histogram_enabled = false;
+		if (ctx->stages) {
+			ctx->bdev->internal.stage_histogram_enabled = false;
+		} else {
+			ctx->bdev->internal.histogram_enabled = false;
+		}
 		spdk_for_each_channel(__bdev_to_io_dev(ctx->bdev), bdev_histogram_disable_channel, ctx,
 				      bdev_histogram_disable_channel_cb);
 	} else {
@@ -6320,9 +6736,12 @@ bdev_histogram_enable_channel(struct spdk_io_channel_iter *i)
 {
 	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
 	struct spdk_bdev_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bdev_histogram_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
 	int status = 0;
 
-	if (ch->histogram == NULL) {
+	if (ctx->stages) {
+		status = bdev_channel_alloc_stage_histograms(ch);
+	} else if (ch->histogram == NULL) {
 		ch->histogram = spdk_histogram_data_alloc();
 		if (ch->histogram == NULL) {
 			status = -ENOMEM;
@@ -6332,9 +6751,9 @@ bdev_histogram_enable_channel(struct spdk_io_channel_iter *i)
 	spdk_for_each_channel_continue(i, status);
 }
 
-void
-spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
-			   void *cb_arg, bool enable)
+static void
+bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
+		      void *cb_arg, bool enable, bool stages)
 {
 	struct spdk_bdev_histogram_ctx *ctx;
 
@@ -6348,6 +6767,7 @@ spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb
 	ctx->status = 0;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
+	ctx->stages = stages;
 
 	pthread_mutex_lock(&bdev->internal.mutex);
 	if (bdev->internal.histogram_in_progress) {
@@ -6360,7 +6780,11 @@ spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb
 	bdev->internal.histogram_in_progress = true;
 	pthread_mutex_unlock(&bdev->internal.mutex);
 
-	bdev->internal.histogram_enabled = enable;
+	if (stages) {
+		bdev->internal.stage_histogram_enabled = enable;
+	} else {
+		bdev->internal.histogram_enabled = enable;
+	}
 
 	if (enable) {
 		/* Allocate histogram for each channel */
@@ -6372,6 +6796,20 @@ spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb
 	}
 }
 
+void
+spdk_bdev_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
+			   void *cb_arg, bool enable)
+{
+	bdev_histogram_enable(bdev, cb_fn, cb_arg, enable, false);
+}
+
+void
+spdk_bdev_stage_histogram_enable(struct spdk_bdev *bdev, spdk_bdev_histogram_status_cb cb_fn,
+				 void *cb_arg, bool enable)
+{
+	bdev_histogram_enable(bdev, cb_fn, cb_arg, enable, true);
+}
+
 struct spdk_bdev_histogram_data_ctx {
 	spdk_bdev_histogram_data_cb cb_fn;
 	void *cb_arg;
@@ -6429,6 +6867,82 @@ spdk_bdev_histogram_get(struct spdk_bdev *bdev, struct spdk_histogram_data *hist
 			      bdev_histogram_get_channel_cb);
 }
 
+static const char *g_bdev_io_stage_names[SPDK_BDEV_IO_NUM_STAGES] = {
+	[SPDK_BDEV_IO_STAGE_QUEUE] = "queue",
+	[SPDK_BDEV_IO_STAGE_MODULE] = "module",
+	[SPDK_BDEV_IO_STAGE_COMPLETE] = "complete",
+};
+
+const char *
+spdk_bdev_io_stage_get_name(enum spdk_bdev_io_stage stage)
+{
+	if ((unsigned int)stage >= SPDK_BDEV_IO_NUM_STAGES) {
+		return NULL;
+	}
+
+	return g_bdev_io_stage_names[stage];
+}
+
+struct spdk_bdev_stage_histogram_data_ctx {
+	spdk_bdev_stage_histogram_data_cb cb_fn;
+	void *cb_arg;
+	struct spdk_bdev *bdev;
+	/** merged per-stage histogram data from all channels */
+	struct spdk_histogram_data	**histograms;
+};
+
+static void
+bdev_stage_histogram_get_channel_cb(struct spdk_io_channel_iter *i, int status)
+{
+	struct spdk_bdev_stage_histogram_data_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb_fn(ctx->cb_arg, status, ctx->histograms);
+	free(ctx);
+}
+
+static void
+bdev_stage_histogram_get_channel(struct spdk_io_channel_iter *i)
+{
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bdev_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bdev_stage_histogram_data_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	int stage, status = 0;
+
+	if (ch->stage_histogram[0] == NULL) {
+		status = -EFAULT;
+	} else {
+		for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+			spdk_histogram_data_merge(ctx->histograms[stage],
+						  ch->stage_histogram[stage]);
+		}
+	}
+
+	spdk_for_each_channel_continue(i, status);
+}
+
+void
+spdk_bdev_stage_histogram_get(struct spdk_bdev *bdev, struct spdk_histogram_data **histograms,
+			      spdk_bdev_stage_histogram_data_cb cb_fn,
+			      void *cb_arg)
+{
+	struct spdk_bdev_stage_histogram_data_ctx *ctx;
+
+	ctx = calloc(1, sizeof(struct spdk_bdev_stage_histogram_data_ctx));
+	if (ctx == NULL) {
+		cb_fn(cb_arg, -ENOMEM, histograms);
+		return;
+	}
+
+	ctx->bdev = bdev;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	ctx->histograms = histograms;
+
+	spdk_for_each_channel(__bdev_to_io_dev(bdev), bdev_stage_histogram_get_channel, ctx,
+			      bdev_stage_histogram_get_channel_cb);
+}
+
 size_t
 spdk_bdev_get_media_events(struct spdk_bdev_desc *desc, struct spdk_bdev_media_event *events,
 			   size_t max_events)
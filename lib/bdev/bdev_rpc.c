@@ -48,6 +48,8 @@ struct spdk_rpc_set_bdev_opts {
 	bool bdev_auto_examine;
 	uint32_t small_buf_pool_size;
 	uint32_t large_buf_pool_size;
+	uint32_t small_buf_cache_size;
+	uint32_t large_buf_cache_size;
 };
 
 static const struct spdk_json_object_decoder rpc_set_bdev_opts_decoders[] = {
@@ -56,6 +58,8 @@ static const struct spdk_json_object_decoder rpc_set_bdev_opts_decoders[] = {
 	{"bdev_auto_examine", offsetof(struct spdk_rpc_set_bdev_opts, bdev_auto_examine), spdk_json_decode_bool, true},
 	{"small_buf_pool_size", offsetof(struct spdk_rpc_set_bdev_opts, small_buf_pool_size), spdk_json_decode_uint32, true},
 	{"large_buf_pool_size", offsetof(struct spdk_rpc_set_bdev_opts, large_buf_pool_size), spdk_json_decode_uint32, true},
+	{"small_buf_cache_size", offsetof(struct spdk_rpc_set_bdev_opts, small_buf_cache_size), spdk_json_decode_uint32, true},
+	{"large_buf_cache_size", offsetof(struct spdk_rpc_set_bdev_opts, large_buf_cache_size), spdk_json_decode_uint32, true},
 };
 
 static void
@@ -69,6 +73,8 @@ rpc_bdev_set_options(struct spdk_jsonrpc_request *request, const struct spdk_jso
 	rpc_opts.bdev_io_cache_size = UINT32_MAX;
 	rpc_opts.small_buf_pool_size = UINT32_MAX;
 	rpc_opts.large_buf_pool_size = UINT32_MAX;
+	rpc_opts.small_buf_cache_size = UINT32_MAX;
+	rpc_opts.large_buf_cache_size = UINT32_MAX;
 	rpc_opts.bdev_auto_examine = true;
 
 	if (params != NULL) {
@@ -95,6 +101,12 @@ rpc_bdev_set_options(struct spdk_jsonrpc_request *request, const struct spdk_jso
 	if (rpc_opts.large_buf_pool_size != UINT32_MAX) {
 		bdev_opts.large_buf_pool_size = rpc_opts.large_buf_pool_size;
 	}
+	if (rpc_opts.small_buf_cache_size != UINT32_MAX) {
+		bdev_opts.small_buf_cache_size = rpc_opts.small_buf_cache_size;
+	}
+	if (rpc_opts.large_buf_cache_size != UINT32_MAX) {
+		bdev_opts.large_buf_cache_size = rpc_opts.large_buf_cache_size;
+	}
 
 	rc = spdk_bdev_set_opts(&bdev_opts);
 
@@ -423,6 +435,8 @@ rpc_dump_bdev_info(struct spdk_json_write_ctx *w,
 				   spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_UNMAP));
 	spdk_json_write_named_bool(w, "write_zeroes",
 				   spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_WRITE_ZEROES));
+	spdk_json_write_named_bool(w, "copy",
+				   spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY));
 	spdk_json_write_named_bool(w, "flush",
 				   spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_FLUSH));
 	spdk_json_write_named_bool(w, "reset",
@@ -804,3 +818,151 @@ cleanup:
 
 SPDK_RPC_REGISTER("bdev_get_histogram", rpc_bdev_get_histogram, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_get_histogram, get_bdev_histogram)
+
+/* SPDK_RPC_ENABLE_BDEV_STAGE_HISTOGRAM */
+
+static void
+rpc_bdev_enable_stage_histogram(struct spdk_jsonrpc_request *request,
+				const struct spdk_json_val *params)
+{
+	struct rpc_bdev_enable_histogram_request req = {NULL};
+	struct spdk_bdev *bdev;
+
+	if (spdk_json_decode_object(params, rpc_bdev_enable_histogram_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_enable_histogram_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_get_by_name(req.name);
+	if (bdev == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		goto cleanup;
+	}
+
+	spdk_bdev_stage_histogram_enable(bdev, bdev_histogram_status_cb, request, req.enable);
+
+cleanup:
+	free_rpc_bdev_enable_histogram_request(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_enable_stage_histogram", rpc_bdev_enable_stage_histogram,
+		  SPDK_RPC_RUNTIME)
+
+/* SPDK_RPC_GET_BDEV_STAGE_HISTOGRAM */
+
+static void
+rpc_bdev_stage_histograms_free(struct spdk_histogram_data **histograms)
+{
+	int stage;
+
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		if (histograms[stage] != NULL) {
+			spdk_histogram_data_free(histograms[stage]);
+		}
+	}
+	free(histograms);
+}
+
+static void
+_rpc_bdev_stage_histogram_data_cb(void *cb_arg, int status,
+				  struct spdk_histogram_data **histograms)
+{
+	struct spdk_jsonrpc_request *request = cb_arg;
+	struct spdk_json_write_ctx *w;
+	char *encoded_histogram;
+	size_t src_len, dst_len;
+	int stage, rc;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 spdk_strerror(-status));
+		goto invalid;
+	}
+
+	/* All stages use the same bucket layout */
+	src_len = SPDK_HISTOGRAM_NUM_BUCKETS(histograms[0]) * sizeof(uint64_t);
+	dst_len = spdk_base64_get_encoded_strlen(src_len) + 1;
+
+	encoded_histogram = malloc(dst_len);
+	if (encoded_histogram == NULL) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 spdk_strerror(ENOMEM));
+		goto invalid;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_int64(w, "bucket_shift", histograms[0]->bucket_shift);
+	spdk_json_write_named_int64(w, "tsc_rate", spdk_get_ticks_hz());
+	spdk_json_write_named_array_begin(w, "stages");
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		rc = spdk_base64_encode(encoded_histogram, histograms[stage]->bucket, src_len);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to encode histogram of stage %d\n", stage);
+			continue;
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "name", spdk_bdev_io_stage_get_name(stage));
+		spdk_json_write_named_string(w, "histogram", encoded_histogram);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(request, w);
+
+	free(encoded_histogram);
+invalid:
+	rpc_bdev_stage_histograms_free(histograms);
+}
+
+static void
+rpc_bdev_get_stage_histogram(struct spdk_jsonrpc_request *request,
+			     const struct spdk_json_val *params)
+{
+	struct rpc_bdev_get_histogram_request req = {NULL};
+	struct spdk_histogram_data **histograms;
+	struct spdk_bdev *bdev;
+	int stage;
+
+	if (spdk_json_decode_object(params, rpc_bdev_get_histogram_request_decoders,
+				    SPDK_COUNTOF(rpc_bdev_get_histogram_request_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	bdev = spdk_bdev_get_by_name(req.name);
+	if (bdev == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		goto cleanup;
+	}
+
+	histograms = calloc(SPDK_BDEV_IO_NUM_STAGES, sizeof(*histograms));
+	if (histograms == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		goto cleanup;
+	}
+
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		histograms[stage] = spdk_histogram_data_alloc();
+		if (histograms[stage] == NULL) {
+			rpc_bdev_stage_histograms_free(histograms);
+			spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+			goto cleanup;
+		}
+	}
+
+	spdk_bdev_stage_histogram_get(bdev, histograms, _rpc_bdev_stage_histogram_data_cb, request);
+
+cleanup:
+	free_rpc_bdev_get_histogram_request(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_get_stage_histogram", rpc_bdev_get_stage_histogram, SPDK_RPC_RUNTIME)
@@ -55,7 +55,8 @@ static int bs_register_md_thread(struct spdk_blob_store *bs);
 static int bs_unregister_md_thread(struct spdk_blob_store *bs);
 static void blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno);
 static void blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-		uint64_t cluster, uint32_t extent, spdk_blob_op_complete cb_fn, void *cb_arg);
+		uint64_t *clusters, uint32_t cluster_count, uint32_t extent,
+		spdk_blob_op_complete cb_fn, void *cb_arg);
 
 static int blob_set_xattr(struct spdk_blob *blob, const char *name, const void *value,
 			  uint16_t value_len, bool internal);
@@ -74,18 +75,127 @@ blob_verify_md_op(struct spdk_blob *blob)
 	assert(blob->state != SPDK_BLOB_STATE_LOADING);
 }
 
+static int
+blob_id_hash_init(struct spdk_blob_id_hash *hash)
+{
+	uint32_t i;
+
+	hash->buckets = calloc(SPDK_BLOB_ID_HASH_MIN_BUCKETS, sizeof(*hash->buckets));
+	if (!hash->buckets) {
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < SPDK_BLOB_ID_HASH_MIN_BUCKETS; i++) {
+		LIST_INIT(&hash->buckets[i]);
+	}
+	hash->num_buckets = SPDK_BLOB_ID_HASH_MIN_BUCKETS;
+	hash->count = 0;
+
+	return 0;
+}
+
+static void
+blob_id_hash_free(struct spdk_blob_id_hash *hash)
+{
+	free(hash->buckets);
+	hash->buckets = NULL;
+	hash->num_buckets = 0;
+	hash->count = 0;
+}
+
+static inline uint32_t
+blob_id_hash_bucket(uint32_t num_buckets, spdk_blob_id id)
+{
+	/* num_buckets is always a power of 2 */
+	return bs_blobid_to_page(id) & (num_buckets - 1);
+}
+
+static struct spdk_blob_id_hash_node *
+blob_id_hash_find(const struct spdk_blob_id_hash *hash, spdk_blob_id id)
+{
+	struct spdk_blob_id_hash_node *node;
+
+	LIST_FOREACH(node, &hash->buckets[blob_id_hash_bucket(hash->num_buckets, id)], link) {
+		if (node->id == id) {
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+static void
+blob_id_hash_grow(struct spdk_blob_id_hash *hash)
+{
+	struct spdk_blob_id_hash grown;
+	struct spdk_blob_id_hash_node *node;
+	uint32_t i;
+
+	grown.num_buckets = hash->num_buckets * 2;
+	grown.buckets = calloc(grown.num_buckets, sizeof(*grown.buckets));
+	if (!grown.buckets) {
+		/* Not fatal, the chains just get longer. */
+		return;
+	}
+
+	for (i = 0; i < grown.num_buckets; i++) {
+		LIST_INIT(&grown.buckets[i]);
+	}
+
+	for (i = 0; i < hash->num_buckets; i++) {
+		while (!LIST_EMPTY(&hash->buckets[i])) {
+			node = LIST_FIRST(&hash->buckets[i]);
+			LIST_REMOVE(node, link);
+			LIST_INSERT_HEAD(&grown.buckets[blob_id_hash_bucket(grown.num_buckets, node->id)],
+					 node, link);
+		}
+	}
+
+	free(hash->buckets);
+	hash->buckets = grown.buckets;
+	hash->num_buckets = grown.num_buckets;
+}
+
+static void
+blob_id_hash_insert(struct spdk_blob_id_hash *hash, struct spdk_blob_id_hash_node *node)
+{
+	assert(blob_id_hash_find(hash, node->id) == NULL);
+
+	if (hash->count >= hash->num_buckets) {
+		blob_id_hash_grow(hash);
+	}
+
+	LIST_INSERT_HEAD(&hash->buckets[blob_id_hash_bucket(hash->num_buckets, node->id)], node, link);
+	hash->count++;
+}
+
+static void
+blob_id_hash_remove(struct spdk_blob_id_hash *hash, struct spdk_blob_id_hash_node *node)
+{
+	assert(hash->count > 0);
+
+	LIST_REMOVE(node, link);
+	node->link.le_prev = NULL;
+	hash->count--;
+}
+
+static inline bool
+blob_id_hash_node_is_linked(const struct spdk_blob_id_hash_node *node)
+{
+	return node->link.le_prev != NULL;
+}
+
 static struct spdk_blob_list *
 bs_get_snapshot_entry(struct spdk_blob_store *bs, spdk_blob_id blobid)
 {
-	struct spdk_blob_list *snapshot_entry = NULL;
+	struct spdk_blob_id_hash_node *node;
 
-	TAILQ_FOREACH(snapshot_entry, &bs->snapshots, link) {
-		if (snapshot_entry->id == blobid) {
-			break;
-		}
+	node = blob_id_hash_find(&bs->snapshot_hash, blobid);
+	if (node == NULL) {
+		return NULL;
 	}
 
-	return snapshot_entry;
+	return SPDK_CONTAINEROF(node, struct spdk_blob_list, hash_node);
 }
 
 static void
@@ -265,6 +375,7 @@ spdk_blob_open_opts_init(struct spdk_blob_open_opts *opts, size_t opts_size)
         } \
 
 	SET_FIELD(clear_method, BLOB_CLEAR_WITH_DEFAULT);
+	SET_FIELD(cluster_alloc_hint, 1);
 
 #undef FIELD_OK
 #undef SET_FILED
@@ -281,6 +392,7 @@ blob_alloc(struct spdk_blob_store *bs, spdk_blob_id id)
 	}
 
 	blob->id = id;
+	blob->hash_node.id = id;
 	blob->bs = bs;
 
 	blob->parent_id = SPDK_BLOBID_INVALID;
@@ -1597,6 +1709,30 @@ struct spdk_blob_persist_ctx {
 	spdk_bs_sequence_cpl		cb_fn;
 	void				*cb_arg;
 	TAILQ_ENTRY(spdk_blob_persist_ctx) link;
+
+	/* Group commit batch this persist is part of, if any */
+	struct blob_persist_batch	*batch;
+	TAILQ_ENTRY(spdk_blob_persist_ctx) batch_link;
+};
+
+/*
+ * Persists of different blobs started within the group commit window are run
+ *  together: the super block is marked dirty once for all of them, and once
+ *  every blob has written the rest of its metadata, the root pages of all of
+ *  them are written in as few writes as possible. Root pages of blobs created
+ *  one after the other are adjacent, so this is usually a single write.
+ */
+struct blob_persist_batch {
+	struct spdk_blob_store		*bs;
+	struct spdk_bs_super_block	*super;
+	struct spdk_blob_md_page	*root_pages;
+
+	/* Persists that are yet to start, or that wait for their root page to be written */
+	TAILQ_HEAD(, spdk_blob_persist_ctx) ctxs;
+	uint32_t			num_ready;
+
+	/* Persists that have not reached the root page write or completed yet */
+	uint32_t			num_waiting;
 };
 
 static void
@@ -1617,7 +1753,9 @@ bs_batch_clear_dev(struct spdk_blob_persist_ctx *ctx, spdk_bs_batch_t *batch, ui
 	}
 }
 
-static void blob_persist_check_dirty(struct spdk_blob_persist_ctx *ctx);
+static void blob_persist_begin(struct spdk_blob_persist_ctx *ctx);
+static void blob_persist_batch_root_ready(struct spdk_blob_persist_ctx *ctx);
+static void blob_persist_batch_leave(struct spdk_blob_persist_ctx *ctx);
 
 static void
 blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx, int bserrno)
@@ -1625,6 +1763,11 @@ blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx
 	struct spdk_blob_persist_ctx	*next_persist;
 	struct spdk_blob		*blob = ctx->blob;
 
+	if (ctx->batch != NULL) {
+		/* Failed before its root page was handed over to the batch */
+		blob_persist_batch_leave(ctx);
+	}
+
 	if (bserrno == 0) {
 		blob_mark_clean(blob);
 	}
@@ -1642,7 +1785,7 @@ blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx
 	free(ctx);
 
 	if (next_persist != NULL) {
-		blob_persist_check_dirty(next_persist);
+		blob_persist_begin(next_persist);
 	}
 }
 
@@ -1909,6 +2052,12 @@ blob_persist_write_page_root(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
+	if (ctx->batch != NULL) {
+		/* The batch writes the root pages of all its blobs together */
+		blob_persist_batch_root_ready(ctx);
+		return;
+	}
+
 	lba_count = bs_byte_to_lba(bs, sizeof(*page));
 
 	page = &ctx->pages[0];
@@ -2245,6 +2394,254 @@ blob_persist_check_dirty(struct spdk_blob_persist_ctx *ctx)
 	}
 }
 
+static void
+blob_persist_batch_free(struct blob_persist_batch *batch)
+{
+	assert(TAILQ_EMPTY(&batch->ctxs));
+
+	spdk_free(batch->super);
+	spdk_free(batch->root_pages);
+	free(batch);
+}
+
+static void
+blob_persist_batch_roots_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct blob_persist_batch	*batch = cb_arg;
+	struct spdk_blob_persist_ctx	*ctx;
+
+	while (!TAILQ_EMPTY(&batch->ctxs)) {
+		ctx = TAILQ_FIRST(&batch->ctxs);
+		TAILQ_REMOVE(&batch->ctxs, ctx, batch_link);
+		ctx->batch = NULL;
+		blob_persist_zero_pages(ctx->seq, ctx, bserrno);
+	}
+
+	blob_persist_batch_free(batch);
+}
+
+static int
+blob_persist_ctx_root_cmp(const void *a, const void *b)
+{
+	const struct spdk_blob_persist_ctx *ctx_a = *(struct spdk_blob_persist_ctx * const *)a;
+	const struct spdk_blob_persist_ctx *ctx_b = *(struct spdk_blob_persist_ctx * const *)b;
+	uint32_t page_a = bs_blobid_to_page(ctx_a->blob->id);
+	uint32_t page_b = bs_blobid_to_page(ctx_b->blob->id);
+
+	return page_a < page_b ? -1 : page_a > page_b;
+}
+
+static void
+blob_persist_batch_write_roots(struct blob_persist_batch *batch)
+{
+	struct spdk_blob_store		*bs = batch->bs;
+	struct spdk_blob_persist_ctx	**ctxs, *ctx;
+	spdk_bs_batch_t			*bs_batch;
+	uint32_t			i, run_start, page_num, lba_count;
+
+	if (batch->num_ready == 0) {
+		blob_persist_batch_free(batch);
+		return;
+	}
+
+	ctxs = calloc(batch->num_ready, sizeof(*ctxs));
+	batch->root_pages = spdk_zmalloc(batch->num_ready * sizeof(*batch->root_pages), 0x1000, NULL,
+					 SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (ctxs == NULL || batch->root_pages == NULL) {
+		free(ctxs);
+		blob_persist_batch_roots_cpl(TAILQ_FIRST(&batch->ctxs)->seq, batch, -ENOMEM);
+		return;
+	}
+
+	i = 0;
+	TAILQ_FOREACH(ctx, &batch->ctxs, batch_link) {
+		ctxs[i++] = ctx;
+	}
+	assert(i == batch->num_ready);
+	qsort(ctxs, batch->num_ready, sizeof(*ctxs), blob_persist_ctx_root_cmp);
+
+	for (i = 0; i < batch->num_ready; i++) {
+		memcpy(&batch->root_pages[i], &ctxs[i]->pages[0], sizeof(batch->root_pages[i]));
+	}
+
+	/* Write each run of adjacent root pages with a single write */
+	lba_count = bs_byte_to_lba(bs, sizeof(*batch->root_pages));
+	bs_batch = bs_sequence_to_batch(ctxs[0]->seq, blob_persist_batch_roots_cpl, batch);
+	run_start = 0;
+	for (i = 1; i <= batch->num_ready; i++) {
+		page_num = bs_blobid_to_page(ctxs[run_start]->blob->id);
+		if (i < batch->num_ready &&
+		    bs_blobid_to_page(ctxs[i]->blob->id) == page_num + (i - run_start)) {
+			continue;
+		}
+
+		bs_batch_write_dev(bs_batch, &batch->root_pages[run_start], bs_md_page_to_lba(bs, page_num),
+				   lba_count * (i - run_start));
+		run_start = i;
+	}
+	bs_batch_close(bs_batch);
+
+	free(ctxs);
+}
+
+static void
+blob_persist_batch_put(struct blob_persist_batch *batch)
+{
+	assert(batch->num_waiting > 0);
+	if (--batch->num_waiting == 0) {
+		blob_persist_batch_write_roots(batch);
+	}
+}
+
+static void
+blob_persist_batch_root_ready(struct spdk_blob_persist_ctx *ctx)
+{
+	struct blob_persist_batch *batch = ctx->batch;
+
+	TAILQ_INSERT_TAIL(&batch->ctxs, ctx, batch_link);
+	batch->num_ready++;
+	blob_persist_batch_put(batch);
+}
+
+static void
+blob_persist_batch_leave(struct spdk_blob_persist_ctx *ctx)
+{
+	struct blob_persist_batch *batch = ctx->batch;
+
+	ctx->batch = NULL;
+	blob_persist_batch_put(batch);
+}
+
+static void
+blob_persist_batch_start(struct blob_persist_batch *batch, int bserrno)
+{
+	struct spdk_blob_persist_ctx	*ctx;
+	TAILQ_HEAD(, spdk_blob_persist_ctx) ctxs;
+
+	if (bserrno == 0) {
+		batch->bs->clean = 0;
+	}
+
+	/*
+	 * Hold an extra reference while starting the persists, as some of them may
+	 *  reach the root page write or complete before the others are started.
+	 */
+	TAILQ_INIT(&ctxs);
+	TAILQ_CONCAT(&ctxs, &batch->ctxs, batch_link);
+	batch->num_waiting++;
+
+	while (!TAILQ_EMPTY(&ctxs)) {
+		ctx = TAILQ_FIRST(&ctxs);
+		TAILQ_REMOVE(&ctxs, ctx, batch_link);
+		if (bserrno != 0) {
+			blob_persist_complete(ctx->seq, ctx, bserrno);
+		} else {
+			blob_persist_start(ctx);
+		}
+	}
+
+	blob_persist_batch_put(batch);
+}
+
+static void
+blob_persist_batch_dirty_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	blob_persist_batch_start(cb_arg, bserrno);
+}
+
+static void
+blob_persist_batch_dirty(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct blob_persist_batch *batch = cb_arg;
+
+	if (bserrno != 0) {
+		blob_persist_batch_start(batch, bserrno);
+		return;
+	}
+
+	batch->super->clean = 0;
+	if (batch->super->size == 0) {
+		batch->super->size = batch->bs->dev->blockcnt * batch->bs->dev->blocklen;
+	}
+
+	bs_write_super(seq, batch->bs, batch->super, blob_persist_batch_dirty_cpl, batch);
+}
+
+static void
+blob_persist_batch_flush(struct spdk_blob_store *bs)
+{
+	struct blob_persist_batch	*batch;
+	struct spdk_blob_persist_ctx	*ctx;
+
+	batch = calloc(1, sizeof(*batch));
+	if (batch == NULL) {
+		/* Fall back to persisting the blobs one by one */
+		while (!TAILQ_EMPTY(&bs->md_batch_queued)) {
+			ctx = TAILQ_FIRST(&bs->md_batch_queued);
+			TAILQ_REMOVE(&bs->md_batch_queued, ctx, batch_link);
+			blob_persist_check_dirty(ctx);
+		}
+		return;
+	}
+
+	batch->bs = bs;
+	TAILQ_INIT(&batch->ctxs);
+	TAILQ_FOREACH(ctx, &bs->md_batch_queued, batch_link) {
+		ctx->batch = batch;
+		batch->num_waiting++;
+	}
+	TAILQ_CONCAT(&batch->ctxs, &bs->md_batch_queued, batch_link);
+
+	if (!bs->clean) {
+		blob_persist_batch_start(batch, 0);
+		return;
+	}
+
+	batch->super = spdk_zmalloc(sizeof(*batch->super), 0x1000, NULL,
+				    SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!batch->super) {
+		blob_persist_batch_start(batch, -ENOMEM);
+		return;
+	}
+
+	/* Any of the queued sequences can carry the super block update */
+	ctx = TAILQ_FIRST(&batch->ctxs);
+	bs_sequence_read_dev(ctx->seq, batch->super, bs_page_to_lba(bs, 0),
+			     bs_byte_to_lba(bs, sizeof(*batch->super)),
+			     blob_persist_batch_dirty, batch);
+}
+
+static int
+blob_persist_batch_poll(void *arg)
+{
+	struct spdk_blob_store *bs = arg;
+
+	spdk_poller_unregister(&bs->md_batch_poller);
+	blob_persist_batch_flush(bs);
+
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+blob_persist_begin(struct spdk_blob_persist_ctx *ctx)
+{
+	struct spdk_blob_store *bs = ctx->blob->bs;
+
+	if (bs->md_batch_window_us == 0) {
+		blob_persist_check_dirty(ctx);
+		return;
+	}
+
+	TAILQ_INSERT_TAIL(&bs->md_batch_queued, ctx, batch_link);
+	if (bs->md_batch_poller == NULL) {
+		bs->md_batch_poller = SPDK_POLLER_REGISTER(blob_persist_batch_poll, bs,
+				      bs->md_batch_window_us);
+		if (bs->md_batch_poller == NULL) {
+			blob_persist_batch_flush(bs);
+		}
+	}
+}
+
 /* Write a blob to disk */
 static void
 blob_persist(spdk_bs_sequence_t *seq, struct spdk_blob *blob,
@@ -2278,16 +2675,19 @@ blob_persist(spdk_bs_sequence_t *seq, struct spdk_blob *blob,
 	}
 	TAILQ_INSERT_HEAD(&blob->pending_persists, ctx, link);
 
-	blob_persist_check_dirty(ctx);
+	blob_persist_begin(ctx);
 }
 
 struct spdk_blob_copy_cluster_ctx {
 	struct spdk_blob *blob;
 	uint8_t *buf;
 	uint64_t page;
-	uint64_t new_cluster;
 	uint32_t new_extent_page;
 	spdk_bs_sequence_t *seq;
+	/* Clusters claimed for the run starting at page. A zero entry marks a
+	 * cluster that was already released, as cluster 0 is never handed out. */
+	uint32_t num_clusters;
+	uint64_t new_clusters[];
 };
 
 static void
@@ -2315,6 +2715,20 @@ blob_allocate_and_copy_cluster_cpl(void *cb_arg, int bserrno)
 	free(ctx);
 }
 
+static void
+bs_release_copy_clusters(struct spdk_blob_copy_cluster_ctx *ctx)
+{
+	uint32_t i;
+
+	pthread_mutex_lock(&ctx->blob->bs->used_clusters_mutex);
+	for (i = 0; i < ctx->num_clusters; i++) {
+		if (ctx->new_clusters[i] != 0) {
+			bs_release_cluster(ctx->blob->bs, ctx->new_clusters[i]);
+		}
+	}
+	pthread_mutex_unlock(&ctx->blob->bs->used_clusters_mutex);
+}
+
 static void
 blob_insert_cluster_cpl(void *cb_arg, int bserrno)
 {
@@ -2323,13 +2737,11 @@ blob_insert_cluster_cpl(void *cb_arg, int bserrno)
 	if (bserrno) {
 		if (bserrno == -EEXIST) {
 			/* The metadata insert failed because another thread
-			 * allocated the cluster first. Free our cluster
+			 * allocated the clusters first. Free our clusters
 			 * but continue without error. */
 			bserrno = 0;
 		}
-		pthread_mutex_lock(&ctx->blob->bs->used_clusters_mutex);
-		bs_release_cluster(ctx->blob->bs, ctx->new_cluster);
-		pthread_mutex_unlock(&ctx->blob->bs->used_clusters_mutex);
+		bs_release_copy_clusters(ctx);
 		if (ctx->new_extent_page != 0) {
 			bs_release_md_page(ctx->blob->bs, ctx->new_extent_page);
 		}
@@ -2352,8 +2764,9 @@ blob_write_copy_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 
 	cluster_number = bs_page_to_cluster(ctx->blob->bs, ctx->page);
 
-	blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-					 ctx->new_extent_page, blob_insert_cluster_cpl, ctx);
+	blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_clusters,
+					 ctx->num_clusters, ctx->new_extent_page,
+					 blob_insert_cluster_cpl, ctx);
 }
 
 static void
@@ -2368,12 +2781,44 @@ blob_write_copy(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	}
 
 	/* Write whole cluster */
+	assert(ctx->num_clusters == 1);
 	bs_sequence_write_dev(seq, ctx->buf,
-			      bs_cluster_to_lba(ctx->blob->bs, ctx->new_cluster),
+			      bs_cluster_to_lba(ctx->blob->bs, ctx->new_clusters[0]),
 			      bs_cluster_to_lba(ctx->blob->bs, 1),
 			      blob_write_copy_cpl, ctx);
 }
 
+/*
+ * Number of clusters to claim on a first write to cluster_number. Blobs backed
+ *  by a snapshot copy one cluster at a time, others may claim a run of
+ *  unallocated clusters up to the allocation hint in a single metadata update.
+ */
+static uint32_t
+blob_cluster_alloc_run(struct spdk_blob *blob, uint32_t cluster_number)
+{
+	uint64_t max_clusters;
+	uint32_t count;
+
+	if (blob->parent_id != SPDK_BLOBID_INVALID || blob->cluster_alloc_hint <= 1) {
+		return 1;
+	}
+
+	max_clusters = spdk_min(blob->cluster_alloc_hint, blob->active.num_clusters - cluster_number);
+	if (blob->use_extent_table) {
+		/* Stay within a single extent page, so that at most one has to be claimed */
+		max_clusters = spdk_min(max_clusters,
+					SPDK_EXTENTS_PER_EP - cluster_number % SPDK_EXTENTS_PER_EP);
+	}
+
+	for (count = 1; count < max_clusters; count++) {
+		if (blob->active.clusters[cluster_number + count] != 0) {
+			break;
+		}
+	}
+
+	return count;
+}
+
 static void
 bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 			     struct spdk_io_channel *_ch,
@@ -2384,6 +2829,7 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	struct spdk_blob_copy_cluster_ctx *ctx;
 	uint32_t cluster_start_page;
 	uint32_t cluster_number;
+	uint32_t num_clusters, cluster;
 	int rc;
 
 	ch = spdk_io_channel_get_ctx(_ch);
@@ -2402,8 +2848,9 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	/* Calculate which index in the metadata cluster array the corresponding
 	 * cluster is supposed to be at. */
 	cluster_number = bs_io_unit_to_cluster_number(blob, io_unit);
+	num_clusters = blob_cluster_alloc_run(blob, cluster_number);
 
-	ctx = calloc(1, sizeof(*ctx));
+	ctx = calloc(1, sizeof(*ctx) + num_clusters * sizeof(ctx->new_clusters[0]));
 	if (!ctx) {
 		bs_user_op_abort(op);
 		return;
@@ -2427,8 +2874,19 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	}
 
 	pthread_mutex_lock(&blob->bs->used_clusters_mutex);
-	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_cluster, &ctx->new_extent_page,
+	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_clusters[0], &ctx->new_extent_page,
 				 false);
+	if (rc == 0) {
+		/* The rest of the run shares the extent page, so only the clusters are claimed.
+		 * Running out of space shortens the run instead of failing the write. */
+		for (ctx->num_clusters = 1; ctx->num_clusters < num_clusters; ctx->num_clusters++) {
+			cluster = bs_claim_cluster(blob->bs);
+			if (cluster == UINT32_MAX) {
+				break;
+			}
+			ctx->new_clusters[ctx->num_clusters] = cluster;
+		}
+	}
 	pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
 	if (rc != 0) {
 		spdk_free(ctx->buf);
@@ -2443,9 +2901,7 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 
 	ctx->seq = bs_sequence_start(_ch, &cpl);
 	if (!ctx->seq) {
-		pthread_mutex_lock(&blob->bs->used_clusters_mutex);
-		bs_release_cluster(blob->bs, ctx->new_cluster);
-		pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
+		bs_release_copy_clusters(ctx);
 		spdk_free(ctx->buf);
 		free(ctx);
 		bs_user_op_abort(op);
@@ -2462,8 +2918,9 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 					bs_dev_byte_to_lba(blob->back_bs_dev, blob->bs->cluster_sz),
 					blob_write_copy, ctx);
 	} else {
-		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_cluster,
-						 ctx->new_extent_page, blob_insert_cluster_cpl, ctx);
+		blob_insert_cluster_on_md_thread(ctx->blob, cluster_number, ctx->new_clusters,
+						 ctx->num_clusters, ctx->new_extent_page,
+						 blob_insert_cluster_cpl, ctx);
 	}
 }
 
@@ -2954,19 +3411,33 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 static struct spdk_blob *
 blob_lookup(struct spdk_blob_store *bs, spdk_blob_id blobid)
 {
-	struct spdk_blob *blob;
+	struct spdk_blob_id_hash_node *node;
 
-	if (spdk_bit_array_get(bs->open_blobids, blobid) == 0) {
+	node = blob_id_hash_find(&bs->blob_hash, blobid);
+	if (node == NULL) {
 		return NULL;
 	}
 
-	TAILQ_FOREACH(blob, &bs->blobs, link) {
-		if (blob->id == blobid) {
-			return blob;
-		}
-	}
+	return SPDK_CONTAINEROF(node, struct spdk_blob, hash_node);
+}
 
-	return NULL;
+static void
+blob_insert_open(struct spdk_blob *blob)
+{
+	struct spdk_blob_store *bs = blob->bs;
+
+	TAILQ_INSERT_HEAD(&bs->blobs, blob, link);
+	blob_id_hash_insert(&bs->blob_hash, &blob->hash_node);
+}
+
+static void
+blob_remove_open(struct spdk_blob *blob)
+{
+	struct spdk_blob_store *bs = blob->bs;
+
+	assert(blob_id_hash_node_is_linked(&blob->hash_node));
+	TAILQ_REMOVE(&bs->blobs, blob, link);
+	blob_id_hash_remove(&bs->blob_hash, &blob->hash_node);
 }
 
 static void
@@ -2981,12 +3452,7 @@ blob_get_snapshot_and_clone_entries(struct spdk_blob *blob,
 		return;
 	}
 
-	TAILQ_FOREACH(*snapshot_entry, &blob->bs->snapshots, link) {
-		if ((*snapshot_entry)->id == blob->parent_id) {
-			break;
-		}
-	}
-
+	*snapshot_entry = bs_get_snapshot_entry(blob->bs, blob->parent_id);
 	if (*snapshot_entry != NULL) {
 		TAILQ_FOREACH(*clone_entry, &(*snapshot_entry)->clones, link) {
 			if ((*clone_entry)->id == blob->id) {
@@ -3067,14 +3533,18 @@ bs_dev_destroy(void *io_device)
 	bs->dev->destroy(bs->dev);
 
 	TAILQ_FOREACH_SAFE(blob, &bs->blobs, link, blob_tmp) {
-		TAILQ_REMOVE(&bs->blobs, blob, link);
-		spdk_bit_array_clear(bs->open_blobids, blob->id);
+		blob_remove_open(blob);
 		blob_free(blob);
 	}
 
+	assert(TAILQ_EMPTY(&bs->md_batch_queued));
+	spdk_poller_unregister(&bs->md_batch_poller);
+
 	pthread_mutex_destroy(&bs->used_clusters_mutex);
 
-	spdk_bit_array_free(&bs->open_blobids);
+	blob_id_hash_free(&bs->blob_hash);
+	blob_id_hash_free(&bs->snapshot_hash);
+
 	spdk_bit_array_free(&bs->used_blobids);
 	spdk_bit_array_free(&bs->used_md_pages);
 	spdk_bit_pool_free(&bs->used_clusters);
@@ -3109,8 +3579,10 @@ bs_blob_list_add(struct spdk_blob *blob)
 			return -ENOMEM;
 		}
 		snapshot_entry->id = snapshot_id;
+		snapshot_entry->hash_node.id = snapshot_id;
 		TAILQ_INIT(&snapshot_entry->clones);
 		TAILQ_INSERT_TAIL(&blob->bs->snapshots, snapshot_entry, link);
+		blob_id_hash_insert(&blob->bs->snapshot_hash, &snapshot_entry->hash_node);
 	} else {
 		TAILQ_FOREACH(clone_entry, &snapshot_entry->clones, link) {
 			if (clone_entry->id == blob->id) {
@@ -3167,6 +3639,7 @@ bs_blob_list_free(struct spdk_blob_store *bs)
 			free(clone_entry);
 		}
 		TAILQ_REMOVE(&bs->snapshots, snapshot_entry, link);
+		blob_id_hash_remove(&bs->snapshot_hash, &snapshot_entry->hash_node);
 		free(snapshot_entry);
 	}
 
@@ -3219,6 +3692,7 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts, size_t opts_size)
 
 	SET_FIELD(iter_cb_fn, NULL);
 	SET_FIELD(iter_cb_arg, NULL);
+	SET_FIELD(md_batch_window_us, 0);
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -3314,6 +3788,16 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 
 	TAILQ_INIT(&bs->blobs);
 	TAILQ_INIT(&bs->snapshots);
+	TAILQ_INIT(&bs->md_batch_queued);
+	if (blob_id_hash_init(&bs->blob_hash) != 0 ||
+	    blob_id_hash_init(&bs->snapshot_hash) != 0) {
+		blob_id_hash_free(&bs->blob_hash);
+		spdk_free(ctx->super);
+		free(ctx);
+		free(bs);
+		return -ENOMEM;
+	}
+
 	bs->dev = dev;
 	bs->md_thread = spdk_get_thread();
 	assert(bs->md_thread != NULL);
@@ -3326,6 +3810,8 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->total_clusters = dev->blockcnt / (bs->cluster_sz / dev->blocklen);
 	ctx->used_clusters = spdk_bit_array_create(bs->total_clusters);
 	if (!ctx->used_clusters) {
+		blob_id_hash_free(&bs->blob_hash);
+		blob_id_hash_free(&bs->snapshot_hash);
 		spdk_free(ctx->super);
 		free(ctx);
 		free(bs);
@@ -3340,13 +3826,13 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->io_unit_size = dev->blocklen;
 
 	bs->max_channel_ops = opts->max_channel_ops;
+	bs->md_batch_window_us = opts->md_batch_window_us;
 	bs->super_blob = SPDK_BLOBID_INVALID;
 	memcpy(&bs->bstype, &opts->bstype, sizeof(opts->bstype));
 
 	/* The metadata is assumed to be at least 1 page */
 	bs->used_md_pages = spdk_bit_array_create(1);
 	bs->used_blobids = spdk_bit_array_create(0);
-	bs->open_blobids = spdk_bit_array_create(0);
 
 	pthread_mutex_init(&bs->used_clusters_mutex, NULL);
 
@@ -3356,10 +3842,11 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	if (rc == -1) {
 		spdk_io_device_unregister(bs, NULL);
 		pthread_mutex_destroy(&bs->used_clusters_mutex);
-		spdk_bit_array_free(&bs->open_blobids);
 		spdk_bit_array_free(&bs->used_blobids);
 		spdk_bit_array_free(&bs->used_md_pages);
 		spdk_bit_array_free(&ctx->used_clusters);
+		blob_id_hash_free(&bs->blob_hash);
+		blob_id_hash_free(&bs->snapshot_hash);
 		spdk_free(ctx->super);
 		free(ctx);
 		free(bs);
@@ -4261,12 +4748,6 @@ bs_recover(struct spdk_bs_load_ctx *ctx)
 		return;
 	}
 
-	rc = spdk_bit_array_resize(&ctx->bs->open_blobids, ctx->super->md_len);
-	if (rc < 0) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
-		return;
-	}
-
 	ctx->bs->num_free_clusters = ctx->bs->total_clusters;
 	bs_load_replay_md(ctx);
 }
@@ -4380,12 +4861,13 @@ bs_opts_copy(struct spdk_bs_opts *src, struct spdk_bs_opts *dst)
 	}
 	SET_FIELD(iter_cb_fn);
 	SET_FIELD(iter_cb_arg);
+	SET_FIELD(md_batch_window_us);
 
 	dst->opts_size = src->opts_size;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 64, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_bs_opts) == 72, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -4806,15 +5288,6 @@ spdk_bs_init(struct spdk_bs_dev *dev, struct spdk_bs_opts *o,
 		return;
 	}
 
-	rc = spdk_bit_array_resize(&bs->open_blobids, bs->md_len);
-	if (rc < 0) {
-		spdk_free(ctx->super);
-		free(ctx);
-		bs_free(bs);
-		cb_fn(cb_arg, NULL, -ENOMEM);
-		return;
-	}
-
 	memcpy(ctx->super->signature, SPDK_BS_SUPER_BLOCK_SIG,
 	       sizeof(ctx->super->signature));
 	ctx->super->version = SPDK_BS_VERSION;
@@ -6379,8 +6852,7 @@ delete_snapshot_cleanup_snapshot(void *cb_arg, int bserrno)
 
 	if (ctx->bserrno != 0) {
 		assert(blob_lookup(ctx->snapshot->bs, ctx->snapshot->id) == NULL);
-		TAILQ_INSERT_HEAD(&ctx->snapshot->bs->blobs, ctx->snapshot, link);
-		spdk_bit_array_set(ctx->snapshot->bs->open_blobids, ctx->snapshot->id);
+		blob_insert_open(ctx->snapshot);
 	}
 
 	ctx->snapshot->locked_operation_in_progress = false;
@@ -6661,6 +7133,7 @@ bs_delete_blob_finish(void *cb_arg, struct spdk_blob *blob, int bserrno)
 	snapshot_entry = bs_get_snapshot_entry(blob->bs, blob->id);
 	if (snapshot_entry != NULL) {
 		TAILQ_REMOVE(&blob->bs->snapshots, snapshot_entry, link);
+		blob_id_hash_remove(&blob->bs->snapshot_hash, &snapshot_entry->hash_node);
 		free(snapshot_entry);
 	}
 
@@ -6773,8 +7246,7 @@ bs_delete_open_cpl(void *cb_arg, struct spdk_blob *blob, int bserrno)
 	 * Remove the blob from the blob_store list now, to ensure it does not
 	 *  get returned after this point by blob_lookup().
 	 */
-	spdk_bit_array_clear(blob->bs->open_blobids, blob->id);
-	TAILQ_REMOVE(&blob->bs->blobs, blob, link);
+	blob_remove_open(blob);
 
 	if (update_clone) {
 		/* This blob is a snapshot with active clone - update clone first */
@@ -6839,8 +7311,7 @@ bs_open_blob_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 
 	blob->open_ref++;
 
-	spdk_bit_array_set(blob->bs->open_blobids, blob->id);
-	TAILQ_INSERT_HEAD(&blob->bs->blobs, blob, link);
+	blob_insert_open(blob);
 
 	bs_sequence_finish(seq, bserrno);
 }
@@ -6849,7 +7320,7 @@ static inline void
 blob_open_opts_copy(const struct spdk_blob_open_opts *src, struct spdk_blob_open_opts *dst)
 {
 #define FIELD_OK(field) \
-        offsetof(struct spdk_blob_opts, field) + sizeof(src->field) <= src->opts_size
+        offsetof(struct spdk_blob_open_opts, field) + sizeof(src->field) <= src->opts_size
 
 #define SET_FIELD(field) \
         if (FIELD_OK(field)) { \
@@ -6857,12 +7328,13 @@ blob_open_opts_copy(const struct spdk_blob_open_opts *src, struct spdk_blob_open
         } \
 
 	SET_FIELD(clear_method);
+	SET_FIELD(cluster_alloc_hint);
 
 	dst->opts_size = src->opts_size;
 
 	/* You should not remove this statement, but need to update the assert statement
 	 * if you add a new field, and also add a corresponding SET_FIELD statement */
-	SPDK_STATIC_ASSERT(sizeof(struct spdk_blob_open_opts) == 16, "Incorrect size");
+	SPDK_STATIC_ASSERT(sizeof(struct spdk_blob_open_opts) == 24, "Incorrect size");
 
 #undef FIELD_OK
 #undef SET_FIELD
@@ -6910,6 +7382,7 @@ bs_open_blob(struct spdk_blob_store *bs,
 	}
 
 	blob->clear_method = opts_local.clear_method;
+	blob->cluster_alloc_hint = opts_local.cluster_alloc_hint;
 
 	cpl.type = SPDK_BS_CPL_TYPE_BLOB_HANDLE;
 	cpl.u.blob_handle.cb_fn = cb_fn;
@@ -7008,7 +7481,8 @@ struct spdk_blob_insert_cluster_ctx {
 	struct spdk_thread	*thread;
 	struct spdk_blob	*blob;
 	uint32_t		cluster_num;	/* cluster index in blob */
-	uint32_t		cluster;	/* cluster on disk */
+	uint64_t		*clusters;	/* clusters on disk, owned by the caller */
+	uint32_t		cluster_count;
 	uint32_t		extent_page;	/* extent page on disk */
 	int			rc;
 	spdk_blob_op_complete	cb_fn;
@@ -7082,14 +7556,37 @@ static void
 blob_insert_cluster_msg(void *arg)
 {
 	struct spdk_blob_insert_cluster_ctx *ctx = arg;
+	struct spdk_blob_store *bs = ctx->blob->bs;
 	uint32_t *extent_page;
+	uint32_t i, inserted = 0;
 
-	ctx->rc = blob_insert_cluster(ctx->blob, ctx->cluster_num, ctx->cluster);
-	if (ctx->rc != 0) {
+	for (i = 0; i < ctx->cluster_count; i++) {
+		if (blob_insert_cluster(ctx->blob, ctx->cluster_num + i, ctx->clusters[i]) == 0) {
+			inserted++;
+		}
+	}
+
+	if (inserted == 0) {
+		/* Every cluster was allocated by another thread first,
+		 * the caller releases all of ours. */
+		ctx->rc = -EEXIST;
 		spdk_thread_send_msg(ctx->thread, blob_insert_cluster_msg_cpl, ctx);
 		return;
 	}
 
+	if (inserted < ctx->cluster_count) {
+		/* Release the clusters that lost the race and mark them as such */
+		pthread_mutex_lock(&bs->used_clusters_mutex);
+		for (i = 0; i < ctx->cluster_count; i++) {
+			if (ctx->blob->active.clusters[ctx->cluster_num + i] !=
+			    bs_cluster_to_lba(bs, ctx->clusters[i])) {
+				bs_release_cluster(bs, ctx->clusters[i]);
+				ctx->clusters[i] = 0;
+			}
+		}
+		pthread_mutex_unlock(&bs->used_clusters_mutex);
+	}
+
 	if (ctx->blob->use_extent_table == false) {
 		/* Extent table is not used, proceed with sync of md that will only use extents_rle. */
 		ctx->blob->state = SPDK_BLOB_STATE_DIRTY;
@@ -7125,7 +7622,8 @@ blob_insert_cluster_msg(void *arg)
 
 static void
 blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
-				 uint64_t cluster, uint32_t extent_page, spdk_blob_op_complete cb_fn, void *cb_arg)
+				 uint64_t *clusters, uint32_t cluster_count, uint32_t extent_page,
+				 spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_blob_insert_cluster_ctx *ctx;
 
@@ -7138,7 +7636,8 @@ blob_insert_cluster_on_md_thread(struct spdk_blob *blob, uint32_t cluster_num,
 	ctx->thread = spdk_get_thread();
 	ctx->blob = blob;
 	ctx->cluster_num = cluster_num;
-	ctx->cluster = cluster;
+	ctx->clusters = clusters;
+	ctx->cluster_count = cluster_count;
 	ctx->extent_page = extent_page;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
@@ -7163,8 +7662,7 @@ blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 			 *  remove them again.
 			 */
 			if (blob->active.num_pages > 0) {
-				spdk_bit_array_clear(blob->bs->open_blobids, blob->id);
-				TAILQ_REMOVE(&blob->bs->blobs, blob, link);
+				blob_remove_open(blob);
 			}
 			blob_free(blob);
 		}
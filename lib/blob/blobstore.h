@@ -51,6 +51,24 @@
 #define SPDK_BLOB_OPTS_MAX_MD_OPS 32
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
+#define SPDK_BLOB_ID_HASH_MIN_BUCKETS 64
+
+/* Entry of a hash table keyed on blob id, embedded in the object it indexes. */
+struct spdk_blob_id_hash_node {
+	spdk_blob_id			id;
+	LIST_ENTRY(spdk_blob_id_hash_node)	link;
+};
+
+/*
+ * Chained hash table keyed on blob id. The lower 32 bits of a blob id are its
+ *  metadata page index, which is dense, so it is used directly as the hash.
+ *  The bucket array doubles whenever the table holds more entries than buckets.
+ */
+struct spdk_blob_id_hash {
+	LIST_HEAD(, spdk_blob_id_hash_node)	*buckets;
+	uint32_t			num_buckets;
+	uint32_t			count;
+};
 
 struct spdk_xattr {
 	uint32_t	index;
@@ -121,6 +139,9 @@ struct spdk_blob_list {
 	size_t clone_count;
 	TAILQ_HEAD(, spdk_blob_list) clones;
 	TAILQ_ENTRY(spdk_blob_list) link;
+
+	/* Only used for snapshot entries, which are indexed by id in bs->snapshot_hash. */
+	struct spdk_blob_id_hash_node hash_node;
 };
 
 struct spdk_blob {
@@ -158,10 +179,13 @@ struct spdk_blob {
 	struct spdk_xattr_tailq xattrs_internal;
 
 	TAILQ_ENTRY(spdk_blob) link;
+	struct spdk_blob_id_hash_node hash_node;
 
 	uint32_t frozen_refcnt;
 	bool locked_operation_in_progress;
 	enum blob_clear_method clear_method;
+	/* Number of clusters claimed at once on a first write to a thin blob */
+	uint32_t cluster_alloc_hint;
 	bool extent_rle_found;
 	bool extent_table_found;
 	bool use_extent_table;
@@ -188,7 +212,6 @@ struct spdk_blob_store {
 	struct spdk_bit_array		*used_md_pages;
 	struct spdk_bit_pool		*used_clusters;
 	struct spdk_bit_array		*used_blobids;
-	struct spdk_bit_array		*open_blobids;
 
 	pthread_mutex_t			used_clusters_mutex;
 
@@ -209,6 +232,15 @@ struct spdk_blob_store {
 	TAILQ_HEAD(, spdk_blob)		blobs;
 	TAILQ_HEAD(, spdk_blob_list)	snapshots;
 
+	/* Open blobs and snapshot entries, indexed by blob id. */
+	struct spdk_blob_id_hash	blob_hash;
+	struct spdk_blob_id_hash	snapshot_hash;
+
+	/* Group commit of metadata persists, disabled when the window is 0. */
+	uint32_t			md_batch_window_us;
+	struct spdk_poller		*md_batch_poller;
+	TAILQ_HEAD(, spdk_blob_persist_ctx)	md_batch_queued;
+
 	bool                            clean;
 };
 
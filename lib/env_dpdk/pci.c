@@ -47,6 +47,39 @@
 #define RTE_BUS_SCAN_ALLOWLIST RTE_BUS_SCAN_WHITELIST
 #endif
 
+/* Compatibility for versions < 21.11, where struct rte_intr_handle is not opaque and is
+ * embedded in struct rte_pci_device.
+ */
+#if RTE_VERSION < RTE_VERSION_NUM(21, 11, 0, 0)
+static inline enum rte_intr_handle_type
+rte_intr_type_get(const struct rte_intr_handle *intr_handle)
+{
+	return intr_handle->type;
+}
+
+static inline int
+rte_intr_fd_get(const struct rte_intr_handle *intr_handle)
+{
+	return intr_handle->fd;
+}
+
+static inline int
+rte_intr_nb_efd_get(const struct rte_intr_handle *intr_handle)
+{
+	return intr_handle->nb_efd;
+}
+
+static inline int
+rte_intr_efds_index_get(const struct rte_intr_handle *intr_handle, int index)
+{
+	return intr_handle->efds[index];
+}
+
+#define PCI_DEVICE_INTR_HANDLE(rte_dev) (&(rte_dev)->intr_handle)
+#else
+#define PCI_DEVICE_INTR_HANDLE(rte_dev) ((rte_dev)->intr_handle)
+#endif
+
 #define PCI_CFG_SIZE		256
 #define PCI_EXT_CAP_ID_SN	0x03
 
@@ -897,6 +930,95 @@ spdk_pci_device_is_removed(struct spdk_pci_device *dev)
 	return dev->internal.pending_removal;
 }
 
+static struct rte_intr_handle *
+pci_device_get_msix_handle(struct spdk_pci_device *dev)
+{
+	struct rte_pci_device *rte_dev;
+	struct rte_intr_handle *intr_handle;
+
+	/* Hooked devices, e.g. VMD endpoints, are not backed by a DPDK device. */
+	if (dev->map_bar != map_bar_rte) {
+		return NULL;
+	}
+
+	rte_dev = dev->dev_handle;
+	intr_handle = PCI_DEVICE_INTR_HANDLE(rte_dev);
+	if (rte_intr_type_get(intr_handle) != RTE_INTR_HANDLE_VFIO_MSIX) {
+		return NULL;
+	}
+
+	return intr_handle;
+}
+
+int
+spdk_pci_device_enable_interrupts(struct spdk_pci_device *dev, uint32_t efd_count)
+{
+	struct rte_intr_handle *intr_handle;
+	int rc;
+
+	intr_handle = pci_device_get_msix_handle(dev);
+	if (intr_handle == NULL) {
+		return -ENOTSUP;
+	}
+
+	if (efd_count == 0 || efd_count > RTE_MAX_RXTX_INTR_VEC_ID) {
+		return -EINVAL;
+	}
+
+	rc = rte_intr_efd_enable(intr_handle, efd_count);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to allocate %u interrupt event fds\n", efd_count);
+		return rc < 0 ? rc : -EIO;
+	}
+
+	rc = rte_intr_enable(intr_handle);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to enable %u MSI-X vectors\n", efd_count + 1);
+		rte_intr_efd_disable(intr_handle);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+int
+spdk_pci_device_disable_interrupts(struct spdk_pci_device *dev)
+{
+	struct rte_intr_handle *intr_handle;
+	int rc;
+
+	intr_handle = pci_device_get_msix_handle(dev);
+	if (intr_handle == NULL) {
+		return -ENOTSUP;
+	}
+
+	rc = rte_intr_disable(intr_handle);
+	rte_intr_efd_disable(intr_handle);
+
+	return rc == 0 ? 0 : -EIO;
+}
+
+int
+spdk_pci_device_get_interrupt_efd_by_index(struct spdk_pci_device *dev, uint32_t index)
+{
+	struct rte_intr_handle *intr_handle;
+
+	intr_handle = pci_device_get_msix_handle(dev);
+	if (intr_handle == NULL) {
+		return -ENOTSUP;
+	}
+
+	if (index == 0) {
+		return rte_intr_fd_get(intr_handle);
+	}
+
+	if (index > (uint32_t)rte_intr_nb_efd_get(intr_handle)) {
+		return -EINVAL;
+	}
+
+	return rte_intr_efds_index_get(intr_handle, index - 1);
+}
+
 int
 spdk_pci_addr_compare(const struct spdk_pci_addr *a1, const struct spdk_pci_addr *a2)
 {
@@ -199,15 +199,12 @@ _rpc_thread_get_stats(void *arg)
 	struct spdk_poller *poller;
 	struct spdk_thread_stats stats;
 	uint64_t active_pollers_count = 0;
-	uint64_t timed_pollers_count = 0;
+	uint64_t timed_pollers_count = thread->num_timed_pollers;
 	uint64_t paused_pollers_count = 0;
 
 	TAILQ_FOREACH(poller, &thread->active_pollers, tailq) {
 		active_pollers_count++;
 	}
-	TAILQ_FOREACH(poller, &thread->timed_pollers, tailq) {
-		timed_pollers_count++;
-	}
 	TAILQ_FOREACH(poller, &thread->paused_pollers, tailq) {
 		paused_pollers_count++;
 	}
@@ -220,6 +217,9 @@ _rpc_thread_get_stats(void *arg)
 					     spdk_cpuset_fmt(spdk_thread_get_cpumask(thread)));
 		spdk_json_write_named_uint64(ctx->w, "busy", stats.busy_tsc);
 		spdk_json_write_named_uint64(ctx->w, "idle", stats.idle_tsc);
+		spdk_json_write_named_uint64(ctx->w, "msg_count", stats.msg_count);
+		spdk_json_write_named_uint64(ctx->w, "msg_backlog", stats.msg_backlog);
+		spdk_json_write_named_uint64(ctx->w, "msg_backlog_max", stats.msg_backlog_max);
 		spdk_json_write_named_uint64(ctx->w, "active_pollers_count", active_pollers_count);
 		spdk_json_write_named_uint64(ctx->w, "timed_pollers_count", timed_pollers_count);
 		spdk_json_write_named_uint64(ctx->w, "paused_pollers_count", paused_pollers_count);
@@ -262,6 +262,7 @@ _rpc_thread_get_pollers(void *arg)
 	struct rpc_get_stats_ctx *ctx = arg;
 	struct spdk_thread *thread = spdk_get_thread();
 	struct spdk_poller *poller;
+	uint32_t i;
 
 	spdk_json_write_object_begin(ctx->w);
 	spdk_json_write_named_string(ctx->w, "name", spdk_thread_get_name(thread));
@@ -274,8 +275,8 @@ _rpc_thread_get_pollers(void *arg)
 	spdk_json_write_array_end(ctx->w);
 
 	spdk_json_write_named_array_begin(ctx->w, "timed_pollers");
-	TAILQ_FOREACH(poller, &thread->timed_pollers, tailq) {
-		rpc_get_poller(poller, ctx->w);
+	for (i = 0; i < thread->num_timed_pollers; i++) {
+		rpc_get_poller(thread->timed_pollers[i], ctx->w);
 	}
 	spdk_json_write_array_end(ctx->w);
 
@@ -390,6 +391,7 @@ _rpc_framework_get_reactors(void *arg1, void *arg2)
 					     spdk_cpuset_fmt(spdk_thread_get_cpumask(thread)));
 		spdk_json_write_named_uint64(ctx->w, "elapsed",
 					     GET_DELTA(ctx->now, lw_thread->tsc_start));
+		spdk_json_write_named_uint64(ctx->w, "migrations", lw_thread->migrations);
 		spdk_json_write_object_end(ctx->w);
 	}
 	spdk_json_write_array_end(ctx->w);
@@ -451,17 +453,43 @@ rpc_framework_set_scheduler(struct spdk_jsonrpc_request *request,
 			    const struct spdk_json_val *params)
 {
 	struct rpc_set_scheduler_ctx req = {NULL};
+	struct spdk_scheduler *scheduler;
 	int ret;
 
-	ret = spdk_json_decode_object(params, rpc_set_scheduler_decoders,
-				      SPDK_COUNTOF(rpc_set_scheduler_decoders),
-				      &req);
+	/* Any other parameters are options of the selected scheduler */
+	ret = spdk_json_decode_object_relaxed(params, rpc_set_scheduler_decoders,
+					      SPDK_COUNTOF(rpc_set_scheduler_decoders),
+					      &req);
 	if (ret) {
 		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
 						 "Invalid parameters");
 		goto end;
 	}
 
+	scheduler = _spdk_scheduler_find(req.name);
+	if (scheduler != NULL && scheduler->set_opts == NULL) {
+		free_rpc_framework_set_scheduler(&req);
+		memset(&req, 0, sizeof(req));
+		ret = spdk_json_decode_object(params, rpc_set_scheduler_decoders,
+					      SPDK_COUNTOF(rpc_set_scheduler_decoders),
+					      &req);
+		if (ret) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "Invalid parameters");
+			goto end;
+		}
+	}
+
+	/* Apply the options first, so that invalid ones leave the current scheduler running */
+	if (scheduler != NULL && scheduler->set_opts != NULL) {
+		ret = scheduler->set_opts(params);
+		if (ret) {
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 spdk_strerror(-ret));
+			goto end;
+		}
+	}
+
 	if (req.period != 0) {
 		_spdk_scheduler_period_set(req.period);
 	}
@@ -500,6 +528,11 @@ rpc_framework_get_scheduler(struct spdk_jsonrpc_request *request,
 	spdk_json_write_named_string(w, "scheduler name", scheduler->name);
 	spdk_json_write_named_uint64(w, "scheduler period", scheduler_period);
 	spdk_json_write_named_string(w, "governor name", governor->name);
+	if (scheduler->dump_info_json != NULL) {
+		spdk_json_write_named_object_begin(w, "scheduler info");
+		scheduler->dump_info_json(w);
+		spdk_json_write_object_end(w);
+	}
 	spdk_json_write_object_end(w);
 	spdk_jsonrpc_end_result(request, w);
 }
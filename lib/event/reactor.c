@@ -87,8 +87,8 @@ static struct spdk_governor g_governor = {
 static int reactor_interrupt_init(struct spdk_reactor *reactor);
 static void reactor_interrupt_fini(struct spdk_reactor *reactor);
 
-static struct spdk_scheduler *
-_scheduler_find(char *name)
+struct spdk_scheduler *
+_spdk_scheduler_find(const char *name)
 {
 	struct spdk_scheduler *tmp;
 
@@ -106,7 +106,7 @@ _spdk_scheduler_set(char *name)
 {
 	struct spdk_scheduler *scheduler;
 
-	scheduler = _scheduler_find(name);
+	scheduler = _spdk_scheduler_find(name);
 	if (scheduler == NULL) {
 		SPDK_ERRLOG("Requested scheduler is missing\n");
 		return -ENOENT;
@@ -162,7 +162,7 @@ _spdk_scheduler_disable(void)
 void
 _spdk_scheduler_list_add(struct spdk_scheduler *scheduler)
 {
-	if (_scheduler_find(scheduler->name)) {
+	if (_spdk_scheduler_find(scheduler->name)) {
 		SPDK_ERRLOG("scheduler named '%s' already registered.\n", scheduler->name);
 		assert(false);
 		return;
@@ -675,6 +675,7 @@ _threads_reschedule(struct spdk_scheduler_core_info *cores_info)
 		for (j = 0; j < core->threads_count; j++) {
 			lw_thread = core->threads[j];
 			if (lw_thread->lcore != lw_thread->new_lcore) {
+				lw_thread->migrations++;
 				_spdk_lw_thread_set_core(lw_thread, lw_thread->new_lcore);
 			}
 		}
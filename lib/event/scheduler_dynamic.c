@@ -36,6 +36,8 @@
 #include "spdk/event.h"
 #include "spdk/log.h"
 #include "spdk/env.h"
+#include "spdk/cpuset.h"
+#include "spdk/json.h"
 
 #include "spdk_internal/thread.h"
 #include "spdk_internal/event.h"
@@ -47,6 +49,59 @@ uint64_t g_last_main_core_busy, g_last_main_core_idle;
 
 #define SCHEDULER_THREAD_BUSY 100
 #define SCHEDULER_LOAD_LIMIT 50
+#define SCHEDULER_LOAD_HYSTERESIS 0
+#define SCHEDULER_LOAD_WEIGHT 100
+#define SCHEDULER_MAX_MIGRATIONS 0
+
+struct dynamic_scheduler_opts {
+	/* Load, in percent, from which a thread is considered busy */
+	uint32_t	load_limit;
+	/*
+	 * Distance, in percent, from load_limit that a thread's load has to cross
+	 *  before it is moved off or back to the main core. Keeps threads whose load
+	 *  hovers around the limit from moving back and forth.
+	 */
+	uint32_t	load_hysteresis;
+	/* Weight, in percent, of the last period in a thread's load average, 100 disables averaging */
+	uint32_t	load_weight;
+	/* Maximum number of thread migrations per scheduling period, 0 for no limit */
+	uint32_t	max_migrations;
+};
+
+/* Kept across scheduler switches, framework_set_scheduler sets them before the switch */
+static struct dynamic_scheduler_opts g_opts = {
+	.load_limit = SCHEDULER_LOAD_LIMIT,
+	.load_hysteresis = SCHEDULER_LOAD_HYSTERESIS,
+	.load_weight = SCHEDULER_LOAD_WEIGHT,
+	.max_migrations = SCHEDULER_MAX_MIGRATIONS,
+};
+
+/*
+ * Weights used to score candidate cores for a busy thread, lowest score wins.
+ *  Running on the socket the thread's I/O is local to matters most, then the
+ *  number of threads already on the core, then sharing a last level cache with
+ *  the core the thread currently runs on.
+ */
+#define SCHEDULER_SCORE_REMOTE_SOCKET (1ULL << 32)
+#define SCHEDULER_SCORE_THREAD 2
+#define SCHEDULER_SCORE_CACHE_MISS 1
+
+struct core_topology {
+	uint32_t		socket_id;
+	/* Cores sharing the last level cache with this one, itself included */
+	struct spdk_cpuset	cache_cpus;
+};
+
+static struct core_topology *g_cores_topology;
+static uint32_t g_cores_topology_count;
+
+static struct {
+	uint64_t	moves;
+	uint64_t	local_moves;
+	uint64_t	remote_moves;
+	/* Moves skipped because the migration budget of the period was used up */
+	uint64_t	deferred_moves;
+} g_placement_stats;
 
 static uint32_t
 _get_next_target_core(void)
@@ -63,6 +118,147 @@ _get_next_target_core(void)
 	return target_lcore;
 }
 
+static void
+_get_cache_cpus(uint32_t lcore, struct spdk_cpuset *cache_cpus)
+{
+	char path[128], list[SPDK_CPUSET_SIZE * 4], mask[sizeof(list) + 2];
+	FILE *f;
+	uint32_t i;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index3/shared_cpu_list",
+		 lcore);
+	f = fopen(path, "r");
+	if (f != NULL) {
+		if (fgets(list, sizeof(list), f) != NULL) {
+			list[strcspn(list, "\n")] = '\0';
+			snprintf(mask, sizeof(mask), "[%s]", list);
+			if (spdk_cpuset_parse(cache_cpus, mask) == 0 &&
+			    spdk_cpuset_get_cpu(cache_cpus, lcore)) {
+				fclose(f);
+				return;
+			}
+		}
+		fclose(f);
+	}
+
+	/* Without cache information assume that the whole socket shares a cache */
+	spdk_cpuset_zero(cache_cpus);
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (spdk_env_get_socket_id(i) == spdk_env_get_socket_id(lcore)) {
+			spdk_cpuset_set_cpu(cache_cpus, i, true);
+		}
+	}
+}
+
+static int
+_init_cores_topology(void)
+{
+	uint32_t i;
+
+	free(g_cores_topology);
+	g_cores_topology_count = spdk_env_get_last_core() + 1;
+	g_cores_topology = calloc(g_cores_topology_count, sizeof(*g_cores_topology));
+	if (g_cores_topology == NULL) {
+		g_cores_topology_count = 0;
+		return -ENOMEM;
+	}
+
+	SPDK_ENV_FOREACH_CORE(i) {
+		g_cores_topology[i].socket_id = spdk_env_get_socket_id(i);
+		_get_cache_cpus(i, &g_cores_topology[i].cache_cpus);
+	}
+
+	return 0;
+}
+
+static uint64_t
+_get_core_score(struct spdk_scheduler_core_info *cores_info, uint32_t lcore, uint32_t src_lcore,
+		int32_t socket_hint)
+{
+	uint64_t score;
+	uint32_t threads_count = cores_info[lcore].pending_threads_count;
+
+	/* The thread itself is still accounted on its current core */
+	if (lcore == src_lcore && threads_count > 0) {
+		threads_count--;
+	}
+	score = threads_count * SCHEDULER_SCORE_THREAD;
+
+	if (g_cores_topology == NULL) {
+		return score;
+	}
+
+	if (!spdk_cpuset_get_cpu(&g_cores_topology[src_lcore].cache_cpus, lcore)) {
+		score += SCHEDULER_SCORE_CACHE_MISS;
+	}
+
+	if (socket_hint != SPDK_ENV_SOCKET_ID_ANY &&
+	    g_cores_topology[lcore].socket_id != (uint32_t)socket_hint) {
+		score += SCHEDULER_SCORE_REMOTE_SOCKET;
+	}
+
+	return score;
+}
+
+/*
+ * Pick the core with the lowest score for a busy thread. Cores are visited in
+ *  round-robin order, so that equally scored cores are used in turn.
+ */
+static uint32_t
+_find_target_core(struct spdk_scheduler_core_info *cores_info, struct spdk_lw_thread *lw_thread,
+		  bool main_core_allowed)
+{
+	struct spdk_thread *thread = spdk_thread_get_from_ctx(lw_thread);
+	struct spdk_cpuset *cpumask = spdk_thread_get_cpumask(thread);
+	int32_t socket_hint = spdk_thread_get_socket_hint(thread);
+	uint32_t target_lcore = SPDK_ENV_LCORE_ID_ANY;
+	uint32_t lcore, k;
+	uint64_t score, best_score = UINT64_MAX;
+
+	for (k = 0; k < spdk_env_get_core_count(); k++) {
+		lcore = _get_next_target_core();
+
+		if (!spdk_cpuset_get_cpu(cpumask, lcore)) {
+			continue;
+		}
+
+		if (lcore == g_main_lcore && !main_core_allowed) {
+			continue;
+		}
+
+		score = _get_core_score(cores_info, lcore, lw_thread->lcore, socket_hint);
+		if (score < best_score) {
+			best_score = score;
+			target_lcore = lcore;
+		}
+	}
+
+	/* Start the next search one core further */
+	_get_next_target_core();
+
+	return target_lcore;
+}
+
+static void
+_move_thread(struct spdk_scheduler_core_info *cores_info, struct spdk_lw_thread *lw_thread,
+	     uint32_t target_lcore)
+{
+	int32_t socket_hint = spdk_thread_get_socket_hint(spdk_thread_get_from_ctx(lw_thread));
+
+	lw_thread->new_lcore = target_lcore;
+	cores_info[target_lcore].pending_threads_count++;
+	cores_info[lw_thread->lcore].pending_threads_count--;
+
+	g_placement_stats.moves++;
+	if (socket_hint != SPDK_ENV_SOCKET_ID_ANY && g_cores_topology != NULL) {
+		if (g_cores_topology[target_lcore].socket_id == (uint32_t)socket_hint) {
+			g_placement_stats.local_moves++;
+		} else {
+			g_placement_stats.remote_moves++;
+		}
+	}
+}
+
 static uint8_t
 _get_thread_load(struct spdk_lw_thread *lw_thread)
 {
@@ -78,6 +274,35 @@ _get_thread_load(struct spdk_lw_thread *lw_thread)
 	return busy  * 100 / (busy + idle);
 }
 
+/* Fold the load of the last period into the thread's exponentially weighted moving average */
+static uint32_t
+_update_thread_load_avg(struct spdk_lw_thread *lw_thread)
+{
+	uint32_t load = _get_thread_load(lw_thread);
+
+	lw_thread->load_avg = (load * g_opts.load_weight +
+			       lw_thread->load_avg * (100 - g_opts.load_weight) + 50) / 100;
+
+	return lw_thread->load_avg;
+}
+
+/* Returns true if a migration fits into the budget of this period and accounts for it */
+static bool
+_take_migration(uint32_t *migrations_left)
+{
+	if (g_opts.max_migrations == 0) {
+		return true;
+	}
+
+	if (*migrations_left == 0) {
+		g_placement_stats.deferred_moves++;
+		return false;
+	}
+
+	(*migrations_left)--;
+	return true;
+}
+
 static int
 init(struct spdk_governor *governor)
 {
@@ -91,7 +316,9 @@ init(struct spdk_governor *governor)
 	g_last_main_core_busy = 0;
 	g_last_main_core_idle = 0;
 
-	return 0;
+	memset(&g_placement_stats, 0, sizeof(g_placement_stats));
+
+	return _init_cores_topology();
 }
 
 static int
@@ -100,6 +327,10 @@ deinit(struct spdk_governor *governor)
 	uint32_t i;
 	int rc = 0;
 
+	free(g_cores_topology);
+	g_cores_topology = NULL;
+	g_cores_topology_count = 0;
+
 	if (!g_core_mngmnt_available) {
 		return 0;
 	}
@@ -133,11 +364,18 @@ balance(struct spdk_scheduler_core_info *cores_info, int cores_count,
 	uint64_t main_core_idle;
 	uint64_t thread_busy;
 	uint32_t target_lcore;
-	uint32_t i, j, k;
+	uint32_t i, j;
+	uint32_t busy_limit, idle_limit;
+	uint32_t migrations_left = g_opts.max_migrations;
+	int32_t socket_hint;
 	int rc;
-	uint8_t load;
+	uint32_t load;
 	bool busy_threads_present = false;
 
+	/* A thread leaves the main core above busy_limit and returns to it below idle_limit */
+	busy_limit = spdk_min(g_opts.load_limit + g_opts.load_hysteresis, 100);
+	idle_limit = g_opts.load_limit - spdk_min(g_opts.load_limit, g_opts.load_hysteresis);
+
 	main_core_busy = cores_info[g_main_lcore].core_busy_tsc - g_last_main_core_busy;
 	main_core_idle = cores_info[g_main_lcore].core_idle_tsc - g_last_main_core_idle;
 	g_last_main_core_busy = cores_info[g_main_lcore].core_busy_tsc;
@@ -170,58 +408,69 @@ balance(struct spdk_scheduler_core_info *cores_info, int cores_count,
 
 			thread_busy = lw_thread->snapshot_stats.busy_tsc - lw_thread->last_stats.busy_tsc;
 
-			load = _get_thread_load(lw_thread);
-
-			if (i == g_main_lcore && load >= SCHEDULER_LOAD_LIMIT) {
-				/* This thread is active and on the main core, we need to pick a core to move it to */
-				for (k = 0; k < spdk_env_get_core_count(); k++) {
-					target_lcore = _get_next_target_core();
-
-					/* Do not use main core if it is too busy for new thread */
-					if (target_lcore == g_main_lcore && thread_busy > main_core_idle) {
-						continue;
-					}
-
-					if (spdk_cpuset_get_cpu(cpumask, target_lcore)) {
-						lw_thread->new_lcore = target_lcore;
-						cores_info[target_lcore].pending_threads_count++;
-						core->pending_threads_count--;
-
-						if (target_lcore != g_main_lcore) {
-							busy_threads_present = true;
-							main_core_idle += spdk_min(UINT64_MAX - main_core_idle, thread_busy);
-							main_core_busy -= spdk_min(main_core_busy, thread_busy);
-						}
-
-						break;
-					}
+			load = _update_thread_load_avg(lw_thread);
+
+			if (i == g_main_lcore && load >= busy_limit) {
+				/* This thread is active and on the main core, we need to pick a core to move it to.
+				 * Keep it on the main core only if it has enough idle time for the thread. */
+				target_lcore = _find_target_core(cores_info, lw_thread,
+								 thread_busy <= main_core_idle);
+				if (target_lcore != SPDK_ENV_LCORE_ID_ANY &&
+				    target_lcore != g_main_lcore &&
+				    _take_migration(&migrations_left)) {
+					_move_thread(cores_info, lw_thread, target_lcore);
+					busy_threads_present = true;
+					main_core_idle += spdk_min(UINT64_MAX - main_core_idle, thread_busy);
+					main_core_busy -= spdk_min(main_core_busy, thread_busy);
 				}
-			} else if (i != g_main_lcore && load < SCHEDULER_LOAD_LIMIT) {
+			} else if (i != g_main_lcore && load < idle_limit) {
 				/* This thread is idle but not on the main core, so we need to move it to the main core */
+				if (!_take_migration(&migrations_left)) {
+					busy_threads_present = true;
+					continue;
+				}
+
 				lw_thread->new_lcore = g_main_lcore;
 				cores_info[g_main_lcore].pending_threads_count++;
 				core->pending_threads_count--;
+				g_placement_stats.moves++;
 
 				main_core_busy += spdk_min(UINT64_MAX - main_core_busy, thread_busy);
 				main_core_idle -= spdk_min(main_core_idle, thread_busy);
 			} else {
-				/* Move busy thread only if cpumask does not match current core (except main core) */
+				/* Move busy thread only if cpumask does not match current core or the core
+				 * is on a different socket than the thread's I/O (except main core) */
 				if (i != g_main_lcore) {
+					socket_hint = spdk_thread_get_socket_hint(thread);
+					target_lcore = SPDK_ENV_LCORE_ID_ANY;
+
 					if (!spdk_cpuset_get_cpu(cpumask, i)) {
-						for (k = 0; k < spdk_env_get_core_count(); k++) {
-							target_lcore = _get_next_target_core();
-
-							if (spdk_cpuset_get_cpu(cpumask, target_lcore)) {
-								lw_thread->new_lcore = target_lcore;
-								cores_info[target_lcore].pending_threads_count++;
-								core->pending_threads_count--;
-
-								if (target_lcore == g_main_lcore) {
-									main_core_busy += spdk_min(UINT64_MAX - main_core_busy, thread_busy);
-									main_core_idle -= spdk_min(main_core_idle, thread_busy);
-								}
-								break;
-							}
+						/* Required by the cpumask, so not subject to the budget */
+						target_lcore = _find_target_core(cores_info, lw_thread, true);
+						if (migrations_left > 0) {
+							migrations_left--;
+						}
+					} else if (socket_hint != SPDK_ENV_SOCKET_ID_ANY &&
+						   g_cores_topology != NULL &&
+						   g_cores_topology[i].socket_id != (uint32_t)socket_hint) {
+						target_lcore = _find_target_core(cores_info, lw_thread, false);
+						/* Only worth a migration if it makes the thread local */
+						if (target_lcore != SPDK_ENV_LCORE_ID_ANY &&
+						    g_cores_topology[target_lcore].socket_id != (uint32_t)socket_hint) {
+							target_lcore = SPDK_ENV_LCORE_ID_ANY;
+						}
+						if (target_lcore != SPDK_ENV_LCORE_ID_ANY &&
+						    !_take_migration(&migrations_left)) {
+							target_lcore = SPDK_ENV_LCORE_ID_ANY;
+						}
+					}
+
+					if (target_lcore != SPDK_ENV_LCORE_ID_ANY && target_lcore != i) {
+						_move_thread(cores_info, lw_thread, target_lcore);
+
+						if (target_lcore == g_main_lcore) {
+							main_core_busy += spdk_min(UINT64_MAX - main_core_busy, thread_busy);
+							main_core_idle -= spdk_min(main_core_idle, thread_busy);
 						}
 					}
 
@@ -267,11 +516,77 @@ balance(struct spdk_scheduler_core_info *cores_info, int cores_count,
 	}
 }
 
+static const struct spdk_json_object_decoder dynamic_opts_decoders[] = {
+	{"load_limit", offsetof(struct dynamic_scheduler_opts, load_limit), spdk_json_decode_uint32, true},
+	{"load_hysteresis", offsetof(struct dynamic_scheduler_opts, load_hysteresis), spdk_json_decode_uint32, true},
+	{"load_weight", offsetof(struct dynamic_scheduler_opts, load_weight), spdk_json_decode_uint32, true},
+	{"max_migrations", offsetof(struct dynamic_scheduler_opts, max_migrations), spdk_json_decode_uint32, true},
+};
+
+static int
+set_opts(const struct spdk_json_val *opts)
+{
+	struct dynamic_scheduler_opts new_opts = g_opts;
+
+	if (opts == NULL) {
+		return 0;
+	}
+
+	if (spdk_json_decode_object_relaxed(opts, dynamic_opts_decoders,
+					    SPDK_COUNTOF(dynamic_opts_decoders), &new_opts)) {
+		SPDK_ERRLOG("Failed to decode dynamic scheduler options\n");
+		return -EINVAL;
+	}
+
+	if (new_opts.load_limit > 100 || new_opts.load_hysteresis > 100 ||
+	    new_opts.load_weight == 0 || new_opts.load_weight > 100) {
+		SPDK_ERRLOG("Dynamic scheduler options out of range\n");
+		return -EINVAL;
+	}
+
+	g_opts = new_opts;
+
+	return 0;
+}
+
+static void
+dump_info_json(struct spdk_json_write_ctx *w)
+{
+	uint32_t i;
+
+	spdk_json_write_named_uint32(w, "load_limit", g_opts.load_limit);
+	spdk_json_write_named_uint32(w, "load_hysteresis", g_opts.load_hysteresis);
+	spdk_json_write_named_uint32(w, "load_weight", g_opts.load_weight);
+	spdk_json_write_named_uint32(w, "max_migrations", g_opts.max_migrations);
+
+	spdk_json_write_named_uint64(w, "thread_moves", g_placement_stats.moves);
+	spdk_json_write_named_uint64(w, "socket_local_moves", g_placement_stats.local_moves);
+	spdk_json_write_named_uint64(w, "socket_remote_moves", g_placement_stats.remote_moves);
+	spdk_json_write_named_uint64(w, "deferred_moves", g_placement_stats.deferred_moves);
+
+	spdk_json_write_named_array_begin(w, "cores");
+	SPDK_ENV_FOREACH_CORE(i) {
+		if (i >= g_cores_topology_count) {
+			break;
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint32(w, "lcore", i);
+		spdk_json_write_named_uint32(w, "socket_id", g_cores_topology[i].socket_id);
+		spdk_json_write_named_string(w, "cache_cpumask",
+					     spdk_cpuset_fmt(&g_cores_topology[i].cache_cpus));
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+}
+
 static struct spdk_scheduler scheduler_dynamic = {
 	.name = "dynamic",
 	.init = init,
 	.deinit = deinit,
 	.balance = balance,
+	.dump_info_json = dump_info_json,
+	.set_opts = set_opts,
 };
 
 SPDK_SCHEDULER_REGISTER(scheduler_dynamic);
@@ -288,6 +288,10 @@ spdk_nvme_ctrlr_get_default_io_qpair_opts(struct spdk_nvme_ctrlr *ctrlr,
 		opts->create_only = false;
 	}
 
+	if (FIELD_OK(enable_interrupts)) {
+		opts->enable_interrupts = false;
+	}
+
 #undef FIELD_OK
 }
 
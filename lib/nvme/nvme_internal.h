@@ -419,6 +419,9 @@ struct spdk_nvme_qpair {
 
 	uint8_t					first_fused_submitted: 1;
 
+	/* Set between spdk_nvme_qpair_submit_batch_start() and _end(). */
+	uint8_t					submit_batch: 1;
+
 	enum spdk_nvme_transport_type		trtype;
 
 	STAILQ_HEAD(, nvme_request)		free_req;
@@ -1308,6 +1311,8 @@ void nvme_transport_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr,
 void nvme_transport_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
 int nvme_transport_qpair_reset(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_request *req);
+void nvme_transport_qpair_flush_submissions(struct spdk_nvme_qpair *qpair);
+int nvme_transport_qpair_get_interrupt_fd(struct spdk_nvme_qpair *qpair);
 int32_t nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 void nvme_transport_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
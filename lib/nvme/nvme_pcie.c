@@ -702,6 +702,95 @@ static struct spdk_nvme_ctrlr *nvme_pcie_ctrlr_construct(const struct spdk_nvme_
 	return &pctrlr->ctrlr;
 }
 
+/* PCI configuration space fields used to look up the MSI-X table size */
+#define NVME_PCIE_CFG_STATUS		0x06
+#define NVME_PCIE_CFG_STATUS_CAP_LIST	0x10
+#define NVME_PCIE_CFG_CAP_PTR		0x34
+#define NVME_PCIE_CAP_ID_MSIX		0x11
+#define NVME_PCIE_MSIX_TABLE_SIZE_MASK	0x7ff
+
+static uint32_t
+nvme_pcie_ctrlr_get_msix_vectors(struct spdk_pci_device *pci_dev)
+{
+	uint16_t status, msgctl;
+	uint8_t pos, cap_id;
+	int ttl;
+
+	if (spdk_pci_device_cfg_read16(pci_dev, &status, NVME_PCIE_CFG_STATUS) != 0 ||
+	    !(status & NVME_PCIE_CFG_STATUS_CAP_LIST)) {
+		return 0;
+	}
+
+	if (spdk_pci_device_cfg_read8(pci_dev, &pos, NVME_PCIE_CFG_CAP_PTR) != 0) {
+		return 0;
+	}
+
+	/* Bound the walk in case the capability list is corrupted and loops */
+	for (ttl = 48; ttl > 0 && pos >= 0x40; ttl--) {
+		pos &= ~3;
+		if (spdk_pci_device_cfg_read8(pci_dev, &cap_id, pos) != 0) {
+			return 0;
+		}
+
+		if (cap_id == NVME_PCIE_CAP_ID_MSIX) {
+			if (spdk_pci_device_cfg_read16(pci_dev, &msgctl, pos + 2) != 0) {
+				return 0;
+			}
+			return (msgctl & NVME_PCIE_MSIX_TABLE_SIZE_MASK) + 1;
+		}
+
+		if (spdk_pci_device_cfg_read8(pci_dev, &pos, pos + 1) != 0) {
+			return 0;
+		}
+	}
+
+	return 0;
+}
+
+int
+nvme_pcie_ctrlr_enable_interrupts(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid)
+{
+	struct nvme_pcie_ctrlr *pctrlr = nvme_pcie_ctrlr(ctrlr);
+	uint32_t num_vectors;
+	int rc;
+
+	if (pctrlr->num_io_intr_vectors == 0) {
+		/* The event fds only exist in the process that enabled the interrupts. */
+		if (!spdk_process_is_primary()) {
+			return -ENOTSUP;
+		}
+
+		num_vectors = nvme_pcie_ctrlr_get_msix_vectors(pctrlr->devhandle);
+		if (num_vectors < 2) {
+			return -ENOTSUP;
+		}
+
+		/* Vector 0 belongs to the admin queue. I/O queue N is assigned vector N. */
+		num_vectors = spdk_min(num_vectors - 1, ctrlr->opts.num_io_queues);
+		rc = spdk_pci_device_enable_interrupts(pctrlr->devhandle, num_vectors);
+		if (rc != 0) {
+			return rc;
+		}
+
+		pctrlr->num_io_intr_vectors = num_vectors;
+	}
+
+	return qid <= pctrlr->num_io_intr_vectors ? 0 : -ENOSPC;
+}
+
+static int
+nvme_pcie_qpair_get_interrupt_fd(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_ctrlr *pctrlr = nvme_pcie_ctrlr(qpair->ctrlr);
+	struct nvme_pcie_qpair *pqpair = nvme_pcie_qpair(qpair);
+
+	if (!pqpair->flags.enable_interrupts) {
+		return -ENOTSUP;
+	}
+
+	return spdk_pci_device_get_interrupt_efd_by_index(pctrlr->devhandle, qpair->id);
+}
+
 static int
 nvme_pcie_ctrlr_enable(struct spdk_nvme_ctrlr *ctrlr)
 {
@@ -749,6 +838,9 @@ nvme_pcie_ctrlr_destruct(struct spdk_nvme_ctrlr *ctrlr)
 	nvme_pcie_ctrlr_free_bars(pctrlr);
 
 	if (devhandle) {
+		if (pctrlr->num_io_intr_vectors != 0) {
+			spdk_pci_device_disable_interrupts(devhandle);
+		}
 		spdk_pci_device_unclaim(devhandle);
 		spdk_pci_device_detach(devhandle);
 	}
@@ -1343,6 +1435,8 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.qpair_submit_request = nvme_pcie_qpair_submit_request,
 	.qpair_process_completions = nvme_pcie_qpair_process_completions,
 	.qpair_iterate_requests = nvme_pcie_qpair_iterate_requests,
+	.qpair_flush_submissions = nvme_pcie_qpair_flush_submissions,
+	.qpair_get_interrupt_fd = nvme_pcie_qpair_get_interrupt_fd,
 	.admin_qpair_abort_aers = nvme_pcie_admin_qpair_abort_aers,
 
 	.poll_group_create = nvme_pcie_poll_group_create,
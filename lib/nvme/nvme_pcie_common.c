@@ -360,6 +360,10 @@ nvme_pcie_ctrlr_cmd_create_io_cq(struct spdk_nvme_ctrlr *ctrlr,
 	cmd->cdw10_bits.create_io_q.qsize = pqpair->num_entries - 1;
 
 	cmd->cdw11_bits.create_io_cq.pc = 1;
+	if (pqpair->flags.enable_interrupts) {
+		cmd->cdw11_bits.create_io_cq.ien = 1;
+		cmd->cdw11_bits.create_io_cq.iv = io_que->id;
+	}
 	cmd->dptr.prp.prp1 = pqpair->cpl_bus_addr;
 
 	return nvme_ctrlr_submit_admin_request(ctrlr, req);
@@ -574,6 +578,12 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 	if (req->cmd.fuse == SPDK_NVME_IO_FLAGS_FUSE_FIRST) {
 		/* This is first cmd of two fused commands - don't ring doorbell */
 		qpair->first_fused_submitted = 1;
+	} else if (req->cmd.fuse == SPDK_NVME_IO_FLAGS_FUSE_SECOND) {
+		/*
+		 * The first cmd may not have rung the doorbell itself, when the submission
+		 * is delayed or batched, so the flag is still set. Both cmds are queued now.
+		 */
+		qpair->first_fused_submitted = 0;
 	}
 
 	/* Don't use wide instructions to copy NVMe command, this is limited by QEMU
@@ -594,11 +604,17 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 		SPDK_ERRLOG("sq_tail is passing sq_head!\n");
 	}
 
-	if (!pqpair->flags.delay_cmd_submit) {
+	if (!pqpair->flags.delay_cmd_submit && !qpair->submit_batch) {
 		nvme_pcie_qpair_ring_sq_doorbell(qpair);
 	}
 }
 
+void
+nvme_pcie_qpair_flush_submissions(struct spdk_nvme_qpair *qpair)
+{
+	nvme_pcie_qpair_flush_sq_doorbell(qpair);
+}
+
 void
 nvme_pcie_qpair_complete_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracker *tr,
 				 struct spdk_nvme_cpl *cpl, bool print_on_error)
@@ -841,11 +857,9 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 		nvme_pcie_qpair_ring_cq_doorbell(qpair);
 	}
 
-	if (pqpair->flags.delay_cmd_submit) {
-		if (pqpair->last_sq_tail != pqpair->sq_tail) {
-			nvme_pcie_qpair_ring_sq_doorbell(qpair);
-			pqpair->last_sq_tail = pqpair->sq_tail;
-		}
+	/* Submit commands deferred by delay_cmd_submit or an open submission batch */
+	if (pqpair->flags.delay_cmd_submit || qpair->submit_batch) {
+		nvme_pcie_qpair_flush_sq_doorbell(qpair);
 	}
 
 	if (spdk_unlikely(ctrlr->timeout_enabled)) {
@@ -915,6 +929,16 @@ nvme_pcie_ctrlr_create_io_qpair(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid,
 	pqpair->num_entries = opts->io_queue_size;
 	pqpair->flags.delay_cmd_submit = opts->delay_cmd_submit;
 
+	if (opts->enable_interrupts && ctrlr->trid.trtype == SPDK_NVME_TRANSPORT_PCIE) {
+		rc = nvme_pcie_ctrlr_enable_interrupts(ctrlr, qid);
+		if (rc == 0) {
+			pqpair->flags.enable_interrupts = 1;
+		} else {
+			SPDK_DEBUGLOG(nvme, "Creating qpair %u without interrupts: %s\n",
+				      qid, spdk_strerror(-rc));
+		}
+	}
+
 	qpair = &pqpair->qpair;
 
 	rc = nvme_qpair_init(qpair, qid, ctrlr, opts->qprio, opts->io_queue_requests);
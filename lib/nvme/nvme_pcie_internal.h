@@ -81,6 +81,9 @@ struct nvme_pcie_ctrlr {
 	/* Opaque handle to associated PCI device. */
 	struct spdk_pci_device *devhandle;
 
+	/* Number of I/O queue interrupt vectors enabled through MSI-X, 0 if none */
+	uint32_t num_io_intr_vectors;
+
 	/* Flag to indicate the MMIO register has been remapped */
 	bool is_remapped;
 
@@ -157,6 +160,7 @@ struct nvme_pcie_qpair {
 		uint8_t phase			: 1;
 		uint8_t delay_cmd_submit	: 1;
 		uint8_t has_shadow_doorbell	: 1;
+		uint8_t enable_interrupts	: 1;
 	} flags;
 
 	/*
@@ -264,6 +268,19 @@ nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 		spdk_mmio_write_4(pqpair->sq_tdbl, pqpair->sq_tail);
 		g_thread_mmio_ctrlr = NULL;
 	}
+
+	pqpair->last_sq_tail = pqpair->sq_tail;
+}
+
+/* Ring the SQ tail doorbell for commands whose submission was deferred, if any. */
+static inline void
+nvme_pcie_qpair_flush_sq_doorbell(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_qpair *pqpair = nvme_pcie_qpair(qpair);
+
+	if (pqpair->last_sq_tail != pqpair->sq_tail) {
+		nvme_pcie_qpair_ring_sq_doorbell(qpair);
+	}
 }
 
 static inline void
@@ -315,6 +332,8 @@ void nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_t
 void nvme_pcie_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_admin_qpair_destroy(struct spdk_nvme_qpair *qpair);
 void nvme_pcie_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
+void nvme_pcie_qpair_flush_submissions(struct spdk_nvme_qpair *qpair);
+int nvme_pcie_ctrlr_enable_interrupts(struct spdk_nvme_ctrlr *ctrlr, uint16_t qid);
 int32_t nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 int nvme_pcie_qpair_destroy(struct spdk_nvme_qpair *qpair);
@@ -122,6 +122,7 @@ static const struct nvme_string io_opcode[] = {
 	{ SPDK_NVME_OPC_RESERVATION_REPORT, "RESERVATION REPORT" },
 	{ SPDK_NVME_OPC_RESERVATION_ACQUIRE, "RESERVATION ACQUIRE" },
 	{ SPDK_NVME_OPC_RESERVATION_RELEASE, "RESERVATION RELEASE" },
+	{ SPDK_NVME_OPC_COPY, "COPY" },
 	{ SPDK_OCSSD_OPC_VECTOR_RESET, "OCSSD / VECTOR RESET" },
 	{ SPDK_OCSSD_OPC_VECTOR_WRITE, "OCSSD / VECTOR WRITE" },
 	{ SPDK_OCSSD_OPC_VECTOR_READ, "OCSSD / VECTOR READ" },
@@ -382,6 +383,7 @@ static const struct nvme_string command_specific_status[] = {
 	{ SPDK_NVME_SC_CONFLICTING_ATTRIBUTES, "CONFLICTING ATTRIBUTES" },
 	{ SPDK_NVME_SC_INVALID_PROTECTION_INFO, "INVALID PROTECTION INFO" },
 	{ SPDK_NVME_SC_ATTEMPTED_WRITE_TO_RO_RANGE, "WRITE TO RO RANGE" },
+	{ SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED, "COMMAND SIZE LIMIT EXCEEDED" },
 	{ 0xFFFF, "COMMAND SPECIFIC" }
 };
 
@@ -744,6 +746,27 @@ spdk_nvme_qpair_get_failure_reason(struct spdk_nvme_qpair *qpair)
 	return qpair->transport_failure_reason;
 }
 
+void
+spdk_nvme_qpair_submit_batch_start(struct spdk_nvme_qpair *qpair)
+{
+	assert(!qpair->submit_batch);
+	qpair->submit_batch = 1;
+}
+
+void
+spdk_nvme_qpair_submit_batch_end(struct spdk_nvme_qpair *qpair)
+{
+	assert(qpair->submit_batch);
+	qpair->submit_batch = 0;
+	nvme_transport_qpair_flush_submissions(qpair);
+}
+
+int
+spdk_nvme_qpair_get_interrupt_fd(struct spdk_nvme_qpair *qpair)
+{
+	return nvme_transport_qpair_get_interrupt_fd(qpair);
+}
+
 int
 nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 		struct spdk_nvme_ctrlr *ctrlr,
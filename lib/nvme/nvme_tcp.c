@@ -965,7 +965,7 @@ nvme_tcp_pdu_payload_handle(struct nvme_tcp_qpair *tqpair,
 
 	/* check data digest if need */
 	if (pdu->ddgst_enable) {
-		crc32c = nvme_tcp_pdu_calc_data_digest(pdu);
+		crc32c = nvme_tcp_pdu_get_data_digest(pdu);
 		rc = MATCH_DIGEST_WORD(pdu->data_digest, crc32c);
 		if (rc == 0) {
 			SPDK_ERRLOG("data digest error on tqpair=(%p) with pdu=%p\n", tqpair, pdu);
@@ -1498,6 +1498,9 @@ nvme_tcp_read_pdu(struct nvme_tcp_qpair *tqpair, uint32_t *reaped)
 				break;
 			}
 
+			if (pdu->ddgst_enable) {
+				nvme_tcp_pdu_update_data_digest(pdu, pdu->rw_offset, rc);
+			}
 			pdu->rw_offset += rc;
 			if (pdu->rw_offset < data_len) {
 				rc =  NVME_TCP_PDU_IN_PROGRESS;
@@ -408,6 +408,42 @@ nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t
 	return transport->ops.qpair_process_completions(qpair, max_completions);
 }
 
+void
+nvme_transport_qpair_flush_submissions(struct spdk_nvme_qpair *qpair)
+{
+	const struct spdk_nvme_transport *transport;
+
+	if (spdk_likely(!nvme_qpair_is_admin_queue(qpair))) {
+		transport = qpair->transport;
+	} else {
+		transport = nvme_get_transport(qpair->ctrlr->trid.trstring);
+		assert(transport != NULL);
+	}
+
+	if (transport->ops.qpair_flush_submissions) {
+		transport->ops.qpair_flush_submissions(qpair);
+	}
+}
+
+int
+nvme_transport_qpair_get_interrupt_fd(struct spdk_nvme_qpair *qpair)
+{
+	const struct spdk_nvme_transport *transport;
+
+	if (spdk_likely(!nvme_qpair_is_admin_queue(qpair))) {
+		transport = qpair->transport;
+	} else {
+		transport = nvme_get_transport(qpair->ctrlr->trid.trstring);
+		assert(transport != NULL);
+	}
+
+	if (transport->ops.qpair_get_interrupt_fd) {
+		return transport->ops.qpair_get_interrupt_fd(qpair);
+	}
+
+	return -ENOTSUP;
+}
+
 int
 nvme_transport_qpair_iterate_requests(struct spdk_nvme_qpair *qpair,
 				      int (*iter_fn)(struct nvme_request *req, void *arg),
@@ -1919,6 +1919,8 @@ static const struct spdk_nvme_cmds_and_effect_log_page g_cmds_and_effect_log_pag
 		[SPDK_NVME_OPC_DATASET_MANAGEMENT]	= {1, 1, 0, 0, 0, 0, 0, 0},
 		/* COMPARE */
 		[SPDK_NVME_OPC_COMPARE]			= {1, 0, 0, 0, 0, 0, 0, 0},
+		/* COPY */
+		[SPDK_NVME_OPC_COPY]			= {1, 1, 0, 0, 0, 0, 0, 0},
 	},
 };
 
@@ -2230,6 +2232,7 @@ spdk_nvmf_ctrlr_identify_ctrlr(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvme_c
 
 		cdata->oncs.dsm = nvmf_ctrlr_dsm_supported(ctrlr);
 		cdata->oncs.write_zeroes = nvmf_ctrlr_write_zeroes_supported(ctrlr);
+		cdata->oncs.copy = nvmf_ctrlr_copy_supported(ctrlr);
 		cdata->oncs.reservations = 1;
 		if (subsystem->flags.ana_reporting) {
 			cdata->anatt = ANA_TRANSITION_TIME_IN_SEC;
@@ -3217,6 +3220,7 @@ nvmf_ns_reservation_request_check(struct spdk_nvmf_subsystem_pg_ns_info *ns_info
 	case SPDK_NVME_OPC_WRITE_UNCORRECTABLE:
 	case SPDK_NVME_OPC_WRITE_ZEROES:
 	case SPDK_NVME_OPC_DATASET_MANAGEMENT:
+	case SPDK_NVME_OPC_COPY:
 		if (rtype == SPDK_NVME_RESERVE_WRITE_EXCLUSIVE ||
 		    rtype == SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS) {
 			status = SPDK_NVME_SC_RESERVATION_CONFLICT;
@@ -3416,6 +3420,12 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		req->qpair->first_fused_req = NULL;
 	}
 
+	if (spdk_unlikely(req->zcopy_phase == NVMF_ZCOPY_PHASE_INIT)) {
+		/* Only reads and writes are started with zero-copy, see nvmf_ctrlr_use_zcopy() */
+		assert(cmd->opc == SPDK_NVME_OPC_READ || cmd->opc == SPDK_NVME_OPC_WRITE);
+		return nvmf_bdev_ctrlr_zcopy_start(bdev, desc, ch, req);
+	}
+
 	switch (cmd->opc) {
 	case SPDK_NVME_OPC_READ:
 		return nvmf_bdev_ctrlr_read_cmd(bdev, desc, ch, req);
@@ -3429,6 +3439,8 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		return nvmf_bdev_ctrlr_flush_cmd(bdev, desc, ch, req);
 	case SPDK_NVME_OPC_DATASET_MANAGEMENT:
 		return nvmf_bdev_ctrlr_dsm_cmd(bdev, desc, ch, req);
+	case SPDK_NVME_OPC_COPY:
+		return nvmf_bdev_ctrlr_copy_cmd(bdev, desc, ch, req);
 	case SPDK_NVME_OPC_RESERVATION_REGISTER:
 	case SPDK_NVME_OPC_RESERVATION_ACQUIRE:
 	case SPDK_NVME_OPC_RESERVATION_RELEASE:
@@ -3440,6 +3452,67 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 	}
 }
 
+bool
+nvmf_ctrlr_use_zcopy(struct spdk_nvmf_request *req)
+{
+	struct spdk_nvmf_ctrlr *ctrlr = req->qpair->ctrlr;
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvmf_ns *ns;
+
+	if (nvmf_qpair_is_admin_queue(req->qpair) || ctrlr == NULL) {
+		return false;
+	}
+
+	if (cmd->opc != SPDK_NVME_OPC_READ && cmd->opc != SPDK_NVME_OPC_WRITE) {
+		return false;
+	}
+
+	/* Fused commands and DIF insert/strip need the data in transport buffers */
+	if (cmd->fuse != SPDK_NVME_CMD_FUSE_NONE || req->dif.dif_insert_or_strip) {
+		return false;
+	}
+
+	ns = _nvmf_subsystem_get_ns(ctrlr->subsys, cmd->nsid);
+	if (ns == NULL || ns->bdev == NULL) {
+		return false;
+	}
+
+	/* The bdev layer emulates zcopy with a bounce buffer for other bdevs, which
+	 * doesn't save anything over the transport buffers.
+	 */
+	return spdk_bdev_io_type_supported(ns->bdev, SPDK_BDEV_IO_TYPE_ZCOPY);
+}
+
+static int
+nvmf_ctrlr_process_io_zcopy(struct spdk_nvmf_request *req)
+{
+	if (req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_READ) {
+		/* The data was read into the buffers when they were obtained */
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	/* Write the data received from the host into the buffers to the bdev */
+	spdk_nvmf_request_zcopy_end(req, true);
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+void
+spdk_nvmf_request_zcopy_start(struct spdk_nvmf_request *req)
+{
+	assert(req->zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
+
+	spdk_nvmf_request_exec(req);
+}
+
+void
+spdk_nvmf_request_zcopy_end(struct spdk_nvmf_request *req, bool commit)
+{
+	assert(req->zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE);
+
+	req->zcopy_phase = NVMF_ZCOPY_PHASE_END_PENDING;
+	nvmf_bdev_ctrlr_zcopy_end(req, commit);
+}
+
 static void
 nvmf_qpair_request_cleanup(struct spdk_nvmf_qpair *qpair)
 {
@@ -3496,6 +3569,19 @@ _nvmf_request_complete(void *ctx)
 		spdk_nvme_print_completion(qpair->qid, rsp);
 	}
 
+	if (spdk_unlikely(req->zcopy_phase == NVMF_ZCOPY_PHASE_INIT)) {
+		/* The request failed before its buffers were requested from the bdev */
+		req->zcopy_phase = NVMF_ZCOPY_PHASE_INIT_FAILED;
+	} else if (spdk_unlikely(req->zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE)) {
+		/* The request holds the bdev's buffers, so it stays outstanding until the
+		 * transport releases them with spdk_nvmf_request_zcopy_end().
+		 */
+		if (nvmf_transport_req_complete(req)) {
+			SPDK_ERRLOG("Transport request completion error!\n");
+		}
+		return;
+	}
+
 	TAILQ_REMOVE(&qpair->outstanding, req, link);
 	if (nvmf_transport_req_complete(req)) {
 		SPDK_ERRLOG("Transport request completion error!\n");
@@ -3593,6 +3679,17 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 	enum spdk_nvmf_request_exec_status status;
 	uint32_t nsid;
 
+	if (spdk_unlikely(req->zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE)) {
+		/* The request was already accounted for and placed on the outstanding
+		 * list when its buffers were requested.
+		 */
+		status = nvmf_ctrlr_process_io_zcopy(req);
+		if (status == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE) {
+			_nvmf_request_complete(req);
+		}
+		return;
+	}
+
 	if (qpair->ctrlr) {
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
 		assert(sgroup != NULL);
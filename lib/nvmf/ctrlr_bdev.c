@@ -49,6 +49,11 @@
 
 #include "spdk/log.h"
 
+/* Copy limits reported in Identify Namespace (MSRC, MSSRL and MCL) */
+#define SPDK_NVMF_COPY_MAX_RANGES	SPDK_NVME_COPY_MAX_RANGES
+#define SPDK_NVMF_COPY_MAX_RANGE_BLOCKS	UINT16_MAX
+#define SPDK_NVMF_COPY_MAX_LENGTH	(SPDK_NVMF_COPY_MAX_RANGES * SPDK_NVMF_COPY_MAX_RANGE_BLOCKS)
+
 static bool
 nvmf_subsystem_bdev_io_type_supported(struct spdk_nvmf_subsystem *subsystem,
 				      enum spdk_bdev_io_type io_type)
@@ -87,6 +92,12 @@ nvmf_ctrlr_write_zeroes_supported(struct spdk_nvmf_ctrlr *ctrlr)
 	return nvmf_subsystem_bdev_io_type_supported(ctrlr->subsys, SPDK_BDEV_IO_TYPE_WRITE_ZEROES);
 }
 
+bool
+nvmf_ctrlr_copy_supported(struct spdk_nvmf_ctrlr *ctrlr)
+{
+	return nvmf_subsystem_bdev_io_type_supported(ctrlr->subsys, SPDK_BDEV_IO_TYPE_COPY);
+}
+
 static void
 nvmf_bdev_ctrlr_complete_cmd(struct spdk_bdev_io *bdev_io, bool success,
 			     void *cb_arg)
@@ -182,6 +193,14 @@ nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_data *n
 		nsdata->lbaf[0].lbads = spdk_u32log2(spdk_bdev_get_data_block_size(bdev));
 	}
 	nsdata->noiob = spdk_bdev_get_optimal_io_boundary(bdev);
+	if (spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY)) {
+		/* The bdev layer splits or emulates each source range as needed, so
+		 * the limits only bound the size of the source range list.
+		 */
+		nsdata->msrc = SPDK_NVMF_COPY_MAX_RANGES - 1;
+		nsdata->mssrl = SPDK_NVMF_COPY_MAX_RANGE_BLOCKS;
+		nsdata->mcl = SPDK_NVMF_COPY_MAX_LENGTH;
+	}
 	nsdata->nmic.can_share = 1;
 	if (ns->ptpl_file != NULL) {
 		nsdata->nsrescap.rescap.persist = 1;
@@ -345,6 +364,137 @@ nvmf_bdev_ctrlr_write_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
 }
 
+static void
+nvmf_bdev_ctrlr_zcopy_start_complete(struct spdk_bdev_io *bdev_io, bool success,
+				     void *cb_arg)
+{
+	struct spdk_nvmf_request	*req = cb_arg;
+	struct spdk_nvme_cpl		*response = &req->rsp->nvme_cpl;
+	struct iovec			*iov;
+	int				iovcnt = 0, sc = 0, sct = 0;
+	uint32_t			cdw0 = 0;
+
+	if (spdk_unlikely(!success)) {
+		spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+		response->cdw0 = cdw0;
+		response->status.sc = sc;
+		response->status.sct = sct;
+
+		spdk_bdev_free_io(bdev_io);
+		req->zcopy_phase = NVMF_ZCOPY_PHASE_INIT_FAILED;
+		spdk_nvmf_request_complete(req);
+		return;
+	}
+
+	spdk_bdev_io_get_iovec(bdev_io, &iov, &iovcnt);
+	assert(iovcnt > 0);
+
+	if (spdk_unlikely(iovcnt > NVMF_REQ_MAX_BUFFERS)) {
+		SPDK_ERRLOG("Zero-copy buffer has %d iovecs, more than the maximum of %d\n",
+			    iovcnt, NVMF_REQ_MAX_BUFFERS);
+		response->status.sct = SPDK_NVME_SCT_GENERIC;
+		response->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+
+		/* The bdev_io is released by the completion of spdk_nvmf_request_zcopy_end() */
+		req->zcopy_bdev_io = bdev_io;
+		req->zcopy_phase = NVMF_ZCOPY_PHASE_INIT_FAILED;
+		nvmf_bdev_ctrlr_zcopy_end(req, false);
+		return;
+	}
+
+	memcpy(req->iov, iov, sizeof(*iov) * iovcnt);
+	req->iovcnt = iovcnt;
+	req->data = iov[0].iov_base;
+	req->zcopy_bdev_io = bdev_io;
+	req->zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+
+	spdk_nvmf_request_complete(req);
+}
+
+int
+nvmf_bdev_ctrlr_zcopy_start(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			    struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	uint32_t block_size = spdk_bdev_get_block_size(bdev);
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	uint64_t start_lba;
+	uint64_t num_blocks;
+	int rc;
+
+	nvmf_bdev_ctrlr_get_rw_params(cmd, &start_lba, &num_blocks);
+
+	if (spdk_unlikely(!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, start_lba, num_blocks))) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(num_blocks * block_size > req->length)) {
+		SPDK_ERRLOG("Zcopy NLB %" PRIu64 " * block size %" PRIu32 " > SGL length %" PRIu32 "\n",
+			    num_blocks, block_size, req->length);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	/* Only reads need the buffers filled with the data on the bdev */
+	rc = spdk_bdev_zcopy_start(desc, ch, start_lba, num_blocks,
+				   cmd->opc == SPDK_NVME_OPC_READ,
+				   nvmf_bdev_ctrlr_zcopy_start_complete, req);
+	if (spdk_unlikely(rc)) {
+		if (rc == -ENOMEM) {
+			nvmf_bdev_ctrl_queue_io(req, bdev, ch, nvmf_ctrlr_process_io_cmd_resubmit, req);
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+		}
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+static void
+nvmf_bdev_ctrlr_zcopy_end_complete(struct spdk_bdev_io *bdev_io, bool success,
+				   void *cb_arg)
+{
+	struct spdk_nvmf_request	*req = cb_arg;
+	struct spdk_nvme_cpl		*response = &req->rsp->nvme_cpl;
+	int				sc = 0, sct = 0;
+	uint32_t			cdw0 = 0;
+
+	/* Keep the error of a request whose buffers were released because it failed */
+	if (req->zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING) {
+		spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+		response->cdw0 = cdw0;
+		response->status.sc = sc;
+		response->status.sct = sct;
+		req->zcopy_phase = NVMF_ZCOPY_PHASE_COMPLETE;
+	}
+
+	req->zcopy_bdev_io = NULL;
+	spdk_bdev_free_io(bdev_io);
+
+	spdk_nvmf_request_complete(req);
+}
+
+void
+nvmf_bdev_ctrlr_zcopy_end(struct spdk_nvmf_request *req, bool commit)
+{
+	int rc __attribute__((unused));
+
+	rc = spdk_bdev_zcopy_end(req->zcopy_bdev_io, commit, nvmf_bdev_ctrlr_zcopy_end_complete,
+				 req);
+
+	/* The bdev_io was obtained from a successful spdk_bdev_zcopy_start(), so
+	 * releasing it can't fail.
+	 */
+	assert(rc == 0);
+}
+
 int
 nvmf_bdev_ctrlr_compare_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 			    struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
@@ -648,6 +798,194 @@ nvmf_bdev_ctrlr_dsm_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 }
 
+struct nvmf_bdev_ctrlr_copy {
+	struct spdk_nvmf_request	*req;
+	uint32_t			count;
+	struct spdk_bdev_desc		*desc;
+	struct spdk_bdev		*bdev;
+	struct spdk_io_channel		*ch;
+	uint32_t			range_index;
+	uint64_t			dst_lba;
+};
+
+static void
+nvmf_bdev_ctrlr_copy_cpl(struct spdk_bdev_io *bdev_io, bool success,
+			 void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_copy	*copy_ctx = cb_arg;
+	struct spdk_nvmf_request	*req = copy_ctx->req;
+	struct spdk_nvme_cpl		*response = &req->rsp->nvme_cpl;
+	int				sc, sct;
+	uint32_t			cdw0;
+
+	copy_ctx->count--;
+
+	if (response->status.sct == SPDK_NVME_SCT_GENERIC &&
+	    response->status.sc == SPDK_NVME_SC_SUCCESS) {
+		spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+		response->cdw0 = cdw0;
+		response->status.sc = sc;
+		response->status.sct = sct;
+	}
+
+	if (copy_ctx->count == 0) {
+		spdk_nvmf_request_complete(req);
+		free(copy_ctx);
+	}
+	spdk_bdev_free_io(bdev_io);
+}
+
+static int
+nvmf_bdev_ctrlr_copy(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+		     struct spdk_io_channel *ch, struct spdk_nvmf_request *req,
+		     struct nvmf_bdev_ctrlr_copy *copy_ctx);
+static void
+nvmf_bdev_ctrlr_copy_resubmit(void *arg)
+{
+	struct nvmf_bdev_ctrlr_copy *copy_ctx = arg;
+
+	nvmf_bdev_ctrlr_copy(copy_ctx->bdev, copy_ctx->desc, copy_ctx->ch, copy_ctx->req, copy_ctx);
+}
+
+static int
+nvmf_bdev_ctrlr_copy(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+		     struct spdk_io_channel *ch, struct spdk_nvmf_request *req,
+		     struct nvmf_bdev_ctrlr_copy *copy_ctx)
+{
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *response = &req->rsp->nvme_cpl;
+	struct spdk_nvme_scc_source_range *range;
+	uint16_t nr, i;
+	int rc;
+
+	/* NR: CDW12 bits 07:00, 0's based */
+	nr = (from_le32(&cmd->cdw12) & 0xFFu) + 1;
+
+	if (copy_ctx == NULL) {
+		copy_ctx = calloc(1, sizeof(*copy_ctx));
+		if (!copy_ctx) {
+			response->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+
+		copy_ctx->req = req;
+		copy_ctx->desc = desc;
+		copy_ctx->ch = ch;
+		copy_ctx->bdev = bdev;
+		/* SDLBA: CDW10 and CDW11 */
+		copy_ctx->dst_lba = from_le64(&cmd->cdw10);
+
+		response->status.sct = SPDK_NVME_SCT_GENERIC;
+		response->status.sc = SPDK_NVME_SC_SUCCESS;
+	} else {
+		copy_ctx->count--;	/* dequeued */
+	}
+
+	range = (struct spdk_nvme_scc_source_range *)req->data;
+	for (i = copy_ctx->range_index; i < nr; i++) {
+		copy_ctx->count++;
+
+		rc = spdk_bdev_copy_blocks(desc, ch, copy_ctx->dst_lba, range[i].slba,
+					   (uint64_t)range[i].nlb + 1,
+					   nvmf_bdev_ctrlr_copy_cpl, copy_ctx);
+		if (rc) {
+			if (rc == -ENOMEM) {
+				nvmf_bdev_ctrl_queue_io(req, bdev, ch, nvmf_bdev_ctrlr_copy_resubmit,
+							copy_ctx);
+				/* count will be decremented when the request is dequeued */
+				return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+			}
+			response->status.sc = rc == -EINVAL ? SPDK_NVME_SC_INVALID_FIELD :
+					      SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+			copy_ctx->count--;
+			/* Wait for any copies already sent to complete */
+			break;
+		}
+		copy_ctx->dst_lba += (uint64_t)range[i].nlb + 1;
+		copy_ctx->range_index++;
+	}
+
+	if (copy_ctx->count == 0) {
+		free(copy_ctx);
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+int
+nvmf_bdev_ctrlr_copy_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			 struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *response = &req->rsp->nvme_cpl;
+	struct spdk_nvme_scc_source_range *range;
+	uint64_t num_blocks = 0, bdev_num_blocks, dst_lba;
+	uint32_t cdw12;
+	uint16_t nr, i;
+
+	cdw12 = from_le32(&cmd->cdw12);
+	nr = (cdw12 & 0xFFu) + 1;
+
+	response->status.sct = SPDK_NVME_SCT_GENERIC;
+
+	/* Only source range entries descriptor format 0 is supported */
+	if (((cdw12 >> 8) & 0xFu) != SPDK_NVME_COPY_DESC_FORMAT_0) {
+		response->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (nr * sizeof(struct spdk_nvme_scc_source_range) > req->length) {
+		SPDK_ERRLOG("Copy number of ranges > SGL length\n");
+		response->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	/* Validate the whole command up front so that no range is copied
+	 * when another one is out of bounds.
+	 */
+	bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	range = (struct spdk_nvme_scc_source_range *)req->data;
+	for (i = 0; i < nr; i++) {
+		if (spdk_unlikely(!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, range[i].slba,
+				  (uint64_t)range[i].nlb + 1))) {
+			response->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+		if (spdk_unlikely((uint64_t)range[i].nlb + 1 > SPDK_NVMF_COPY_MAX_RANGE_BLOCKS)) {
+			response->status.sct = SPDK_NVME_SCT_COMMAND_SPECIFIC;
+			response->status.sc = SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+		num_blocks += (uint64_t)range[i].nlb + 1;
+	}
+
+	if (spdk_unlikely(num_blocks > SPDK_NVMF_COPY_MAX_LENGTH)) {
+		response->status.sct = SPDK_NVME_SCT_COMMAND_SPECIFIC;
+		response->status.sc = SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	dst_lba = from_le64(&cmd->cdw10);
+	if (spdk_unlikely(!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, dst_lba, num_blocks))) {
+		response->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	/* The ranges are copied concurrently, so no source range may overlap any part
+	 * of the destination, not only the blocks it is copied to.
+	 */
+	for (i = 0; i < nr; i++) {
+		if (spdk_unlikely(range[i].slba < dst_lba + num_blocks &&
+				  dst_lba < range[i].slba + range[i].nlb + 1)) {
+			response->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+	}
+
+	return nvmf_bdev_ctrlr_copy(bdev, desc, ch, req, NULL);
+}
+
 int
 nvmf_bdev_ctrlr_nvme_passthru_io(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 				 struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
@@ -50,6 +50,9 @@ SPDK_LOG_REGISTER_COMPONENT(nvmf)
 
 #define SPDK_NVMF_DEFAULT_MAX_SUBSYSTEMS 1024
 #define SPDK_NVMF_DEFAULT_ACCEPT_POLL_RATE_US 10000
+#define SPDK_NVMF_POLL_GROUP_LOAD_SAMPLE_US 100000
+/* Poll groups whose busy percentages fall within the same step are considered equally busy */
+#define SPDK_NVMF_POLL_GROUP_BUSY_PCT_STEP 10
 
 static TAILQ_HEAD(, spdk_nvmf_tgt) g_nvmf_tgts = TAILQ_HEAD_INITIALIZER(g_nvmf_tgts);
 
@@ -107,6 +110,39 @@ nvmf_poll_group_poll(void *ctx)
 	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+static int
+nvmf_poll_group_sample_load(void *ctx)
+{
+	struct spdk_nvmf_poll_group *group = ctx;
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_thread_stats stats;
+	uint64_t busy_tsc, idle_tsc, outstanding_io = 0;
+	uint32_t sid, nsid;
+
+	if (spdk_thread_get_stats(&stats) == 0) {
+		busy_tsc = stats.busy_tsc - group->last_busy_tsc;
+		idle_tsc = stats.idle_tsc - group->last_idle_tsc;
+		if (busy_tsc + idle_tsc > 0) {
+			__atomic_store_n(&group->busy_pct, busy_tsc * 100 / (busy_tsc + idle_tsc),
+					 __ATOMIC_RELAXED);
+		}
+		group->last_busy_tsc = stats.busy_tsc;
+		group->last_idle_tsc = stats.idle_tsc;
+	}
+
+	for (sid = 0; sid < group->num_sgroups; sid++) {
+		sgroup = &group->sgroups[sid];
+
+		for (nsid = 0; nsid < sgroup->num_ns; nsid++) {
+			outstanding_io += sgroup->ns_info[nsid].io_outstanding;
+		}
+	}
+	__atomic_store_n(&group->outstanding_io, outstanding_io, __ATOMIC_RELAXED);
+
+	/* Sampling isn't real work, so don't count it towards the busy time */
+	return SPDK_POLLER_IDLE;
+}
+
 static int
 nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 {
@@ -149,6 +185,11 @@ nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 	group->poller = SPDK_POLLER_REGISTER(nvmf_poll_group_poll, group, 0);
 	group->thread = spdk_get_thread();
 
+	if (tgt->qpair_placement == SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED) {
+		group->load_poller = SPDK_POLLER_REGISTER(nvmf_poll_group_sample_load, group,
+				     SPDK_NVMF_POLL_GROUP_LOAD_SAMPLE_US);
+	}
+
 	return 0;
 }
 
@@ -186,6 +227,7 @@ nvmf_tgt_destroy_poll_group(void *io_device, void *ctx_buf)
 	free(group->sgroups);
 
 	spdk_poller_unregister(&group->poller);
+	spdk_poller_unregister(&group->load_poller);
 
 	if (group->destroy_cb_fn) {
 		group->destroy_cb_fn(group->destroy_cb_arg, 0);
@@ -282,6 +324,10 @@ spdk_nvmf_tgt_create(struct spdk_nvmf_target_opts *opts)
 		acceptor_poll_rate = opts->acceptor_poll_rate;
 	}
 
+	if (opts) {
+		tgt->qpair_placement = opts->qpair_placement;
+	}
+
 	tgt->discovery_genctr = 0;
 	TAILQ_INIT(&tgt->transports);
 	TAILQ_INIT(&tgt->poll_groups);
@@ -817,19 +863,75 @@ _nvmf_poll_group_add(void *_ctx)
 
 	free(_ctx);
 
+	__atomic_fetch_sub(&group->pending_qpairs, 1, __ATOMIC_RELAXED);
+
 	if (spdk_nvmf_poll_group_add(group, qpair) != 0) {
 		SPDK_ERRLOG("Unable to add the qpair to a poll group.\n");
 		spdk_nvmf_qpair_disconnect(qpair, NULL, NULL);
 	}
 }
 
+/* Compare the load of two poll groups. The busy percentage is compared first, in steps so
+ * that small fluctuations don't decide, followed by the outstanding I/O and the number of
+ * qpairs, which include qpairs that were assigned but not added yet.
+ */
+static bool
+nvmf_poll_group_less_loaded(struct spdk_nvmf_poll_group *a, struct spdk_nvmf_poll_group *b)
+{
+	uint32_t busy_a, busy_b, qpairs_a, qpairs_b;
+	uint64_t io_a, io_b;
+
+	/* The fields are updated by the groups' own threads */
+	busy_a = __atomic_load_n(&a->busy_pct, __ATOMIC_RELAXED);
+	busy_b = __atomic_load_n(&b->busy_pct, __ATOMIC_RELAXED);
+	busy_a /= SPDK_NVMF_POLL_GROUP_BUSY_PCT_STEP;
+	busy_b /= SPDK_NVMF_POLL_GROUP_BUSY_PCT_STEP;
+	if (busy_a != busy_b) {
+		return busy_a < busy_b;
+	}
+
+	io_a = __atomic_load_n(&a->outstanding_io, __ATOMIC_RELAXED);
+	io_b = __atomic_load_n(&b->outstanding_io, __ATOMIC_RELAXED);
+	if (io_a != io_b) {
+		return io_a < io_b;
+	}
+
+	qpairs_a = __atomic_load_n(&a->num_qpairs, __ATOMIC_RELAXED) +
+		   __atomic_load_n(&a->pending_qpairs, __ATOMIC_RELAXED);
+	qpairs_b = __atomic_load_n(&b->num_qpairs, __ATOMIC_RELAXED) +
+		   __atomic_load_n(&b->pending_qpairs, __ATOMIC_RELAXED);
+
+	return qpairs_a < qpairs_b;
+}
+
+static struct spdk_nvmf_poll_group *
+nvmf_tgt_get_least_loaded_poll_group(struct spdk_nvmf_tgt *tgt)
+{
+	struct spdk_nvmf_poll_group *group, *least_loaded = NULL;
+
+	pthread_mutex_lock(&tgt->mutex);
+	TAILQ_FOREACH(group, &tgt->poll_groups, link) {
+		if (least_loaded == NULL || nvmf_poll_group_less_loaded(group, least_loaded)) {
+			least_loaded = group;
+		}
+	}
+	pthread_mutex_unlock(&tgt->mutex);
+
+	return least_loaded;
+}
+
 void
 spdk_nvmf_tgt_new_qpair(struct spdk_nvmf_tgt *tgt, struct spdk_nvmf_qpair *qpair)
 {
 	struct spdk_nvmf_poll_group *group;
 	struct nvmf_new_qpair_ctx *ctx;
 
-	group = spdk_nvmf_get_optimal_poll_group(qpair);
+	if (tgt->qpair_placement == SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED) {
+		group = nvmf_tgt_get_least_loaded_poll_group(tgt);
+	} else {
+		group = spdk_nvmf_get_optimal_poll_group(qpair);
+	}
+
 	if (group == NULL) {
 		if (tgt->next_poll_group == NULL) {
 			tgt->next_poll_group = TAILQ_FIRST(&tgt->poll_groups);
@@ -853,6 +955,8 @@ spdk_nvmf_tgt_new_qpair(struct spdk_nvmf_tgt *tgt, struct spdk_nvmf_qpair *qpair
 	ctx->qpair = qpair;
 	ctx->group = group;
 
+	__atomic_fetch_add(&group->pending_qpairs, 1, __ATOMIC_RELAXED);
+
 	spdk_thread_send_msg(group->thread, _nvmf_poll_group_add, ctx);
 }
 
@@ -905,6 +1009,7 @@ spdk_nvmf_poll_group_add(struct spdk_nvmf_poll_group *group,
 	/* We add the qpair to the group only it is succesfully added into the tgroup */
 	if (rc == 0) {
 		TAILQ_INSERT_TAIL(&group->qpairs, qpair, link);
+		__atomic_fetch_add(&group->num_qpairs, 1, __ATOMIC_RELAXED);
 		nvmf_qpair_set_state(qpair, SPDK_NVMF_QPAIR_ACTIVE);
 	}
 
@@ -991,6 +1096,8 @@ spdk_nvmf_poll_group_remove(struct spdk_nvmf_qpair *qpair)
 	}
 
 	TAILQ_REMOVE(&qpair->group->qpairs, qpair, link);
+	assert(qpair->group->num_qpairs > 0);
+	__atomic_fetch_sub(&qpair->group->num_qpairs, 1, __ATOMIC_RELAXED);
 	qpair->group = NULL;
 }
 
@@ -1080,6 +1187,7 @@ spdk_nvmf_qpair_disconnect(struct spdk_nvmf_qpair *qpair, nvmf_qpair_disconnect_
 	if (!TAILQ_EMPTY(&qpair->outstanding)) {
 		qpair->state_cb = _nvmf_qpair_destroy;
 		qpair->state_cb_arg = qpair_ctx;
+		nvmf_transport_qpair_abort_zcopy(qpair);
 		nvmf_qpair_free_aer(qpair);
 		return 0;
 	}
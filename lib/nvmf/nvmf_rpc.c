@@ -1597,7 +1597,7 @@ static void
 rpc_nvmf_create_target(struct spdk_jsonrpc_request *request,
 		       const struct spdk_json_val *params)
 {
-	struct spdk_nvmf_target_opts	opts;
+	struct spdk_nvmf_target_opts	opts = {0};
 	struct nvmf_rpc_target_ctx	ctx = {0};
 	struct spdk_nvmf_tgt		*tgt;
 	struct spdk_json_write_ctx	*w;
@@ -93,6 +93,15 @@ enum spdk_nvmf_tcp_req_state {
 	/* The request completed and can be marked free. */
 	TCP_REQUEST_STATE_COMPLETED,
 
+	/* The request is waiting for the bdev to provide zero-copy buffers */
+	TCP_REQUEST_STATE_AWAITING_ZCOPY_START,
+
+	/* The bdev finished providing zero-copy buffers */
+	TCP_REQUEST_STATE_ZCOPY_START_COMPLETED,
+
+	/* The request is waiting for the bdev to release zero-copy buffers */
+	TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE,
+
 	/* Terminator */
 	TCP_REQUEST_NUM_STATES,
 };
@@ -122,6 +131,9 @@ static const char *spdk_nvmf_tcp_term_req_fes_str[] = {
 #define TRACE_TCP_FLUSH_WRITEBUF_DONE					SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xA)
 #define TRACE_TCP_READ_FROM_SOCKET_DONE					SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xB)
 #define TRACE_TCP_REQUEST_STATE_AWAIT_R2T_ACK				SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xC)
+#define TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_START			SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xD)
+#define TRACE_TCP_REQUEST_STATE_ZCOPY_START_COMPLETED			SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xE)
+#define TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_RELEASE			SPDK_TPOINT_ID(TRACE_GROUP_NVMF_TCP, 0xF)
 
 SPDK_TRACE_REGISTER_FN(nvmf_tcp_trace, "nvmf_tcp", TRACE_GROUP_NVMF_TCP)
 {
@@ -165,6 +177,15 @@ SPDK_TRACE_REGISTER_FN(nvmf_tcp_trace, "nvmf_tcp", TRACE_GROUP_NVMF_TCP)
 	spdk_trace_register_description("TCP_REQ_AWAIT_R2T_ACK",
 					TRACE_TCP_REQUEST_STATE_AWAIT_R2T_ACK,
 					OWNER_NONE, OBJECT_NVMF_TCP_IO, 0, 1, "");
+	spdk_trace_register_description("TCP_REQ_AWAIT_ZCPY_START",
+					TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_START,
+					OWNER_NONE, OBJECT_NVMF_TCP_IO, 0, 1, "");
+	spdk_trace_register_description("TCP_REQ_ZCPY_START_CMPL",
+					TRACE_TCP_REQUEST_STATE_ZCOPY_START_COMPLETED,
+					OWNER_NONE, OBJECT_NVMF_TCP_IO, 0, 1, "");
+	spdk_trace_register_description("TCP_REQ_AWAIT_ZCPY_RLS",
+					TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_RELEASE,
+					OWNER_NONE, OBJECT_NVMF_TCP_IO, 0, 1, "");
 }
 
 struct spdk_nvmf_tcp_req  {
@@ -286,6 +307,7 @@ struct tcp_transport_opts {
 	bool		c2h_success;
 	uint16_t	control_msg_num;
 	uint32_t	sock_priority;
+	bool		zcopy;
 };
 
 struct spdk_nvmf_tcp_transport {
@@ -310,6 +332,10 @@ static const struct spdk_json_object_decoder tcp_transport_opts_decoder[] = {
 		"sock_priority", offsetof(struct tcp_transport_opts, sock_priority),
 		spdk_json_decode_uint32, true
 	},
+	{
+		"zcopy", offsetof(struct tcp_transport_opts, zcopy),
+		spdk_json_decode_bool, true
+	},
 };
 
 static bool nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
@@ -368,6 +394,8 @@ nvmf_tcp_req_get(struct spdk_nvmf_tcp_qpair *tqpair)
 	tcp_req->h2c_offset = 0;
 	tcp_req->has_incapsule_data = false;
 	tcp_req->req.dif.dif_insert_or_strip = false;
+	tcp_req->req.zcopy_phase = NVMF_ZCOPY_PHASE_NONE;
+	tcp_req->req.zcopy_bdev_io = NULL;
 
 	TAILQ_REMOVE(&tqpair->tcp_req_free_queue, tcp_req, state_link);
 	TAILQ_INSERT_TAIL(&tqpair->tcp_req_working_queue, tcp_req, state_link);
@@ -503,6 +531,7 @@ nvmf_tcp_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_write
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
 	spdk_json_write_named_bool(w, "c2h_success", ttransport->tcp_opts.c2h_success);
 	spdk_json_write_named_uint32(w, "sock_priority", ttransport->tcp_opts.sock_priority);
+	spdk_json_write_named_bool(w, "zcopy", ttransport->tcp_opts.zcopy);
 }
 
 static int
@@ -559,7 +588,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     "  in_capsule_data_size=%d, max_aq_depth=%d\n"
 		     "  num_shared_buffers=%d, c2h_success=%d,\n"
 		     "  dif_insert_or_strip=%d, sock_priority=%d\n"
-		     "  abort_timeout_sec=%d, control_msg_num=%hu\n",
+		     "  abort_timeout_sec=%d, control_msg_num=%hu\n"
+		     "  zcopy=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr - 1,
@@ -571,7 +601,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     opts->dif_insert_or_strip,
 		     ttransport->tcp_opts.sock_priority,
 		     opts->abort_timeout_sec,
-		     ttransport->tcp_opts.control_msg_num);
+		     ttransport->tcp_opts.control_msg_num,
+		     ttransport->tcp_opts.zcopy);
 
 	if (ttransport->tcp_opts.sock_priority > SPDK_NVMF_TCP_DEFAULT_MAX_SOCK_PRIORITY) {
 		SPDK_ERRLOG("Unsupported socket_priority=%d, the current range is: 0 to %d\n"
@@ -1537,6 +1568,10 @@ nvmf_tcp_r2t_complete(void *cb_arg)
 	if (tcp_req->h2c_offset == tcp_req->req.length) {
 		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_EXECUTE);
 		nvmf_tcp_req_process(ttransport, tcp_req);
+	} else if (spdk_unlikely(tcp_req->req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE &&
+				 tcp_req->req.qpair->state != SPDK_NVMF_QPAIR_ACTIVE)) {
+		/* The rest of the data won't come, see nvmf_tcp_qpair_abort_zcopy() */
+		nvmf_tcp_req_process(ttransport, tcp_req);
 	}
 }
 
@@ -1658,7 +1693,7 @@ nvmf_tcp_pdu_payload_handle(struct spdk_nvmf_tcp_qpair *tqpair,
 	SPDK_DEBUGLOG(nvmf_tcp, "enter\n");
 	/* check data digest if need */
 	if (pdu->ddgst_enable) {
-		crc32c = nvme_tcp_pdu_calc_data_digest(pdu);
+		crc32c = nvme_tcp_pdu_get_data_digest(pdu);
 		rc = MATCH_DIGEST_WORD(pdu->data_digest, crc32c);
 		if (rc == 0) {
 			SPDK_ERRLOG("Data digest error on tqpair=(%p) with pdu=%p\n", tqpair, pdu);
@@ -2020,6 +2055,9 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 			if (rc < 0) {
 				return NVME_TCP_PDU_FATAL;
 			}
+			if (pdu->ddgst_enable) {
+				nvme_tcp_pdu_update_data_digest(pdu, pdu->rw_offset, rc);
+			}
 			pdu->rw_offset += rc;
 
 			if (spdk_unlikely(pdu->dif_ctx != NULL)) {
@@ -2114,6 +2152,11 @@ nvmf_tcp_req_parse_sgl(struct spdk_nvmf_tcp_req *tcp_req,
 			req->dif.elba_length = length;
 		}
 
+		if (spdk_nvmf_request_using_zcopy(req)) {
+			/* The buffers will be provided by the bdev */
+			return 0;
+		}
+
 		if (spdk_nvmf_request_get_buffers(req, group, transport, length)) {
 			/* No available buffers. Queue this request up. */
 			SPDK_DEBUGLOG(nvmf_tcp, "No available large data buffers. Queueing request %p\n",
@@ -2410,8 +2453,12 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 	group = &tqpair->group->group;
 	assert(tcp_req->state != TCP_REQUEST_STATE_FREE);
 
-	/* If the qpair is not active, we need to abort the outstanding requests. */
-	if (tqpair->qpair.state != SPDK_NVMF_QPAIR_ACTIVE) {
+	/* If the qpair is not active, we need to abort the outstanding requests. Requests
+	 * waiting for the bdev's zero-copy buffers are finished once the bdev calls back.
+	 */
+	if (tqpair->qpair.state != SPDK_NVMF_QPAIR_ACTIVE &&
+	    tcp_req->state != TCP_REQUEST_STATE_AWAITING_ZCOPY_START &&
+	    tcp_req->state != TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE) {
 		if (tcp_req->state == TCP_REQUEST_STATE_NEED_BUFFER) {
 			STAILQ_REMOVE(&group->pending_buf_queue, &tcp_req->req, spdk_nvmf_request, buf_link);
 		}
@@ -2466,6 +2513,25 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 				nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_READY);
 			}
 
+			/* Let the bdev provide the data buffers instead of taking them from the
+			 * shared pool. In-capsule data already sits in the request's buffer.
+			 */
+			if (ttransport->tcp_opts.zcopy && !tcp_req->has_incapsule_data &&
+			    nvmf_ctrlr_use_zcopy(&tcp_req->req)) {
+				tcp_req->req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+				rc = nvmf_tcp_req_parse_sgl(tcp_req, transport, group);
+				if (rc < 0) {
+					tcp_req->req.zcopy_phase = NVMF_ZCOPY_PHASE_NONE;
+					nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_ERROR);
+					nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
+					break;
+				}
+
+				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+				spdk_nvmf_request_zcopy_start(&tcp_req->req);
+				break;
+			}
+
 			nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_NEED_BUFFER);
 			STAILQ_INSERT_TAIL(&group->pending_buf_queue, &tcp_req->req, buf_link);
 			break;
@@ -2572,8 +2638,47 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			/* Some external code must kick a request into TCP_REQUEST_STATE_COMPLETED
 			 * to escape this state. */
 			break;
+		case TCP_REQUEST_STATE_AWAITING_ZCOPY_START:
+			spdk_trace_record(TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_START, 0, 0,
+					  (uintptr_t)tcp_req, 0);
+			/* Some external code must kick a request into
+			 * TCP_REQUEST_STATE_ZCOPY_START_COMPLETED to escape this state. */
+			break;
+		case TCP_REQUEST_STATE_ZCOPY_START_COMPLETED:
+			spdk_trace_record(TRACE_TCP_REQUEST_STATE_ZCOPY_START_COMPLETED, 0, 0,
+					  (uintptr_t)tcp_req, 0);
+			if (spdk_unlikely(tcp_req->req.zcopy_phase != NVMF_ZCOPY_PHASE_EXECUTE)) {
+				/* The bdev couldn't provide the buffers and set the status */
+				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_COMPLETE);
+				break;
+			}
+
+			if (tcp_req->req.xfer == SPDK_NVME_DATA_HOST_TO_CONTROLLER) {
+				SPDK_DEBUGLOG(nvmf_tcp, "Sending R2T for tcp_req(%p) on tqpair=%p\n",
+					      tcp_req, tqpair);
+				nvmf_tcp_send_r2t_pdu(tqpair, tcp_req);
+				break;
+			}
+
+			nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_READY_TO_EXECUTE);
+			break;
+		case TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE:
+			spdk_trace_record(TRACE_TCP_REQUEST_STATE_AWAIT_ZCOPY_RELEASE, 0, 0,
+					  (uintptr_t)tcp_req, 0);
+			/* Some external code must kick a request into TCP_REQUEST_STATE_COMPLETED
+			 * to escape this state. */
+			break;
 		case TCP_REQUEST_STATE_COMPLETED:
 			spdk_trace_record(TRACE_TCP_REQUEST_STATE_COMPLETED, 0, 0, (uintptr_t)tcp_req, 0);
+			if (spdk_unlikely(tcp_req->req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE)) {
+				/* The data was sent, or the request was aborted. Either way the
+				 * buffers go back to the bdev without being committed.
+				 */
+				nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE);
+				spdk_nvmf_request_zcopy_end(&tcp_req->req, false);
+				break;
+			}
+			tcp_req->req.zcopy_phase = NVMF_ZCOPY_PHASE_NONE;
 			if (tcp_req->req.data_from_pool) {
 				spdk_nvmf_request_free_buffers(&tcp_req->req, group, transport);
 			} else if (spdk_unlikely(tcp_req->has_incapsule_data && (tcp_req->cmd.opc == SPDK_NVME_OPC_FABRIC ||
@@ -2702,7 +2807,18 @@ nvmf_tcp_req_complete(struct spdk_nvmf_request *req)
 	ttransport = SPDK_CONTAINEROF(req->qpair->transport, struct spdk_nvmf_tcp_transport, transport);
 	tcp_req = SPDK_CONTAINEROF(req, struct spdk_nvmf_tcp_req, req);
 
-	nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_EXECUTED);
+	switch (tcp_req->state) {
+	case TCP_REQUEST_STATE_AWAITING_ZCOPY_START:
+		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_ZCOPY_START_COMPLETED);
+		break;
+	case TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE:
+		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_COMPLETED);
+		break;
+	default:
+		nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_EXECUTED);
+		break;
+	}
+
 	nvmf_tcp_req_process(ttransport, tcp_req);
 
 	return 0;
@@ -2908,6 +3024,35 @@ nvmf_tcp_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
 	_nvmf_tcp_qpair_abort_request(req);
 }
 
+static void
+nvmf_tcp_qpair_abort_zcopy(struct spdk_nvmf_qpair *qpair)
+{
+	struct spdk_nvmf_tcp_qpair *tqpair;
+	struct spdk_nvmf_tcp_transport *ttransport;
+	struct spdk_nvmf_tcp_req *tcp_req, *req_tmp;
+
+	tqpair = SPDK_CONTAINEROF(qpair, struct spdk_nvmf_tcp_qpair, qpair);
+	ttransport = SPDK_CONTAINEROF(qpair->transport, struct spdk_nvmf_tcp_transport, transport);
+
+	/* Stop receiving first, so no data lands in the buffers released below */
+	if (tqpair->state <= NVME_TCP_QPAIR_STATE_RUNNING) {
+		tqpair->state = NVME_TCP_QPAIR_STATE_EXITING;
+		nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_ERROR);
+		spdk_poller_unregister(&tqpair->timeout_poller);
+	}
+
+	/* The qpair isn't active anymore, so processing the requests completes them and
+	 * ends the zero-copy without committing. The ones awaiting the R2T ack are
+	 * completed by nvmf_tcp_r2t_complete().
+	 */
+	TAILQ_FOREACH_SAFE(tcp_req, &tqpair->tcp_req_working_queue, state_link, req_tmp) {
+		if (tcp_req->state == TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER &&
+		    tcp_req->req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE) {
+			nvmf_tcp_req_process(ttransport, tcp_req);
+		}
+	}
+}
+
 #define SPDK_NVMF_TCP_DEFAULT_MAX_QUEUE_DEPTH 128
 #define SPDK_NVMF_TCP_DEFAULT_AQ_DEPTH 128
 #define SPDK_NVMF_TCP_DEFAULT_MAX_QPAIRS_PER_CTRLR 128
@@ -2964,6 +3109,7 @@ const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp = {
 	.qpair_get_peer_trid = nvmf_tcp_qpair_get_peer_trid,
 	.qpair_get_listen_trid = nvmf_tcp_qpair_get_listen_trid,
 	.qpair_abort_request = nvmf_tcp_qpair_abort_request,
+	.qpair_abort_zcopy = nvmf_tcp_qpair_abort_zcopy,
 };
 
 SPDK_NVMF_TRANSPORT_REGISTER(tcp, &spdk_nvmf_transport_tcp);
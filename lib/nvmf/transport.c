@@ -556,6 +556,14 @@ nvmf_transport_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
 	qpair->transport->ops->qpair_abort_request(qpair, req);
 }
 
+void
+nvmf_transport_qpair_abort_zcopy(struct spdk_nvmf_qpair *qpair)
+{
+	if (qpair->transport->ops->qpair_abort_zcopy) {
+		qpair->transport->ops->qpair_abort_zcopy(qpair);
+	}
+}
+
 bool
 spdk_nvmf_transport_opts_init(const char *transport_name,
 			      struct spdk_nvmf_transport_opts *opts, size_t opts_size)
@@ -80,4 +80,6 @@ int nvmf_transport_qpair_get_listen_trid(struct spdk_nvmf_qpair *qpair,
 void nvmf_transport_qpair_abort_request(struct spdk_nvmf_qpair *qpair,
 					struct spdk_nvmf_request *req);
 
+void nvmf_transport_qpair_abort_zcopy(struct spdk_nvmf_qpair *qpair);
+
 #endif /* SPDK_NVMF_TRANSPORT_H */
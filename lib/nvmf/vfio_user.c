@@ -2021,6 +2021,12 @@ get_nvmf_io_req_length(struct spdk_nvmf_request *req)
 		return nr * sizeof(struct spdk_nvme_dsm_range);
 	}
 
+	if (cmd->opc == SPDK_NVME_OPC_COPY) {
+		/* NR: CDW12 bits 07:00, 0's based */
+		nr = (cmd->cdw12 & 0xffu) + 1;
+		return nr * sizeof(struct spdk_nvme_scc_source_range);
+	}
+
 	nlb = (cmd->cdw12 & 0x0000ffffu) + 1;
 	return nlb * spdk_bdev_get_block_size(ns->bdev);
 }
@@ -814,6 +814,8 @@ spdk_sock_write_config_json(struct spdk_json_write_ctx *w)
 			spdk_json_write_named_bool(w, "enable_zerocopy_send", opts.enable_zerocopy_send);
 			spdk_json_write_named_bool(w, "enable_quickack", opts.enable_quickack);
 			spdk_json_write_named_uint32(w, "enable_placement_id", opts.enable_placement_id);
+			spdk_json_write_named_uint32(w, "zerocopy_threshold",
+						     opts.zerocopy_threshold);
 			spdk_json_write_object_end(w);
 			spdk_json_write_object_end(w);
 		} else {
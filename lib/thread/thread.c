@@ -49,7 +49,9 @@
 #include <sys/eventfd.h>
 #endif
 
+/* Bounds of the number of messages run per poll */
 #define SPDK_MSG_BATCH_SIZE		8
+#define SPDK_MSG_BATCH_SIZE_MAX		128
 #define SPDK_MAX_DEVICE_NAME_LEN	256
 #define SPDK_THREAD_EXIT_TIMEOUT_SEC	5
 
@@ -194,6 +196,7 @@ _free_thread(struct spdk_thread *thread)
 	struct spdk_io_channel *ch;
 	struct spdk_msg *msg;
 	struct spdk_poller *poller, *ptmp;
+	uint32_t i;
 
 	TAILQ_FOREACH(ch, &thread->io_channels, tailq) {
 		SPDK_ERRLOG("thread %s still has channel for io_device %s\n",
@@ -209,14 +212,15 @@ _free_thread(struct spdk_thread *thread)
 		free(poller);
 	}
 
-	TAILQ_FOREACH_SAFE(poller, &thread->timed_pollers, tailq, ptmp) {
+	for (i = 0; i < thread->num_timed_pollers; i++) {
+		poller = thread->timed_pollers[i];
 		if (poller->state != SPDK_POLLER_STATE_UNREGISTERED) {
 			SPDK_WARNLOG("timed_poller %s still registered at thread exit\n",
 				     poller->name);
 		}
-		TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
 		free(poller);
 	}
+	free(thread->timed_pollers);
 
 	TAILQ_FOREACH_SAFE(poller, &thread->paused_pollers, tailq, ptmp) {
 		SPDK_WARNLOG("paused_poller %s still registered at thread exit\n", poller->name);
@@ -269,13 +273,14 @@ spdk_thread_create(const char *name, struct spdk_cpuset *cpumask)
 	} else {
 		spdk_cpuset_negate(&thread->cpumask);
 	}
+	thread->socket_hint = SPDK_ENV_SOCKET_ID_ANY;
 
 	TAILQ_INIT(&thread->io_channels);
 	TAILQ_INIT(&thread->active_pollers);
-	TAILQ_INIT(&thread->timed_pollers);
 	TAILQ_INIT(&thread->paused_pollers);
 	SLIST_INIT(&thread->msg_cache);
 	thread->msg_cache_count = 0;
+	thread->msg_batch_size = SPDK_MSG_BATCH_SIZE;
 
 	thread->tsc_last = spdk_get_ticks();
 
@@ -354,6 +359,7 @@ thread_exit(struct spdk_thread *thread, uint64_t now)
 {
 	struct spdk_poller *poller;
 	struct spdk_io_channel *ch;
+	uint32_t i;
 
 	if (now >= thread->exit_timeout_tsc) {
 		SPDK_ERRLOG("thread %s got timeout, and move it to the exited state forcefully\n",
@@ -370,7 +376,8 @@ thread_exit(struct spdk_thread *thread, uint64_t now)
 		}
 	}
 
-	TAILQ_FOREACH(poller, &thread->timed_pollers, tailq) {
+	for (i = 0; i < thread->num_timed_pollers; i++) {
+		poller = thread->timed_pollers[i];
 		if (poller->state != SPDK_POLLER_STATE_UNREGISTERED) {
 			SPDK_INFOLOG(thread,
 				     "thread %s still has active timed poller %s\n",
@@ -489,6 +496,33 @@ spdk_thread_set_cpumask(struct spdk_cpuset *cpumask)
 	return 0;
 }
 
+int32_t
+spdk_thread_get_socket_hint(struct spdk_thread *thread)
+{
+	return thread->socket_hint;
+}
+
+int
+spdk_thread_set_socket_hint(int32_t socket_id)
+{
+	struct spdk_thread *thread;
+
+	thread = spdk_get_thread();
+	if (!thread) {
+		SPDK_ERRLOG("Called from non-SPDK thread\n");
+		assert(false);
+		return -EINVAL;
+	}
+
+	if (socket_id < 0 && socket_id != SPDK_ENV_SOCKET_ID_ANY) {
+		return -EINVAL;
+	}
+
+	thread->socket_hint = socket_id;
+
+	return 0;
+}
+
 struct spdk_thread *
 spdk_thread_get_from_ctx(void *ctx)
 {
@@ -502,12 +536,35 @@ spdk_thread_get_from_ctx(void *ctx)
 	return SPDK_CONTAINEROF(ctx, struct spdk_thread, ctx);
 }
 
+/*
+ * Adapt the number of messages run per poll to the depth of the messages ring.
+ * The batch doubles while messages pile up, so a burst is drained in a few
+ * polls, and halves back once the ring is shallow, so that the pollers don't
+ * wait behind long batches.
+ */
+static inline uint32_t
+msg_queue_batch_size(struct spdk_thread *thread, size_t depth)
+{
+	uint32_t batch_size = thread->msg_batch_size;
+
+	if (spdk_unlikely(depth > batch_size)) {
+		batch_size = spdk_min(batch_size * 2, SPDK_MSG_BATCH_SIZE_MAX);
+	} else if (depth < batch_size / 4) {
+		batch_size = spdk_max(batch_size / 2, SPDK_MSG_BATCH_SIZE);
+	}
+	thread->msg_batch_size = batch_size;
+
+	return batch_size;
+}
+
 static inline uint32_t
 msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 {
 	unsigned count, i;
-	void *messages[SPDK_MSG_BATCH_SIZE];
+	void *messages[SPDK_MSG_BATCH_SIZE_MAX];
 	uint64_t notify = 1;
+	size_t depth;
+	uint32_t batch_size;
 	int rc;
 
 #ifdef DEBUG
@@ -519,11 +576,6 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 	memset(messages, 0, sizeof(messages));
 #endif
 
-	if (max_msgs > 0) {
-		max_msgs = spdk_min(max_msgs, SPDK_MSG_BATCH_SIZE);
-	} else {
-		max_msgs = SPDK_MSG_BATCH_SIZE;
-	}
 	if (thread->interrupt_mode) {
 		/* There may be race between msg_acknowledge and another producer's msg_notify,
 		 * so msg_acknowledge should be applied ahead. And then check for self's msg_notify.
@@ -535,6 +587,19 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 		}
 	}
 
+	depth = spdk_ring_count(thread->messages);
+	thread->stats.msg_backlog = depth;
+	if (spdk_unlikely(depth > thread->stats.msg_backlog_max)) {
+		thread->stats.msg_backlog_max = depth;
+	}
+
+	batch_size = msg_queue_batch_size(thread, depth);
+	if (max_msgs > 0) {
+		max_msgs = spdk_min(max_msgs, batch_size);
+	} else {
+		max_msgs = batch_size;
+	}
+
 	count = spdk_ring_dequeue(thread->messages, messages, max_msgs);
 	if (thread->interrupt_mode && spdk_ring_count(thread->messages) != 0) {
 		rc = write(thread->msg_fd, &notify, sizeof(notify));
@@ -546,6 +611,8 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 		return 0;
 	}
 
+	thread->stats.msg_count += count;
+
 	for (i = 0; i < count; i++) {
 		struct spdk_msg *msg = messages[i];
 
@@ -565,26 +632,139 @@ msg_queue_run_batch(struct spdk_thread *thread, uint32_t max_msgs)
 	return count;
 }
 
+static inline bool
+timed_poller_expires_before(const struct spdk_poller *p1, const struct spdk_poller *p2)
+{
+	if (p1->next_run_tick != p2->next_run_tick) {
+		return p1->next_run_tick < p2->next_run_tick;
+	}
+
+	return p1->timer_seq < p2->timer_seq;
+}
+
+static inline void
+timed_poller_set(struct spdk_thread *thread, uint32_t index, struct spdk_poller *poller)
+{
+	thread->timed_pollers[index] = poller;
+	poller->timer_index = index;
+}
+
 static void
-poller_insert_timer(struct spdk_thread *thread, struct spdk_poller *poller, uint64_t now)
+timed_poller_sift_up(struct spdk_thread *thread, struct spdk_poller *poller)
 {
-	struct spdk_poller *iter;
+	uint32_t index = poller->timer_index;
+	struct spdk_poller *parent;
 
-	poller->next_run_tick = now + poller->period_ticks;
+	while (index > 0) {
+		parent = thread->timed_pollers[(index - 1) / 2];
+		if (!timed_poller_expires_before(poller, parent)) {
+			break;
+		}
+		timed_poller_set(thread, index, parent);
+		index = (index - 1) / 2;
+	}
 
-	/*
-	 * Insert poller in the thread's timed_pollers list in sorted order by next scheduled
-	 * run time.
-	 */
-	TAILQ_FOREACH_REVERSE(iter, &thread->timed_pollers, timed_pollers_head, tailq) {
-		if (iter->next_run_tick <= poller->next_run_tick) {
-			TAILQ_INSERT_AFTER(&thread->timed_pollers, iter, poller, tailq);
-			return;
+	timed_poller_set(thread, index, poller);
+}
+
+static void
+timed_poller_sift_down(struct spdk_thread *thread, struct spdk_poller *poller)
+{
+	uint32_t index = poller->timer_index;
+	uint32_t child;
+
+	while ((child = 2 * index + 1) < thread->num_timed_pollers) {
+		if (child + 1 < thread->num_timed_pollers &&
+		    timed_poller_expires_before(thread->timed_pollers[child + 1],
+						thread->timed_pollers[child])) {
+			child++;
+		}
+		if (!timed_poller_expires_before(thread->timed_pollers[child], poller)) {
+			break;
 		}
+		timed_poller_set(thread, index, thread->timed_pollers[child]);
+		index = child;
 	}
 
-	/* No earlier pollers were found, so this poller must be the new head */
-	TAILQ_INSERT_HEAD(&thread->timed_pollers, poller, tailq);
+	timed_poller_set(thread, index, poller);
+}
+
+/* Schedule the next run of a timed poller, inserting it in the heap if it isn't there */
+static void
+poller_insert_timer(struct spdk_thread *thread, struct spdk_poller *poller, uint64_t now)
+{
+	poller->next_run_tick = now + poller->period_ticks;
+	poller->timer_seq = thread->timer_seq++;
+
+	if (poller->timer_index < thread->num_timed_pollers &&
+	    thread->timed_pollers[poller->timer_index] == poller) {
+		/* It can only expire later than before */
+		timed_poller_sift_down(thread, poller);
+		return;
+	}
+
+	/* The array is grown when the poller is registered, see timed_pollers_reserve() */
+	assert(thread->num_timed_pollers < thread->max_timed_pollers);
+	timed_poller_set(thread, thread->num_timed_pollers++, poller);
+	timed_poller_sift_up(thread, poller);
+}
+
+static void
+poller_remove_timer(struct spdk_thread *thread, struct spdk_poller *poller)
+{
+	struct spdk_poller *last;
+	uint32_t index = poller->timer_index;
+
+	assert(index < thread->num_timed_pollers);
+	assert(thread->timed_pollers[index] == poller);
+
+	last = thread->timed_pollers[--thread->num_timed_pollers];
+	thread->timed_pollers[thread->num_timed_pollers] = NULL;
+	poller->timer_index = UINT32_MAX;
+	if (last == poller) {
+		return;
+	}
+
+	timed_poller_set(thread, index, last);
+	if (index > 0 && timed_poller_expires_before(last, thread->timed_pollers[(index - 1) / 2])) {
+		timed_poller_sift_up(thread, last);
+	} else {
+		timed_poller_sift_down(thread, last);
+	}
+}
+
+static inline struct spdk_poller *
+thread_first_timed_poller(struct spdk_thread *thread)
+{
+	return thread->num_timed_pollers > 0 ? thread->timed_pollers[0] : NULL;
+}
+
+/*
+ * Make room in the timed_pollers heap for one more registered timed poller.
+ * One extra slot is kept for a poller unregistered from within itself, which
+ * stays in the heap until it returns.
+ */
+static int
+timed_pollers_reserve(struct spdk_thread *thread)
+{
+	struct spdk_poller **timed_pollers;
+	uint32_t max_timed_pollers;
+
+	if (thread->num_registered_timed_pollers + 2 <= thread->max_timed_pollers) {
+		return 0;
+	}
+
+	max_timed_pollers = spdk_max(thread->max_timed_pollers * 2,
+				     thread->num_registered_timed_pollers + 2);
+	timed_pollers = realloc(thread->timed_pollers, max_timed_pollers * sizeof(*timed_pollers));
+	if (timed_pollers == NULL) {
+		return -ENOMEM;
+	}
+
+	thread->timed_pollers = timed_pollers;
+	thread->max_timed_pollers = max_timed_pollers;
+
+	return 0;
 }
 
 static void
@@ -674,20 +854,16 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 		}
 	}
 
-	TAILQ_FOREACH_SAFE(poller, &thread->timed_pollers, tailq, tmp) {
+	/*
+	 * Timed pollers are removed from the heap as soon as they are paused or
+	 * unregistered, unless they are running, so the first one is always
+	 * waiting. A poller that runs is due next at least a tick after now, so
+	 * each of them runs at most once here.
+	 */
+	while ((poller = thread_first_timed_poller(thread)) != NULL) {
 		int timer_rc = 0;
 
-		if (poller->state == SPDK_POLLER_STATE_UNREGISTERED) {
-			TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
-			free(poller);
-			continue;
-		} else if (poller->state == SPDK_POLLER_STATE_PAUSING) {
-			TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
-			TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
-			poller->state = SPDK_POLLER_STATE_PAUSED;
-			continue;
-		}
-
+		assert(poller->state == SPDK_POLLER_STATE_WAITING);
 		if (now < poller->next_run_tick) {
 			break;
 		}
@@ -707,11 +883,10 @@ thread_poll(struct spdk_thread *thread, uint32_t max_msgs, uint64_t now)
 #endif
 
 		if (poller->state == SPDK_POLLER_STATE_UNREGISTERED) {
-			TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
+			poller_remove_timer(thread, poller);
 			free(poller);
 		} else if (poller->state != SPDK_POLLER_STATE_PAUSED) {
 			poller->state = SPDK_POLLER_STATE_WAITING;
-			TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
 			poller_insert_timer(thread, poller, now);
 		}
 
@@ -760,7 +935,7 @@ spdk_thread_next_poller_expiration(struct spdk_thread *thread)
 {
 	struct spdk_poller *poller;
 
-	poller = TAILQ_FIRST(&thread->timed_pollers);
+	poller = thread_first_timed_poller(thread);
 	if (poller) {
 		return poller->next_run_tick;
 	}
@@ -778,7 +953,7 @@ static bool
 thread_has_unpaused_pollers(struct spdk_thread *thread)
 {
 	if (TAILQ_EMPTY(&thread->active_pollers) &&
-	    TAILQ_EMPTY(&thread->timed_pollers)) {
+	    thread->num_timed_pollers == 0) {
 		return false;
 	}
 
@@ -1102,6 +1277,13 @@ poller_register(spdk_poller_fn fn,
 		poller->period_ticks = 0;
 	}
 
+	poller->timer_index = UINT32_MAX;
+	if (poller->period_ticks > 0 && timed_pollers_reserve(thread) != 0) {
+		SPDK_ERRLOG("Timed poller memory allocation failed\n");
+		free(poller);
+		return NULL;
+	}
+
 	if (thread->interrupt_mode && period_microseconds != 0) {
 		int rc;
 
@@ -1115,6 +1297,9 @@ poller_register(spdk_poller_fn fn,
 		poller->timerfd = rc;
 	}
 
+	if (poller->period_ticks > 0) {
+		thread->num_registered_timed_pollers++;
+	}
 	thread_insert_poller(thread, poller);
 
 	return poller;
@@ -1168,13 +1353,24 @@ spdk_poller_unregister(struct spdk_poller **ppoller)
 		poller->timerfd = -1;
 	}
 
-	/* If the poller was paused, put it on the active_pollers list so that
-	 * its unregistration can be processed by spdk_thread_poll().
+	if (poller->period_ticks > 0) {
+		assert(thread->num_registered_timed_pollers > 0);
+		thread->num_registered_timed_pollers--;
+	}
+
+	/* If the poller was paused, or is a timed poller waiting for its next
+	 * run, put it on the active_pollers list so that its unregistration can
+	 * be processed by spdk_thread_poll(). A running timed poller is removed
+	 * from the timed_pollers heap when it returns.
 	 */
 	if (poller->state == SPDK_POLLER_STATE_PAUSED) {
 		TAILQ_REMOVE(&thread->paused_pollers, poller, tailq);
 		TAILQ_INSERT_TAIL(&thread->active_pollers, poller, tailq);
 		poller->period_ticks = 0;
+	} else if (poller->period_ticks > 0 && poller->state != SPDK_POLLER_STATE_RUNNING) {
+		poller_remove_timer(thread, poller);
+		TAILQ_INSERT_TAIL(&thread->active_pollers, poller, tailq);
+		poller->period_ticks = 0;
 	}
 
 	/* Simply set the state to unregistered. The poller will get cleaned up
@@ -1199,24 +1395,23 @@ spdk_poller_pause(struct spdk_poller *poller)
 		return;
 	}
 
-	/* If a poller is paused from within itself, we can immediately move it
-	 * on the paused_pollers list.  Otherwise we just set its state to
-	 * SPDK_POLLER_STATE_PAUSING and let spdk_thread_poll() move it.  It
-	 * allows a poller to be paused from another one's context without
+	/* If a poller is paused from within itself, or is a timed poller, we can
+	 * immediately move it on the paused_pollers list.  Otherwise we just set
+	 * its state to SPDK_POLLER_STATE_PAUSING and let spdk_thread_poll() move
+	 * it.  It allows a poller to be paused from another one's context without
 	 * breaking the TAILQ_FOREACH_REVERSE_SAFE iteration.
 	 */
-	if (poller->state != SPDK_POLLER_STATE_RUNNING) {
+	if (poller->period_ticks > 0) {
+		poller_remove_timer(thread, poller);
+	} else if (poller->state != SPDK_POLLER_STATE_RUNNING) {
 		poller->state = SPDK_POLLER_STATE_PAUSING;
+		return;
 	} else {
-		if (poller->period_ticks > 0) {
-			TAILQ_REMOVE(&thread->timed_pollers, poller, tailq);
-		} else {
-			TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
-		}
-
-		TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
-		poller->state = SPDK_POLLER_STATE_PAUSED;
+		TAILQ_REMOVE(&thread->active_pollers, poller, tailq);
 	}
+
+	TAILQ_INSERT_TAIL(&thread->paused_pollers, poller, tailq);
+	poller->state = SPDK_POLLER_STATE_PAUSED;
 }
 
 void
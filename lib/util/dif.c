@@ -90,6 +90,20 @@ _dif_sgl_get_buf(struct _dif_sgl *s, void **_buf, uint32_t *_buf_len)
 	}
 }
 
+/* Get the number of whole blocks, up to num_blocks, that are laid out contiguously
+ * from the current position of the SGL, and the buffer they start at.
+ */
+static inline uint32_t
+_dif_sgl_get_blocks(struct _dif_sgl *s, uint32_t block_size, uint32_t num_blocks,
+		    void **_buf)
+{
+	uint32_t buf_len;
+
+	_dif_sgl_get_buf(s, _buf, &buf_len);
+
+	return spdk_min(buf_len / block_size, num_blocks);
+}
+
 static inline bool
 _dif_sgl_append(struct _dif_sgl *s, uint8_t *data, uint32_t data_len)
 {
@@ -324,24 +338,39 @@ _dif_generate(void *_dif, uint16_t guard, uint32_t offset_blocks,
 	}
 }
 
+/* Generate DIF for a run of contiguous blocks without walking the SGL per block. */
 static void
-dif_generate(struct _dif_sgl *sgl, uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
+_dif_generate_blocks(uint8_t *buf, uint32_t num_blocks, uint32_t offset_blocks,
+		     const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks = 0;
-	void *buf;
+	uint32_t i;
 	uint16_t guard = 0;
 
-	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(sgl, &buf, NULL);
-
+	for (i = 0; i < num_blocks; i++) {
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
 			guard = spdk_crc16_t10dif(ctx->guard_seed, buf, ctx->guard_interval);
 		}
 
-		_dif_generate(buf + ctx->guard_interval, guard, offset_blocks, ctx);
+		_dif_generate(buf + ctx->guard_interval, guard, offset_blocks + i, ctx);
 
-		_dif_sgl_advance(sgl, ctx->block_size);
-		offset_blocks++;
+		buf += ctx->block_size;
+	}
+}
+
+static void
+dif_generate(struct _dif_sgl *sgl, uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
+{
+	uint32_t offset_blocks = 0, blocks;
+	void *buf;
+
+	while (offset_blocks < num_blocks) {
+		blocks = _dif_sgl_get_blocks(sgl, ctx->block_size, num_blocks - offset_blocks, &buf);
+		assert(blocks > 0);
+
+		_dif_generate_blocks(buf, blocks, offset_blocks, ctx);
+
+		_dif_sgl_advance(sgl, blocks * ctx->block_size);
+		offset_blocks += blocks;
 	}
 }
 
@@ -411,15 +440,26 @@ static void
 dif_generate_split(struct _dif_sgl *sgl, uint32_t num_blocks,
 		   const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks;
+	uint32_t offset_blocks = 0, blocks;
 	uint16_t guard = 0;
+	void *buf;
 
 	if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
 		guard = ctx->guard_seed;
 	}
 
-	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
+	while (offset_blocks < num_blocks) {
+		/* Only the blocks crossing an iovec boundary need the split path. */
+		blocks = _dif_sgl_get_blocks(sgl, ctx->block_size, num_blocks - offset_blocks, &buf);
+		if (blocks > 0) {
+			_dif_generate_blocks(buf, blocks, offset_blocks, ctx);
+			_dif_sgl_advance(sgl, blocks * ctx->block_size);
+			offset_blocks += blocks;
+			continue;
+		}
+
 		_dif_generate_split(sgl, 0, ctx->block_size, guard, offset_blocks, ctx);
+		offset_blocks++;
 	}
 }
 
@@ -564,29 +604,50 @@ _dif_verify(void *_dif, uint16_t guard, uint32_t offset_blocks,
 	return 0;
 }
 
+/* Verify DIF of a run of contiguous blocks without walking the SGL per block. */
+static int
+_dif_verify_blocks(uint8_t *buf, uint32_t num_blocks, uint32_t offset_blocks,
+		   const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err_blk)
+{
+	uint32_t i;
+	uint16_t guard = 0;
+	int rc;
+
+	for (i = 0; i < num_blocks; i++) {
+		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
+			guard = spdk_crc16_t10dif(ctx->guard_seed, buf, ctx->guard_interval);
+		}
+
+		rc = _dif_verify(buf + ctx->guard_interval, guard, offset_blocks + i, ctx, err_blk);
+		if (rc != 0) {
+			return rc;
+		}
+
+		buf += ctx->block_size;
+	}
+
+	return 0;
+}
+
 static int
 dif_verify(struct _dif_sgl *sgl, uint32_t num_blocks,
 	   const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks = 0;
+	uint32_t offset_blocks = 0, blocks;
 	int rc;
 	void *buf;
-	uint16_t guard = 0;
 
 	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(sgl, &buf, NULL);
+		blocks = _dif_sgl_get_blocks(sgl, ctx->block_size, num_blocks - offset_blocks, &buf);
+		assert(blocks > 0);
 
-		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
-			guard = spdk_crc16_t10dif(ctx->guard_seed, buf, ctx->guard_interval);
-		}
-
-		rc = _dif_verify(buf + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
+		rc = _dif_verify_blocks(buf, blocks, offset_blocks, ctx, err_blk);
 		if (rc != 0) {
 			return rc;
 		}
 
-		_dif_sgl_advance(sgl, ctx->block_size);
-		offset_blocks++;
+		_dif_sgl_advance(sgl, blocks * ctx->block_size);
+		offset_blocks += blocks;
 	}
 
 	return 0;
@@ -664,20 +725,34 @@ static int
 dif_verify_split(struct _dif_sgl *sgl, uint32_t num_blocks,
 		 const struct spdk_dif_ctx *ctx, struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks;
+	uint32_t offset_blocks = 0, blocks;
 	uint16_t guard = 0;
+	void *buf;
 	int rc;
 
 	if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
 		guard = ctx->guard_seed;
 	}
 
-	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
+	while (offset_blocks < num_blocks) {
+		/* Only the blocks crossing an iovec boundary need the split path. */
+		blocks = _dif_sgl_get_blocks(sgl, ctx->block_size, num_blocks - offset_blocks, &buf);
+		if (blocks > 0) {
+			rc = _dif_verify_blocks(buf, blocks, offset_blocks, ctx, err_blk);
+			if (rc != 0) {
+				return rc;
+			}
+			_dif_sgl_advance(sgl, blocks * ctx->block_size);
+			offset_blocks += blocks;
+			continue;
+		}
+
 		rc = _dif_verify_split(sgl, 0, ctx->block_size, &guard, offset_blocks,
 				       ctx, err_blk);
 		if (rc != 0) {
 			return rc;
 		}
+		offset_blocks++;
 	}
 
 	return 0;
@@ -792,20 +867,19 @@ spdk_dif_update_crc32c(struct iovec *iovs, int iovcnt, uint32_t num_blocks,
 	return 0;
 }
 
+/* Copy a run of contiguous data blocks into contiguous extended blocks, generating
+ * DIF in the same pass over the data.
+ */
 static void
-dif_generate_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
-		  uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
+_dif_generate_copy_blocks(uint8_t *dst, uint8_t *src, uint32_t num_blocks,
+			  uint32_t offset_blocks, const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks = 0, data_block_size;
-	void *src, *dst;
+	uint32_t i, data_block_size;
 	uint16_t guard;
 
 	data_block_size = ctx->block_size - ctx->md_size;
 
-	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(src_sgl, &src, NULL);
-		_dif_sgl_get_buf(dst_sgl, &dst, NULL);
-
+	for (i = 0; i < num_blocks; i++) {
 		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
 			guard = spdk_crc16_t10dif_copy(ctx->guard_seed, dst, src, data_block_size);
@@ -815,11 +889,46 @@ dif_generate_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 			memcpy(dst, src, data_block_size);
 		}
 
-		_dif_generate(dst + ctx->guard_interval, guard, offset_blocks, ctx);
+		_dif_generate(dst + ctx->guard_interval, guard, offset_blocks + i, ctx);
 
-		_dif_sgl_advance(src_sgl, data_block_size);
-		_dif_sgl_advance(dst_sgl, ctx->block_size);
-		offset_blocks++;
+		src += data_block_size;
+		dst += ctx->block_size;
+	}
+}
+
+/* Get the number of whole blocks, up to num_blocks, that are contiguous in both the
+ * data and the extended block SGL.
+ */
+static uint32_t
+_dif_sgl_get_copy_blocks(struct _dif_sgl *data_sgl, struct _dif_sgl *ext_sgl,
+			 uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+			 void **data_buf, void **ext_buf)
+{
+	uint32_t blocks;
+
+	blocks = _dif_sgl_get_blocks(data_sgl, ctx->block_size - ctx->md_size, num_blocks,
+				     data_buf);
+
+	return _dif_sgl_get_blocks(ext_sgl, ctx->block_size, blocks, ext_buf);
+}
+
+static void
+dif_generate_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
+		  uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
+{
+	uint32_t offset_blocks = 0, blocks;
+	void *src, *dst;
+
+	while (offset_blocks < num_blocks) {
+		blocks = _dif_sgl_get_copy_blocks(src_sgl, dst_sgl, num_blocks - offset_blocks,
+						  ctx, &src, &dst);
+		assert(blocks > 0);
+
+		_dif_generate_copy_blocks(dst, src, blocks, offset_blocks, ctx);
+
+		_dif_sgl_advance(src_sgl, blocks * (ctx->block_size - ctx->md_size));
+		_dif_sgl_advance(dst_sgl, blocks * ctx->block_size);
+		offset_blocks += blocks;
 	}
 }
 
@@ -872,10 +981,23 @@ static void
 dif_generate_copy_split(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 			uint32_t num_blocks, const struct spdk_dif_ctx *ctx)
 {
-	uint32_t offset_blocks;
+	uint32_t offset_blocks = 0, blocks;
+	void *src, *dst;
+
+	while (offset_blocks < num_blocks) {
+		/* Only the blocks crossing an iovec boundary need the split path. */
+		blocks = _dif_sgl_get_copy_blocks(src_sgl, dst_sgl, num_blocks - offset_blocks,
+						  ctx, &src, &dst);
+		if (blocks > 0) {
+			_dif_generate_copy_blocks(dst, src, blocks, offset_blocks, ctx);
+			_dif_sgl_advance(src_sgl, blocks * (ctx->block_size - ctx->md_size));
+			_dif_sgl_advance(dst_sgl, blocks * ctx->block_size);
+			offset_blocks += blocks;
+			continue;
+		}
 
-	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
 		_dif_generate_copy_split(src_sgl, dst_sgl, offset_blocks, ctx);
+		offset_blocks++;
 	}
 }
 
@@ -910,22 +1032,21 @@ spdk_dif_generate_copy(struct iovec *iovs, int iovcnt, struct iovec *bounce_iov,
 	return 0;
 }
 
+/* Copy a run of contiguous extended blocks into contiguous data blocks, verifying
+ * DIF in the same pass over the data.
+ */
 static int
-dif_verify_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
-		uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
-		struct spdk_dif_error *err_blk)
+_dif_verify_copy_blocks(uint8_t *dst, uint8_t *src, uint32_t num_blocks,
+			uint32_t offset_blocks, const struct spdk_dif_ctx *ctx,
+			struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks = 0, data_block_size;
-	void *src, *dst;
-	int rc;
+	uint32_t i, data_block_size;
 	uint16_t guard;
+	int rc;
 
 	data_block_size = ctx->block_size - ctx->md_size;
 
-	while (offset_blocks < num_blocks) {
-		_dif_sgl_get_buf(src_sgl, &src, NULL);
-		_dif_sgl_get_buf(dst_sgl, &dst, NULL);
-
+	for (i = 0; i < num_blocks; i++) {
 		guard = 0;
 		if (ctx->dif_flags & SPDK_DIF_FLAGS_GUARD_CHECK) {
 			guard = spdk_crc16_t10dif_copy(ctx->guard_seed, dst, src, data_block_size);
@@ -935,14 +1056,40 @@ dif_verify_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 			memcpy(dst, src, data_block_size);
 		}
 
-		rc = _dif_verify(src + ctx->guard_interval, guard, offset_blocks, ctx, err_blk);
+		rc = _dif_verify(src + ctx->guard_interval, guard, offset_blocks + i, ctx, err_blk);
 		if (rc != 0) {
 			return rc;
 		}
 
-		_dif_sgl_advance(src_sgl, ctx->block_size);
-		_dif_sgl_advance(dst_sgl, data_block_size);
-		offset_blocks++;
+		src += ctx->block_size;
+		dst += data_block_size;
+	}
+
+	return 0;
+}
+
+static int
+dif_verify_copy(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
+		uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
+		struct spdk_dif_error *err_blk)
+{
+	uint32_t offset_blocks = 0, blocks;
+	void *src, *dst;
+	int rc;
+
+	while (offset_blocks < num_blocks) {
+		blocks = _dif_sgl_get_copy_blocks(dst_sgl, src_sgl, num_blocks - offset_blocks,
+						  ctx, &dst, &src);
+		assert(blocks > 0);
+
+		rc = _dif_verify_copy_blocks(dst, src, blocks, offset_blocks, ctx, err_blk);
+		if (rc != 0) {
+			return rc;
+		}
+
+		_dif_sgl_advance(src_sgl, blocks * ctx->block_size);
+		_dif_sgl_advance(dst_sgl, blocks * (ctx->block_size - ctx->md_size));
+		offset_blocks += blocks;
 	}
 
 	return 0;
@@ -999,14 +1146,30 @@ dif_verify_copy_split(struct _dif_sgl *src_sgl, struct _dif_sgl *dst_sgl,
 		      uint32_t num_blocks, const struct spdk_dif_ctx *ctx,
 		      struct spdk_dif_error *err_blk)
 {
-	uint32_t offset_blocks;
+	uint32_t offset_blocks = 0, blocks;
+	void *src, *dst;
 	int rc;
 
-	for (offset_blocks = 0; offset_blocks < num_blocks; offset_blocks++) {
+	while (offset_blocks < num_blocks) {
+		/* Only the blocks crossing an iovec boundary need the split path. */
+		blocks = _dif_sgl_get_copy_blocks(dst_sgl, src_sgl, num_blocks - offset_blocks,
+						  ctx, &dst, &src);
+		if (blocks > 0) {
+			rc = _dif_verify_copy_blocks(dst, src, blocks, offset_blocks, ctx, err_blk);
+			if (rc != 0) {
+				return rc;
+			}
+			_dif_sgl_advance(src_sgl, blocks * ctx->block_size);
+			_dif_sgl_advance(dst_sgl, blocks * (ctx->block_size - ctx->md_size));
+			offset_blocks += blocks;
+			continue;
+		}
+
 		rc = _dif_verify_copy_split(src_sgl, dst_sgl, offset_blocks, ctx, err_blk);
 		if (rc != 0) {
 			return rc;
 		}
+		offset_blocks++;
 	}
 
 	return 0;
@@ -1576,9 +1739,10 @@ spdk_dif_generate_stream(struct iovec *iovs, int iovcnt,
 			 struct spdk_dif_ctx *ctx)
 {
 	uint32_t buf_len = 0, buf_offset = 0;
-	uint32_t len, offset_in_block, offset_blocks;
+	uint32_t len, offset_in_block, offset_blocks, blocks;
 	uint16_t guard = 0;
 	struct _dif_sgl sgl;
+	void *buf;
 	int rc;
 
 	if (iovs == NULL || iovcnt == 0) {
@@ -1601,6 +1765,18 @@ spdk_dif_generate_stream(struct iovec *iovs, int iovcnt,
 		offset_in_block = buf_offset % ctx->block_size;
 		offset_blocks = buf_offset / ctx->block_size;
 
+		if (offset_in_block == 0) {
+			blocks = _dif_sgl_get_blocks(&sgl, ctx->block_size,
+						     buf_len / ctx->block_size, &buf);
+			if (blocks > 0) {
+				_dif_generate_blocks(buf, blocks, offset_blocks, ctx);
+				_dif_sgl_advance(&sgl, blocks * ctx->block_size);
+				buf_len -= blocks * ctx->block_size;
+				buf_offset += blocks * ctx->block_size;
+				continue;
+			}
+		}
+
 		guard = _dif_generate_split(&sgl, offset_in_block, len, guard, offset_blocks, ctx);
 
 		buf_len -= len;
@@ -1621,9 +1797,10 @@ spdk_dif_verify_stream(struct iovec *iovs, int iovcnt,
 		       struct spdk_dif_error *err_blk)
 {
 	uint32_t buf_len = 0, buf_offset = 0;
-	uint32_t len, offset_in_block, offset_blocks;
+	uint32_t len, offset_in_block, offset_blocks, blocks;
 	uint16_t guard = 0;
 	struct _dif_sgl sgl;
+	void *buf;
 	int rc = 0;
 
 	if (iovs == NULL || iovcnt == 0) {
@@ -1646,6 +1823,21 @@ spdk_dif_verify_stream(struct iovec *iovs, int iovcnt,
 		offset_in_block = buf_offset % ctx->block_size;
 		offset_blocks = buf_offset / ctx->block_size;
 
+		if (offset_in_block == 0) {
+			blocks = _dif_sgl_get_blocks(&sgl, ctx->block_size,
+						     buf_len / ctx->block_size, &buf);
+			if (blocks > 0) {
+				rc = _dif_verify_blocks(buf, blocks, offset_blocks, ctx, err_blk);
+				if (rc != 0) {
+					goto error;
+				}
+				_dif_sgl_advance(&sgl, blocks * ctx->block_size);
+				buf_len -= blocks * ctx->block_size;
+				buf_offset += blocks * ctx->block_size;
+				continue;
+			}
+		}
+
 		rc = _dif_verify_split(&sgl, offset_in_block, len, &guard, offset_blocks,
 				       ctx, err_blk);
 		if (rc != 0) {
@@ -0,0 +1,471 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/xor.h"
+#include "spdk/config.h"
+#include "spdk/util.h"
+
+#ifdef SPDK_CONFIG_ISAL
+#define SPDK_HAVE_ISAL
+#include <isa-l/include/raid.h>
+#endif
+
+#if defined(__x86_64__) && defined(__AVX512F__) && defined(__AVX512BW__)
+#define SPDK_XOR_AVX512
+#include <x86intrin.h>
+#elif defined(__x86_64__) && defined(__AVX2__)
+#define SPDK_XOR_AVX2
+#include <x86intrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define SPDK_XOR_NEON
+#include <arm_neon.h>
+#endif
+
+/* Alignment and length granularity required by the isa-l raid functions */
+#define XOR_ISAL_ALIGN	32
+
+/*
+ * Each kernel works on vectors of XOR_VEC_SIZE bytes. The Q syndrome needs a
+ * multiplication by 2 in GF(2^8), which is a left shift of every byte followed
+ * by a reduction with 0x1d of the bytes that had their top bit set.
+ */
+#if defined(SPDK_XOR_AVX512)
+
+typedef __m512i xor_vec_t;
+#define XOR_VEC_SIZE		64
+#define xor_vec_load(p)		_mm512_loadu_si512((const void *)(p))
+#define xor_vec_store(p, v)	_mm512_storeu_si512((void *)(p), (v))
+#define xor_vec_xor(a, b)	_mm512_xor_si512((a), (b))
+
+static inline xor_vec_t
+xor_vec_mul2(xor_vec_t v)
+{
+	return _mm512_xor_si512(_mm512_add_epi8(v, v),
+				_mm512_maskz_mov_epi8(_mm512_movepi8_mask(v), _mm512_set1_epi8(0x1d)));
+}
+
+#elif defined(SPDK_XOR_AVX2)
+
+typedef __m256i xor_vec_t;
+#define XOR_VEC_SIZE		32
+#define xor_vec_load(p)		_mm256_loadu_si256((const __m256i *)(p))
+#define xor_vec_store(p, v)	_mm256_storeu_si256((__m256i *)(p), (v))
+#define xor_vec_xor(a, b)	_mm256_xor_si256((a), (b))
+
+static inline xor_vec_t
+xor_vec_mul2(xor_vec_t v)
+{
+	__m256i mask = _mm256_cmpgt_epi8(_mm256_setzero_si256(), v);
+
+	return _mm256_xor_si256(_mm256_add_epi8(v, v),
+				_mm256_and_si256(mask, _mm256_set1_epi8(0x1d)));
+}
+
+#elif defined(SPDK_XOR_NEON)
+
+typedef uint8x16_t xor_vec_t;
+#define XOR_VEC_SIZE		16
+#define xor_vec_load(p)		vld1q_u8((const uint8_t *)(p))
+#define xor_vec_store(p, v)	vst1q_u8((uint8_t *)(p), (v))
+#define xor_vec_xor(a, b)	veorq_u8((a), (b))
+
+static inline xor_vec_t
+xor_vec_mul2(xor_vec_t v)
+{
+	uint8x16_t mask = vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(v), 7));
+
+	return veorq_u8(vshlq_n_u8(v, 1), vandq_u8(mask, vdupq_n_u8(0x1d)));
+}
+
+#else /* No SIMD instructions available, use 64-bit words */
+
+typedef uint64_t xor_vec_t;
+#define XOR_VEC_SIZE		8
+
+static inline xor_vec_t
+xor_vec_load(const void *p)
+{
+	uint64_t v;
+
+	/* Use memcpy() to avoid unaligned loads, which are undefined behavior in C. */
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline void
+xor_vec_store(void *p, xor_vec_t v)
+{
+	memcpy(p, &v, sizeof(v));
+}
+
+#define xor_vec_xor(a, b)	((a) ^ (b))
+
+static inline xor_vec_t
+xor_vec_mul2(xor_vec_t v)
+{
+	uint64_t mask = (v & 0x8080808080808080ULL) >> 7;
+
+	return ((v << 1) & 0xfefefefefefefefeULL) ^ (mask * 0x1d);
+}
+
+#endif
+
+static inline uint8_t
+xor_byte_mul2(uint8_t v)
+{
+	return (uint8_t)(v << 1) ^ ((v & 0x80) ? 0x1d : 0);
+}
+
+static void
+xor_gen_basic(void *dest, void **sources, uint32_t n, size_t len)
+{
+	size_t off = 0;
+	uint32_t i;
+
+	/* Process 4 vectors at a time to keep several loads in flight per source. */
+	for (; off + 4 * XOR_VEC_SIZE <= len; off += 4 * XOR_VEC_SIZE) {
+		const uint8_t *s = (const uint8_t *)sources[0] + off;
+		xor_vec_t v0 = xor_vec_load(s);
+		xor_vec_t v1 = xor_vec_load(s + XOR_VEC_SIZE);
+		xor_vec_t v2 = xor_vec_load(s + 2 * XOR_VEC_SIZE);
+		xor_vec_t v3 = xor_vec_load(s + 3 * XOR_VEC_SIZE);
+		uint8_t *d = (uint8_t *)dest + off;
+
+		for (i = 1; i < n; i++) {
+			s = (const uint8_t *)sources[i] + off;
+			v0 = xor_vec_xor(v0, xor_vec_load(s));
+			v1 = xor_vec_xor(v1, xor_vec_load(s + XOR_VEC_SIZE));
+			v2 = xor_vec_xor(v2, xor_vec_load(s + 2 * XOR_VEC_SIZE));
+			v3 = xor_vec_xor(v3, xor_vec_load(s + 3 * XOR_VEC_SIZE));
+		}
+
+		xor_vec_store(d, v0);
+		xor_vec_store(d + XOR_VEC_SIZE, v1);
+		xor_vec_store(d + 2 * XOR_VEC_SIZE, v2);
+		xor_vec_store(d + 3 * XOR_VEC_SIZE, v3);
+	}
+
+	for (; off + XOR_VEC_SIZE <= len; off += XOR_VEC_SIZE) {
+		xor_vec_t v = xor_vec_load((const uint8_t *)sources[0] + off);
+
+		for (i = 1; i < n; i++) {
+			v = xor_vec_xor(v, xor_vec_load((const uint8_t *)sources[i] + off));
+		}
+		xor_vec_store((uint8_t *)dest + off, v);
+	}
+
+	for (; off < len; off++) {
+		uint8_t b = ((const uint8_t *)sources[0])[off];
+
+		for (i = 1; i < n; i++) {
+			b ^= ((const uint8_t *)sources[i])[off];
+		}
+		((uint8_t *)dest)[off] = b;
+	}
+}
+
+static void
+xor_gen_pq_basic(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	size_t off = 0;
+	uint32_t i;
+
+	/*
+	 * Q is evaluated with Horner's method, starting from the source with the
+	 * highest coefficient: q = ((s[n-1] * 2 + s[n-2]) * 2 + ...) * 2 + s[0]
+	 */
+	for (; off + 2 * XOR_VEC_SIZE <= len; off += 2 * XOR_VEC_SIZE) {
+		const uint8_t *s = (const uint8_t *)sources[n - 1] + off;
+		xor_vec_t p0 = xor_vec_load(s);
+		xor_vec_t p1 = xor_vec_load(s + XOR_VEC_SIZE);
+		xor_vec_t q0 = p0, q1 = p1;
+
+		for (i = n - 1; i > 0; i--) {
+			xor_vec_t d0, d1;
+
+			s = (const uint8_t *)sources[i - 1] + off;
+			d0 = xor_vec_load(s);
+			d1 = xor_vec_load(s + XOR_VEC_SIZE);
+			p0 = xor_vec_xor(p0, d0);
+			p1 = xor_vec_xor(p1, d1);
+			q0 = xor_vec_xor(xor_vec_mul2(q0), d0);
+			q1 = xor_vec_xor(xor_vec_mul2(q1), d1);
+		}
+
+		xor_vec_store((uint8_t *)p + off, p0);
+		xor_vec_store((uint8_t *)p + off + XOR_VEC_SIZE, p1);
+		xor_vec_store((uint8_t *)q + off, q0);
+		xor_vec_store((uint8_t *)q + off + XOR_VEC_SIZE, q1);
+	}
+
+	for (; off + XOR_VEC_SIZE <= len; off += XOR_VEC_SIZE) {
+		xor_vec_t pv = xor_vec_load((const uint8_t *)sources[n - 1] + off);
+		xor_vec_t qv = pv;
+
+		for (i = n - 1; i > 0; i--) {
+			xor_vec_t d = xor_vec_load((const uint8_t *)sources[i - 1] + off);
+
+			pv = xor_vec_xor(pv, d);
+			qv = xor_vec_xor(xor_vec_mul2(qv), d);
+		}
+		xor_vec_store((uint8_t *)p + off, pv);
+		xor_vec_store((uint8_t *)q + off, qv);
+	}
+
+	for (; off < len; off++) {
+		uint8_t pb = ((const uint8_t *)sources[n - 1])[off];
+		uint8_t qb = pb;
+
+		for (i = n - 1; i > 0; i--) {
+			uint8_t d = ((const uint8_t *)sources[i - 1])[off];
+
+			pb ^= d;
+			qb = xor_byte_mul2(qb) ^ d;
+		}
+		((uint8_t *)p)[off] = pb;
+		((uint8_t *)q)[off] = qb;
+	}
+}
+
+#ifdef SPDK_HAVE_ISAL
+
+static bool
+xor_isal_usable(void **bufs, uint32_t nbufs, size_t len)
+{
+	uint32_t i;
+
+	if (len % XOR_ISAL_ALIGN != 0 || len > INT_MAX) {
+		return false;
+	}
+
+	for (i = 0; i < nbufs; i++) {
+		if ((uintptr_t)bufs[i] % XOR_ISAL_ALIGN != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void
+xor_gen_buf(void *dest, void **sources, uint32_t n, size_t len)
+{
+	void *bufs[SPDK_XOR_MAX_SOURCES + 1];
+
+	if (n >= 2 && n <= SPDK_XOR_MAX_SOURCES) {
+		/* isa-l expects the destination as the last element of the array. */
+		memcpy(bufs, sources, n * sizeof(void *));
+		bufs[n] = dest;
+		if (xor_isal_usable(bufs, n + 1, len) && xor_gen(n + 1, (int)len, bufs) == 0) {
+			return;
+		}
+	}
+
+	xor_gen_basic(dest, sources, n, len);
+}
+
+static void
+xor_gen_pq_buf(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	void *bufs[SPDK_XOR_MAX_SOURCES + 2];
+
+	if (n >= 2) {
+		/* isa-l expects P and Q as the last two elements of the array. */
+		memcpy(bufs, sources, n * sizeof(void *));
+		bufs[n] = p;
+		bufs[n + 1] = q;
+		if (xor_isal_usable(bufs, n + 2, len) && pq_gen(n + 2, (int)len, bufs) == 0) {
+			return;
+		}
+	}
+
+	xor_gen_pq_basic(p, q, sources, n, len);
+}
+
+#else
+
+#define xor_gen_buf xor_gen_basic
+#define xor_gen_pq_buf xor_gen_pq_basic
+
+#endif
+
+size_t
+spdk_xor_get_optimal_alignment(void)
+{
+#ifdef SPDK_HAVE_ISAL
+	return spdk_max(XOR_VEC_SIZE, XOR_ISAL_ALIGN);
+#else
+	return XOR_VEC_SIZE;
+#endif
+}
+
+int
+spdk_xor_gen(void *dest, void **sources, uint32_t n, size_t len)
+{
+	if (n == 0) {
+		return -EINVAL;
+	}
+
+	xor_gen_buf(dest, sources, n, len);
+	return 0;
+}
+
+int
+spdk_xor_gen_pq(void *p, void *q, void **sources, uint32_t n, size_t len)
+{
+	if (n == 0 || n > SPDK_XOR_MAX_SOURCES) {
+		return -EINVAL;
+	}
+
+	xor_gen_pq_buf(p, q, sources, n, len);
+	return 0;
+}
+
+struct xor_iov_iter {
+	struct iovec	*iovs;
+	int		iovcnt;
+	int		idx;
+	size_t		off;
+};
+
+static inline void
+xor_iov_iter_init(struct xor_iov_iter *iter, struct iovec *iovs, int iovcnt)
+{
+	iter->iovs = iovs;
+	iter->iovcnt = iovcnt;
+	iter->idx = 0;
+	iter->off = 0;
+}
+
+/* Return the current position and the number of bytes left in the current iovec. */
+static inline void *
+xor_iov_iter_get(struct xor_iov_iter *iter, size_t *len)
+{
+	while (iter->idx < iter->iovcnt) {
+		if (iter->off < iter->iovs[iter->idx].iov_len) {
+			*len = iter->iovs[iter->idx].iov_len - iter->off;
+			return (uint8_t *)iter->iovs[iter->idx].iov_base + iter->off;
+		}
+		iter->idx++;
+		iter->off = 0;
+	}
+
+	return NULL;
+}
+
+static inline void
+xor_iov_iter_advance(struct xor_iov_iter *iter, size_t len)
+{
+	iter->off += len;
+}
+
+/*
+ * Walk the destination and source iovecs in lockstep and run the buffer
+ * kernel on every range that is contiguous in all of them.
+ */
+static int
+xor_gen_iov(struct iovec **dest_iovs, int *dest_iovcnts, uint32_t num_dests,
+	    struct iovec **src_iovs, int *src_iovcnts, uint32_t n, size_t len)
+{
+	struct xor_iov_iter src_iters[SPDK_XOR_MAX_SOURCES];
+	struct xor_iov_iter dest_iters[2];
+	void *sources[SPDK_XOR_MAX_SOURCES];
+	void *dests[2];
+	size_t seg_len, iov_len;
+	uint32_t i;
+
+	if (n == 0 || n > SPDK_XOR_MAX_SOURCES) {
+		return -EINVAL;
+	}
+
+	assert(num_dests == 1 || num_dests == 2);
+
+	for (i = 0; i < num_dests; i++) {
+		xor_iov_iter_init(&dest_iters[i], dest_iovs[i], dest_iovcnts[i]);
+	}
+	for (i = 0; i < n; i++) {
+		xor_iov_iter_init(&src_iters[i], src_iovs[i], src_iovcnts[i]);
+	}
+
+	while (len > 0) {
+		seg_len = len;
+
+		for (i = 0; i < num_dests; i++) {
+			dests[i] = xor_iov_iter_get(&dest_iters[i], &iov_len);
+			if (dests[i] == NULL) {
+				return -EINVAL;
+			}
+			seg_len = spdk_min(seg_len, iov_len);
+		}
+		for (i = 0; i < n; i++) {
+			sources[i] = xor_iov_iter_get(&src_iters[i], &iov_len);
+			if (sources[i] == NULL) {
+				return -EINVAL;
+			}
+			seg_len = spdk_min(seg_len, iov_len);
+		}
+
+		if (num_dests == 1) {
+			xor_gen_buf(dests[0], sources, n, seg_len);
+		} else {
+			xor_gen_pq_buf(dests[0], dests[1], sources, n, seg_len);
+		}
+
+		for (i = 0; i < num_dests; i++) {
+			xor_iov_iter_advance(&dest_iters[i], seg_len);
+		}
+		for (i = 0; i < n; i++) {
+			xor_iov_iter_advance(&src_iters[i], seg_len);
+		}
+		len -= seg_len;
+	}
+
+	return 0;
+}
+
+int
+spdk_xor_gen_iov(struct iovec *dest_iovs, int dest_iovcnt,
+		 struct iovec **src_iovs, int *src_iovcnts, uint32_t n, size_t len)
+{
+	return xor_gen_iov(&dest_iovs, &dest_iovcnt, 1, src_iovs, src_iovcnts, n, len);
+}
+
+int
+spdk_xor_gen_pq_iov(struct iovec *p_iovs, int p_iovcnt, struct iovec *q_iovs, int q_iovcnt,
+		    struct iovec **src_iovs, int *src_iovcnts, uint32_t n, size_t len)
+{
+	struct iovec *dest_iovs[2] = { p_iovs, q_iovs };
+	int dest_iovcnts[2] = { p_iovcnt, q_iovcnt };
+
+	return xor_gen_iov(dest_iovs, dest_iovcnts, 2, src_iovs, src_iovcnts, n, len);
+}
@@ -51,9 +51,17 @@
 #include <sys/eventfd.h>
 #include <libaio.h>
 
+#define SPDK_AIO_QUEUE_DEPTH 128
+#define MAX_EVENTS_PER_POLL 32
+
 struct bdev_aio_io_channel {
 	uint64_t				io_inflight;
 	io_context_t				io_ctx;
+	/* iocbs prepared by the submit path and not yet passed to io_submit().
+	 * They are flushed in a single io_submit() call from the group poller.
+	 */
+	uint32_t				num_pending;
+	struct iocb				*pending[SPDK_AIO_QUEUE_DEPTH];
 	struct bdev_aio_group_channel		*group_ch;
 	TAILQ_ENTRY(bdev_aio_io_channel)	link;
 };
@@ -105,9 +113,6 @@ static void bdev_aio_fini(void);
 static void aio_free_disk(struct file_disk *fdisk);
 static TAILQ_HEAD(, file_disk) g_aio_disk_head = TAILQ_HEAD_INITIALIZER(g_aio_disk_head);
 
-#define SPDK_AIO_QUEUE_DEPTH 128
-#define MAX_EVENTS_PER_POLL 32
-
 static int
 bdev_aio_get_ctx_size(void)
 {
@@ -166,6 +171,67 @@ bdev_aio_close(struct file_disk *disk)
 	return 0;
 }
 
+static void
+bdev_aio_flush_iocbs(struct bdev_aio_io_channel *aio_ch)
+{
+	struct iocb *iocbs[SPDK_AIO_QUEUE_DEPTH];
+	struct bdev_aio_task *aio_task;
+	uint32_t num_iocbs, submitted = 0;
+	int rc;
+
+	/* Completing a failed bdev_io may submit new I/O on this channel,
+	 * so take the batch off the channel before submitting it.
+	 */
+	num_iocbs = aio_ch->num_pending;
+	memcpy(iocbs, aio_ch->pending, num_iocbs * sizeof(iocbs[0]));
+	aio_ch->num_pending = 0;
+
+	while (submitted < num_iocbs) {
+		rc = io_submit(aio_ch->io_ctx, num_iocbs - submitted, &iocbs[submitted]);
+		if (spdk_likely(rc > 0)) {
+			submitted += rc;
+			continue;
+		}
+
+		if (rc == -EAGAIN || rc == 0) {
+			/* The kernel queue is full. Fail the remaining iocbs with NOMEM
+			 * so that the bdev layer retries them once I/O completes.
+			 */
+			while (submitted < num_iocbs) {
+				aio_task = iocbs[submitted++]->data;
+				aio_ch->io_inflight--;
+				spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task),
+						      SPDK_BDEV_IO_STATUS_NOMEM);
+			}
+			break;
+		}
+
+		/* io_submit() reports an error only for the first iocb of the batch. */
+		aio_task = iocbs[submitted++]->data;
+		aio_ch->io_inflight--;
+		spdk_bdev_io_complete_aio_status(spdk_bdev_io_from_ctx(aio_task), rc);
+		SPDK_ERRLOG("%s: io_submit returned %d\n", __func__, rc);
+	}
+}
+
+static void
+bdev_aio_queue_iocb(struct bdev_aio_io_channel *aio_ch, struct iocb *iocb)
+{
+	aio_ch->io_inflight++;
+
+	/* In interrupt mode there is no poller to flush the batch, so submit right away. */
+	if (aio_ch->group_ch->efd >= 0) {
+		aio_ch->pending[aio_ch->num_pending++] = iocb;
+		bdev_aio_flush_iocbs(aio_ch);
+		return;
+	}
+
+	if (aio_ch->num_pending == SPDK_AIO_QUEUE_DEPTH) {
+		bdev_aio_flush_iocbs(aio_ch);
+	}
+	aio_ch->pending[aio_ch->num_pending++] = iocb;
+}
+
 static int64_t
 bdev_aio_readv(struct file_disk *fdisk, struct spdk_io_channel *ch,
 	       struct bdev_aio_task *aio_task,
@@ -173,7 +239,6 @@ bdev_aio_readv(struct file_disk *fdisk, struct spdk_io_channel *ch,
 {
 	struct iocb *iocb = &aio_task->iocb;
 	struct bdev_aio_io_channel *aio_ch = spdk_io_channel_get_ctx(ch);
-	int rc;
 
 	io_prep_preadv(iocb, fdisk->fd, iov, iovcnt, offset);
 	if (aio_ch->group_ch->efd >= 0) {
@@ -186,17 +251,7 @@ bdev_aio_readv(struct file_disk *fdisk, struct spdk_io_channel *ch,
 	SPDK_DEBUGLOG(aio, "read %d iovs size %lu to off: %#lx\n",
 		      iovcnt, nbytes, offset);
 
-	rc = io_submit(aio_ch->io_ctx, 1, &iocb);
-	if (rc < 0) {
-		if (rc == -EAGAIN) {
-			spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task), SPDK_BDEV_IO_STATUS_NOMEM);
-		} else {
-			spdk_bdev_io_complete_aio_status(spdk_bdev_io_from_ctx(aio_task), rc);
-			SPDK_ERRLOG("%s: io_submit returned %d\n", __func__, rc);
-		}
-		return -1;
-	}
-	aio_ch->io_inflight++;
+	bdev_aio_queue_iocb(aio_ch, iocb);
 	return nbytes;
 }
 
@@ -207,7 +262,6 @@ bdev_aio_writev(struct file_disk *fdisk, struct spdk_io_channel *ch,
 {
 	struct iocb *iocb = &aio_task->iocb;
 	struct bdev_aio_io_channel *aio_ch = spdk_io_channel_get_ctx(ch);
-	int rc;
 
 	io_prep_pwritev(iocb, fdisk->fd, iov, iovcnt, offset);
 	if (aio_ch->group_ch->efd >= 0) {
@@ -220,17 +274,7 @@ bdev_aio_writev(struct file_disk *fdisk, struct spdk_io_channel *ch,
 	SPDK_DEBUGLOG(aio, "write %d iovs size %lu from off: %#lx\n",
 		      iovcnt, len, offset);
 
-	rc = io_submit(aio_ch->io_ctx, 1, &iocb);
-	if (rc < 0) {
-		if (rc == -EAGAIN) {
-			spdk_bdev_io_complete(spdk_bdev_io_from_ctx(aio_task), SPDK_BDEV_IO_STATUS_NOMEM);
-		} else {
-			spdk_bdev_io_complete_aio_status(spdk_bdev_io_from_ctx(aio_task), rc);
-			SPDK_ERRLOG("%s: io_submit returned %d\n", __func__, rc);
-		}
-		return -1;
-	}
-	aio_ch->io_inflight++;
+	bdev_aio_queue_iocb(aio_ch, iocb);
 	return len;
 }
 
@@ -369,6 +413,10 @@ bdev_aio_group_poll(void *arg)
 	int nr = 0;
 
 	TAILQ_FOREACH(io_ch, &group_ch->io_ch_head, link) {
+		if (io_ch->num_pending > 0) {
+			nr += io_ch->num_pending;
+			bdev_aio_flush_iocbs(io_ch);
+		}
 		nr += bdev_aio_io_channel_poll(io_ch);
 	}
 
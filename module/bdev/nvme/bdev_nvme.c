@@ -38,6 +38,7 @@
 
 #include "spdk/config.h"
 #include "spdk/endian.h"
+#include "spdk/env.h"
 #include "spdk/bdev.h"
 #include "spdk/json.h"
 #include "spdk/nvme.h"
@@ -49,6 +50,10 @@
 #include "spdk/bdev_module.h"
 #include "spdk/log.h"
 
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
 #define SPDK_BDEV_NVME_DEFAULT_DELAY_CMD_SUBMIT true
 #define SPDK_BDEV_NVME_DEFAULT_KEEP_ALIVE_TIMEOUT_IN_MS	(10000)
 
@@ -274,6 +279,150 @@ bdev_nvme_poll(void *arg)
 	return num_completions > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+/*
+ * In interrupt mode, a poll group keeps polling for this long after its last
+ * completion before it goes back to waiting for completion interrupts.
+ */
+#define BDEV_NVME_INTERRUPT_IDLE_US	100
+
+static void
+bdev_nvme_poll_group_start_polling(struct nvme_bdev_poll_group *group)
+{
+	struct nvme_io_channel *nvme_ch;
+	uint64_t notify = 1;
+
+	group->last_busy_tsc = spdk_get_ticks();
+	if (group->polling) {
+		return;
+	}
+
+	if (write(group->poll_efd, &notify, sizeof(notify)) < 0) {
+		SPDK_ERRLOG("Failed to start polling NVMe poll group: %s\n", spdk_strerror(errno));
+		return;
+	}
+
+	/* While polling, completion interrupts would only cause extra wakeups. */
+	TAILQ_FOREACH(nvme_ch, &group->intr_chs, intr_tailq) {
+		spdk_interrupt_set_event_types(nvme_ch->intr, 0);
+	}
+
+	group->polling = true;
+}
+
+static void
+bdev_nvme_poll_group_stop_polling(struct nvme_bdev_poll_group *group)
+{
+	struct nvme_io_channel *nvme_ch;
+	uint64_t notify;
+
+	if (read(group->poll_efd, &notify, sizeof(notify)) < 0 && errno != EAGAIN) {
+		SPDK_ERRLOG("Failed to stop polling NVMe poll group: %s\n", spdk_strerror(errno));
+		return;
+	}
+
+	TAILQ_FOREACH(nvme_ch, &group->intr_chs, intr_tailq) {
+		spdk_interrupt_set_event_types(nvme_ch->intr, SPDK_INTERRUPT_EVENT_IN);
+	}
+
+	group->polling = false;
+}
+
+static int
+bdev_nvme_poll_group_interrupt(void *arg)
+{
+	struct nvme_bdev_poll_group *group = arg;
+	uint64_t idle_ticks;
+	int rc;
+
+	rc = bdev_nvme_poll(group);
+	if (rc == SPDK_POLLER_BUSY) {
+		group->last_busy_tsc = spdk_get_ticks();
+		return rc;
+	}
+
+	if (group->num_polled_qpairs != 0) {
+		return rc;
+	}
+
+	idle_ticks = BDEV_NVME_INTERRUPT_IDLE_US * spdk_get_ticks_hz() / SPDK_SEC_TO_USEC;
+	if (spdk_get_ticks() - group->last_busy_tsc >= idle_ticks) {
+		bdev_nvme_poll_group_stop_polling(group);
+	}
+
+	return rc;
+}
+
+static int
+bdev_nvme_qpair_interrupt(void *arg)
+{
+	struct nvme_io_channel *nvme_ch = arg;
+	uint64_t notify;
+	int rc;
+
+	/* Acknowledge the interrupt before reaping, so later completions signal it again. */
+	if (read(nvme_ch->intr_fd, &notify, sizeof(notify)) < 0 && errno != EAGAIN) {
+		SPDK_ERRLOG("Failed to read NVMe qpair interrupt: %s\n", spdk_strerror(errno));
+	}
+
+	/*
+	 * The interrupt may be stale if its completions were already reaped while
+	 * polling. Only switch back to polling if there actually was work to do.
+	 */
+	rc = bdev_nvme_poll(nvme_ch->group);
+	if (rc == SPDK_POLLER_BUSY) {
+		bdev_nvme_poll_group_start_polling(nvme_ch->group);
+	}
+
+	return rc;
+}
+
+static void
+bdev_nvme_qpair_register_interrupt(struct nvme_io_channel *nvme_ch)
+{
+	struct nvme_bdev_poll_group *group = nvme_ch->group;
+	int fd;
+
+	if (group->intr == NULL) {
+		return;
+	}
+
+	fd = spdk_nvme_qpair_get_interrupt_fd(nvme_ch->qpair);
+	if (fd >= 0) {
+		nvme_ch->intr = SPDK_INTERRUPT_REGISTER(fd, bdev_nvme_qpair_interrupt, nvme_ch);
+	}
+
+	if (nvme_ch->intr == NULL) {
+		/* Completions on this qpair can only be found by polling. */
+		nvme_ch->polled = true;
+		group->num_polled_qpairs++;
+		bdev_nvme_poll_group_start_polling(group);
+		return;
+	}
+
+	nvme_ch->intr_fd = fd;
+	TAILQ_INSERT_TAIL(&group->intr_chs, nvme_ch, intr_tailq);
+	if (group->polling) {
+		spdk_interrupt_set_event_types(nvme_ch->intr, 0);
+	}
+}
+
+static void
+bdev_nvme_qpair_unregister_interrupt(struct nvme_io_channel *nvme_ch)
+{
+	struct nvme_bdev_poll_group *group = nvme_ch->group;
+
+	if (nvme_ch->intr != NULL) {
+		TAILQ_REMOVE(&group->intr_chs, nvme_ch, intr_tailq);
+		spdk_interrupt_unregister(&nvme_ch->intr);
+	}
+
+	if (nvme_ch->polled) {
+		assert(group->num_polled_qpairs > 0);
+		group->num_polled_qpairs--;
+		nvme_ch->polled = false;
+	}
+}
+
 static int
 bdev_nvme_poll_adminq(void *arg)
 {
@@ -325,6 +474,7 @@ bdev_nvme_create_qpair(struct nvme_io_channel *nvme_ch)
 	spdk_nvme_ctrlr_get_default_io_qpair_opts(ctrlr, &opts, sizeof(opts));
 	opts.delay_cmd_submit = g_opts.delay_cmd_submit;
 	opts.create_only = true;
+	opts.enable_interrupts = nvme_ch->group->intr != NULL;
 	opts.io_queue_requests = spdk_max(g_opts.io_queue_requests, opts.io_queue_requests);
 	g_opts.io_queue_requests = opts.io_queue_requests;
 
@@ -347,6 +497,8 @@ bdev_nvme_create_qpair(struct nvme_io_channel *nvme_ch)
 		goto err;
 	}
 
+	bdev_nvme_qpair_register_interrupt(nvme_ch);
+
 	return 0;
 
 err:
@@ -491,6 +643,8 @@ _bdev_nvme_reset_destroy_qpair(struct spdk_io_channel_iter *i)
 	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
 	int rc;
 
+	bdev_nvme_qpair_unregister_interrupt(nvme_ch);
+
 	rc = spdk_nvme_ctrlr_free_io_qpair(nvme_ch->qpair);
 	if (!rc) {
 		nvme_ch->qpair = NULL;
@@ -618,6 +772,13 @@ bdev_nvme_unmap(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 		uint64_t offset_blocks,
 		uint64_t num_blocks);
 
+static int
+bdev_nvme_copy(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+	       struct nvme_bdev_io *bio,
+	       uint64_t dst_offset_blocks,
+	       uint64_t src_offset_blocks,
+	       uint64_t num_blocks);
+
 static void
 bdev_nvme_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 		     bool success)
@@ -673,6 +834,11 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 		return -1;
 	}
 
+	/* New I/O means load, so poll for its completion instead of waiting for an interrupt. */
+	if (nvme_ch->group->intr != NULL) {
+		bdev_nvme_poll_group_start_polling(nvme_ch->group);
+	}
+
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 		if (bdev_io->u.bdev.iovs && bdev_io->u.bdev.iovs[0].iov_base) {
@@ -740,6 +906,14 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 				       bdev_io->u.bdev.offset_blocks,
 				       bdev_io->u.bdev.num_blocks);
 
+	case SPDK_BDEV_IO_TYPE_COPY:
+		return bdev_nvme_copy(nvme_ns->ns,
+				      qpair,
+				      nbdev_io,
+				      bdev_io->u.bdev.offset_blocks,
+				      bdev_io->u.bdev.copy.src_offset_blocks,
+				      bdev_io->u.bdev.num_blocks);
+
 	case SPDK_BDEV_IO_TYPE_RESET:
 		return bdev_nvme_reset(nvme_ch, nbdev_io);
 
@@ -860,11 +1034,63 @@ bdev_nvme_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 		}
 		return false;
 
+	case SPDK_BDEV_IO_TYPE_COPY:
+		/* Copy is only issued without protection information checks */
+		return (spdk_nvme_ns_get_flags(ns) & SPDK_NVME_NS_COPY_SUPPORTED) &&
+		       spdk_nvme_ns_get_pi_type(ns) == SPDK_NVME_FMT_NVM_PROTECTION_DISABLE;
+
 	default:
 		return false;
 	}
 }
 
+/* Hint the scheduler to keep the thread on the socket of the PCIe SSD it polls. A thread
+ * polling SSDs on several sockets keeps the socket of the first one. Every channel on
+ * that socket holds a reference to the hint and the last one clears it.
+ */
+static void
+bdev_nvme_get_socket_hint(struct nvme_io_channel *nvme_ch)
+{
+	struct spdk_pci_device *pci_dev;
+	int32_t hint;
+	int socket_id;
+
+	pci_dev = spdk_nvme_ctrlr_get_pci_device(nvme_ch->ctrlr->ctrlr);
+	if (pci_dev == NULL) {
+		return;
+	}
+
+	socket_id = spdk_pci_device_get_socket_id(pci_dev);
+	if (socket_id < 0) {
+		return;
+	}
+
+	hint = spdk_thread_get_socket_hint(spdk_get_thread());
+	if (hint == SPDK_ENV_SOCKET_ID_ANY) {
+		assert(nvme_ch->group->num_socket_hint_chs == 0);
+		spdk_thread_set_socket_hint(socket_id);
+	} else if (hint != socket_id) {
+		return;
+	}
+
+	nvme_ch->socket_hint = true;
+	nvme_ch->group->num_socket_hint_chs++;
+}
+
+static void
+bdev_nvme_put_socket_hint(struct nvme_io_channel *nvme_ch)
+{
+	if (!nvme_ch->socket_hint) {
+		return;
+	}
+
+	nvme_ch->socket_hint = false;
+	assert(nvme_ch->group->num_socket_hint_chs > 0);
+	if (--nvme_ch->group->num_socket_hint_chs == 0) {
+		spdk_thread_set_socket_hint(SPDK_ENV_SOCKET_ID_ANY);
+	}
+}
+
 static int
 bdev_nvme_create_cb(void *io_device, void *ctx_buf)
 {
@@ -903,6 +1129,8 @@ bdev_nvme_create_cb(void *io_device, void *ctx_buf)
 		goto err_qpair;
 	}
 
+	bdev_nvme_get_socket_hint(nvme_ch);
+
 	return 0;
 
 err_qpair:
@@ -926,11 +1154,36 @@ bdev_nvme_destroy_cb(void *io_device, void *ctx_buf)
 		bdev_ocssd_destroy_io_channel(nvme_ch);
 	}
 
+	bdev_nvme_put_socket_hint(nvme_ch);
+
+	bdev_nvme_qpair_unregister_interrupt(nvme_ch);
 	spdk_nvme_ctrlr_free_io_qpair(nvme_ch->qpair);
 
 	spdk_put_io_channel(spdk_io_channel_from_ctx(nvme_ch->group));
 }
 
+static int
+bdev_nvme_poll_group_register_interrupt(struct nvme_bdev_poll_group *group)
+{
+#ifdef __linux__
+	group->poll_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (group->poll_efd < 0) {
+		return -1;
+	}
+
+	group->intr = SPDK_INTERRUPT_REGISTER(group->poll_efd, bdev_nvme_poll_group_interrupt,
+					      group);
+	if (group->intr == NULL) {
+		close(group->poll_efd);
+		return -1;
+	}
+
+	return 0;
+#else
+	return -1;
+#endif
+}
+
 static int
 bdev_nvme_poll_group_create_cb(void *io_device, void *ctx_buf)
 {
@@ -941,6 +1194,21 @@ bdev_nvme_poll_group_create_cb(void *io_device, void *ctx_buf)
 		return -1;
 	}
 
+	TAILQ_INIT(&group->intr_chs);
+	group->poll_efd = -1;
+
+	/*
+	 * In interrupt mode the group polls only while it is busy and otherwise
+	 * waits for completion interrupts, see bdev_nvme_poll_group_interrupt().
+	 */
+	if (spdk_interrupt_mode_is_enabled()) {
+		if (bdev_nvme_poll_group_register_interrupt(group) != 0) {
+			spdk_nvme_poll_group_destroy(group->group);
+			return -1;
+		}
+		return 0;
+	}
+
 	group->poller = SPDK_POLLER_REGISTER(bdev_nvme_poll, group, g_opts.nvme_ioq_poll_period_us);
 
 	if (group->poller == NULL) {
@@ -956,6 +1224,13 @@ bdev_nvme_poll_group_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct nvme_bdev_poll_group *group = ctx_buf;
 
+	if (group->intr != NULL) {
+		assert(TAILQ_EMPTY(&group->intr_chs));
+		spdk_interrupt_unregister(&group->intr);
+		close(group->poll_efd);
+		group->poll_efd = -1;
+	}
+
 	spdk_poller_unregister(&group->poller);
 	if (spdk_nvme_poll_group_destroy(group->group)) {
 		SPDK_ERRLOG("Unable to destroy a poll group for the NVMe bdev module.");
@@ -1122,6 +1397,32 @@ bdev_nvme_get_spin_time(struct spdk_io_channel *ch)
 	return spin_time;
 }
 
+static uint32_t
+bdev_nvme_copy_range_max_blocks(const struct spdk_nvme_ns_data *nsdata)
+{
+	if (nsdata->mssrl == 0) {
+		return SPDK_NVME_COPY_RANGE_MAX_BLOCKS;
+	}
+
+	return nsdata->mssrl;
+}
+
+static uint32_t
+bdev_nvme_get_max_copy(const struct spdk_nvme_ns_data *nsdata)
+{
+	uint64_t max_copy;
+
+	/* A single Copy command carries up to MSRC + 1 ranges of at most MSSRL blocks,
+	 * and at most MCL blocks in total.
+	 */
+	max_copy = (uint64_t)bdev_nvme_copy_range_max_blocks(nsdata) * ((uint32_t)nsdata->msrc + 1);
+	if (nsdata->mcl != 0) {
+		max_copy = spdk_min(max_copy, nsdata->mcl);
+	}
+
+	return (uint32_t)max_copy;
+}
+
 static const struct spdk_bdev_fn_table nvmelib_fn_table = {
 	.destruct		= bdev_nvme_destruct,
 	.submit_request		= bdev_nvme_submit_request,
@@ -1186,6 +1487,10 @@ nvme_disk_create(struct spdk_bdev *disk, const char *base_name,
 		disk->acwu = cdata->acwu;
 	}
 
+	if (spdk_nvme_ns_get_flags(ns) & SPDK_NVME_NS_COPY_SUPPORTED) {
+		disk->max_copy = bdev_nvme_get_max_copy(nsdata);
+	}
+
 	disk->ctxt = ctx;
 	disk->fn_table = &nvmelib_fn_table;
 	disk->module = &nvme_if;
@@ -2750,6 +3055,46 @@ bdev_nvme_unmap(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
 	return rc;
 }
 
+static int
+bdev_nvme_copy(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+	       struct nvme_bdev_io *bio,
+	       uint64_t dst_offset_blocks,
+	       uint64_t src_offset_blocks,
+	       uint64_t num_blocks)
+{
+	struct spdk_nvme_scc_source_range ranges[SPDK_NVME_COPY_MAX_RANGES] = {};
+	struct spdk_nvme_scc_source_range *range;
+	const struct spdk_nvme_ns_data *nsdata;
+	uint64_t offset, remaining;
+	uint32_t range_max_blocks;
+	uint16_t num_ranges = 0;
+
+	nsdata = spdk_nvme_ns_get_data(ns);
+	range_max_blocks = bdev_nvme_copy_range_max_blocks(nsdata);
+
+	/* The bdev layer splits copy requests larger than max_copy */
+	if (num_blocks > bdev_nvme_get_max_copy(nsdata)) {
+		SPDK_ERRLOG("Copy request for %" PRIu64 " blocks is too large\n", num_blocks);
+		return -EINVAL;
+	}
+
+	offset = src_offset_blocks;
+	remaining = num_blocks;
+
+	while (remaining > 0) {
+		range = &ranges[num_ranges++];
+		range->slba = offset;
+		/* NLB is 0's based */
+		range->nlb = spdk_min(remaining, range_max_blocks) - 1;
+
+		offset += range->nlb + 1;
+		remaining -= range->nlb + 1;
+	}
+
+	return spdk_nvme_ns_cmd_copy(ns, qpair, ranges, num_ranges, dst_offset_blocks,
+				     bdev_nvme_queued_done, bio);
+}
+
 static int
 bdev_nvme_admin_passthru(struct nvme_io_channel *nvme_ch, struct nvme_bdev_io *bio,
 			 struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes)
@@ -126,6 +126,20 @@ struct nvme_bdev_poll_group {
 	uint64_t				spin_ticks;
 	uint64_t				start_ticks;
 	uint64_t				end_ticks;
+
+	/*
+	 * Interrupt mode only. The group is polled for as long as poll_efd is
+	 * signalled and otherwise waits for the completion interrupts of its qpairs.
+	 */
+	struct spdk_interrupt			*intr;
+	int					poll_efd;
+	bool					polling;
+	uint64_t				last_busy_tsc;
+	TAILQ_HEAD(, nvme_io_channel)		intr_chs;
+	/* Number of qpairs without completion interrupts. The group never stops polling them. */
+	uint32_t				num_polled_qpairs;
+	/* Number of channels holding the thread's socket hint */
+	uint32_t				num_socket_hint_chs;
 };
 
 typedef void (*spdk_bdev_create_nvme_fn)(void *ctx, size_t bdev_count, int rc);
@@ -155,6 +169,15 @@ struct nvme_io_channel {
 	struct nvme_bdev_poll_group	*group;
 	TAILQ_HEAD(, spdk_bdev_io)	pending_resets;
 	struct ocssd_io_channel		*ocssd_ch;
+
+	/* Interrupt mode only: completion interrupt of the qpair */
+	struct spdk_interrupt		*intr;
+	int				intr_fd;
+	TAILQ_ENTRY(nvme_io_channel)	intr_tailq;
+	/* Interrupt mode only: the qpair has no completion interrupts */
+	bool				polled;
+	/* The channel holds a reference to the thread's socket hint */
+	bool				socket_hint;
 };
 
 void nvme_ctrlr_populate_namespace_done(struct nvme_async_probe_ctx *ctx,
@@ -42,6 +42,10 @@
 
 static bool g_shutdown_started = false;
 
+static struct raid_bdev_opts g_opts = {
+	.rebuild_max_bandwidth_mb_sec = 0,
+};
+
 /* raid bdev config as read from config file */
 struct raid_config	g_raid_config = {
 	.raid_bdev_config_head = TAILQ_HEAD_INITIALIZER(g_raid_config.raid_bdev_config_head),
@@ -94,6 +98,7 @@ void raid_bdev_module_list_add(struct raid_bdev_module *raid_module)
 /* Function declarations */
 static void	raid_bdev_examine(struct spdk_bdev *bdev);
 static int	raid_bdev_init(void);
+static int	raid_bdev_config_json(struct spdk_json_write_ctx *w);
 static void	raid_bdev_deconfigure(struct raid_bdev *raid_bdev,
 				      raid_bdev_destruct_cb cb_fn, void *cb_arg);
 static void	raid_bdev_event_base_bdev(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
@@ -123,6 +128,17 @@ raid_bdev_create_cb(void *io_device, void *ctx_buf)
 	assert(raid_bdev->state == RAID_BDEV_STATE_ONLINE);
 
 	raid_ch->num_channels = raid_bdev->num_base_bdevs;
+	TAILQ_INIT(&raid_ch->in_flight_ios);
+	TAILQ_INIT(&raid_ch->quiesced_ios);
+
+	/*
+	 * A channel created while a range is quiesced must not let I/O through to
+	 * it either. The raid_bdev's range is set before the quiesce iterates the
+	 * channels and cleared before the unquiesce does, so this channel either
+	 * picks it up here or gets it from the iteration.
+	 */
+	raid_ch->quiesce_offset = raid_bdev->quiesce_offset;
+	raid_ch->quiesce_blocks = raid_bdev->quiesce_blocks;
 
 	raid_ch->base_channel = calloc(raid_ch->num_channels,
 				       sizeof(struct spdk_io_channel *));
@@ -130,7 +146,20 @@ raid_bdev_create_cb(void *io_device, void *ctx_buf)
 		SPDK_ERRLOG("Unable to allocate base bdevs io channel\n");
 		return -ENOMEM;
 	}
+	raid_ch->base_channel_outstanding = calloc(raid_ch->num_channels, sizeof(uint64_t));
+	if (!raid_ch->base_channel_outstanding) {
+		SPDK_ERRLOG("Unable to allocate base bdevs io channel counters\n");
+		free(raid_ch->base_channel);
+		raid_ch->base_channel = NULL;
+		return -ENOMEM;
+	}
 	for (i = 0; i < raid_ch->num_channels; i++) {
+		/* Missing base bdevs of a degraded raid bdev have no channel */
+		if (raid_bdev->base_bdev_info[i].desc == NULL ||
+		    raid_bdev->base_bdev_info[i].remove_scheduled) {
+			continue;
+		}
+
 		/*
 		 * Get the spdk_io_channel for all the base bdevs. This is used during
 		 * split logic to send the respective child bdev ios to respective base
@@ -139,19 +168,31 @@ raid_bdev_create_cb(void *io_device, void *ctx_buf)
 		raid_ch->base_channel[i] = spdk_bdev_get_io_channel(
 						   raid_bdev->base_bdev_info[i].desc);
 		if (!raid_ch->base_channel[i]) {
-			uint8_t j;
-
-			for (j = 0; j < i; j++) {
-				spdk_put_io_channel(raid_ch->base_channel[j]);
-			}
-			free(raid_ch->base_channel);
-			raid_ch->base_channel = NULL;
 			SPDK_ERRLOG("Unable to create io channel for base bdev\n");
-			return -ENOMEM;
+			goto err;
+		}
+	}
+
+	if (raid_bdev->module->get_io_channel) {
+		raid_ch->module_channel = raid_bdev->module->get_io_channel(raid_bdev);
+		if (!raid_ch->module_channel) {
+			SPDK_ERRLOG("Unable to create io channel for raid module\n");
+			goto err;
 		}
 	}
 
 	return 0;
+err:
+	for (i = 0; i < raid_ch->num_channels; i++) {
+		if (raid_ch->base_channel[i] != NULL) {
+			spdk_put_io_channel(raid_ch->base_channel[i]);
+		}
+	}
+	free(raid_ch->base_channel);
+	raid_ch->base_channel = NULL;
+	free(raid_ch->base_channel_outstanding);
+	raid_ch->base_channel_outstanding = NULL;
+	return -ENOMEM;
 }
 
 /*
@@ -174,26 +215,36 @@ raid_bdev_destroy_cb(void *io_device, void *ctx_buf)
 
 	assert(raid_ch != NULL);
 	assert(raid_ch->base_channel);
+	assert(TAILQ_EMPTY(&raid_ch->in_flight_ios));
+	assert(TAILQ_EMPTY(&raid_ch->quiesced_ios));
+
+	if (raid_ch->module_channel) {
+		spdk_put_io_channel(raid_ch->module_channel);
+	}
+
 	for (i = 0; i < raid_ch->num_channels; i++) {
 		/* Free base bdev channels */
-		assert(raid_ch->base_channel[i] != NULL);
-		spdk_put_io_channel(raid_ch->base_channel[i]);
+		if (raid_ch->base_channel[i] != NULL) {
+			spdk_put_io_channel(raid_ch->base_channel[i]);
+		}
 	}
 	free(raid_ch->base_channel);
 	raid_ch->base_channel = NULL;
+	free(raid_ch->base_channel_outstanding);
+	raid_ch->base_channel_outstanding = NULL;
 }
 
 /*
  * brief:
- * raid_bdev_cleanup is used to cleanup and free raid_bdev related data
- * structures.
+ * _raid_bdev_cleanup is used to cleanup and free raid_bdev related data
+ * structures, except the raid_bdev itself.
  * params:
  * raid_bdev - pointer to raid_bdev
  * returns:
  * none
  */
 static void
-raid_bdev_cleanup(struct raid_bdev *raid_bdev)
+_raid_bdev_cleanup(struct raid_bdev *raid_bdev)
 {
 	SPDK_DEBUGLOG(bdev_raid, "raid_bdev_cleanup, %p name %s, state %u, config %p\n",
 		      raid_bdev,
@@ -211,6 +262,21 @@ raid_bdev_cleanup(struct raid_bdev *raid_bdev)
 	if (raid_bdev->config) {
 		raid_bdev->config->raid_bdev = NULL;
 	}
+}
+
+/*
+ * brief:
+ * raid_bdev_cleanup is used to cleanup and free raid_bdev related data
+ * structures.
+ * params:
+ * raid_bdev - pointer to raid_bdev
+ * returns:
+ * none
+ */
+static void
+raid_bdev_cleanup(struct raid_bdev *raid_bdev)
+{
+	_raid_bdev_cleanup(raid_bdev);
 	free(raid_bdev);
 }
 
@@ -252,6 +318,7 @@ raid_bdev_free_base_bdev_resource(struct raid_bdev *raid_bdev,
 	}
 	base_info->desc = NULL;
 	base_info->bdev = NULL;
+	base_info->rebuilding = false;
 
 	assert(raid_bdev->num_base_bdevs_discovered);
 	raid_bdev->num_base_bdevs_discovered--;
@@ -259,30 +326,26 @@ raid_bdev_free_base_bdev_resource(struct raid_bdev *raid_bdev,
 
 /*
  * brief:
- * raid_bdev_destruct is the destruct function table pointer for raid bdev
+ * _raid_bdev_destruct closes the base bdevs and unregisters the io device of
+ * the raid bdev on its destruct.
  * params:
- * ctxt - pointer to raid_bdev
+ * raid_bdev - pointer to raid_bdev
  * returns:
- * 0 - success
- * non zero - failure
+ * true - if there are no base bdevs left and the raid_bdev should be freed
+ * false - otherwise
  */
-static int
-raid_bdev_destruct(void *ctxt)
+static bool
+_raid_bdev_destruct(struct raid_bdev *raid_bdev)
 {
-	struct raid_bdev *raid_bdev = ctxt;
 	struct raid_base_bdev_info *base_info;
 
-	SPDK_DEBUGLOG(bdev_raid, "raid_bdev_destruct\n");
-
-	raid_bdev->destruct_called = true;
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
 		/*
 		 * Close all base bdev descriptors for which call has come from below
 		 * layers.  Also close the descriptors if we have started shutdown.
 		 */
-		if (g_shutdown_started ||
-		    ((base_info->remove_scheduled == true) &&
-		     (base_info->bdev != NULL))) {
+		if ((g_shutdown_started || base_info->remove_scheduled == true) &&
+		    (base_info->bdev != NULL)) {
 			raid_bdev_free_base_bdev_resource(raid_bdev, base_info);
 		}
 	}
@@ -301,16 +364,99 @@ raid_bdev_destruct(void *ctxt)
 	if (raid_bdev->num_base_bdevs_discovered == 0) {
 		/* Free raid_bdev when there are no base bdevs left */
 		SPDK_DEBUGLOG(bdev_raid, "raid bdev base bdevs is 0, going to free all in destruct\n");
+		return true;
+	}
+
+	return false;
+}
+
+static void
+raid_bdev_destruct_rebuild_stopped(void *ctx)
+{
+	struct raid_bdev *raid_bdev = ctx;
+
+	if (_raid_bdev_destruct(raid_bdev)) {
+		_raid_bdev_cleanup(raid_bdev);
+		/* The bdev is embedded in raid_bdev, so free it only when the bdev layer is done */
+		spdk_bdev_destruct_done(&raid_bdev->bdev, 0);
+		free(raid_bdev);
+	} else {
+		spdk_bdev_destruct_done(&raid_bdev->bdev, 0);
+	}
+}
+
+/*
+ * brief:
+ * raid_bdev_destruct is the destruct function table pointer for raid bdev
+ * params:
+ * ctxt - pointer to raid_bdev
+ * returns:
+ * 0 - success
+ * 1 - the destruct completes asynchronously, after the rebuild in progress is stopped
+ */
+static int
+raid_bdev_destruct(void *ctxt)
+{
+	struct raid_bdev *raid_bdev = ctxt;
+
+	SPDK_DEBUGLOG(bdev_raid, "raid_bdev_destruct\n");
+
+	raid_bdev->destruct_called = true;
+
+	if (raid_bdev->rebuild != NULL) {
+		raid_bdev_rebuild_stop(raid_bdev, raid_bdev_destruct_rebuild_stopped, raid_bdev);
+		return 1;
+	}
+
+	if (_raid_bdev_destruct(raid_bdev)) {
 		raid_bdev_cleanup(raid_bdev);
 	}
 
 	return 0;
 }
 
+/* Check if an I/O type has a block range that is subject to quiescing */
+static inline bool
+raid_bdev_io_type_has_range(enum spdk_bdev_io_type io_type)
+{
+	switch (io_type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static inline bool
+raid_bdev_io_overlaps(struct spdk_bdev_io *bdev_io, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	return bdev_io->u.bdev.offset_blocks < offset_blocks + num_blocks &&
+	       offset_blocks < bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks;
+}
+
 void
 raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
 {
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
+	struct spdk_io_channel_iter *iter;
+
+	if (raid_bdev_io_type_has_range(bdev_io->type)) {
+		TAILQ_REMOVE(&raid_ch->in_flight_ios, raid_io, link);
+
+		if (raid_ch->quiesce_iter != NULL &&
+		    raid_bdev_io_overlaps(bdev_io, raid_ch->quiesce_offset, raid_ch->quiesce_blocks)) {
+			assert(raid_ch->quiesce_outstanding > 0);
+			if (--raid_ch->quiesce_outstanding == 0) {
+				iter = raid_ch->quiesce_iter;
+				raid_ch->quiesce_iter = NULL;
+				spdk_for_each_channel_continue(iter, 0);
+			}
+		}
+	}
 
 	spdk_bdev_io_complete(bdev_io, status);
 }
@@ -418,13 +564,22 @@ raid_bdev_submit_reset_request(struct raid_bdev_io *raid_io)
 	raid_bdev = raid_io->raid_bdev;
 
 	if (raid_io->base_bdev_io_remaining == 0) {
-		raid_io->base_bdev_io_remaining = raid_bdev->num_base_bdevs;
+		for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+			if (raid_io->raid_ch->base_channel[i] != NULL) {
+				raid_io->base_bdev_io_remaining++;
+			}
+		}
 	}
 
 	while (raid_io->base_bdev_io_submitted < raid_bdev->num_base_bdevs) {
 		i = raid_io->base_bdev_io_submitted;
 		base_info = &raid_bdev->base_bdev_info[i];
 		base_ch = raid_io->raid_ch->base_channel[i];
+		if (base_ch == NULL) {
+			/* Missing base bdev of a degraded raid bdev */
+			raid_io->base_bdev_io_submitted++;
+			continue;
+		}
 		ret = spdk_bdev_reset(base_info->desc, base_ch,
 				      raid_base_bdev_reset_complete, raid_io);
 		if (ret == 0) {
@@ -466,6 +621,48 @@ raid_bdev_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 	raid_io->raid_bdev->module->submit_rw_request(raid_io);
 }
 
+/*
+ * brief:
+ * raid_bdev_submit_range_request submits an I/O with a block range to the raid
+ * module, or queues it if it overlaps the quiesced range of the channel.
+ * params:
+ * raid_io - pointer to raid_bdev_io
+ * returns:
+ * none
+ */
+static void
+raid_bdev_submit_range_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
+
+	if (spdk_unlikely(raid_ch->quiesce_blocks != 0) &&
+	    raid_bdev_io_overlaps(bdev_io, raid_ch->quiesce_offset, raid_ch->quiesce_blocks)) {
+		TAILQ_INSERT_TAIL(&raid_ch->quiesced_ios, raid_io, link);
+		return;
+	}
+
+	TAILQ_INSERT_TAIL(&raid_ch->in_flight_ios, raid_io, link);
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		spdk_bdev_io_get_buf(bdev_io, raid_bdev_get_buf_cb,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		raid_io->raid_bdev->module->submit_rw_request(raid_io);
+		break;
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		raid_io->raid_bdev->module->submit_null_payload_request(raid_io);
+		break;
+	default:
+		assert(false);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
 /*
  * brief:
  * raid_bdev_submit_request function is the submit_request function pointer of
@@ -490,22 +687,16 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
-		spdk_bdev_io_get_buf(bdev_io, raid_bdev_get_buf_cb,
-				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
-		break;
 	case SPDK_BDEV_IO_TYPE_WRITE:
-		raid_io->raid_bdev->module->submit_rw_request(raid_io);
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		raid_bdev_submit_range_request(raid_io);
 		break;
 
 	case SPDK_BDEV_IO_TYPE_RESET:
 		raid_bdev_submit_reset_request(raid_io);
 		break;
 
-	case SPDK_BDEV_IO_TYPE_FLUSH:
-	case SPDK_BDEV_IO_TYPE_UNMAP:
-		raid_io->raid_bdev->module->submit_null_payload_request(raid_io);
-		break;
-
 	default:
 		SPDK_ERRLOG("submit request, invalid io type %u\n", bdev_io->type);
 		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
@@ -513,6 +704,153 @@ raid_bdev_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_i
 	}
 }
 
+struct raid_bdev_quiesce_ctx {
+	uint64_t		offset_blocks;
+	uint64_t		num_blocks;
+	raid_bdev_quiesce_cb	cb_fn;
+	void			*cb_arg;
+};
+
+static void
+raid_bdev_quiesce_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct raid_bdev_quiesce_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+static void
+raid_bdev_channel_quiesce(struct spdk_io_channel_iter *i)
+{
+	struct raid_bdev_quiesce_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	struct raid_bdev_io *raid_io;
+
+	/* A channel created after the quiesce started already has the range */
+	assert(raid_ch->quiesce_blocks == 0 ||
+	       (raid_ch->quiesce_offset == ctx->offset_blocks &&
+		raid_ch->quiesce_blocks == ctx->num_blocks));
+	raid_ch->quiesce_offset = ctx->offset_blocks;
+	raid_ch->quiesce_blocks = ctx->num_blocks;
+
+	TAILQ_FOREACH(raid_io, &raid_ch->in_flight_ios, link) {
+		if (raid_bdev_io_overlaps(spdk_bdev_io_from_ctx(raid_io), ctx->offset_blocks,
+					  ctx->num_blocks)) {
+			raid_ch->quiesce_outstanding++;
+		}
+	}
+
+	if (raid_ch->quiesce_outstanding == 0) {
+		spdk_for_each_channel_continue(i, 0);
+	} else {
+		/* Continue when the last overlapping I/O completes */
+		raid_ch->quiesce_iter = i;
+	}
+}
+
+/*
+ * brief:
+ * raid_bdev_quiesce_range stops I/O to a range of the raid bdev. The I/Os that
+ * overlap the range and are submitted from now on are queued until the range
+ * is unquiesced. The callback is called when the overlapping I/Os already in
+ * progress have completed on all the channels. Only one range can be quiesced
+ * at a time.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * offset_blocks - start of the range
+ * num_blocks - size of the range, must not be 0
+ * cb_fn - callback called when the range is quiesced
+ * cb_arg - argument to callback function
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_quiesce_range(struct raid_bdev *raid_bdev, uint64_t offset_blocks,
+			uint64_t num_blocks, raid_bdev_quiesce_cb cb_fn, void *cb_arg)
+{
+	struct raid_bdev_quiesce_ctx *ctx;
+
+	assert(num_blocks != 0);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->offset_blocks = offset_blocks;
+	ctx->num_blocks = num_blocks;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	assert(raid_bdev->quiesce_blocks == 0);
+	raid_bdev->quiesce_offset = offset_blocks;
+	raid_bdev->quiesce_blocks = num_blocks;
+
+	spdk_for_each_channel(raid_bdev, raid_bdev_channel_quiesce, ctx, raid_bdev_quiesce_done);
+
+	return 0;
+}
+
+static void
+raid_bdev_channel_unquiesce(struct spdk_io_channel_iter *i)
+{
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	struct raid_bdev_io *raid_io;
+	TAILQ_HEAD(, raid_bdev_io) quiesced_ios;
+
+	assert(raid_ch->quiesce_iter == NULL);
+	raid_ch->quiesce_offset = 0;
+	raid_ch->quiesce_blocks = 0;
+
+	TAILQ_INIT(&quiesced_ios);
+	TAILQ_SWAP(&quiesced_ios, &raid_ch->quiesced_ios, raid_bdev_io, link);
+
+	while ((raid_io = TAILQ_FIRST(&quiesced_ios)) != NULL) {
+		TAILQ_REMOVE(&quiesced_ios, raid_io, link);
+		raid_bdev_submit_range_request(raid_io);
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+/*
+ * brief:
+ * raid_bdev_unquiesce_range resumes I/O to the range quiesced with
+ * raid_bdev_quiesce_range and submits the I/Os queued in the meantime.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * cb_fn - callback called when the range is unquiesced on all the channels
+ * cb_arg - argument to callback function
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_unquiesce_range(struct raid_bdev *raid_bdev, raid_bdev_quiesce_cb cb_fn,
+			  void *cb_arg)
+{
+	struct raid_bdev_quiesce_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	raid_bdev->quiesce_offset = 0;
+	raid_bdev->quiesce_blocks = 0;
+
+	spdk_for_each_channel(raid_bdev, raid_bdev_channel_unquiesce, ctx, raid_bdev_quiesce_done);
+
+	return 0;
+}
+
 /*
  * brief:
  * _raid_bdev_io_type_supported checks whether io_type is supported in
@@ -539,8 +877,8 @@ _raid_bdev_io_type_supported(struct raid_bdev *raid_bdev, enum spdk_bdev_io_type
 	}
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		/* Missing base bdev of a degraded raid bdev */
 		if (base_info->bdev == NULL) {
-			assert(false);
 			continue;
 		}
 
@@ -639,6 +977,7 @@ raid_bdev_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 		}
 	}
 	spdk_json_write_array_end(w);
+	raid_bdev_rebuild_dump_info_json(raid_bdev, w);
 	spdk_json_write_object_end(w);
 
 	return 0;
@@ -869,6 +1208,10 @@ static struct {
 } g_raid_level_names[] = {
 	{ "raid0", RAID0 },
 	{ "0", RAID0 },
+	{ "raid1", RAID1 },
+	{ "1", RAID1 },
+	{ "raid10", RAID10 },
+	{ "10", RAID10 },
 	{ "raid5", RAID5 },
 	{ "5", RAID5 },
 	{ }
@@ -934,6 +1277,63 @@ raid_bdev_exit(void)
 	raid_bdev_free();
 }
 
+/*
+ * brief:
+ * raid_bdev_get_opts gets the options of the raid bdev module
+ * params:
+ * opts - options filled in by this function
+ * returns:
+ * none
+ */
+void
+raid_bdev_get_opts(struct raid_bdev_opts *opts)
+{
+	*opts = g_opts;
+}
+
+/*
+ * brief:
+ * raid_bdev_set_opts sets the options of the raid bdev module. They apply to
+ * the rebuilds in progress too.
+ * params:
+ * opts - new options
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_set_opts(const struct raid_bdev_opts *opts)
+{
+	g_opts = *opts;
+
+	return 0;
+}
+
+/*
+ * brief:
+ * raid_bdev_config_json writes the options of the raid bdev module
+ * params:
+ * w - pointer to json context
+ * returns:
+ * 0 - success
+ */
+static int
+raid_bdev_config_json(struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_raid_set_options");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_uint64(w, "rebuild_max_bandwidth_mb_sec",
+				     g_opts.rebuild_max_bandwidth_mb_sec);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
 /*
  * brief:
  * raid_bdev_get_ctx_size is used to return the context size of bdev_io for raid
@@ -996,6 +1396,7 @@ static struct spdk_bdev_module g_raid_if = {
 	.module_fini = raid_bdev_exit,
 	.get_ctx_size = raid_bdev_get_ctx_size,
 	.examine_config = raid_bdev_examine,
+	.config_json = raid_bdev_config_json,
 	.async_init = false,
 	.async_fini = false,
 };
@@ -1031,6 +1432,7 @@ raid_bdev_create(struct raid_bdev_config *raid_cfg)
 	struct raid_bdev *raid_bdev;
 	struct spdk_bdev *raid_bdev_gen;
 	struct raid_bdev_module *module;
+	struct raid_base_bdev_info *base_info;
 
 	module = raid_bdev_module_find(raid_cfg->level);
 	if (module == NULL) {
@@ -1061,6 +1463,9 @@ raid_bdev_create(struct raid_bdev_config *raid_cfg)
 		free(raid_bdev);
 		return -ENOMEM;
 	}
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		base_info->raid_bdev = raid_bdev;
+	}
 
 	/* strip_size_kb is from the rpc param.  strip_size is in blocks and used
 	 * internally and set later.
@@ -1095,6 +1500,41 @@ raid_bdev_create(struct raid_bdev_config *raid_cfg)
 	return 0;
 }
 
+/*
+ * brief:
+ * raid_bdev_check_replacement checks if a bdev can replace a missing base
+ * bdev of an online raid bdev.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * bdev - pointer to the replacement bdev
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+static int
+raid_bdev_check_replacement(struct raid_bdev *raid_bdev, struct spdk_bdev *bdev)
+{
+	if (raid_bdev->module->get_rebuild_sources == NULL) {
+		SPDK_ERRLOG("Raid bdev '%s' can't rebuild base bdevs\n", raid_bdev->bdev.name);
+		return -ENOTSUP;
+	}
+
+	if (bdev->blocklen != raid_bdev->bdev.blocklen) {
+		SPDK_ERRLOG("Blocklen of bdev '%s' doesn't match raid bdev '%s'\n",
+			    bdev->name, raid_bdev->bdev.name);
+		return -EINVAL;
+	}
+
+	assert(raid_bdev->data_width != 0);
+	if (bdev->blockcnt < raid_bdev->bdev.blockcnt / raid_bdev->data_width) {
+		SPDK_ERRLOG("Bdev '%s' is too small to replace a base bdev of raid bdev '%s'\n",
+			    bdev->name, raid_bdev->bdev.name);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 /*
  * brief
  * raid_bdev_alloc_base_bdev_resource allocates resource of base bdev.
@@ -1112,6 +1552,7 @@ raid_bdev_alloc_base_bdev_resource(struct raid_bdev *raid_bdev, const char *bdev
 {
 	struct spdk_bdev_desc *desc;
 	struct spdk_bdev *bdev;
+	struct raid_base_bdev_info *base_info;
 	int rc;
 
 	rc = spdk_bdev_open_ext(bdev_name, true, raid_bdev_event_base_bdev, NULL, &desc);
@@ -1124,6 +1565,14 @@ raid_bdev_alloc_base_bdev_resource(struct raid_bdev *raid_bdev, const char *bdev
 
 	bdev = spdk_bdev_desc_get_bdev(desc);
 
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE) {
+		rc = raid_bdev_check_replacement(raid_bdev, bdev);
+		if (rc != 0) {
+			spdk_bdev_close(desc);
+			return rc;
+		}
+	}
+
 	rc = spdk_bdev_module_claim_bdev(bdev, NULL, &g_raid_if);
 	if (rc != 0) {
 		SPDK_ERRLOG("Unable to claim this bdev as it is already claimed\n");
@@ -1133,12 +1582,17 @@ raid_bdev_alloc_base_bdev_resource(struct raid_bdev *raid_bdev, const char *bdev
 
 	SPDK_DEBUGLOG(bdev_raid, "bdev %s is claimed\n", bdev_name);
 
-	assert(raid_bdev->state != RAID_BDEV_STATE_ONLINE);
 	assert(base_bdev_slot < raid_bdev->num_base_bdevs);
-
-	raid_bdev->base_bdev_info[base_bdev_slot].thread = spdk_get_thread();
-	raid_bdev->base_bdev_info[base_bdev_slot].bdev = bdev;
-	raid_bdev->base_bdev_info[base_bdev_slot].desc = desc;
+	base_info = &raid_bdev->base_bdev_info[base_bdev_slot];
+	assert(base_info->bdev == NULL);
+
+	base_info->thread = spdk_get_thread();
+	base_info->bdev = bdev;
+	base_info->desc = desc;
+	base_info->remove_scheduled = false;
+	/* A base bdev added to an online raid bdev holds valid data only after its rebuild */
+	base_info->rebuilding = raid_bdev->state == RAID_BDEV_STATE_ONLINE;
+	base_info->rebuild_offset = 0;
 	raid_bdev->num_base_bdevs_discovered++;
 	assert(raid_bdev->num_base_bdevs_discovered <= raid_bdev->num_base_bdevs);
 
@@ -1246,7 +1700,6 @@ raid_bdev_deconfigure(struct raid_bdev *raid_bdev, raid_bdev_destruct_cb cb_fn,
 		return;
 	}
 
-	assert(raid_bdev->num_base_bdevs == raid_bdev->num_base_bdevs_discovered);
 	TAILQ_REMOVE(&g_raid_bdev_configured_list, raid_bdev, state_link);
 	if (raid_bdev->module->stop != NULL) {
 		raid_bdev->module->stop(raid_bdev);
@@ -1291,6 +1744,125 @@ raid_bdev_find_by_base_bdev(struct spdk_bdev *base_bdev, struct raid_bdev **_rai
 	return false;
 }
 
+static void
+raid_bdev_channel_remove_base_bdev(struct spdk_io_channel_iter *i)
+{
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	uint8_t idx = base_info - base_info->raid_bdev->base_bdev_info;
+
+	if (raid_ch->base_channel[idx] != NULL) {
+		spdk_put_io_channel(raid_ch->base_channel[idx]);
+		raid_ch->base_channel[idx] = NULL;
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+raid_bdev_channels_remove_base_bdev_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+
+	/* The descriptor may have been closed by the destruct of the raid bdev meanwhile */
+	if (base_info->bdev != NULL) {
+		raid_bdev_free_base_bdev_resource(raid_bdev, base_info);
+	}
+
+	SPDK_NOTICELOG("raid bdev %s is running degraded, %u of %u base bdevs left\n",
+		       raid_bdev->bdev.name, raid_bdev->num_base_bdevs_discovered,
+		       raid_bdev->num_base_bdevs);
+}
+
+static void
+_raid_bdev_detach_base_bdev(void *ctx)
+{
+	struct raid_base_bdev_info *base_info = ctx;
+
+	spdk_for_each_channel(base_info->raid_bdev, raid_bdev_channel_remove_base_bdev, base_info,
+			      raid_bdev_channels_remove_base_bdev_done);
+}
+
+/*
+ * brief:
+ * raid_bdev_detach_base_bdev removes a base bdev from an online raid bdev,
+ * which keeps running degraded without it.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * base_info - raid base bdev info of the base bdev to remove
+ * returns:
+ * none
+ */
+static void
+raid_bdev_detach_base_bdev(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *base_info)
+{
+	base_info->remove_scheduled = true;
+
+	if (base_info->rebuilding && raid_bdev->rebuild != NULL) {
+		raid_bdev_rebuild_stop(raid_bdev, _raid_bdev_detach_base_bdev, base_info);
+	} else {
+		_raid_bdev_detach_base_bdev(base_info);
+	}
+}
+
+/*
+ * brief:
+ * raid_bdev_fail_base_bdev removes a base bdev whose rebuild failed from its
+ * raid bdev. The raid bdev keeps running degraded, as it did during the
+ * rebuild, and a new base bdev can be added in its place.
+ * params:
+ * base_info - raid base bdev info of the failed base bdev
+ * returns:
+ * none
+ */
+void
+raid_bdev_fail_base_bdev(struct raid_base_bdev_info *base_info)
+{
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+
+	assert(base_info->rebuilding);
+	assert(raid_bdev->rebuild == NULL);
+
+	if (base_info->remove_scheduled) {
+		return;
+	}
+
+	SPDK_ERRLOG("Removing failed base bdev %s from raid bdev %s\n",
+		    base_info->bdev->name, raid_bdev->bdev.name);
+	raid_bdev_detach_base_bdev(raid_bdev, base_info);
+}
+
+/*
+ * brief:
+ * raid_bdev_can_degrade checks if an online raid bdev can keep running
+ * without a base bdev. Base bdevs that are being rebuilt don't count as
+ * operational.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * removed - raid base bdev info of the base bdev to remove
+ * returns:
+ * true - if the raid bdev can run without the base bdev
+ * false - otherwise
+ */
+static bool
+raid_bdev_can_degrade(struct raid_bdev *raid_bdev, struct raid_base_bdev_info *removed)
+{
+	struct raid_base_bdev_info *base_info;
+	uint8_t num_operational = 0;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		if (base_info != removed && base_info->bdev != NULL &&
+		    !base_info->remove_scheduled && !base_info->rebuilding) {
+			num_operational++;
+		}
+	}
+
+	return raid_bdev->num_base_bdevs - num_operational <=
+	       raid_bdev->module->base_bdevs_max_degraded;
+}
+
 /*
  * brief:
  * raid_bdev_remove_base_bdev function is called by below layers when base_bdev
@@ -1316,6 +1888,18 @@ raid_bdev_remove_base_bdev(struct spdk_bdev *base_bdev)
 	}
 
 	assert(base_info->desc);
+
+	if (base_info->remove_scheduled) {
+		/* Already being removed from the degraded raid bdev */
+		return;
+	}
+
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE && raid_bdev->destruct_called == false &&
+	    raid_bdev_can_degrade(raid_bdev, base_info)) {
+		raid_bdev_detach_base_bdev(raid_bdev, base_info);
+		return;
+	}
+
 	base_info->remove_scheduled = true;
 
 	if (raid_bdev->destruct_called == true ||
@@ -1427,6 +2011,48 @@ raid_bdev_remove_base_devices(struct raid_bdev_config *raid_cfg,
 	raid_bdev_deconfigure(raid_bdev, cb_fn, cb_arg);
 }
 
+static void
+raid_bdev_channel_add_base_bdev(struct spdk_io_channel_iter *i)
+{
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *ch = spdk_io_channel_iter_get_channel(i);
+	struct raid_bdev_io_channel *raid_ch = spdk_io_channel_get_ctx(ch);
+	uint8_t idx = base_info - base_info->raid_bdev->base_bdev_info;
+
+	/* Channels created after the base bdev was added already have it */
+	if (raid_ch->base_channel[idx] == NULL) {
+		raid_ch->base_channel[idx] = spdk_bdev_get_io_channel(base_info->desc);
+		if (raid_ch->base_channel[idx] == NULL) {
+			spdk_for_each_channel_continue(i, -ENOMEM);
+			return;
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+raid_bdev_channels_add_base_bdev_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct raid_base_bdev_info *base_info = spdk_io_channel_iter_get_ctx(i);
+	struct raid_bdev *raid_bdev = base_info->raid_bdev;
+
+	if (base_info->remove_scheduled || raid_bdev->destruct_called) {
+		/* Removed meanwhile, nothing to rebuild */
+		return;
+	}
+
+	if (status == 0) {
+		status = raid_bdev_rebuild_start(raid_bdev, base_info - raid_bdev->base_bdev_info);
+	}
+
+	if (status != 0) {
+		SPDK_ERRLOG("Failed to start rebuild of base bdev %s on raid bdev %s: %s\n",
+			    base_info->bdev->name, raid_bdev->bdev.name, spdk_strerror(-status));
+		raid_bdev_detach_base_bdev(raid_bdev, base_info);
+	}
+}
+
 /*
  * brief:
  * raid_bdev_add_base_device function is the actual function which either adds
@@ -1463,6 +2089,14 @@ raid_bdev_add_base_device(struct raid_bdev_config *raid_cfg, const char *bdev_na
 
 	assert(raid_bdev->num_base_bdevs_discovered <= raid_bdev->num_base_bdevs);
 
+	if (raid_bdev->state == RAID_BDEV_STATE_ONLINE) {
+		/* A replacement of a missing base bdev, get its channels and rebuild it */
+		spdk_for_each_channel(raid_bdev, raid_bdev_channel_add_base_bdev,
+				      &raid_bdev->base_bdev_info[base_bdev_slot],
+				      raid_bdev_channels_add_base_bdev_done);
+		return 0;
+	}
+
 	if (raid_bdev->num_base_bdevs_discovered == raid_bdev->num_base_bdevs) {
 		rc = raid_bdev_configure(raid_bdev);
 		if (rc != 0) {
@@ -1512,6 +2146,71 @@ raid_bdev_add_base_devices(struct raid_bdev_config *raid_cfg)
 	return rc;
 }
 
+/*
+ * brief:
+ * raid_bdev_replace_base_device adds a bdev in place of a missing base bdev of
+ * an online raid bdev and starts rebuilding it. The bdev replaces the missing
+ * base bdev in the raid bdev configuration too.
+ * params:
+ * raid_cfg - pointer to raid bdev config
+ * base_bdev_name - name of the replacement bdev
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_replace_base_device(struct raid_bdev_config *raid_cfg, const char *base_bdev_name)
+{
+	struct raid_bdev *raid_bdev = raid_cfg->raid_bdev;
+	struct raid_bdev_config *tmp;
+	char *name;
+	uint8_t slot;
+	uint8_t i;
+	int rc;
+
+	if (raid_bdev == NULL || raid_bdev->state != RAID_BDEV_STATE_ONLINE) {
+		SPDK_ERRLOG("Raid bdev '%s' is not online\n", raid_cfg->name);
+		return -ENODEV;
+	}
+
+	for (slot = 0; slot < raid_bdev->num_base_bdevs; slot++) {
+		if (raid_bdev->base_bdev_info[slot].bdev == NULL) {
+			break;
+		}
+	}
+	if (slot == raid_bdev->num_base_bdevs) {
+		SPDK_ERRLOG("Raid bdev '%s' has no missing base bdev\n", raid_cfg->name);
+		return -EEXIST;
+	}
+
+	TAILQ_FOREACH(tmp, &g_raid_config.raid_bdev_config_head, link) {
+		for (i = 0; i < tmp->num_base_bdevs; i++) {
+			if (tmp->base_bdev[i].name != NULL &&
+			    strcmp(tmp->base_bdev[i].name, base_bdev_name) == 0) {
+				SPDK_ERRLOG("duplicate base bdev name %s mentioned\n",
+					    base_bdev_name);
+				return -EEXIST;
+			}
+		}
+	}
+
+	name = strdup(base_bdev_name);
+	if (name == NULL) {
+		return -ENOMEM;
+	}
+
+	rc = raid_bdev_add_base_device(raid_cfg, base_bdev_name, slot);
+	if (rc != 0) {
+		free(name);
+		return rc;
+	}
+
+	free(raid_cfg->base_bdev[slot].name);
+	raid_cfg->base_bdev[slot].name = name;
+
+	return 0;
+}
+
 /*
  * brief:
  * raid_bdev_examine function is the examine function call by the below layers
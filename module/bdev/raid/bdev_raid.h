@@ -35,11 +35,15 @@
 #define SPDK_BDEV_RAID_INTERNAL_H
 
 #include "spdk/bdev_module.h"
+#include "spdk/likely.h"
+#include "spdk/log.h"
 
 enum raid_level {
 	INVALID_RAID_LEVEL	= -1,
 	RAID0			= 0,
+	RAID1			= 1,
 	RAID5			= 5,
+	RAID10			= 10,
 };
 
 /*
@@ -72,6 +76,9 @@ enum raid_bdev_state {
  * required per base device for raid bdev will be kept here
  */
 struct raid_base_bdev_info {
+	/* pointer to the raid bdev this base bdev belongs to */
+	struct raid_bdev	*raid_bdev;
+
 	/* pointer to base spdk bdev */
 	struct spdk_bdev	*bdev;
 
@@ -87,6 +94,13 @@ struct raid_base_bdev_info {
 
 	/* thread where base device is opened */
 	struct spdk_thread	*thread;
+
+	/*
+	 * Set while the base bdev is rebuilt. Its data is valid only for the
+	 * blocks of the raid bdev below rebuild_offset.
+	 */
+	bool			rebuilding;
+	uint64_t		rebuild_offset;
 };
 
 /*
@@ -107,6 +121,12 @@ struct raid_bdev_io {
 	uint64_t			base_bdev_io_remaining;
 	uint8_t				base_bdev_io_submitted;
 	uint8_t				base_bdev_io_status;
+
+	/* Base bdev a read went to, for the modules that balance reads */
+	uint8_t				base_bdev_io_idx;
+
+	/* Link in the in flight or quiesced I/O list of the raid bdev io channel */
+	TAILQ_ENTRY(raid_bdev_io)	link;
 };
 
 /*
@@ -154,6 +174,22 @@ struct raid_bdev {
 	/* Raid Level of this raid bdev */
 	enum raid_level			level;
 
+	/*
+	 * Number of blocks of the raid bdev per block of a base bdev. Set by the
+	 * modules that support rebuild in start.
+	 */
+	uint8_t				data_width;
+
+	/* Rebuild in progress, NULL if there is none */
+	struct raid_bdev_rebuild	*rebuild;
+
+	/*
+	 * Range quiesced with raid_bdev_quiesce_range(), copied into io channels
+	 * created while it is quiesced. quiesce_blocks is 0 if there is none.
+	 */
+	uint64_t			quiesce_offset;
+	uint64_t			quiesce_blocks;
+
 	/* Set to true if destruct is called for this raid bdev */
 	bool				destruct_called;
 
@@ -226,6 +262,32 @@ struct raid_bdev_io_channel {
 
 	/* Number of IO channels */
 	uint8_t			num_channels;
+
+	/*
+	 * Number of reads outstanding on each base bdev IO channel. Maintained by
+	 * the raid modules that balance reads across base bdevs.
+	 */
+	uint64_t		*base_channel_outstanding;
+
+	/* Private raid module IO channel */
+	struct spdk_io_channel	*module_channel;
+
+	/* I/Os with a block range that are submitted to the raid module */
+	TAILQ_HEAD(, raid_bdev_io)	in_flight_ios;
+
+	/* I/Os overlapping the quiesced range, submitted when it is unquiesced */
+	TAILQ_HEAD(, raid_bdev_io)	quiesced_ios;
+
+	/* Quiesced range of the raid bdev, num_blocks is 0 if there is none */
+	uint64_t		quiesce_offset;
+	uint64_t		quiesce_blocks;
+
+	/*
+	 * Number of in flight I/Os overlapping the quiesced range. The quiesce
+	 * of this channel completes with quiesce_iter when they are all done.
+	 */
+	uint64_t			quiesce_outstanding;
+	struct spdk_io_channel_iter	*quiesce_iter;
 };
 
 /* TAIL heads for various raid bdev lists */
@@ -242,6 +304,17 @@ extern struct raid_config		g_raid_config;
 
 typedef void (*raid_bdev_destruct_cb)(void *cb_ctx, int rc);
 
+/*
+ * Options of the raid bdev module
+ */
+struct raid_bdev_opts {
+	/* Maximum rebuild bandwidth of a raid bdev in MiB/s, 0 means unlimited */
+	uint64_t rebuild_max_bandwidth_mb_sec;
+};
+
+void raid_bdev_get_opts(struct raid_bdev_opts *opts);
+int raid_bdev_set_opts(const struct raid_bdev_opts *opts);
+
 int raid_bdev_create(struct raid_bdev_config *raid_cfg);
 int raid_bdev_add_base_devices(struct raid_bdev_config *raid_cfg);
 void raid_bdev_remove_base_devices(struct raid_bdev_config *raid_cfg,
@@ -250,6 +323,7 @@ int raid_bdev_config_add(const char *raid_name, uint32_t strip_size, uint8_t num
 			 enum raid_level level, struct raid_bdev_config **_raid_cfg);
 int raid_bdev_config_add_base_bdev(struct raid_bdev_config *raid_cfg,
 				   const char *base_bdev_name, uint8_t slot);
+int raid_bdev_replace_base_device(struct raid_bdev_config *raid_cfg, const char *base_bdev_name);
 void raid_bdev_config_cleanup(struct raid_bdev_config *raid_cfg);
 struct raid_bdev_config *raid_bdev_config_find_by_name(const char *raid_name);
 enum raid_level raid_bdev_parse_raid_level(const char *str);
@@ -292,6 +366,22 @@ struct raid_bdev_module {
 	/* Handler for requests without payload (flush, unmap). Optional. */
 	void (*submit_null_payload_request)(struct raid_bdev_io *raid_io);
 
+	/*
+	 * Called when the raid bdev io channel is created, to get the module's
+	 * own io channel for this thread. It is stored in the module_channel
+	 * field of raid_bdev_io_channel. Optional.
+	 */
+	struct spdk_io_channel *(*get_io_channel)(struct raid_bdev *raid_bdev);
+
+	/*
+	 * Get the base bdevs the data of base bdev 'idx' is rebuilt from. Each
+	 * block of 'idx' is rebuilt as the XOR of the same block of all of them,
+	 * so a single source is copied. Returns the number of sources stored in
+	 * 'sources', or 0 if 'idx' can't be rebuilt. Optional, base bdevs can't
+	 * be replaced while the raid bdev is online without it.
+	 */
+	uint8_t (*get_rebuild_sources)(struct raid_bdev *raid_bdev, uint8_t idx, uint8_t *sources);
+
 	TAILQ_ENTRY(raid_bdev_module) link;
 };
 
@@ -307,6 +397,106 @@ __RAID_MODULE_REGISTER(__LINE__)(void)					\
     raid_bdev_module_list_add(_module);					\
 }
 
+/*
+ * Range of an I/O striped RAID-0 style over a number of disks. The "disks" may
+ * be base bdevs or, for levels layered on top of striping, groups of base
+ * bdevs.
+ */
+struct raid_bdev_io_range {
+	uint64_t	strip_size;
+	uint64_t	start_strip_in_disk;
+	uint64_t	end_strip_in_disk;
+	uint64_t	start_offset_in_strip;
+	uint64_t	end_offset_in_strip;
+	uint8_t		start_disk;
+	uint8_t		end_disk;
+	uint8_t		n_disks_involved;
+};
+
+static inline void
+_raid0_get_io_range(struct raid_bdev_io_range *io_range,
+		    uint8_t num_base_bdevs, uint64_t strip_size, uint64_t strip_size_shift,
+		    uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint64_t	start_strip;
+	uint64_t	end_strip;
+
+	io_range->strip_size = strip_size;
+
+	/* The start and end strip index in raid0 bdev scope */
+	start_strip = offset_blocks >> strip_size_shift;
+	end_strip = (offset_blocks + num_blocks - 1) >> strip_size_shift;
+	io_range->start_strip_in_disk = start_strip / num_base_bdevs;
+	io_range->end_strip_in_disk = end_strip / num_base_bdevs;
+
+	/* The first strip may have unaligned start LBA offset.
+	 * The end strip may have unaligned end LBA offset.
+	 * Strips between them certainly have aligned offset and length to boundaries.
+	 */
+	io_range->start_offset_in_strip = offset_blocks % strip_size;
+	io_range->end_offset_in_strip = (offset_blocks + num_blocks - 1) % strip_size;
+
+	/* The base bdev indexes in which start and end strips are located */
+	io_range->start_disk = start_strip % num_base_bdevs;
+	io_range->end_disk = end_strip % num_base_bdevs;
+
+	/* Calculate how many base_bdevs are involved in io operation.
+	 * Number of base bdevs involved is between 1 and num_base_bdevs.
+	 * It will be 1 if the first strip and last strip are the same one.
+	 */
+	io_range->n_disks_involved = spdk_min((end_strip - start_strip + 1), num_base_bdevs);
+}
+
+static inline void
+_raid0_split_io_range(struct raid_bdev_io_range *io_range, uint8_t disk_idx,
+		      uint64_t *_offset_in_disk, uint64_t *_nblocks_in_disk)
+{
+	uint64_t n_strips_in_disk;
+	uint64_t start_offset_in_disk;
+	uint64_t end_offset_in_disk;
+	uint64_t offset_in_disk;
+	uint64_t nblocks_in_disk;
+	uint64_t start_strip_in_disk;
+	uint64_t end_strip_in_disk;
+
+	start_strip_in_disk = io_range->start_strip_in_disk;
+	if (disk_idx < io_range->start_disk) {
+		start_strip_in_disk += 1;
+	}
+
+	end_strip_in_disk = io_range->end_strip_in_disk;
+	if (disk_idx > io_range->end_disk) {
+		end_strip_in_disk -= 1;
+	}
+
+	assert(end_strip_in_disk >= start_strip_in_disk);
+	n_strips_in_disk = end_strip_in_disk - start_strip_in_disk + 1;
+
+	if (disk_idx == io_range->start_disk) {
+		start_offset_in_disk = io_range->start_offset_in_strip;
+	} else {
+		start_offset_in_disk = 0;
+	}
+
+	if (disk_idx == io_range->end_disk) {
+		end_offset_in_disk = io_range->end_offset_in_strip;
+	} else {
+		end_offset_in_disk = io_range->strip_size - 1;
+	}
+
+	offset_in_disk = start_offset_in_disk + start_strip_in_disk * io_range->strip_size;
+	nblocks_in_disk = (n_strips_in_disk - 1) * io_range->strip_size
+			  + end_offset_in_disk - start_offset_in_disk + 1;
+
+	SPDK_DEBUGLOG(bdev_raid,
+		      "raid_bdev (strip_size 0x%" PRIx64 ") splits IO to base_bdev (%u) at (0x%" PRIx64 ", 0x%" PRIx64
+		      ").\n",
+		      io_range->strip_size, disk_idx, offset_in_disk, nblocks_in_disk);
+
+	*_offset_in_disk = offset_in_disk;
+	*_nblocks_in_disk = nblocks_in_disk;
+}
+
 bool
 raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed,
 			   enum spdk_bdev_io_status status);
@@ -316,4 +506,44 @@ raid_bdev_queue_io_wait(struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
 void
 raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status);
 
+/*
+ * Check if the data of base bdev 'idx' can be used for a raid_io. It can't be
+ * used if the base bdev is missing, or if it is being rebuilt and the blocks
+ * of the raid_io are not rebuilt yet.
+ */
+static inline bool
+raid_bdev_io_base_bdev_valid(struct raid_bdev_io *raid_io, uint8_t idx)
+{
+	struct raid_base_bdev_info *base_info = &raid_io->raid_bdev->base_bdev_info[idx];
+	struct spdk_bdev_io *bdev_io;
+
+	if (raid_io->raid_ch->base_channel[idx] == NULL) {
+		return false;
+	}
+
+	if (spdk_likely(!base_info->rebuilding)) {
+		return true;
+	}
+
+	bdev_io = spdk_bdev_io_from_ctx(raid_io);
+
+	return bdev_io->u.bdev.offset_blocks + bdev_io->u.bdev.num_blocks <= base_info->rebuild_offset;
+}
+
+typedef void (*raid_bdev_quiesce_cb)(void *cb_arg, int status);
+
+int raid_bdev_quiesce_range(struct raid_bdev *raid_bdev, uint64_t offset_blocks,
+			    uint64_t num_blocks, raid_bdev_quiesce_cb cb_fn, void *cb_arg);
+int raid_bdev_unquiesce_range(struct raid_bdev *raid_bdev, raid_bdev_quiesce_cb cb_fn,
+			      void *cb_arg);
+
+typedef void (*raid_bdev_rebuild_cb)(void *cb_arg);
+
+int raid_bdev_rebuild_start(struct raid_bdev *raid_bdev, uint8_t idx);
+void raid_bdev_rebuild_stop(struct raid_bdev *raid_bdev, raid_bdev_rebuild_cb cb_fn,
+			    void *cb_arg);
+void raid_bdev_rebuild_dump_info_json(struct raid_bdev *raid_bdev,
+				      struct spdk_json_write_ctx *w);
+void raid_bdev_fail_base_bdev(struct raid_base_bdev_info *base_info);
+
 #endif /* SPDK_BDEV_RAID_INTERNAL_H */
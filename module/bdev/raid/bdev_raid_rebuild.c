@@ -0,0 +1,621 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bdev_raid.h"
+
+#include "spdk/env.h"
+#include "spdk/thread.h"
+#include "spdk/json.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+#include "spdk/xor.h"
+
+#include "spdk/log.h"
+
+/*
+ * The rebuild walks the base bdev being rebuilt in windows of a few strips.
+ * Each window is rebuilt with the matching range of the raid bdev quiesced, so
+ * the writes of the raid bdev can't race with it. The data of the window is
+ * read from the source base bdevs, XORed together and written to the target.
+ * The offset up to which the target is rebuilt is the checkpoint, it moves
+ * only when the write of a window is completed. Blocks of the raid bdev below
+ * the checkpoint are read from the target, the rest is treated as missing.
+ */
+
+/* Minimum size of a rebuild window on the base bdevs */
+#define RAID_REBUILD_WINDOW_SIZE	(256 * 1024)
+
+/* Period of the rebuild poller, also the time slice of the bandwidth limit */
+#define RAID_REBUILD_TIMESLICE_USEC	1000
+
+/* A window is retried that many times before the rebuild is aborted */
+#define RAID_REBUILD_MAX_RETRIES	3
+
+struct raid_bdev_rebuild {
+	struct raid_bdev		*raid_bdev;
+
+	/* Thread the rebuild runs on */
+	struct spdk_thread		*thread;
+
+	/* Base bdev being rebuilt and the base bdevs its data is rebuilt from */
+	uint8_t				target;
+	uint8_t				*sources;
+	uint8_t				num_sources;
+
+	/* Raid bdev io channel used for the base bdev I/O */
+	struct spdk_io_channel		*ch;
+	struct raid_bdev_io_channel	*raid_ch;
+
+	/* Checkpoint, the base bdev blocks below it are rebuilt */
+	uint64_t			offset_blocks;
+
+	/* Number of blocks to rebuild on the base bdev */
+	uint64_t			num_blocks;
+
+	/* Size of a window, and of the window in progress, in base bdev blocks */
+	uint64_t			window_blocks;
+	uint64_t			cur_blocks;
+
+	/* One window sized buffer per source, and one for the target if needed */
+	void				**bufs;
+	void				*target_buf;
+
+	/* Base bdev I/O of the current stage of the window */
+	bool				writing;
+	uint8_t				ios_total;
+	uint8_t				ios_submitted;
+	uint8_t				ios_remaining;
+	bool				ios_failed;
+	struct spdk_bdev_io_wait_entry	waitq_entry;
+
+	/* A window is in progress */
+	bool				busy;
+	uint32_t			retries;
+
+	/* Bandwidth limit, bytes that can be rebuilt until the next time slice */
+	int64_t				quota_bytes;
+	uint64_t			last_timeslice_tsc;
+	struct spdk_poller		*poller;
+
+	uint64_t			start_tsc;
+
+	/* Set when the rebuild is stopped, it's freed after the window in progress */
+	bool				stopping;
+	raid_bdev_rebuild_cb		stop_cb;
+	void				*stop_cb_arg;
+};
+
+static void raid_rebuild_submit_ios(struct raid_bdev_rebuild *rebuild);
+static void raid_rebuild_try_window(struct raid_bdev_rebuild *rebuild);
+
+static void
+raid_rebuild_free(struct raid_bdev_rebuild *rebuild)
+{
+	uint8_t i;
+
+	if (rebuild->bufs != NULL) {
+		for (i = 0; i < rebuild->num_sources; i++) {
+			spdk_dma_free(rebuild->bufs[i]);
+		}
+		free(rebuild->bufs);
+	}
+	if (rebuild->num_sources > 1) {
+		spdk_dma_free(rebuild->target_buf);
+	}
+	if (rebuild->ch != NULL) {
+		spdk_put_io_channel(rebuild->ch);
+	}
+	spdk_poller_unregister(&rebuild->poller);
+	free(rebuild->sources);
+	free(rebuild);
+}
+
+/* End the rebuild, successfully if the whole base bdev is rebuilt */
+static void
+raid_rebuild_finish(struct raid_bdev_rebuild *rebuild)
+{
+	struct raid_bdev *raid_bdev = rebuild->raid_bdev;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[rebuild->target];
+	raid_bdev_rebuild_cb stop_cb = rebuild->stop_cb;
+	void *stop_cb_arg = rebuild->stop_cb_arg;
+	bool failed = false;
+	uint64_t ticks;
+
+	assert(raid_bdev->rebuild == rebuild);
+	raid_bdev->rebuild = NULL;
+
+	if (rebuild->offset_blocks == rebuild->num_blocks) {
+		ticks = spdk_get_ticks() - rebuild->start_tsc;
+		SPDK_NOTICELOG("Rebuild of base bdev %s on raid bdev %s completed in %" PRIu64 " ms\n",
+			       base_info->bdev->name, raid_bdev->bdev.name,
+			       ticks * 1000 / spdk_get_ticks_hz());
+		base_info->rebuilding = false;
+	} else if (rebuild->stopping) {
+		SPDK_NOTICELOG("Rebuild of base bdev %s on raid bdev %s stopped at block %" PRIu64
+			       " of %" PRIu64 "\n", base_info->bdev->name, raid_bdev->bdev.name,
+			       rebuild->offset_blocks, rebuild->num_blocks);
+	} else {
+		SPDK_ERRLOG("Rebuild of base bdev %s on raid bdev %s failed at block %" PRIu64 "\n",
+			    base_info->bdev->name, raid_bdev->bdev.name, rebuild->offset_blocks);
+		failed = true;
+	}
+
+	raid_rebuild_free(rebuild);
+
+	if (failed) {
+		/* The target can't be rebuilt, don't keep it around half written */
+		raid_bdev_fail_base_bdev(base_info);
+	}
+
+	if (stop_cb != NULL) {
+		stop_cb(stop_cb_arg);
+	}
+}
+
+static void
+raid_rebuild_window_unquiesced(void *cb_arg, int status)
+{
+	struct raid_bdev_rebuild *rebuild = cb_arg;
+
+	rebuild->busy = false;
+
+	raid_rebuild_try_window(rebuild);
+}
+
+static void
+raid_rebuild_window_done(struct raid_bdev_rebuild *rebuild, int status)
+{
+	struct raid_bdev *raid_bdev = rebuild->raid_bdev;
+	int rc;
+
+	if (status == 0) {
+		rebuild->offset_blocks += rebuild->cur_blocks;
+		rebuild->retries = 0;
+		/* Reads of the rebuilt blocks can go to the target from now on */
+		raid_bdev->base_bdev_info[rebuild->target].rebuild_offset =
+			rebuild->offset_blocks * raid_bdev->data_width;
+	} else {
+		SPDK_ERRLOG("Failed to rebuild blocks %" PRIu64 "-%" PRIu64 " of base bdev %u on raid bdev %s\n",
+			    rebuild->offset_blocks, rebuild->offset_blocks + rebuild->cur_blocks - 1,
+			    rebuild->target, raid_bdev->bdev.name);
+		rebuild->retries++;
+	}
+
+	rc = raid_bdev_unquiesce_range(raid_bdev, raid_rebuild_window_unquiesced, rebuild);
+	if (rc != 0) {
+		/* The queued I/Os would never be resubmitted, so there's no way to go on */
+		SPDK_ERRLOG("Failed to unquiesce raid bdev %s: %s\n", raid_bdev->bdev.name,
+			    spdk_strerror(-rc));
+		assert(false);
+	}
+}
+
+static void
+raid_rebuild_ios_done(struct raid_bdev_rebuild *rebuild)
+{
+	if (rebuild->ios_failed) {
+		raid_rebuild_window_done(rebuild, -EIO);
+		return;
+	}
+
+	if (rebuild->writing) {
+		raid_rebuild_window_done(rebuild, 0);
+		return;
+	}
+
+	/* All sources are read, calculate the target data and write it */
+	if (rebuild->num_sources > 1) {
+		if (spdk_xor_gen(rebuild->target_buf, rebuild->bufs, rebuild->num_sources,
+				 rebuild->cur_blocks * rebuild->raid_bdev->bdev.blocklen) != 0) {
+			raid_rebuild_window_done(rebuild, -EINVAL);
+			return;
+		}
+	}
+
+	rebuild->writing = true;
+	rebuild->ios_total = 1;
+	rebuild->ios_submitted = 0;
+	rebuild->ios_remaining = 1;
+	raid_rebuild_submit_ios(rebuild);
+}
+
+static void
+raid_rebuild_io_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_rebuild *rebuild = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (!success) {
+		rebuild->ios_failed = true;
+	}
+
+	assert(rebuild->ios_remaining > 0);
+	if (--rebuild->ios_remaining == 0) {
+		raid_rebuild_ios_done(rebuild);
+	}
+}
+
+static void
+_raid_rebuild_submit_ios(void *ctx)
+{
+	raid_rebuild_submit_ios(ctx);
+}
+
+/*
+ * Submit the base bdev I/O of the current stage, the reads of the sources or
+ * the write of the target. Resumes from ios_submitted after -ENOMEM.
+ */
+static void
+raid_rebuild_submit_ios(struct raid_bdev_rebuild *rebuild)
+{
+	struct raid_bdev *raid_bdev = rebuild->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	uint64_t offset_blocks = rebuild->offset_blocks;
+	uint64_t num_blocks = rebuild->cur_blocks;
+	uint8_t idx;
+	int ret;
+
+	while (rebuild->ios_submitted < rebuild->ios_total) {
+		if (rebuild->writing) {
+			idx = rebuild->target;
+		} else {
+			idx = rebuild->sources[rebuild->ios_submitted];
+		}
+		base_info = &raid_bdev->base_bdev_info[idx];
+		base_ch = rebuild->raid_ch->base_channel[idx];
+
+		if (base_ch == NULL) {
+			ret = -ENODEV;
+		} else if (rebuild->writing) {
+			ret = spdk_bdev_write_blocks(base_info->desc, base_ch, rebuild->target_buf,
+						     offset_blocks, num_blocks,
+						     raid_rebuild_io_complete, rebuild);
+		} else {
+			ret = spdk_bdev_read_blocks(base_info->desc, base_ch,
+						    rebuild->bufs[rebuild->ios_submitted],
+						    offset_blocks, num_blocks,
+						    raid_rebuild_io_complete, rebuild);
+		}
+
+		if (ret == 0) {
+			rebuild->ios_submitted++;
+		} else if (ret == -ENOMEM) {
+			rebuild->waitq_entry.bdev = base_info->bdev;
+			rebuild->waitq_entry.cb_fn = _raid_rebuild_submit_ios;
+			rebuild->waitq_entry.cb_arg = rebuild;
+			spdk_bdev_queue_io_wait(base_info->bdev, base_ch, &rebuild->waitq_entry);
+			return;
+		} else {
+			/* Wait for the submitted I/O, if any, and fail the window */
+			rebuild->ios_failed = true;
+			rebuild->ios_remaining -= rebuild->ios_total - rebuild->ios_submitted;
+			rebuild->ios_submitted = rebuild->ios_total;
+			if (rebuild->ios_remaining == 0) {
+				raid_rebuild_ios_done(rebuild);
+			}
+			return;
+		}
+	}
+}
+
+static void
+raid_rebuild_window_quiesced(void *cb_arg, int status)
+{
+	struct raid_bdev_rebuild *rebuild = cb_arg;
+
+	if (status != 0) {
+		raid_rebuild_window_done(rebuild, status);
+		return;
+	}
+
+	rebuild->writing = false;
+	rebuild->ios_failed = false;
+	rebuild->ios_total = rebuild->num_sources;
+	rebuild->ios_submitted = 0;
+	rebuild->ios_remaining = rebuild->num_sources;
+	raid_rebuild_submit_ios(rebuild);
+}
+
+static void
+raid_rebuild_start_window(struct raid_bdev_rebuild *rebuild)
+{
+	struct raid_bdev *raid_bdev = rebuild->raid_bdev;
+	int rc;
+
+	rebuild->cur_blocks = spdk_min(rebuild->window_blocks,
+				       rebuild->num_blocks - rebuild->offset_blocks);
+	rebuild->busy = true;
+
+	/* The window is aligned to strips, so it matches whole rows of the raid bdev */
+	rc = raid_bdev_quiesce_range(raid_bdev, rebuild->offset_blocks * raid_bdev->data_width,
+				     rebuild->cur_blocks * raid_bdev->data_width,
+				     raid_rebuild_window_quiesced, rebuild);
+	if (rc != 0) {
+		/* Retry on the next poll */
+		rebuild->busy = false;
+	}
+}
+
+/* Refill the bandwidth quota for the time slices elapsed since the last refill */
+static void
+raid_rebuild_update_quota(struct raid_bdev_rebuild *rebuild, uint64_t max_bw_mb_sec)
+{
+	uint64_t now = spdk_get_ticks();
+	uint64_t timeslice_ticks = spdk_get_ticks_hz() * RAID_REBUILD_TIMESLICE_USEC / SPDK_SEC_TO_USEC;
+	uint64_t timeslice_bytes = max_bw_mb_sec * 1024 * 1024 * RAID_REBUILD_TIMESLICE_USEC /
+				   SPDK_SEC_TO_USEC;
+	uint64_t timeslices;
+
+	timeslice_ticks = spdk_max(timeslice_ticks, 1);
+	timeslices = (now - rebuild->last_timeslice_tsc) / timeslice_ticks;
+	if (timeslices == 0) {
+		return;
+	}
+
+	rebuild->last_timeslice_tsc += timeslices * timeslice_ticks;
+
+	/* Pay back what previous windows overdrew, but don't save up more than one time slice */
+	rebuild->quota_bytes = spdk_min(rebuild->quota_bytes + (int64_t)(timeslices * timeslice_bytes),
+					(int64_t)timeslice_bytes);
+}
+
+/* Start the next window if the bandwidth limit allows it */
+static void
+raid_rebuild_try_window(struct raid_bdev_rebuild *rebuild)
+{
+	struct raid_bdev_opts opts;
+
+	if (rebuild->busy) {
+		return;
+	}
+
+	if (rebuild->stopping || rebuild->retries > RAID_REBUILD_MAX_RETRIES ||
+	    rebuild->offset_blocks == rebuild->num_blocks) {
+		raid_rebuild_finish(rebuild);
+		return;
+	}
+
+	raid_bdev_get_opts(&opts);
+	if (opts.rebuild_max_bandwidth_mb_sec != 0) {
+		raid_rebuild_update_quota(rebuild, opts.rebuild_max_bandwidth_mb_sec);
+		if (rebuild->quota_bytes <= 0) {
+			return;
+		}
+		/* The quota may go negative, the next windows wait until it's paid back */
+		rebuild->quota_bytes -= spdk_min(rebuild->window_blocks,
+						 rebuild->num_blocks - rebuild->offset_blocks) *
+					rebuild->raid_bdev->bdev.blocklen;
+	}
+
+	raid_rebuild_start_window(rebuild);
+}
+
+static int
+raid_rebuild_poll(void *arg)
+{
+	struct raid_bdev_rebuild *rebuild = arg;
+
+	if (rebuild->busy) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	raid_rebuild_try_window(rebuild);
+
+	return SPDK_POLLER_BUSY;
+}
+
+/*
+ * brief:
+ * raid_bdev_rebuild_start starts rebuilding a base bdev of an online raid bdev
+ * from the other base bdevs. The base bdev must be open and its rebuilding
+ * flag set, with the channels of the raid bdev holding its channel. The
+ * rebuild runs on the current thread.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * idx - index of the base bdev to rebuild
+ * returns:
+ * 0 - success
+ * non zero - failure
+ */
+int
+raid_bdev_rebuild_start(struct raid_bdev *raid_bdev, uint8_t idx)
+{
+	struct raid_bdev_rebuild *rebuild;
+	struct raid_base_bdev_info *base_info = &raid_bdev->base_bdev_info[idx];
+	uint64_t buf_size;
+	uint8_t i;
+
+	assert(raid_bdev->state == RAID_BDEV_STATE_ONLINE);
+	assert(base_info->rebuilding);
+
+	if (raid_bdev->rebuild != NULL) {
+		return -EBUSY;
+	}
+
+	if (raid_bdev->module->get_rebuild_sources == NULL || raid_bdev->data_width == 0) {
+		return -ENOTSUP;
+	}
+
+	rebuild = calloc(1, sizeof(*rebuild));
+	if (rebuild == NULL) {
+		return -ENOMEM;
+	}
+
+	rebuild->raid_bdev = raid_bdev;
+	rebuild->thread = spdk_get_thread();
+	rebuild->target = idx;
+
+	rebuild->sources = calloc(raid_bdev->num_base_bdevs, sizeof(uint8_t));
+	if (rebuild->sources == NULL) {
+		goto err;
+	}
+
+	rebuild->num_sources = raid_bdev->module->get_rebuild_sources(raid_bdev, idx, rebuild->sources);
+	if (rebuild->num_sources == 0) {
+		free(rebuild->sources);
+		free(rebuild);
+		return -ENODEV;
+	}
+
+	for (i = 0; i < rebuild->num_sources; i++) {
+		struct raid_base_bdev_info *src = &raid_bdev->base_bdev_info[rebuild->sources[i]];
+
+		assert(rebuild->sources[i] != idx);
+		if (src->desc == NULL || src->remove_scheduled || src->rebuilding) {
+			SPDK_ERRLOG("Base bdev %u of raid bdev %s can't be rebuilt, source base bdev %u is missing\n",
+				    idx, raid_bdev->bdev.name, rebuild->sources[i]);
+			free(rebuild->sources);
+			free(rebuild);
+			return -ENODEV;
+		}
+	}
+
+	/* Whole strips, so that a window maps to whole rows of the raid bdev */
+	rebuild->window_blocks = spdk_max(raid_bdev->strip_size, 1);
+	rebuild->window_blocks *= spdk_divide_round_up(RAID_REBUILD_WINDOW_SIZE,
+				  rebuild->window_blocks * raid_bdev->bdev.blocklen);
+	rebuild->num_blocks = raid_bdev->bdev.blockcnt / raid_bdev->data_width;
+	buf_size = rebuild->window_blocks * raid_bdev->bdev.blocklen;
+
+	rebuild->bufs = calloc(rebuild->num_sources, sizeof(void *));
+	if (rebuild->bufs == NULL) {
+		goto err;
+	}
+
+	for (i = 0; i < rebuild->num_sources; i++) {
+		rebuild->bufs[i] = spdk_dma_malloc(buf_size, spdk_xor_get_optimal_alignment(), NULL);
+		if (rebuild->bufs[i] == NULL) {
+			goto err;
+		}
+	}
+
+	if (rebuild->num_sources > 1) {
+		rebuild->target_buf = spdk_dma_malloc(buf_size, spdk_xor_get_optimal_alignment(), NULL);
+		if (rebuild->target_buf == NULL) {
+			goto err;
+		}
+	} else {
+		/* A single source is just copied */
+		rebuild->target_buf = rebuild->bufs[0];
+	}
+
+	rebuild->ch = spdk_get_io_channel(raid_bdev);
+	if (rebuild->ch == NULL) {
+		goto err;
+	}
+	rebuild->raid_ch = spdk_io_channel_get_ctx(rebuild->ch);
+
+	rebuild->poller = SPDK_POLLER_REGISTER(raid_rebuild_poll, rebuild, RAID_REBUILD_TIMESLICE_USEC);
+	if (rebuild->poller == NULL) {
+		goto err;
+	}
+
+	rebuild->start_tsc = spdk_get_ticks();
+	rebuild->last_timeslice_tsc = rebuild->start_tsc;
+	base_info->rebuild_offset = 0;
+	raid_bdev->rebuild = rebuild;
+
+	SPDK_NOTICELOG("Rebuilding base bdev %s on raid bdev %s from %u base bdevs\n",
+		       base_info->bdev->name, raid_bdev->bdev.name, rebuild->num_sources);
+
+	raid_rebuild_try_window(rebuild);
+
+	return 0;
+err:
+	raid_rebuild_free(rebuild);
+	return -ENOMEM;
+}
+
+/*
+ * brief:
+ * raid_bdev_rebuild_stop stops the rebuild of a raid bdev. The rebuilt blocks
+ * stay valid, but the base bdev is not used for the rest. The callback is
+ * called when the window in progress is done and the rebuild is freed, right
+ * away if there is no rebuild.
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * cb_fn - callback function
+ * cb_arg - argument to callback function
+ * returns:
+ * none
+ */
+void
+raid_bdev_rebuild_stop(struct raid_bdev *raid_bdev, raid_bdev_rebuild_cb cb_fn, void *cb_arg)
+{
+	struct raid_bdev_rebuild *rebuild = raid_bdev->rebuild;
+
+	if (rebuild == NULL) {
+		cb_fn(cb_arg);
+		return;
+	}
+
+	assert(rebuild->thread == spdk_get_thread());
+	assert(!rebuild->stopping);
+
+	rebuild->stopping = true;
+	rebuild->stop_cb = cb_fn;
+	rebuild->stop_cb_arg = cb_arg;
+
+	if (!rebuild->busy) {
+		raid_rebuild_finish(rebuild);
+	}
+}
+
+/*
+ * brief:
+ * raid_bdev_rebuild_dump_info_json writes the progress of the rebuild of a raid
+ * bdev, if there is one
+ * params:
+ * raid_bdev - pointer to raid bdev
+ * w - pointer to json context
+ * returns:
+ * none
+ */
+void
+raid_bdev_rebuild_dump_info_json(struct raid_bdev *raid_bdev, struct spdk_json_write_ctx *w)
+{
+	struct raid_bdev_rebuild *rebuild = raid_bdev->rebuild;
+
+	if (rebuild == NULL) {
+		return;
+	}
+
+	spdk_json_write_named_object_begin(w, "rebuild");
+	spdk_json_write_named_string(w, "base_bdev",
+				     raid_bdev->base_bdev_info[rebuild->target].bdev->name);
+	spdk_json_write_named_uint64(w, "rebuilt_blocks", rebuild->offset_blocks);
+	spdk_json_write_named_uint64(w, "total_blocks", rebuild->num_blocks);
+	spdk_json_write_object_end(w);
+}
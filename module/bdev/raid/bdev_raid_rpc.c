@@ -442,3 +442,132 @@ cleanup:
 }
 SPDK_RPC_REGISTER("bdev_raid_delete", rpc_bdev_raid_delete, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_raid_delete, destroy_raid_bdev)
+
+/*
+ * Input structure for RPC bdev_raid_add_base_bdev
+ */
+struct rpc_bdev_raid_add_base_bdev {
+	/* raid bdev name */
+	char *raid_bdev;
+
+	/* name of the bdev replacing the missing base bdev */
+	char *base_bdev;
+};
+
+/*
+ * brief:
+ * free_rpc_bdev_raid_add_base_bdev function is used to free RPC bdev_raid_add_base_bdev
+ * related parameters
+ * params:
+ * req - pointer to RPC request
+ * returns:
+ * none
+ */
+static void
+free_rpc_bdev_raid_add_base_bdev(struct rpc_bdev_raid_add_base_bdev *req)
+{
+	free(req->raid_bdev);
+	free(req->base_bdev);
+}
+
+/*
+ * Decoder object for RPC bdev_raid_add_base_bdev
+ */
+static const struct spdk_json_object_decoder rpc_bdev_raid_add_base_bdev_decoders[] = {
+	{"raid_bdev", offsetof(struct rpc_bdev_raid_add_base_bdev, raid_bdev), spdk_json_decode_string},
+	{"base_bdev", offsetof(struct rpc_bdev_raid_add_base_bdev, base_bdev), spdk_json_decode_string},
+};
+
+/*
+ * brief:
+ * rpc_bdev_raid_add_base_bdev function is the RPC for replacing a missing base
+ * bdev of a degraded raid bdev. The new base bdev is rebuilt in the background
+ * while the raid bdev stays online.
+ * params:
+ * request - pointer to json rpc request
+ * params - pointer to request parameters
+ * returns:
+ * none
+ */
+static void
+rpc_bdev_raid_add_base_bdev(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	struct rpc_bdev_raid_add_base_bdev	req = {};
+	struct raid_bdev_config			*raid_cfg;
+	int					rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_raid_add_base_bdev_decoders,
+				    SPDK_COUNTOF(rpc_bdev_raid_add_base_bdev_decoders),
+				    &req)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	raid_cfg = raid_bdev_config_find_by_name(req.raid_bdev);
+	if (raid_cfg == NULL) {
+		spdk_jsonrpc_send_error_response_fmt(request, -ENODEV,
+						     "raid bdev %s is not found in config",
+						     req.raid_bdev);
+		goto cleanup;
+	}
+
+	rc = raid_bdev_replace_base_device(raid_cfg, req.base_bdev);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, rc,
+						     "Failed to add base bdev %s to RAID bdev %s: %s",
+						     req.base_bdev, req.raid_bdev, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+
+cleanup:
+	free_rpc_bdev_raid_add_base_bdev(&req);
+}
+SPDK_RPC_REGISTER("bdev_raid_add_base_bdev", rpc_bdev_raid_add_base_bdev, SPDK_RPC_RUNTIME)
+
+/*
+ * Decoder object for RPC bdev_raid_set_options
+ */
+static const struct spdk_json_object_decoder rpc_bdev_raid_set_options_decoders[] = {
+	{"rebuild_max_bandwidth_mb_sec", offsetof(struct raid_bdev_opts, rebuild_max_bandwidth_mb_sec), spdk_json_decode_uint64, true},
+};
+
+/*
+ * brief:
+ * rpc_bdev_raid_set_options function is the RPC for setting the options of the
+ * raid bdev module.
+ * params:
+ * request - pointer to json rpc request
+ * params - pointer to request parameters
+ * returns:
+ * none
+ */
+static void
+rpc_bdev_raid_set_options(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct raid_bdev_opts	opts;
+	int			rc;
+
+	raid_bdev_get_opts(&opts);
+	if (params && spdk_json_decode_object(params, rpc_bdev_raid_set_options_decoders,
+					      SPDK_COUNTOF(rpc_bdev_raid_set_options_decoders),
+					      &opts)) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "spdk_json_decode_object failed");
+		return;
+	}
+
+	rc = raid_bdev_set_opts(&opts);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+SPDK_RPC_REGISTER("bdev_raid_set_options", rpc_bdev_raid_set_options,
+		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
@@ -156,102 +156,6 @@ raid0_submit_rw_request(struct raid_bdev_io *raid_io)
 	}
 }
 
-/* raid0 IO range */
-struct raid_bdev_io_range {
-	uint64_t	strip_size;
-	uint64_t	start_strip_in_disk;
-	uint64_t	end_strip_in_disk;
-	uint64_t	start_offset_in_strip;
-	uint64_t	end_offset_in_strip;
-	uint8_t		start_disk;
-	uint8_t		end_disk;
-	uint8_t		n_disks_involved;
-};
-
-static inline void
-_raid0_get_io_range(struct raid_bdev_io_range *io_range,
-		    uint8_t num_base_bdevs, uint64_t strip_size, uint64_t strip_size_shift,
-		    uint64_t offset_blocks, uint64_t num_blocks)
-{
-	uint64_t	start_strip;
-	uint64_t	end_strip;
-
-	io_range->strip_size = strip_size;
-
-	/* The start and end strip index in raid0 bdev scope */
-	start_strip = offset_blocks >> strip_size_shift;
-	end_strip = (offset_blocks + num_blocks - 1) >> strip_size_shift;
-	io_range->start_strip_in_disk = start_strip / num_base_bdevs;
-	io_range->end_strip_in_disk = end_strip / num_base_bdevs;
-
-	/* The first strip may have unaligned start LBA offset.
-	 * The end strip may have unaligned end LBA offset.
-	 * Strips between them certainly have aligned offset and length to boundaries.
-	 */
-	io_range->start_offset_in_strip = offset_blocks % strip_size;
-	io_range->end_offset_in_strip = (offset_blocks + num_blocks - 1) % strip_size;
-
-	/* The base bdev indexes in which start and end strips are located */
-	io_range->start_disk = start_strip % num_base_bdevs;
-	io_range->end_disk = end_strip % num_base_bdevs;
-
-	/* Calculate how many base_bdevs are involved in io operation.
-	 * Number of base bdevs involved is between 1 and num_base_bdevs.
-	 * It will be 1 if the first strip and last strip are the same one.
-	 */
-	io_range->n_disks_involved = spdk_min((end_strip - start_strip + 1), num_base_bdevs);
-}
-
-static inline void
-_raid0_split_io_range(struct raid_bdev_io_range *io_range, uint8_t disk_idx,
-		      uint64_t *_offset_in_disk, uint64_t *_nblocks_in_disk)
-{
-	uint64_t n_strips_in_disk;
-	uint64_t start_offset_in_disk;
-	uint64_t end_offset_in_disk;
-	uint64_t offset_in_disk;
-	uint64_t nblocks_in_disk;
-	uint64_t start_strip_in_disk;
-	uint64_t end_strip_in_disk;
-
-	start_strip_in_disk = io_range->start_strip_in_disk;
-	if (disk_idx < io_range->start_disk) {
-		start_strip_in_disk += 1;
-	}
-
-	end_strip_in_disk = io_range->end_strip_in_disk;
-	if (disk_idx > io_range->end_disk) {
-		end_strip_in_disk -= 1;
-	}
-
-	assert(end_strip_in_disk >= start_strip_in_disk);
-	n_strips_in_disk = end_strip_in_disk - start_strip_in_disk + 1;
-
-	if (disk_idx == io_range->start_disk) {
-		start_offset_in_disk = io_range->start_offset_in_strip;
-	} else {
-		start_offset_in_disk = 0;
-	}
-
-	if (disk_idx == io_range->end_disk) {
-		end_offset_in_disk = io_range->end_offset_in_strip;
-	} else {
-		end_offset_in_disk = io_range->strip_size - 1;
-	}
-
-	offset_in_disk = start_offset_in_disk + start_strip_in_disk * io_range->strip_size;
-	nblocks_in_disk = (n_strips_in_disk - 1) * io_range->strip_size
-			  + end_offset_in_disk - start_offset_in_disk + 1;
-
-	SPDK_DEBUGLOG(bdev_raid0,
-		      "raid_bdev (strip_size 0x%" PRIx64 ") splits IO to base_bdev (%u) at (0x%" PRIx64 ", 0x%" PRIx64
-		      ").\n",
-		      io_range->strip_size, disk_idx, offset_in_disk, nblocks_in_disk);
-
-	*_offset_in_disk = offset_in_disk;
-	*_nblocks_in_disk = nblocks_in_disk;
-}
-
 static void
 raid0_submit_null_payload_request(struct raid_bdev_io *raid_io);
 
@@ -0,0 +1,529 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bdev_raid.h"
+
+#include "spdk/env.h"
+#include "spdk/thread.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+#include "spdk/log.h"
+
+/*
+ * RAID1 mirrors the data on all base bdevs. RAID10 groups the base bdevs into
+ * mirror groups of RAID10_MIRRORS consecutive base bdevs and stripes the data
+ * across the groups the same way RAID0 stripes it across base bdevs.
+ */
+#define RAID10_MIRRORS 2
+
+static inline uint8_t
+raid1_num_mirrors(const struct raid_bdev *raid_bdev)
+{
+	return raid_bdev->level == RAID10 ? RAID10_MIRRORS : raid_bdev->num_base_bdevs;
+}
+
+static inline uint8_t
+raid1_num_groups(const struct raid_bdev *raid_bdev)
+{
+	return raid_bdev->num_base_bdevs / raid1_num_mirrors(raid_bdev);
+}
+
+/*
+ * Get the range of mirror groups touched by an I/O. A single mirror group is
+ * not striped, so the range covers the I/O as is.
+ */
+static void
+raid1_get_io_range(struct raid_bdev *raid_bdev, struct raid_bdev_io_range *io_range,
+		   uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint8_t num_groups = raid1_num_groups(raid_bdev);
+
+	if (num_groups > 1) {
+		_raid0_get_io_range(io_range, num_groups, raid_bdev->strip_size,
+				    raid_bdev->strip_size_shift, offset_blocks, num_blocks);
+		return;
+	}
+
+	memset(io_range, 0, sizeof(*io_range));
+	io_range->start_offset_in_strip = offset_blocks;
+	io_range->end_offset_in_strip = offset_blocks + num_blocks - 1;
+	io_range->n_disks_involved = 1;
+}
+
+static void
+raid1_split_io_range(struct raid_bdev *raid_bdev, struct raid_bdev_io_range *io_range,
+		     uint8_t group, uint64_t *offset_in_disk, uint64_t *nblocks_in_disk)
+{
+	if (raid1_num_groups(raid_bdev) > 1) {
+		_raid0_split_io_range(io_range, group, offset_in_disk, nblocks_in_disk);
+		return;
+	}
+
+	*offset_in_disk = io_range->start_offset_in_strip;
+	*nblocks_in_disk = io_range->end_offset_in_strip - io_range->start_offset_in_strip + 1;
+}
+
+/* Count the base bdevs of a mirror group that can take writes */
+static uint8_t
+raid1_num_present_mirrors(struct raid_bdev_io_channel *raid_ch, uint8_t first, uint8_t count)
+{
+	uint8_t i, num = 0;
+
+	for (i = first; i < first + count; i++) {
+		if (raid_ch->base_channel[i] != NULL) {
+			num++;
+		}
+	}
+
+	return num;
+}
+
+/*
+ * Pick the mirror with the fewest reads outstanding on this channel, so that
+ * reads are spread over all the copies in proportion to how fast each of them
+ * completes I/O. Mirrors being rebuilt are used only for the rebuilt blocks.
+ */
+static uint8_t
+raid1_select_read_mirror(struct raid_bdev_io *raid_io, uint8_t first, uint8_t mirrors)
+{
+	struct raid_bdev_io_channel *raid_ch = raid_io->raid_ch;
+	uint64_t min_outstanding = UINT64_MAX;
+	uint8_t idx = UINT8_MAX;
+	uint8_t i;
+
+	for (i = first; i < first + mirrors; i++) {
+		if (!raid_bdev_io_base_bdev_valid(raid_io, i)) {
+			continue;
+		}
+
+		if (raid_ch->base_channel_outstanding[i] < min_outstanding) {
+			min_outstanding = raid_ch->base_channel_outstanding[i];
+			idx = i;
+		}
+	}
+
+	return idx;
+}
+
+static void
+raid1_base_io_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	spdk_bdev_free_io(bdev_io);
+
+	raid_bdev_io_complete_part(raid_io, 1, success ?
+				   SPDK_BDEV_IO_STATUS_SUCCESS :
+				   SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+/*
+ * Reads are counted by the index of the mirror they went to, which stays valid
+ * even if the base bdev is removed while the read is outstanding. Writes go to
+ * every mirror alike, so only reads are counted.
+ */
+static void
+raid1_read_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct raid_bdev_io *raid_io = cb_arg;
+
+	assert(raid_io->raid_ch->base_channel_outstanding[raid_io->base_bdev_io_idx] > 0);
+	raid_io->raid_ch->base_channel_outstanding[raid_io->base_bdev_io_idx]--;
+
+	raid1_base_io_complete(bdev_io, success, cb_arg);
+}
+
+/*
+ * Fail the part of the raid_io that was not submitted yet. The raid_io
+ * completes once the base bdev I/Os already submitted are done.
+ */
+static void
+raid1_fail_unsubmitted(struct raid_bdev_io *raid_io, uint64_t unsubmitted)
+{
+	SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+	assert(false);
+	raid_bdev_io_complete_part(raid_io, unsubmitted, SPDK_BDEV_IO_STATUS_FAILED);
+}
+
+static void
+raid1_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid1_submit_rw_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid1_submit_rw_request(raid_io);
+}
+
+static void
+raid1_submit_read_request(struct raid_bdev_io *raid_io, uint8_t first, uint8_t mirrors,
+			  uint64_t pd_lba, uint64_t pd_blocks)
+{
+	struct spdk_bdev_io		*bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev_io_channel	*raid_ch = raid_io->raid_ch;
+	struct raid_base_bdev_info	*base_info;
+	struct spdk_io_channel		*base_ch;
+	uint8_t				idx;
+	int				ret;
+
+	idx = raid1_select_read_mirror(raid_io, first, mirrors);
+	if (idx == UINT8_MAX) {
+		SPDK_ERRLOG("No base bdev available to read from\n");
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	base_info = &raid_io->raid_bdev->base_bdev_info[idx];
+	base_ch = raid_ch->base_channel[idx];
+
+	raid_io->base_bdev_io_remaining = 1;
+	ret = spdk_bdev_readv_blocks(base_info->desc, base_ch,
+				     bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+				     pd_lba, pd_blocks, raid1_read_complete, raid_io);
+	if (ret == 0) {
+		raid_io->base_bdev_io_idx = idx;
+		raid_ch->base_channel_outstanding[idx]++;
+	} else if (ret == -ENOMEM) {
+		raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+					_raid1_submit_rw_request);
+	} else {
+		raid1_fail_unsubmitted(raid_io, 1);
+	}
+}
+
+static void
+raid1_submit_write_request(struct raid_bdev_io *raid_io, uint8_t first, uint8_t mirrors,
+			   uint64_t pd_lba, uint64_t pd_blocks)
+{
+	struct spdk_bdev_io		*bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev_io_channel	*raid_ch = raid_io->raid_ch;
+	struct raid_base_bdev_info	*base_info;
+	struct spdk_io_channel		*base_ch;
+	uint8_t				idx;
+	int				ret;
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_io->base_bdev_io_remaining = raid1_num_present_mirrors(raid_ch, first, mirrors);
+		if (raid_io->base_bdev_io_remaining == 0) {
+			SPDK_ERRLOG("No base bdev available to write to\n");
+			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+			return;
+		}
+	}
+
+	/*
+	 * base_bdev_io_submitted is the position in the mirror group, including
+	 * missing mirrors. Mirrors being rebuilt get all the writes, the blocks
+	 * that are not rebuilt yet are overwritten by the rebuild later anyway.
+	 */
+	while (raid_io->base_bdev_io_submitted < mirrors) {
+		idx = first + raid_io->base_bdev_io_submitted;
+		base_info = &raid_io->raid_bdev->base_bdev_info[idx];
+		base_ch = raid_ch->base_channel[idx];
+
+		if (base_ch == NULL) {
+			raid_io->base_bdev_io_submitted++;
+			continue;
+		}
+
+		ret = spdk_bdev_writev_blocks(base_info->desc, base_ch,
+					      bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+					      pd_lba, pd_blocks, raid1_base_io_complete, raid_io);
+		if (ret == 0) {
+			raid_io->base_bdev_io_submitted++;
+		} else if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+						_raid1_submit_rw_request);
+			return;
+		} else {
+			raid1_fail_unsubmitted(raid_io, raid1_num_present_mirrors(raid_ch, idx, first + mirrors - idx));
+			return;
+		}
+	}
+}
+
+/*
+ * brief:
+ * raid1_submit_rw_request function is used to submit I/O to the mirror group
+ * the I/O maps to. Writes go to all the mirrors of the group, reads go to the
+ * mirror with the fewest outstanding reads on this channel.
+ * params:
+ * raid_io
+ * returns:
+ * none
+ */
+static void
+raid1_submit_rw_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io		*bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev		*raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_io_range	io_range;
+	uint8_t				mirrors = raid1_num_mirrors(raid_bdev);
+	uint8_t				group;
+	uint64_t			pd_lba;
+	uint64_t			pd_blocks;
+
+	raid1_get_io_range(raid_bdev, &io_range, bdev_io->u.bdev.offset_blocks,
+			   bdev_io->u.bdev.num_blocks);
+	if (io_range.n_disks_involved != 1) {
+		assert(false);
+		SPDK_ERRLOG("I/O spans strip boundary!\n");
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	group = io_range.start_disk;
+	raid1_split_io_range(raid_bdev, &io_range, group, &pd_lba, &pd_blocks);
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		raid1_submit_read_request(raid_io, group * mirrors, mirrors, pd_lba, pd_blocks);
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		raid1_submit_write_request(raid_io, group * mirrors, mirrors, pd_lba, pd_blocks);
+		break;
+	default:
+		SPDK_ERRLOG("Recvd not supported io type %u\n", bdev_io->type);
+		assert(0);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		break;
+	}
+}
+
+static void
+raid1_submit_null_payload_request(struct raid_bdev_io *raid_io);
+
+static void
+_raid1_submit_null_payload_request(void *_raid_io)
+{
+	struct raid_bdev_io *raid_io = _raid_io;
+
+	raid1_submit_null_payload_request(raid_io);
+}
+
+/*
+ * brief:
+ * raid1_submit_null_payload_request function submits requests without payload,
+ * like FLUSH and UNMAP, to all the mirrors of the mirror groups they touch;
+ * it will submit as many as possible unless one base io request fails with
+ * -ENOMEM, in which case it will queue itself for later submission.
+ * params:
+ * raid_io
+ * returns:
+ * none
+ */
+static void
+raid1_submit_null_payload_request(struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io		*bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev		*raid_bdev = raid_io->raid_bdev;
+	struct raid_bdev_io_channel	*raid_ch = raid_io->raid_ch;
+	struct raid_bdev_io_range	io_range;
+	uint8_t				mirrors = raid1_num_mirrors(raid_bdev);
+	uint8_t				num_groups = raid1_num_groups(raid_bdev);
+	struct raid_base_bdev_info	*base_info;
+	struct spdk_io_channel		*base_ch;
+	uint64_t			offset_in_disk;
+	uint64_t			nblocks_in_disk;
+	uint32_t			num_ios;
+	uint32_t			i;
+	uint8_t				group;
+	uint8_t				idx;
+	int				ret;
+
+	raid1_get_io_range(raid_bdev, &io_range, bdev_io->u.bdev.offset_blocks,
+			   bdev_io->u.bdev.num_blocks);
+
+	/* The I/O goes to every mirror of each group involved */
+	num_ios = (uint32_t)io_range.n_disks_involved * mirrors;
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		for (i = 0; i < io_range.n_disks_involved; i++) {
+			group = (io_range.start_disk + i) % num_groups;
+			raid_io->base_bdev_io_remaining += raid1_num_present_mirrors(raid_ch, group * mirrors,
+							   mirrors);
+		}
+		if (raid_io->base_bdev_io_remaining == 0) {
+			SPDK_ERRLOG("No base bdev available\n");
+			raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+			return;
+		}
+	}
+
+	/* num_ios can't exceed num_base_bdevs, so it fits in base_bdev_io_submitted */
+	while (raid_io->base_bdev_io_submitted < num_ios) {
+		i = raid_io->base_bdev_io_submitted;
+		group = (io_range.start_disk + i / mirrors) % num_groups;
+		idx = group * mirrors + i % mirrors;
+		base_info = &raid_bdev->base_bdev_info[idx];
+		base_ch = raid_ch->base_channel[idx];
+
+		if (base_ch == NULL) {
+			raid_io->base_bdev_io_submitted++;
+			continue;
+		}
+
+		raid1_split_io_range(raid_bdev, &io_range, group, &offset_in_disk, &nblocks_in_disk);
+
+		switch (bdev_io->type) {
+		case SPDK_BDEV_IO_TYPE_UNMAP:
+			ret = spdk_bdev_unmap_blocks(base_info->desc, base_ch,
+						     offset_in_disk, nblocks_in_disk,
+						     raid1_base_io_complete, raid_io);
+			break;
+
+		case SPDK_BDEV_IO_TYPE_FLUSH:
+			ret = spdk_bdev_flush_blocks(base_info->desc, base_ch,
+						     offset_in_disk, nblocks_in_disk,
+						     raid1_base_io_complete, raid_io);
+			break;
+
+		default:
+			SPDK_ERRLOG("submit request, invalid io type with null payload %u\n", bdev_io->type);
+			assert(false);
+			ret = -EIO;
+		}
+
+		if (ret == 0) {
+			raid_io->base_bdev_io_submitted++;
+		} else if (ret == -ENOMEM) {
+			raid_bdev_queue_io_wait(raid_io, base_info->bdev, base_ch,
+						_raid1_submit_null_payload_request);
+			return;
+		} else {
+			uint64_t unsubmitted = 0;
+
+			for (; i < num_ios; i++) {
+				group = (io_range.start_disk + i / mirrors) % num_groups;
+				if (raid_ch->base_channel[group * mirrors + i % mirrors] != NULL) {
+					unsubmitted++;
+				}
+			}
+			raid1_fail_unsubmitted(raid_io, unsubmitted);
+			return;
+		}
+	}
+}
+
+static int
+raid1_start(struct raid_bdev *raid_bdev)
+{
+	uint64_t min_blockcnt = UINT64_MAX;
+	uint8_t mirrors = raid1_num_mirrors(raid_bdev);
+	uint8_t num_groups;
+	struct raid_base_bdev_info *base_info;
+
+	if (raid_bdev->num_base_bdevs % mirrors != 0) {
+		SPDK_ERRLOG("Number of base bdevs of %s must be a multiple of %u\n",
+			    raid_bdev_level_to_str(raid_bdev->level), mirrors);
+		return -EINVAL;
+	}
+	num_groups = raid1_num_groups(raid_bdev);
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		/* Calculate minimum block count from all base bdevs */
+		min_blockcnt = spdk_min(min_blockcnt, base_info->bdev->blockcnt);
+	}
+
+	if (num_groups > 1) {
+		if (raid_bdev->strip_size == 0) {
+			SPDK_ERRLOG("Strip size must not be smaller than the block size\n");
+			return -EINVAL;
+		}
+
+		/* Each mirror group holds one strip of each stripe, like a base bdev in raid0 */
+		raid_bdev->bdev.blockcnt = ((min_blockcnt >> raid_bdev->strip_size_shift) <<
+					    raid_bdev->strip_size_shift) * num_groups;
+		raid_bdev->data_width = num_groups;
+		raid_bdev->bdev.optimal_io_boundary = raid_bdev->strip_size;
+		raid_bdev->bdev.split_on_optimal_io_boundary = true;
+	} else {
+		/* Nothing is striped, the whole capacity of a mirror is usable */
+		raid_bdev->bdev.blockcnt = min_blockcnt;
+		raid_bdev->data_width = 1;
+		raid_bdev->bdev.optimal_io_boundary = 0;
+		raid_bdev->bdev.split_on_optimal_io_boundary = false;
+	}
+
+	SPDK_DEBUGLOG(bdev_raid1, "min blockcount %" PRIu64 ", mirrors %u, groups %u, blockcnt %" PRIu64
+		      "\n", min_blockcnt, mirrors, num_groups, raid_bdev->bdev.blockcnt);
+
+	return 0;
+}
+
+/* A mirror is rebuilt by copying another mirror of its group */
+static uint8_t
+raid1_get_rebuild_sources(struct raid_bdev *raid_bdev, uint8_t idx, uint8_t *sources)
+{
+	struct raid_base_bdev_info *base_info;
+	uint8_t mirrors = raid1_num_mirrors(raid_bdev);
+	uint8_t first = idx - idx % mirrors;
+	uint8_t i;
+
+	for (i = first; i < first + mirrors; i++) {
+		base_info = &raid_bdev->base_bdev_info[i];
+		if (i != idx && base_info->desc != NULL && !base_info->remove_scheduled &&
+		    !base_info->rebuilding) {
+			sources[0] = i;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static struct raid_bdev_module g_raid1_module = {
+	.level = RAID1,
+	.base_bdevs_min = 2,
+	.base_bdevs_max_degraded = 1,
+	.start = raid1_start,
+	.submit_rw_request = raid1_submit_rw_request,
+	.submit_null_payload_request = raid1_submit_null_payload_request,
+	.get_rebuild_sources = raid1_get_rebuild_sources,
+};
+RAID_MODULE_REGISTER(&g_raid1_module)
+
+static struct raid_bdev_module g_raid10_module = {
+	.level = RAID10,
+	.base_bdevs_min = 2 * RAID10_MIRRORS,
+	.base_bdevs_max_degraded = 1,
+	.start = raid1_start,
+	.submit_rw_request = raid1_submit_rw_request,
+	.submit_null_payload_request = raid1_submit_null_payload_request,
+	.get_rebuild_sources = raid1_get_rebuild_sources,
+};
+RAID_MODULE_REGISTER(&g_raid10_module)
+
+SPDK_LOG_REGISTER_COMPONENT(bdev_raid1)
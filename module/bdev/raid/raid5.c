@@ -37,9 +37,123 @@
 #include "spdk/thread.h"
 #include "spdk/string.h"
 #include "spdk/util.h"
+#include "spdk/xor.h"
 
 #include "spdk/log.h"
 
+/* Maximum concurrent stripe requests per io channel */
+#define RAID5_MAX_STRIPES 32
+
+/* Number of hash buckets for the locked stripes */
+#define RAID5_STRIPE_LOCK_BUCKETS 256
+
+struct chunk {
+	/* Corresponds to base_bdev index */
+	uint8_t index;
+
+	/* Request offset from chunk start, in blocks */
+	uint64_t req_offset;
+
+	/* Request blocks count */
+	uint64_t req_blocks;
+
+	/* The part of the parent request iovs that belongs to this chunk */
+	struct iovec *iovs;
+	int iovcnt;
+
+	/* Allocated size of the iovs array */
+	int iovcnt_max;
+
+	/* Buffer of strip_size blocks used for old data/parity and reconstruction */
+	void *buf;
+};
+
+enum stripe_request_type {
+	/* Read of healthy chunks, submitted directly to the parent iovs */
+	STRIPE_REQUEST_READ,
+	/* Read touching a missing chunk, reconstructed from the other chunks */
+	STRIPE_REQUEST_DEGRADED_READ,
+	/* Write with the parity chunk missing, no parity update needed */
+	STRIPE_REQUEST_WRITE_NO_PARITY,
+	/* Full stripe write, parity is calculated from the new data only */
+	STRIPE_REQUEST_FULL_WRITE,
+	/* Read-modify-write: read old data and old parity of the modified range */
+	STRIPE_REQUEST_RMW,
+	/* Reconstruct-write: read the rest of the stripe and calculate new parity */
+	STRIPE_REQUEST_RCW,
+};
+
+/* Base bdev I/O of a stripe request stage */
+struct stripe_op {
+	struct chunk *chunk;
+	bool write;
+
+	/* Offset from chunk start and length, in blocks */
+	uint64_t offset;
+	uint64_t blocks;
+
+	struct iovec *iovs;
+	int iovcnt;
+
+	/* Used when the op targets the chunk buffer */
+	struct iovec buf_iov;
+};
+
+struct stripe_request {
+	struct raid5_io_channel *r5ch;
+
+	/*
+	 * The raid5 array, cached so the stripe can be unlocked after the
+	 * raid_io has been completed and possibly freed.
+	 */
+	struct raid5_info *r5info;
+
+	/* The associated raid_bdev_io */
+	struct raid_bdev_io *raid_io;
+
+	enum stripe_request_type type;
+
+	/* The stripe's index in the raid array */
+	uint64_t stripe_index;
+
+	/* The stripe's parity chunk */
+	struct chunk *parity_chunk;
+
+	/* Chunk with a missing base bdev, NULL if the stripe is not degraded */
+	struct chunk *missing_chunk;
+
+	/* Range in chunks covered by the parity update or reconstruction, in blocks */
+	uint64_t range_offset;
+	uint64_t range_blocks;
+
+	/* Thread that submitted the request, used to resume it after the stripe lock is granted */
+	struct spdk_thread *thread;
+
+	/* Link in the free list, or in the locked stripes hash bucket */
+	TAILQ_ENTRY(stripe_request) link;
+
+	/* Requests waiting for this stripe's lock, valid only for the lock holder */
+	TAILQ_HEAD(, stripe_request) lock_waiters;
+
+	/* Current stage's base bdev I/O */
+	struct stripe_op *ops;
+	uint8_t ops_count;
+	uint8_t ops_submitted;
+	uint8_t ops_remaining;
+
+	/* The last stage completes the raid_io with raid_bdev_io_complete_part() */
+	bool final_stage;
+
+	enum spdk_bdev_io_status status;
+
+	void (*stage_done)(struct stripe_request *stripe_req);
+
+	struct spdk_bdev_io_wait_entry waitq_entry;
+
+	/* Array of chunks corresponding to base_bdevs */
+	struct chunk chunks[0];
+};
+
 struct raid5_info {
 	/* The parent raid bdev */
 	struct raid_bdev *raid_bdev;
@@ -49,18 +163,875 @@ struct raid5_info {
 
 	/* Number of stripes on this array */
 	uint64_t total_stripes;
+
+	/* Protects locked_stripes, shared by all io channels */
+	pthread_spinlock_t stripe_lock;
+
+	/* Hash of stripes with writes or degraded reads in progress */
+	TAILQ_HEAD(, stripe_request) locked_stripes[RAID5_STRIPE_LOCK_BUCKETS];
+};
+
+struct raid5_io_channel {
+	/* Preallocated stripe requests with their chunk buffers */
+	TAILQ_HEAD(, stripe_request) free_stripe_requests;
+
+	/* raid_bdev_ios waiting for a free stripe request */
+	TAILQ_HEAD(, spdk_bdev_io) retry_queue;
 };
 
+#define FOR_EACH_CHUNK(req, c) \
+	for (c = req->chunks; \
+	     c < req->chunks + req->raid_io->raid_bdev->num_base_bdevs; c++)
+
+#define FOR_EACH_DATA_CHUNK(req, c) \
+	FOR_EACH_CHUNK(req, c) if (c != req->parity_chunk)
+
+static inline struct raid_bdev *
+stripe_req_raid_bdev(struct stripe_request *stripe_req)
+{
+	return stripe_req->raid_io->raid_bdev;
+}
+
+static inline struct raid5_info *
+stripe_req_r5info(struct stripe_request *stripe_req)
+{
+	return stripe_req->r5info;
+}
+
 static inline uint8_t
 raid5_stripe_data_chunks_num(const struct raid_bdev *raid_bdev)
 {
 	return raid_bdev->num_base_bdevs - raid_bdev->module->base_bdevs_max_degraded;
 }
 
+/*
+ * Parity rotates over the base bdevs, starting on the last one for the first
+ * stripe (left asymmetric layout).
+ */
+static inline uint8_t
+raid5_stripe_parity_chunk_index(const struct raid_bdev *raid_bdev, uint64_t stripe_index)
+{
+	return raid_bdev->num_base_bdevs - 1 - stripe_index % raid_bdev->num_base_bdevs;
+}
+
+static inline bool
+raid5_chunk_missing(struct stripe_request *stripe_req, struct chunk *chunk)
+{
+	return !raid_bdev_io_base_bdev_valid(stripe_req->raid_io, chunk->index);
+}
+
+static inline void *
+raid5_chunk_buf(struct stripe_request *stripe_req, struct chunk *chunk, uint64_t offset_blocks)
+{
+	return (uint8_t *)chunk->buf + (offset_blocks << stripe_req_raid_bdev(stripe_req)->blocklen_shift);
+}
+
+static void
+raid5_copy_iovs_to_buf(void *buf, size_t size, struct iovec *iovs, int iovcnt)
+{
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = size,
+	};
+
+	spdk_iovcpy(iovs, iovcnt, &iov, 1);
+}
+
+static void
+raid5_copy_buf_to_iovs(struct iovec *iovs, int iovcnt, void *buf, size_t size)
+{
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = size,
+	};
+
+	spdk_iovcpy(&iov, 1, iovs, iovcnt);
+}
+
+/*
+ * Describe the part of the parent request payload starting at byte 'offset'
+ * with 'len' bytes in the chunk's own iovs.
+ */
+static int
+raid5_chunk_map_iovs(struct chunk *chunk, const struct iovec *iovs, int iovcnt,
+		     uint64_t offset, uint64_t len)
+{
+	int i;
+	size_t off = 0;
+	int start_iov_idx = 0;
+	size_t len_in_iov;
+
+	for (i = 0; i < iovcnt; i++) {
+		if (off + iovs[i].iov_len > offset) {
+			start_iov_idx = i;
+			break;
+		}
+		off += iovs[i].iov_len;
+	}
+	assert(i < iovcnt);
+
+	chunk->iovcnt = 0;
+	for (i = start_iov_idx; i < iovcnt && len > 0; i++) {
+		if (chunk->iovcnt == chunk->iovcnt_max) {
+			struct iovec *tmp;
+			int iovcnt_max = chunk->iovcnt_max * 2;
+
+			tmp = realloc(chunk->iovs, iovcnt_max * sizeof(*tmp));
+			if (!tmp) {
+				return -ENOMEM;
+			}
+			chunk->iovs = tmp;
+			chunk->iovcnt_max = iovcnt_max;
+		}
+
+		len_in_iov = spdk_min(iovs[i].iov_len - (offset - off), len);
+		chunk->iovs[chunk->iovcnt].iov_base = (uint8_t *)iovs[i].iov_base + (offset - off);
+		chunk->iovs[chunk->iovcnt].iov_len = len_in_iov;
+		chunk->iovcnt++;
+
+		offset += len_in_iov;
+		len -= len_in_iov;
+		off += iovs[i].iov_len;
+	}
+	assert(len == 0);
+
+	return 0;
+}
+
+static void raid5_submit_rw_request(struct raid_bdev_io *raid_io);
+
+static void
+raid5_stripe_request_release(struct stripe_request *stripe_req)
+{
+	struct raid5_io_channel *r5ch = stripe_req->r5ch;
+	struct spdk_bdev_io *bdev_io;
+
+	TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests, stripe_req, link);
+
+	bdev_io = TAILQ_FIRST(&r5ch->retry_queue);
+	if (bdev_io) {
+		TAILQ_REMOVE(&r5ch->retry_queue, bdev_io, module_link);
+		raid5_submit_rw_request((struct raid_bdev_io *)bdev_io->driver_ctx);
+	}
+}
+
+/*
+ * Try to acquire the lock of the request's stripe. If the stripe is already
+ * locked, the request is queued and resumed on its thread when the lock is
+ * handed over to it.
+ */
+static bool
+raid5_stripe_lock(struct stripe_request *stripe_req)
+{
+	struct raid5_info *r5info = stripe_req_r5info(stripe_req);
+	struct stripe_request *holder;
+	bool locked = true;
+
+	pthread_spin_lock(&r5info->stripe_lock);
+	TAILQ_FOREACH(holder, &r5info->locked_stripes[stripe_req->stripe_index %
+			RAID5_STRIPE_LOCK_BUCKETS], link) {
+		if (holder->stripe_index == stripe_req->stripe_index) {
+			TAILQ_INSERT_TAIL(&holder->lock_waiters, stripe_req, link);
+			locked = false;
+			break;
+		}
+	}
+	if (locked) {
+		TAILQ_INIT(&stripe_req->lock_waiters);
+		TAILQ_INSERT_TAIL(&r5info->locked_stripes[stripe_req->stripe_index %
+				  RAID5_STRIPE_LOCK_BUCKETS], stripe_req, link);
+	}
+	pthread_spin_unlock(&r5info->stripe_lock);
+
+	return locked;
+}
+
+static void raid5_stripe_request_start(void *ctx);
+
+static void
+raid5_stripe_unlock(struct stripe_request *stripe_req)
+{
+	struct raid5_info *r5info = stripe_req_r5info(stripe_req);
+	struct stripe_request *next;
+	int rc;
+
+	pthread_spin_lock(&r5info->stripe_lock);
+	TAILQ_REMOVE(&r5info->locked_stripes[stripe_req->stripe_index % RAID5_STRIPE_LOCK_BUCKETS],
+		     stripe_req, link);
+	next = TAILQ_FIRST(&stripe_req->lock_waiters);
+	if (next) {
+		TAILQ_REMOVE(&stripe_req->lock_waiters, next, link);
+		TAILQ_INIT(&next->lock_waiters);
+		TAILQ_CONCAT(&next->lock_waiters, &stripe_req->lock_waiters, link);
+		TAILQ_INSERT_TAIL(&r5info->locked_stripes[next->stripe_index % RAID5_STRIPE_LOCK_BUCKETS],
+				  next, link);
+	}
+	pthread_spin_unlock(&r5info->stripe_lock);
+
+	if (next) {
+		rc = spdk_thread_send_msg(next->thread, raid5_stripe_request_start, next);
+		if (rc != 0) {
+			SPDK_ERRLOG("Failed to resume stripe request: %s\n", spdk_strerror(-rc));
+			assert(false);
+		}
+	}
+}
+
+static void
+raid5_stripe_request_finish(struct stripe_request *stripe_req)
+{
+	if (stripe_req->type != STRIPE_REQUEST_READ) {
+		raid5_stripe_unlock(stripe_req);
+	}
+	raid5_stripe_request_release(stripe_req);
+}
+
+static void
+raid5_stripe_op_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct stripe_request *stripe_req = cb_arg;
+	enum spdk_bdev_io_status status = success ? SPDK_BDEV_IO_STATUS_SUCCESS :
+					  SPDK_BDEV_IO_STATUS_FAILED;
+
+	spdk_bdev_free_io(bdev_io);
+
+	if (stripe_req->final_stage) {
+		if (raid_bdev_io_complete_part(stripe_req->raid_io, 1, status)) {
+			raid5_stripe_request_finish(stripe_req);
+		}
+		return;
+	}
+
+	if (!success) {
+		stripe_req->status = status;
+	}
+
+	assert(stripe_req->ops_remaining > 0);
+	if (--stripe_req->ops_remaining == 0) {
+		stripe_req->stage_done(stripe_req);
+	}
+}
+
+static void
+raid5_stripe_ops_fail(struct stripe_request *stripe_req, uint8_t count)
+{
+	if (stripe_req->final_stage) {
+		if (raid_bdev_io_complete_part(stripe_req->raid_io, count, SPDK_BDEV_IO_STATUS_FAILED)) {
+			raid5_stripe_request_finish(stripe_req);
+		}
+		return;
+	}
+
+	stripe_req->status = SPDK_BDEV_IO_STATUS_FAILED;
+	assert(stripe_req->ops_remaining >= count);
+	stripe_req->ops_remaining -= count;
+	if (stripe_req->ops_remaining == 0) {
+		stripe_req->stage_done(stripe_req);
+	}
+}
+
+static void raid5_stripe_request_submit_ops(struct stripe_request *stripe_req);
+
+static void
+_raid5_stripe_request_submit_ops(void *_stripe_req)
+{
+	struct stripe_request *stripe_req = _stripe_req;
+
+	raid5_stripe_request_submit_ops(stripe_req);
+}
+
+/*
+ * Submit the ops of the current stage to the base bdevs, in parallel. On
+ * -ENOMEM the submission is resumed from the first op not yet submitted.
+ */
+static void
+raid5_stripe_request_submit_ops(struct stripe_request *stripe_req)
+{
+	struct raid_bdev_io *raid_io = stripe_req->raid_io;
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	struct spdk_io_channel *base_ch;
+	struct stripe_op *op;
+	uint64_t base_offset_blocks;
+	int ret;
+
+	while (stripe_req->ops_submitted < stripe_req->ops_count) {
+		op = &stripe_req->ops[stripe_req->ops_submitted];
+		base_info = &raid_bdev->base_bdev_info[op->chunk->index];
+		base_ch = raid_io->raid_ch->base_channel[op->chunk->index];
+		base_offset_blocks = (stripe_req->stripe_index << raid_bdev->strip_size_shift) + op->offset;
+
+		if (op->write) {
+			ret = spdk_bdev_writev_blocks(base_info->desc, base_ch, op->iovs, op->iovcnt,
+						      base_offset_blocks, op->blocks,
+						      raid5_stripe_op_complete, stripe_req);
+		} else {
+			ret = spdk_bdev_readv_blocks(base_info->desc, base_ch, op->iovs, op->iovcnt,
+						     base_offset_blocks, op->blocks,
+						     raid5_stripe_op_complete, stripe_req);
+		}
+
+		if (ret == 0) {
+			stripe_req->ops_submitted++;
+		} else if (ret == -ENOMEM) {
+			stripe_req->waitq_entry.bdev = base_info->bdev;
+			stripe_req->waitq_entry.cb_fn = _raid5_stripe_request_submit_ops;
+			stripe_req->waitq_entry.cb_arg = stripe_req;
+			spdk_bdev_queue_io_wait(base_info->bdev, base_ch, &stripe_req->waitq_entry);
+			return;
+		} else {
+			uint8_t not_submitted = stripe_req->ops_count - stripe_req->ops_submitted;
+
+			SPDK_ERRLOG("bdev io submit error not due to ENOMEM, it should not happen\n");
+			assert(false);
+			stripe_req->ops_submitted = stripe_req->ops_count;
+			raid5_stripe_ops_fail(stripe_req, not_submitted);
+			return;
+		}
+	}
+}
+
+static void
+raid5_stripe_request_add_op(struct stripe_request *stripe_req, struct chunk *chunk, bool write,
+			    uint64_t offset, uint64_t blocks, struct iovec *iovs, int iovcnt)
+{
+	struct stripe_op *op = &stripe_req->ops[stripe_req->ops_count++];
+
+	assert(stripe_req->ops_count <= stripe_req->raid_io->raid_bdev->num_base_bdevs * 2);
+	assert(!raid5_chunk_missing(stripe_req, chunk));
+
+	op->chunk = chunk;
+	op->write = write;
+	op->offset = offset;
+	op->blocks = blocks;
+	op->iovs = iovs;
+	op->iovcnt = iovcnt;
+}
+
+static void
+raid5_stripe_request_add_buf_op(struct stripe_request *stripe_req, struct chunk *chunk, bool write,
+				uint64_t offset, uint64_t blocks)
+{
+	struct stripe_op *op = &stripe_req->ops[stripe_req->ops_count];
+
+	op->buf_iov.iov_base = raid5_chunk_buf(stripe_req, chunk, offset);
+	op->buf_iov.iov_len = blocks << stripe_req_raid_bdev(stripe_req)->blocklen_shift;
+
+	raid5_stripe_request_add_op(stripe_req, chunk, write, offset, blocks, &op->buf_iov, 1);
+}
+
+static void
+raid5_stripe_request_run_stage(struct stripe_request *stripe_req, bool final_stage,
+			       void (*stage_done)(struct stripe_request *stripe_req))
+{
+	stripe_req->final_stage = final_stage;
+	stripe_req->stage_done = stage_done;
+	stripe_req->ops_submitted = 0;
+	stripe_req->ops_remaining = stripe_req->ops_count;
+
+	if (final_stage) {
+		stripe_req->raid_io->base_bdev_io_remaining = stripe_req->ops_count;
+	}
+
+	if (stripe_req->ops_count == 0) {
+		assert(!final_stage);
+		stage_done(stripe_req);
+		return;
+	}
+
+	raid5_stripe_request_submit_ops(stripe_req);
+}
+
+static void
+raid5_stripe_request_write_stage(struct stripe_request *stripe_req)
+{
+	struct chunk *chunk;
+
+	stripe_req->ops_count = 0;
+
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		if (chunk->req_blocks > 0 && chunk != stripe_req->missing_chunk) {
+			raid5_stripe_request_add_op(stripe_req, chunk, true, chunk->req_offset,
+						    chunk->req_blocks, chunk->iovs, chunk->iovcnt);
+		}
+	}
+
+	chunk = stripe_req->parity_chunk;
+	if (chunk != stripe_req->missing_chunk) {
+		raid5_stripe_request_add_buf_op(stripe_req, chunk, true, stripe_req->range_offset,
+						stripe_req->range_blocks);
+	}
+
+	raid5_stripe_request_run_stage(stripe_req, true, NULL);
+}
+
+/*
+ * Calculate the range of the missing chunk's buffer as the xor of the
+ * buffers of all the other chunks, parity included.
+ */
+static int
+raid5_stripe_request_reconstruct(struct stripe_request *stripe_req)
+{
+	struct chunk *chunk;
+	struct chunk *missing = stripe_req->missing_chunk;
+	uint64_t len = stripe_req->range_blocks << stripe_req_raid_bdev(stripe_req)->blocklen_shift;
+	void *srcs[SPDK_XOR_MAX_SOURCES];
+	uint32_t n = 0;
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		if (chunk != missing) {
+			srcs[n++] = raid5_chunk_buf(stripe_req, chunk, stripe_req->range_offset);
+		}
+	}
+
+	return spdk_xor_gen(raid5_chunk_buf(stripe_req, missing, stripe_req->range_offset), srcs, n, len);
+}
+
+static void
+raid5_stripe_request_reads_done(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req_raid_bdev(stripe_req);
+	struct chunk *parity = stripe_req->parity_chunk;
+	struct chunk *chunk;
+	void *srcs[SPDK_XOR_MAX_SOURCES];
+	uint32_t n;
+	uint64_t len;
+	void *dst;
+	int rc = 0;
+
+	if (stripe_req->status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_bdev_io_complete(stripe_req->raid_io, stripe_req->status);
+		raid5_stripe_request_finish(stripe_req);
+		return;
+	}
+
+	switch (stripe_req->type) {
+	case STRIPE_REQUEST_DEGRADED_READ:
+		rc = raid5_stripe_request_reconstruct(stripe_req);
+		if (rc != 0) {
+			break;
+		}
+		chunk = stripe_req->missing_chunk;
+		raid5_copy_buf_to_iovs(chunk->iovs, chunk->iovcnt,
+				       raid5_chunk_buf(stripe_req, chunk, chunk->req_offset),
+				       chunk->req_blocks << raid_bdev->blocklen_shift);
+		raid_bdev_io_complete(stripe_req->raid_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+		raid5_stripe_request_finish(stripe_req);
+		return;
+
+	case STRIPE_REQUEST_RMW:
+		/* new parity = old parity ^ old data ^ new data */
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			struct iovec bufs_iov[2];
+			struct iovec *src_iovs[3] = { &bufs_iov[0], &bufs_iov[1], chunk->iovs };
+			int src_iovcnts[3] = { 1, 1, chunk->iovcnt };
+
+			if (chunk->req_blocks == 0) {
+				continue;
+			}
+			len = chunk->req_blocks << raid_bdev->blocklen_shift;
+			bufs_iov[0].iov_base = raid5_chunk_buf(stripe_req, parity, chunk->req_offset);
+			bufs_iov[0].iov_len = len;
+			bufs_iov[1].iov_base = raid5_chunk_buf(stripe_req, chunk, chunk->req_offset);
+			bufs_iov[1].iov_len = len;
+			rc = spdk_xor_gen_iov(&bufs_iov[0], 1, src_iovs, src_iovcnts, 3, len);
+			if (rc != 0) {
+				break;
+			}
+		}
+		break;
+
+	case STRIPE_REQUEST_RCW:
+		if (stripe_req->missing_chunk != NULL && stripe_req->missing_chunk != parity) {
+			/* Old data of the missing chunk is needed to calculate the new parity */
+			rc = raid5_stripe_request_reconstruct(stripe_req);
+			if (rc != 0) {
+				break;
+			}
+		}
+
+		len = stripe_req->range_blocks << raid_bdev->blocklen_shift;
+		dst = raid5_chunk_buf(stripe_req, parity, stripe_req->range_offset);
+		n = 0;
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks > 0) {
+				raid5_copy_iovs_to_buf(raid5_chunk_buf(stripe_req, chunk, chunk->req_offset),
+						       chunk->req_blocks << raid_bdev->blocklen_shift,
+						       chunk->iovs, chunk->iovcnt);
+			}
+			srcs[n++] = raid5_chunk_buf(stripe_req, chunk, stripe_req->range_offset);
+		}
+		rc = spdk_xor_gen(dst, srcs, n, len);
+		break;
+
+	default:
+		assert(false);
+		break;
+	}
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to calculate parity: %s\n", spdk_strerror(-rc));
+		raid_bdev_io_complete(stripe_req->raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		raid5_stripe_request_finish(stripe_req);
+		return;
+	}
+
+	raid5_stripe_request_write_stage(stripe_req);
+}
+
+static void
+raid5_stripe_request_full_write(struct stripe_request *stripe_req)
+{
+	struct raid_bdev *raid_bdev = stripe_req_raid_bdev(stripe_req);
+	struct chunk *parity = stripe_req->parity_chunk;
+	uint64_t len = raid_bdev->strip_size << raid_bdev->blocklen_shift;
+	struct iovec *src_iovs[SPDK_XOR_MAX_SOURCES];
+	int src_iovcnts[SPDK_XOR_MAX_SOURCES];
+	struct iovec parity_iov = {
+		.iov_base = parity->buf,
+		.iov_len = len,
+	};
+	struct chunk *chunk;
+	uint32_t n = 0;
+	int rc;
+
+	/* All the data is at hand, parity is calculated without reading the stripe */
+	FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+		src_iovs[n] = chunk->iovs;
+		src_iovcnts[n] = chunk->iovcnt;
+		n++;
+	}
+
+	rc = spdk_xor_gen_iov(&parity_iov, 1, src_iovs, src_iovcnts, n, len);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to calculate parity: %s\n", spdk_strerror(-rc));
+		raid_bdev_io_complete(stripe_req->raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		raid5_stripe_request_finish(stripe_req);
+		return;
+	}
+
+	raid5_stripe_request_write_stage(stripe_req);
+}
+
+static void
+raid5_stripe_request_start(void *ctx)
+{
+	struct stripe_request *stripe_req = ctx;
+	struct chunk *missing = stripe_req->missing_chunk;
+	struct chunk *parity = stripe_req->parity_chunk;
+	struct chunk *chunk;
+
+	stripe_req->ops_count = 0;
+
+	switch (stripe_req->type) {
+	case STRIPE_REQUEST_READ:
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks > 0) {
+				raid5_stripe_request_add_op(stripe_req, chunk, false, chunk->req_offset,
+							    chunk->req_blocks, chunk->iovs, chunk->iovcnt);
+			}
+		}
+		raid5_stripe_request_run_stage(stripe_req, true, NULL);
+		break;
+
+	case STRIPE_REQUEST_DEGRADED_READ:
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk == missing) {
+				continue;
+			}
+			if (chunk != parity && chunk->req_blocks > 0) {
+				raid5_stripe_request_add_op(stripe_req, chunk, false, chunk->req_offset,
+							    chunk->req_blocks, chunk->iovs, chunk->iovcnt);
+			}
+			raid5_stripe_request_add_buf_op(stripe_req, chunk, false, stripe_req->range_offset,
+							stripe_req->range_blocks);
+		}
+		raid5_stripe_request_run_stage(stripe_req, false, raid5_stripe_request_reads_done);
+		break;
+
+	case STRIPE_REQUEST_WRITE_NO_PARITY:
+		raid5_stripe_request_write_stage(stripe_req);
+		break;
+
+	case STRIPE_REQUEST_FULL_WRITE:
+		raid5_stripe_request_full_write(stripe_req);
+		break;
+
+	case STRIPE_REQUEST_RMW:
+		FOR_EACH_DATA_CHUNK(stripe_req, chunk) {
+			if (chunk->req_blocks > 0) {
+				raid5_stripe_request_add_buf_op(stripe_req, chunk, false, chunk->req_offset,
+								chunk->req_blocks);
+			}
+		}
+		raid5_stripe_request_add_buf_op(stripe_req, parity, false, stripe_req->range_offset,
+						stripe_req->range_blocks);
+		raid5_stripe_request_run_stage(stripe_req, false, raid5_stripe_request_reads_done);
+		break;
+
+	case STRIPE_REQUEST_RCW:
+		FOR_EACH_CHUNK(stripe_req, chunk) {
+			if (chunk == missing) {
+				continue;
+			}
+			if (chunk == parity) {
+				/* Parity is only needed to reconstruct the missing chunk's old data */
+				if (missing != NULL) {
+					raid5_stripe_request_add_buf_op(stripe_req, chunk, false,
+									stripe_req->range_offset,
+									stripe_req->range_blocks);
+				}
+				continue;
+			}
+			if (missing == NULL && chunk->req_offset == stripe_req->range_offset &&
+			    chunk->req_blocks == stripe_req->range_blocks) {
+				/* Range fully overwritten, old data not needed */
+				continue;
+			}
+			raid5_stripe_request_add_buf_op(stripe_req, chunk, false, stripe_req->range_offset,
+							stripe_req->range_blocks);
+		}
+		raid5_stripe_request_run_stage(stripe_req, false, raid5_stripe_request_reads_done);
+		break;
+	}
+}
+
+/*
+ * Map the request to the stripe's chunks and choose how to handle it,
+ * depending on the request type, size and the stripe's missing chunk.
+ */
+static int
+raid5_stripe_request_init(struct stripe_request *stripe_req, struct raid_bdev_io *raid_io)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid_bdev *raid_bdev = raid_io->raid_bdev;
+	struct raid5_info *r5info = raid_bdev->module_private;
+	uint64_t stripe_offset;
+	uint64_t req_end;
+	uint64_t chunk_start;
+	uint64_t range_end = 0;
+	uint8_t data_chunks_num = raid5_stripe_data_chunks_num(raid_bdev);
+	uint8_t touched = 0;
+	uint8_t missing_count = 0;
+	uint8_t data_idx = 0;
+	struct chunk *chunk;
+	int ret;
+
+	stripe_req->raid_io = raid_io;
+	stripe_req->stripe_index = bdev_io->u.bdev.offset_blocks / r5info->stripe_blocks;
+	stripe_req->parity_chunk = &stripe_req->chunks[raid5_stripe_parity_chunk_index(raid_bdev,
+				   stripe_req->stripe_index)];
+	stripe_req->missing_chunk = NULL;
+	stripe_req->range_offset = raid_bdev->strip_size;
+	stripe_req->status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	stripe_offset = bdev_io->u.bdev.offset_blocks % r5info->stripe_blocks;
+	req_end = stripe_offset + bdev_io->u.bdev.num_blocks;
+	if (req_end > r5info->stripe_blocks) {
+		assert(false);
+		SPDK_ERRLOG("I/O spans stripe boundary!\n");
+		return -EINVAL;
+	}
+
+	FOR_EACH_CHUNK(stripe_req, chunk) {
+		if (raid5_chunk_missing(stripe_req, chunk)) {
+			stripe_req->missing_chunk = chunk;
+			missing_count++;
+		}
+
+		chunk->req_offset = 0;
+		chunk->req_blocks = 0;
+
+		if (chunk == stripe_req->parity_chunk) {
+			continue;
+		}
+
+		chunk_start = data_idx++ * raid_bdev->strip_size;
+		if (stripe_offset < chunk_start + raid_bdev->strip_size && req_end > chunk_start) {
+			uint64_t start = spdk_max(stripe_offset, chunk_start);
+			uint64_t end = spdk_min(req_end, chunk_start + raid_bdev->strip_size);
+
+			chunk->req_offset = start - chunk_start;
+			chunk->req_blocks = end - start;
+			touched++;
+
+			ret = raid5_chunk_map_iovs(chunk, bdev_io->u.bdev.iovs, bdev_io->u.bdev.iovcnt,
+						   (start - stripe_offset) << raid_bdev->blocklen_shift,
+						   chunk->req_blocks << raid_bdev->blocklen_shift);
+			if (ret != 0) {
+				return ret;
+			}
+
+			stripe_req->range_offset = spdk_min(stripe_req->range_offset, chunk->req_offset);
+			range_end = spdk_max(range_end, chunk->req_offset + chunk->req_blocks);
+		}
+	}
+	stripe_req->range_blocks = range_end - stripe_req->range_offset;
+
+	if (missing_count > raid_bdev->module->base_bdevs_max_degraded) {
+		SPDK_ERRLOG("Too many missing base bdevs for stripe %" PRIu64 "\n", stripe_req->stripe_index);
+		return -EIO;
+	}
+
+	if (bdev_io->type == SPDK_BDEV_IO_TYPE_READ) {
+		if (stripe_req->missing_chunk == NULL ||
+		    stripe_req->missing_chunk == stripe_req->parity_chunk ||
+		    stripe_req->missing_chunk->req_blocks == 0) {
+			stripe_req->type = STRIPE_REQUEST_READ;
+		} else {
+			/* Only the missing chunk's range needs reconstruction */
+			stripe_req->type = STRIPE_REQUEST_DEGRADED_READ;
+			stripe_req->range_offset = stripe_req->missing_chunk->req_offset;
+			stripe_req->range_blocks = stripe_req->missing_chunk->req_blocks;
+		}
+	} else if (stripe_req->missing_chunk == stripe_req->parity_chunk &&
+		   stripe_req->missing_chunk != NULL) {
+		stripe_req->type = STRIPE_REQUEST_WRITE_NO_PARITY;
+	} else if (bdev_io->u.bdev.num_blocks == r5info->stripe_blocks) {
+		stripe_req->type = STRIPE_REQUEST_FULL_WRITE;
+	} else if (stripe_req->missing_chunk != NULL) {
+		/*
+		 * Read-modify-write needs the old data of the modified chunks,
+		 * reconstruct-write needs the old data of all the others.
+		 */
+		stripe_req->type = stripe_req->missing_chunk->req_blocks > 0 ?
+				   STRIPE_REQUEST_RCW : STRIPE_REQUEST_RMW;
+	} else {
+		/* Choose the method which reads from fewer base bdevs */
+		stripe_req->type = touched + 1 <= data_chunks_num - touched ?
+				   STRIPE_REQUEST_RMW : STRIPE_REQUEST_RCW;
+	}
+
+	return 0;
+}
+
 static void
 raid5_submit_rw_request(struct raid_bdev_io *raid_io)
 {
-	raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(raid_io);
+	struct raid5_io_channel *r5ch = spdk_io_channel_get_ctx(raid_io->raid_ch->module_channel);
+	struct stripe_request *stripe_req;
+	int ret;
+
+	stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests);
+	if (!stripe_req) {
+		TAILQ_INSERT_TAIL(&r5ch->retry_queue, bdev_io, module_link);
+		return;
+	}
+	TAILQ_REMOVE(&r5ch->free_stripe_requests, stripe_req, link);
+
+	ret = raid5_stripe_request_init(stripe_req, raid_io);
+	if (ret != 0) {
+		raid5_stripe_request_release(stripe_req);
+		raid_bdev_io_complete(raid_io, SPDK_BDEV_IO_STATUS_FAILED);
+		return;
+	}
+
+	if (stripe_req->type == STRIPE_REQUEST_READ) {
+		/* Healthy reads don't depend on the rest of the stripe, no locking needed */
+		raid5_stripe_request_start(stripe_req);
+		return;
+	}
+
+	stripe_req->thread = spdk_get_thread();
+	if (raid5_stripe_lock(stripe_req)) {
+		raid5_stripe_request_start(stripe_req);
+	}
+}
+
+static void
+raid5_stripe_request_free(struct stripe_request *stripe_req, uint8_t num_chunks)
+{
+	uint8_t i;
+
+	for (i = 0; i < num_chunks; i++) {
+		free(stripe_req->chunks[i].iovs);
+		spdk_dma_free(stripe_req->chunks[i].buf);
+	}
+	free(stripe_req->ops);
+	free(stripe_req);
+}
+
+static struct stripe_request *
+raid5_stripe_request_alloc(struct raid5_io_channel *r5ch, struct raid_bdev *raid_bdev)
+{
+	struct stripe_request *stripe_req;
+	struct chunk *chunk;
+	uint8_t i;
+
+	stripe_req = calloc(1, sizeof(*stripe_req) +
+			    sizeof(struct chunk) * raid_bdev->num_base_bdevs);
+	if (!stripe_req) {
+		return NULL;
+	}
+
+	stripe_req->r5ch = r5ch;
+	stripe_req->r5info = raid_bdev->module_private;
+
+	stripe_req->ops = calloc(raid_bdev->num_base_bdevs * 2, sizeof(*stripe_req->ops));
+	if (!stripe_req->ops) {
+		goto err;
+	}
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		chunk = &stripe_req->chunks[i];
+		chunk->index = i;
+		chunk->iovcnt_max = 4;
+		chunk->iovs = calloc(chunk->iovcnt_max, sizeof(chunk->iovs[0]));
+		if (!chunk->iovs) {
+			goto err;
+		}
+
+		chunk->buf = spdk_dma_malloc(raid_bdev->strip_size << raid_bdev->blocklen_shift, 0, NULL);
+		if (!chunk->buf) {
+			goto err;
+		}
+	}
+
+	return stripe_req;
+err:
+	raid5_stripe_request_free(stripe_req, raid_bdev->num_base_bdevs);
+	return NULL;
+}
+
+static void
+raid5_ioch_destroy(void *io_device, void *ctx_buf)
+{
+	struct raid5_info *r5info = io_device;
+	struct raid5_io_channel *r5ch = ctx_buf;
+	struct stripe_request *stripe_req;
+
+	assert(TAILQ_EMPTY(&r5ch->retry_queue));
+
+	while ((stripe_req = TAILQ_FIRST(&r5ch->free_stripe_requests))) {
+		TAILQ_REMOVE(&r5ch->free_stripe_requests, stripe_req, link);
+		raid5_stripe_request_free(stripe_req, r5info->raid_bdev->num_base_bdevs);
+	}
+}
+
+static int
+raid5_ioch_create(void *io_device, void *ctx_buf)
+{
+	struct raid5_info *r5info = io_device;
+	struct raid5_io_channel *r5ch = ctx_buf;
+	struct stripe_request *stripe_req;
+	int i;
+
+	TAILQ_INIT(&r5ch->free_stripe_requests);
+	TAILQ_INIT(&r5ch->retry_queue);
+
+	for (i = 0; i < RAID5_MAX_STRIPES; i++) {
+		stripe_req = raid5_stripe_request_alloc(r5ch, r5info->raid_bdev);
+		if (!stripe_req) {
+			SPDK_ERRLOG("Failed to allocate stripe request\n");
+			raid5_ioch_destroy(r5info, r5ch);
+			return -ENOMEM;
+		}
+
+		TAILQ_INSERT_HEAD(&r5ch->free_stripe_requests, stripe_req, link);
+	}
+
+	return 0;
 }
 
 static int
@@ -69,6 +1040,7 @@ raid5_start(struct raid_bdev *raid_bdev)
 	uint64_t min_blockcnt = UINT64_MAX;
 	struct raid_base_bdev_info *base_info;
 	struct raid5_info *r5info;
+	int i;
 
 	r5info = calloc(1, sizeof(*r5info));
 	if (!r5info) {
@@ -85,20 +1057,61 @@ raid5_start(struct raid_bdev *raid_bdev)
 	r5info->stripe_blocks = raid_bdev->strip_size * raid5_stripe_data_chunks_num(raid_bdev);
 
 	raid_bdev->bdev.blockcnt = r5info->stripe_blocks * r5info->total_stripes;
+	raid_bdev->data_width = raid5_stripe_data_chunks_num(raid_bdev);
 	raid_bdev->bdev.optimal_io_boundary = r5info->stripe_blocks;
 	raid_bdev->bdev.split_on_optimal_io_boundary = true;
 
+	pthread_spin_init(&r5info->stripe_lock, PTHREAD_PROCESS_PRIVATE);
+	for (i = 0; i < RAID5_STRIPE_LOCK_BUCKETS; i++) {
+		TAILQ_INIT(&r5info->locked_stripes[i]);
+	}
+
 	raid_bdev->module_private = r5info;
 
+	spdk_io_device_register(r5info, raid5_ioch_create, raid5_ioch_destroy,
+				sizeof(struct raid5_io_channel), NULL);
+
 	return 0;
 }
 
+static void
+raid5_io_device_unregister_done(void *io_device)
+{
+	struct raid5_info *r5info = io_device;
+
+	pthread_spin_destroy(&r5info->stripe_lock);
+	free(r5info);
+}
+
 static void
 raid5_stop(struct raid_bdev *raid_bdev)
 {
 	struct raid5_info *r5info = raid_bdev->module_private;
 
-	free(r5info);
+	spdk_io_device_unregister(r5info, raid5_io_device_unregister_done);
+}
+
+static struct spdk_io_channel *
+raid5_get_io_channel(struct raid_bdev *raid_bdev)
+{
+	struct raid5_info *r5info = raid_bdev->module_private;
+
+	return spdk_get_io_channel(r5info);
+}
+
+/* Each chunk of a stripe is the XOR of all the other chunks */
+static uint8_t
+raid5_get_rebuild_sources(struct raid_bdev *raid_bdev, uint8_t idx, uint8_t *sources)
+{
+	uint8_t i, num = 0;
+
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		if (i != idx) {
+			sources[num++] = i;
+		}
+	}
+
+	return num;
 }
 
 static struct raid_bdev_module g_raid5_module = {
@@ -108,6 +1121,8 @@ static struct raid_bdev_module g_raid5_module = {
 	.start = raid5_start,
 	.stop = raid5_stop,
 	.submit_rw_request = raid5_submit_rw_request,
+	.get_io_channel = raid5_get_io_channel,
+	.get_rebuild_sources = raid5_get_rebuild_sources,
 };
 RAID_MODULE_REGISTER(&g_raid5_module)
 
@@ -46,10 +46,15 @@
 #include "spdk/string.h"
 
 #include "spdk/log.h"
+#include "spdk_internal/assert.h"
 #include "spdk_internal/uring.h"
 
+#include <linux/falloc.h>
+
 struct bdev_uring_io_channel {
 	struct bdev_uring_group_channel		*group_ch;
+	/* The bdev's fd is registered in the group channel's file table */
+	bool					fixed_file;
 };
 
 struct bdev_uring_group_channel {
@@ -57,6 +62,9 @@ struct bdev_uring_group_channel {
 	uint64_t				io_pending;
 	struct spdk_poller			*poller;
 	struct io_uring				uring;
+	/* Number of entries of g_fixed_bufs registered with the ring */
+	uint32_t				num_fixed_bufs;
+	bool					fixed_files;
 };
 
 struct bdev_uring_task {
@@ -69,16 +77,51 @@ struct bdev_uring {
 	struct spdk_bdev	bdev;
 	char			*filename;
 	int			fd;
+	/* Index in the ring file tables, -1 if the fd is not registered */
+	int			fixed_file_idx;
 	TAILQ_ENTRY(bdev_uring)  link;
 };
 
 static int bdev_uring_init(void);
 static void bdev_uring_fini(void);
+static int bdev_uring_config_json(struct spdk_json_write_ctx *w);
 static void uring_free_bdev(struct bdev_uring *uring);
 static TAILQ_HEAD(, bdev_uring) g_uring_bdev_head = TAILQ_HEAD_INITIALIZER(g_uring_bdev_head);
 
 #define SPDK_URING_QUEUE_DEPTH 512
 #define MAX_EVENTS_PER_POLL 32
+#define SPDK_URING_MAX_FIXED_FILES 64
+/* The kernel limits both the number and the size of registered buffers */
+#define SPDK_URING_MAX_FIXED_BUFS 1024
+#define SPDK_URING_MAX_FIXED_BUF_SIZE (1ULL << 30)
+
+static struct bdev_uring_opts g_opts = {
+	.fixed_files = false,
+	.fixed_buffers = false,
+	.sqpoll = false,
+	.sqpoll_cpu = -1,
+	.sqpoll_idle_ms = 1000,
+};
+
+static bool g_fallocate_supported;
+
+/* Slots of the ring file tables in use. A slot is released once the io device of
+ * its bdev is unregistered, when no ring has the bdev's fd in it anymore.
+ */
+static bool g_fixed_file_used[SPDK_URING_MAX_FIXED_FILES];
+
+/* SPDK memory is split into chunks of at most SPDK_URING_MAX_FIXED_BUF_SIZE which
+ * are appended to g_fixed_bufs as they get registered. Each group channel registers
+ * the chunks known at its creation with its ring. g_fixed_buf_map translates an
+ * address to the index of its chunk plus one, or 0 if it is not part of a chunk.
+ * Indexes are never reused; the chunks of unregistered memory are replaced with
+ * g_fixed_buf_placeholder so that later rings can still register the whole array.
+ */
+static struct spdk_mem_map *g_fixed_buf_map;
+static pthread_mutex_t g_fixed_bufs_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct iovec g_fixed_bufs[SPDK_URING_MAX_FIXED_BUFS];
+static uint32_t g_num_fixed_bufs;
+static uint8_t g_fixed_buf_placeholder[4096] __attribute__((aligned(4096)));
 
 static int
 bdev_uring_get_ctx_size(void)
@@ -90,6 +133,7 @@ static struct spdk_bdev_module uring_if = {
 	.name		= "uring",
 	.module_init	= bdev_uring_init,
 	.module_fini	= bdev_uring_fini,
+	.config_json	= bdev_uring_config_json,
 	.get_ctx_size	= bdev_uring_get_ctx_size,
 };
 
@@ -138,6 +182,99 @@ bdev_uring_close(struct bdev_uring *bdev)
 	return 0;
 }
 
+static int
+bdev_uring_mem_notify(void *cb_ctx, struct spdk_mem_map *map,
+		      enum spdk_mem_map_notify_action action,
+		      void *vaddr, size_t size)
+{
+	uint64_t start = (uint64_t)vaddr, end = start + size, chunk_start;
+	size_t chunk_size;
+	uint32_t i;
+	int rc = 0;
+
+	pthread_mutex_lock(&g_fixed_bufs_mutex);
+	switch (action) {
+	case SPDK_MEM_MAP_NOTIFY_REGISTER:
+		while (start < end && g_num_fixed_bufs < SPDK_URING_MAX_FIXED_BUFS) {
+			chunk_size = spdk_min(end - start, SPDK_URING_MAX_FIXED_BUF_SIZE);
+			rc = spdk_mem_map_set_translation(map, start, chunk_size,
+							  g_num_fixed_bufs + 1);
+			if (rc != 0) {
+				break;
+			}
+			g_fixed_bufs[g_num_fixed_bufs].iov_base = (void *)start;
+			g_fixed_bufs[g_num_fixed_bufs].iov_len = chunk_size;
+			g_num_fixed_bufs++;
+			start += chunk_size;
+		}
+		break;
+	case SPDK_MEM_MAP_NOTIFY_UNREGISTER:
+		for (i = 0; i < g_num_fixed_bufs; i++) {
+			chunk_start = (uint64_t)g_fixed_bufs[i].iov_base;
+			chunk_size = g_fixed_bufs[i].iov_len;
+			if (chunk_start >= end || chunk_start + chunk_size <= start ||
+			    g_fixed_bufs[i].iov_base == g_fixed_buf_placeholder) {
+				continue;
+			}
+			/* Drop the whole chunk, even if only a part of it is unregistered. */
+			rc = spdk_mem_map_clear_translation(map, chunk_start, chunk_size);
+			if (rc != 0) {
+				break;
+			}
+			g_fixed_bufs[i].iov_base = g_fixed_buf_placeholder;
+			g_fixed_bufs[i].iov_len = sizeof(g_fixed_buf_placeholder);
+		}
+		break;
+	default:
+		SPDK_UNREACHABLE();
+	}
+	pthread_mutex_unlock(&g_fixed_bufs_mutex);
+
+	return rc;
+}
+
+static int
+bdev_uring_check_contiguous_entries(uint64_t addr_1, uint64_t addr_2)
+{
+	/* Two contiguous mappings point to the same registered buffer. */
+	return addr_1 == addr_2;
+}
+
+static const struct spdk_mem_map_ops g_fixed_buf_map_ops = {
+	.notify_cb = bdev_uring_mem_notify,
+	.are_contiguous = bdev_uring_check_contiguous_entries
+};
+
+/* Return the index of the buffer registered with the group channel's ring
+ * which contains the whole iov, or -1 if there is none.
+ */
+static int
+bdev_uring_get_fixed_buf(struct bdev_uring_group_channel *group_ch, struct iovec *iov)
+{
+	uint64_t idx, size = iov->iov_len;
+
+	if (group_ch->num_fixed_bufs == 0) {
+		return -1;
+	}
+
+	idx = spdk_mem_map_translate(g_fixed_buf_map, (uint64_t)iov->iov_base, &size);
+	if (idx == 0 || idx > group_ch->num_fixed_bufs || size < iov->iov_len) {
+		return -1;
+	}
+
+	return idx - 1;
+}
+
+static void
+bdev_uring_sqe_set_file(struct io_uring_sqe *sqe, struct bdev_uring *uring,
+			struct bdev_uring_io_channel *uring_ch)
+{
+	if (uring_ch->fixed_file) {
+		sqe->fd = uring->fixed_file_idx;
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+	}
+}
+
 static int64_t
 bdev_uring_readv(struct bdev_uring *uring, struct spdk_io_channel *ch,
 		 struct bdev_uring_task *uring_task,
@@ -146,9 +283,24 @@ bdev_uring_readv(struct bdev_uring *uring, struct spdk_io_channel *ch,
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
 	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
 	struct io_uring_sqe *sqe;
+	int buf_index = -1;
 
 	sqe = io_uring_get_sqe(&group_ch->uring);
-	io_uring_prep_readv(sqe, uring->fd, iov, iovcnt, offset);
+	if (spdk_unlikely(sqe == NULL)) {
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), SPDK_BDEV_IO_STATUS_NOMEM);
+		return -1;
+	}
+
+	if (iovcnt == 1) {
+		buf_index = bdev_uring_get_fixed_buf(group_ch, iov);
+	}
+	if (buf_index >= 0) {
+		io_uring_prep_read_fixed(sqe, uring->fd, iov->iov_base, iov->iov_len, offset,
+					 buf_index);
+	} else {
+		io_uring_prep_readv(sqe, uring->fd, iov, iovcnt, offset);
+	}
+	bdev_uring_sqe_set_file(sqe, uring, uring_ch);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
 	uring_task->ch = uring_ch;
@@ -168,9 +320,24 @@ bdev_uring_writev(struct bdev_uring *uring, struct spdk_io_channel *ch,
 	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
 	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
 	struct io_uring_sqe *sqe;
+	int buf_index = -1;
 
 	sqe = io_uring_get_sqe(&group_ch->uring);
-	io_uring_prep_writev(sqe, uring->fd, iov, iovcnt, offset);
+	if (spdk_unlikely(sqe == NULL)) {
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), SPDK_BDEV_IO_STATUS_NOMEM);
+		return -1;
+	}
+
+	if (iovcnt == 1) {
+		buf_index = bdev_uring_get_fixed_buf(group_ch, iov);
+	}
+	if (buf_index >= 0) {
+		io_uring_prep_write_fixed(sqe, uring->fd, iov->iov_base, iov->iov_len, offset,
+					  buf_index);
+	} else {
+		io_uring_prep_writev(sqe, uring->fd, iov, iovcnt, offset);
+	}
+	bdev_uring_sqe_set_file(sqe, uring, uring_ch);
 	io_uring_sqe_set_data(sqe, uring_task);
 	uring_task->len = nbytes;
 	uring_task->ch = uring_ch;
@@ -182,6 +349,43 @@ bdev_uring_writev(struct bdev_uring *uring, struct spdk_io_channel *ch,
 	return nbytes;
 }
 
+static int64_t
+bdev_uring_fallocate(struct bdev_uring *uring, struct spdk_io_channel *ch,
+		     struct bdev_uring_task *uring_task,
+		     int mode, uint64_t nbytes, uint64_t offset)
+{
+	struct bdev_uring_io_channel *uring_ch = spdk_io_channel_get_ctx(ch);
+	struct bdev_uring_group_channel *group_ch = uring_ch->group_ch;
+	struct io_uring_sqe *sqe;
+
+	sqe = io_uring_get_sqe(&group_ch->uring);
+	if (spdk_unlikely(sqe == NULL)) {
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(uring_task), SPDK_BDEV_IO_STATUS_NOMEM);
+		return -1;
+	}
+
+	io_uring_prep_fallocate(sqe, uring->fd, mode, offset, nbytes);
+	bdev_uring_sqe_set_file(sqe, uring, uring_ch);
+	io_uring_sqe_set_data(sqe, uring_task);
+	/* fallocate() returns 0 on success */
+	uring_task->len = 0;
+	uring_task->ch = uring_ch;
+
+	SPDK_DEBUGLOG(uring, "fallocate mode %#x size %lu at off: %#lx\n",
+		      mode, nbytes, offset);
+
+	group_ch->io_pending++;
+	return nbytes;
+}
+
+static void
+bdev_uring_unregister_cb(void *io_device)
+{
+	struct bdev_uring *uring = io_device;
+
+	uring_free_bdev(uring);
+}
+
 static int
 bdev_uring_destruct(void *ctx)
 {
@@ -193,8 +397,8 @@ bdev_uring_destruct(void *ctx)
 	if (rc < 0) {
 		SPDK_ERRLOG("bdev_uring_close() failed\n");
 	}
-	spdk_io_device_unregister(uring, NULL);
-	uring_free_bdev(uring);
+	/* Free the bdev and its file slot once the io channels reset the slot in their rings */
+	spdk_io_device_unregister(uring, bdev_uring_unregister_cb);
 	return rc;
 }
 
@@ -311,6 +515,22 @@ static int _bdev_uring_submit_request(struct spdk_io_channel *ch, struct spdk_bd
 		spdk_bdev_io_get_buf(bdev_io, bdev_uring_get_buf_cb,
 				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
 		return 0;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+		bdev_uring_fallocate((struct bdev_uring *)bdev_io->bdev->ctxt,
+				     ch,
+				     (struct bdev_uring_task *)bdev_io->driver_ctx,
+				     FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
+				     bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
+		return 0;
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		bdev_uring_fallocate((struct bdev_uring *)bdev_io->bdev->ctxt,
+				     ch,
+				     (struct bdev_uring_task *)bdev_io->driver_ctx,
+				     FALLOC_FL_ZERO_RANGE | FALLOC_FL_KEEP_SIZE,
+				     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen,
+				     bdev_io->u.bdev.offset_blocks * bdev_io->bdev->blocklen);
+		return 0;
 	default:
 		return -1;
 	}
@@ -330,6 +550,9 @@ bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 	case SPDK_BDEV_IO_TYPE_READ:
 	case SPDK_BDEV_IO_TYPE_WRITE:
 		return true;
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		return g_fallocate_supported;
 	default:
 		return false;
 	}
@@ -338,17 +561,36 @@ bdev_uring_io_type_supported(void *ctx, enum spdk_bdev_io_type io_type)
 static int
 bdev_uring_create_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_uring *uring = io_device;
 	struct bdev_uring_io_channel *ch = ctx_buf;
+	int rc;
 
 	ch->group_ch = spdk_io_channel_get_ctx(spdk_get_io_channel(&uring_if));
 
+	if (uring->fixed_file_idx >= 0 && ch->group_ch->fixed_files) {
+		rc = io_uring_register_files_update(&ch->group_ch->uring, uring->fixed_file_idx,
+						    &uring->fd, 1);
+		if (rc == 1) {
+			ch->fixed_file = true;
+		} else {
+			SPDK_WARNLOG("Failed to register fd of %s with io_uring: %d\n",
+				     uring->bdev.name, rc);
+		}
+	}
+
 	return 0;
 }
 
 static void
 bdev_uring_destroy_cb(void *io_device, void *ctx_buf)
 {
+	struct bdev_uring *uring = io_device;
 	struct bdev_uring_io_channel *ch = ctx_buf;
+	int fd = -1;
+
+	if (ch->fixed_file) {
+		io_uring_register_files_update(&ch->group_ch->uring, uring->fixed_file_idx, &fd, 1);
+	}
 
 	spdk_put_io_channel(spdk_io_channel_from_ctx(ch->group_ch));
 }
@@ -369,6 +611,7 @@ bdev_uring_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 	spdk_json_write_named_object_begin(w, "uring");
 
 	spdk_json_write_named_string(w, "filename", uring->filename);
+	spdk_json_write_named_bool(w, "fixed_file", uring->fixed_file_idx >= 0);
 
 	spdk_json_write_object_end(w);
 
@@ -407,6 +650,9 @@ static void uring_free_bdev(struct bdev_uring *uring)
 	if (uring == NULL) {
 		return;
 	}
+	if (uring->fixed_file_idx >= 0) {
+		g_fixed_file_used[uring->fixed_file_idx] = false;
+	}
 	free(uring->filename);
 	free(uring->bdev.name);
 	free(uring);
@@ -416,14 +662,55 @@ static int
 bdev_uring_group_create_cb(void *io_device, void *ctx_buf)
 {
 	struct bdev_uring_group_channel *ch = ctx_buf;
+	struct io_uring_params params = {};
+	int fds[SPDK_URING_MAX_FIXED_FILES];
+	int i, rc;
+
+	if (g_opts.sqpoll) {
+		params.flags |= IORING_SETUP_SQPOLL;
+		params.sq_thread_idle = g_opts.sqpoll_idle_ms;
+		if (g_opts.sqpoll_cpu >= 0) {
+			params.flags |= IORING_SETUP_SQ_AFF;
+			params.sq_thread_cpu = g_opts.sqpoll_cpu;
+		}
+	}
 
 	/* Do not use IORING_SETUP_IOPOLL until the Linux kernel can support not only
 	 * local devices but also devices attached from remote target */
-	if (io_uring_queue_init(SPDK_URING_QUEUE_DEPTH, &ch->uring, 0) < 0) {
-		SPDK_ERRLOG("uring I/O context setup failure\n");
+	rc = io_uring_queue_init_params(SPDK_URING_QUEUE_DEPTH, &ch->uring, &params);
+	if (rc < 0) {
+		SPDK_ERRLOG("uring I/O context setup failure: %s\n", spdk_strerror(-rc));
 		return -1;
 	}
 
+	if (g_opts.fixed_files) {
+		/* Start with an empty table, io channels fill in the fds of their bdevs. */
+		for (i = 0; i < SPDK_URING_MAX_FIXED_FILES; i++) {
+			fds[i] = -1;
+		}
+		rc = io_uring_register_files(&ch->uring, fds, SPDK_URING_MAX_FIXED_FILES);
+		if (rc == 0) {
+			ch->fixed_files = true;
+		} else {
+			SPDK_WARNLOG("Failed to register io_uring file table: %s\n",
+				     spdk_strerror(-rc));
+		}
+	}
+
+	if (g_fixed_buf_map != NULL) {
+		pthread_mutex_lock(&g_fixed_bufs_mutex);
+		if (g_num_fixed_bufs > 0) {
+			rc = io_uring_register_buffers(&ch->uring, g_fixed_bufs, g_num_fixed_bufs);
+			if (rc == 0) {
+				ch->num_fixed_bufs = g_num_fixed_bufs;
+			} else {
+				SPDK_WARNLOG("Failed to register io_uring buffers: %s\n",
+					     spdk_strerror(-rc));
+			}
+		}
+		pthread_mutex_unlock(&g_fixed_bufs_mutex);
+	}
+
 	ch->poller = SPDK_POLLER_REGISTER(bdev_uring_group_poll, ch, 0);
 	return 0;
 }
@@ -433,11 +720,27 @@ bdev_uring_group_destroy_cb(void *io_device, void *ctx_buf)
 {
 	struct bdev_uring_group_channel *ch = ctx_buf;
 
+	/* Registered files and buffers are released along with the ring. */
 	io_uring_queue_exit(&ch->uring);
 
 	spdk_poller_unregister(&ch->poller);
 }
 
+static int
+bdev_uring_get_fixed_file_idx(void)
+{
+	int idx;
+
+	for (idx = 0; idx < SPDK_URING_MAX_FIXED_FILES; idx++) {
+		if (!g_fixed_file_used[idx]) {
+			g_fixed_file_used[idx] = true;
+			return idx;
+		}
+	}
+
+	return -1;
+}
+
 struct spdk_bdev *
 create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 {
@@ -452,6 +755,7 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 		return NULL;
 	}
 
+	uring->fixed_file_idx = -1;
 	uring->filename = strdup(filename);
 	if (!uring->filename) {
 		goto error_return;
@@ -518,6 +822,14 @@ create_uring_bdev(const char *name, const char *filename, uint32_t block_size)
 
 	uring->bdev.fn_table = &uring_fn_table;
 
+	if (g_opts.fixed_files) {
+		uring->fixed_file_idx = bdev_uring_get_fixed_file_idx();
+		if (uring->fixed_file_idx < 0) {
+			SPDK_NOTICELOG("No free io_uring file slot, %s will not use a registered fd\n",
+				       name);
+		}
+	}
+
 	spdk_io_device_register(uring, bdev_uring_create_cb, bdev_uring_destroy_cb,
 				sizeof(struct bdev_uring_io_channel),
 				uring->bdev.name);
@@ -571,9 +883,82 @@ delete_uring_bdev(struct spdk_bdev *bdev, spdk_delete_uring_complete cb_fn, void
 	spdk_bdev_unregister(bdev, uring_bdev_unregister_cb, ctx);
 }
 
+static void
+bdev_uring_free_fixed_buf_map(void)
+{
+	spdk_mem_map_free(&g_fixed_buf_map);
+
+	pthread_mutex_lock(&g_fixed_bufs_mutex);
+	g_num_fixed_bufs = 0;
+	pthread_mutex_unlock(&g_fixed_bufs_mutex);
+}
+
+void
+bdev_uring_get_opts(struct bdev_uring_opts *opts)
+{
+	*opts = g_opts;
+}
+
+int
+bdev_uring_set_opts(const struct bdev_uring_opts *opts)
+{
+	/* Ring options only apply to rings created afterwards, so they cannot
+	 * change once uring bdevs exist.
+	 */
+	if (!TAILQ_EMPTY(&g_uring_bdev_head)) {
+		return -EPERM;
+	}
+
+	if (opts->sqpoll_cpu < -1) {
+		return -EINVAL;
+	}
+
+	if (opts->fixed_buffers && g_fixed_buf_map == NULL) {
+		g_fixed_buf_map = spdk_mem_map_alloc(0, &g_fixed_buf_map_ops, NULL);
+		if (g_fixed_buf_map == NULL) {
+			SPDK_ERRLOG("Unable to create memory map\n");
+			return -ENOMEM;
+		}
+	} else if (!opts->fixed_buffers && g_fixed_buf_map != NULL) {
+		bdev_uring_free_fixed_buf_map();
+	}
+
+	g_opts = *opts;
+
+	return 0;
+}
+
+static int
+bdev_uring_config_json(struct spdk_json_write_ctx *w)
+{
+	spdk_json_write_object_begin(w);
+
+	spdk_json_write_named_string(w, "method", "bdev_uring_set_options");
+
+	spdk_json_write_named_object_begin(w, "params");
+	spdk_json_write_named_bool(w, "fixed_files", g_opts.fixed_files);
+	spdk_json_write_named_bool(w, "fixed_buffers", g_opts.fixed_buffers);
+	spdk_json_write_named_bool(w, "sqpoll", g_opts.sqpoll);
+	spdk_json_write_named_int32(w, "sqpoll_cpu", g_opts.sqpoll_cpu);
+	spdk_json_write_named_uint32(w, "sqpoll_idle_ms", g_opts.sqpoll_idle_ms);
+	spdk_json_write_object_end(w);
+
+	spdk_json_write_object_end(w);
+
+	return 0;
+}
+
 static int
 bdev_uring_init(void)
 {
+	struct io_uring_probe *probe;
+
+	probe = io_uring_get_probe();
+	if (probe != NULL) {
+		g_fallocate_supported = io_uring_opcode_supported(probe, IORING_OP_FALLOCATE);
+		io_uring_free_probe(probe);
+	}
+
 	spdk_io_device_register(&uring_if, bdev_uring_group_create_cb, bdev_uring_group_destroy_cb,
 				sizeof(struct bdev_uring_group_channel), "uring_module");
 
@@ -584,6 +969,10 @@ static void
 bdev_uring_fini(void)
 {
 	spdk_io_device_unregister(&uring_if, NULL);
+
+	if (g_fixed_buf_map != NULL) {
+		bdev_uring_free_fixed_buf_map();
+	}
 }
 
 SPDK_LOG_REGISTER_COMPONENT(uring)
@@ -43,6 +43,22 @@
 
 typedef void (*spdk_delete_uring_complete)(void *cb_arg, int bdeverrno);
 
+struct bdev_uring_opts {
+	/* Register the fds of uring bdevs with each thread's ring */
+	bool fixed_files;
+	/* Register SPDK memory with each thread's ring and use fixed reads/writes */
+	bool fixed_buffers;
+	/* Let a kernel thread poll the submission queue of each thread's ring */
+	bool sqpoll;
+	/* CPU to pin the SQPOLL threads to, -1 for no affinity */
+	int32_t sqpoll_cpu;
+	/* Idle time in milliseconds after which a SQPOLL thread goes to sleep */
+	uint32_t sqpoll_idle_ms;
+};
+
+void bdev_uring_get_opts(struct bdev_uring_opts *opts);
+int bdev_uring_set_opts(const struct bdev_uring_opts *opts);
+
 struct spdk_bdev *create_uring_bdev(const char *name, const char *filename, uint32_t block_size);
 
 void delete_uring_bdev(struct spdk_bdev *bdev, spdk_delete_uring_complete cb_fn, void *cb_arg);
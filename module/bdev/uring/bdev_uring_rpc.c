@@ -37,6 +37,45 @@
 #include "spdk/string.h"
 #include "spdk/log.h"
 
+static const struct spdk_json_object_decoder rpc_bdev_uring_options_decoders[] = {
+	{"fixed_files", offsetof(struct bdev_uring_opts, fixed_files), spdk_json_decode_bool, true},
+	{"fixed_buffers", offsetof(struct bdev_uring_opts, fixed_buffers), spdk_json_decode_bool,
+		true},
+	{"sqpoll", offsetof(struct bdev_uring_opts, sqpoll), spdk_json_decode_bool, true},
+	{"sqpoll_cpu", offsetof(struct bdev_uring_opts, sqpoll_cpu), spdk_json_decode_int32, true},
+	{"sqpoll_idle_ms", offsetof(struct bdev_uring_opts, sqpoll_idle_ms), spdk_json_decode_uint32,
+		true},
+};
+
+static void
+rpc_bdev_uring_set_options(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct bdev_uring_opts opts;
+	int rc;
+
+	bdev_uring_get_opts(&opts);
+	if (params && spdk_json_decode_object(params, rpc_bdev_uring_options_decoders,
+					      SPDK_COUNTOF(rpc_bdev_uring_options_decoders),
+					      &opts)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		return;
+	}
+
+	rc = bdev_uring_set_opts(&opts);
+	if (rc) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 spdk_strerror(-rc));
+		return;
+	}
+
+	spdk_jsonrpc_send_bool_response(request, true);
+}
+SPDK_RPC_REGISTER("bdev_uring_set_options", rpc_bdev_uring_set_options,
+		  SPDK_RPC_STARTUP | SPDK_RPC_RUNTIME)
+
 /* Structure to hold the parameters for this RPC method. */
 struct rpc_create_uring {
 	char *name;
@@ -52,8 +52,11 @@ struct spdk_nvmf_tgt_conf {
 	uint32_t acceptor_poll_rate;
 	uint32_t conn_sched; /* Deprecated. */
 	struct spdk_nvmf_admin_passthru_conf admin_passthru;
+	enum spdk_nvmf_tgt_qpair_placement qpair_placement;
 };
 
+const char *nvmf_tgt_qpair_placement_str(enum spdk_nvmf_tgt_qpair_placement placement);
+
 extern struct spdk_nvmf_tgt_conf g_spdk_nvmf_tgt_conf;
 
 extern uint32_t g_spdk_nvmf_tgt_max_subsystems;
@@ -98,10 +98,40 @@ static int decode_admin_passthru(const struct spdk_json_val *val, void *out)
 	return 0;
 }
 
+const char *
+nvmf_tgt_qpair_placement_str(enum spdk_nvmf_tgt_qpair_placement placement)
+{
+	switch (placement) {
+	case SPDK_NVMF_TGT_QPAIR_PLACEMENT_ROUND_ROBIN:
+		return "round_robin";
+	case SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED:
+		return "least_loaded";
+	default:
+		return NULL;
+	}
+}
+
+static int decode_qpair_placement(const struct spdk_json_val *val, void *out)
+{
+	enum spdk_nvmf_tgt_qpair_placement *placement = out;
+
+	if (spdk_json_strequal(val, "round_robin")) {
+		*placement = SPDK_NVMF_TGT_QPAIR_PLACEMENT_ROUND_ROBIN;
+	} else if (spdk_json_strequal(val, "least_loaded")) {
+		*placement = SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED;
+	} else {
+		SPDK_ERRLOG("Invalid qpair_placement value\n");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 static const struct spdk_json_object_decoder nvmf_rpc_subsystem_tgt_conf_decoder[] = {
 	{"acceptor_poll_rate", offsetof(struct spdk_nvmf_tgt_conf, acceptor_poll_rate), spdk_json_decode_uint32, true},
 	{"conn_sched", offsetof(struct spdk_nvmf_tgt_conf, conn_sched), decode_conn_sched, true},
-	{"admin_cmd_passthru", offsetof(struct spdk_nvmf_tgt_conf, admin_passthru), decode_admin_passthru, true}
+	{"admin_cmd_passthru", offsetof(struct spdk_nvmf_tgt_conf, admin_passthru), decode_admin_passthru, true},
+	{"qpair_placement", offsetof(struct spdk_nvmf_tgt_conf, qpair_placement), decode_qpair_placement, true}
 };
 
 static void
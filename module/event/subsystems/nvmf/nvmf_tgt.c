@@ -62,7 +62,8 @@ struct nvmf_tgt_poll_group {
 
 struct spdk_nvmf_tgt_conf g_spdk_nvmf_tgt_conf = {
 	.acceptor_poll_rate = ACCEPT_TIMEOUT_US,
-	.admin_passthru.identify_ctrlr = false
+	.admin_passthru.identify_ctrlr = false,
+	.qpair_placement = SPDK_NVMF_TGT_QPAIR_PLACEMENT_ROUND_ROBIN
 };
 
 struct spdk_nvmf_tgt *g_spdk_nvmf_tgt = NULL;
@@ -281,6 +282,7 @@ nvmf_tgt_create_target(void)
 
 	opts.max_subsystems = g_spdk_nvmf_tgt_max_subsystems;
 	opts.acceptor_poll_rate = g_spdk_nvmf_tgt_conf.acceptor_poll_rate;
+	opts.qpair_placement = g_spdk_nvmf_tgt_conf.qpair_placement;
 	g_spdk_nvmf_tgt = spdk_nvmf_tgt_create(&opts);
 	if (!g_spdk_nvmf_tgt) {
 		SPDK_ERRLOG("spdk_nvmf_tgt_create() failed\n");
@@ -461,6 +463,8 @@ nvmf_subsystem_init(void)
 static void
 nvmf_subsystem_write_config_json(struct spdk_json_write_ctx *w)
 {
+	const char *placement;
+
 	spdk_json_write_array_begin(w);
 
 	spdk_json_write_object_begin(w);
@@ -472,6 +476,8 @@ nvmf_subsystem_write_config_json(struct spdk_json_write_ctx *w)
 	spdk_json_write_named_bool(w, "identify_ctrlr",
 				   g_spdk_nvmf_tgt_conf.admin_passthru.identify_ctrlr);
 	spdk_json_write_object_end(w);
+	placement = nvmf_tgt_qpair_placement_str(g_spdk_nvmf_tgt_conf.qpair_placement);
+	spdk_json_write_named_string(w, "qpair_placement", placement);
 	spdk_json_write_object_end(w);
 	spdk_json_write_object_end(w);
 
@@ -87,6 +87,7 @@ static struct spdk_sock_impl_opts g_spdk_posix_sock_impl_opts = {
 	.enable_zerocopy_send = true,
 	.enable_quickack = false,
 	.enable_placement_id = 0,
+	.zerocopy_threshold = 0,
 };
 
 static int
@@ -752,6 +753,7 @@ _sock_flush(struct spdk_sock *sock)
 	ssize_t rc;
 	unsigned int offset;
 	size_t len;
+	bool is_zcopy = false;
 
 	/* Can't flush from within a callback or we end up with recursive calls */
 	if (sock->cb_cnt > 0) {
@@ -764,11 +766,29 @@ _sock_flush(struct spdk_sock *sock)
 		return 0;
 	}
 
+#ifdef SPDK_ZEROCOPY
+	if (psock->zcopy) {
+		req = TAILQ_FIRST(&sock->queued_reqs);
+		/* A request that was partially sent with zero copy has to finish with it
+		 * as well, so that it completes on the notification of its last send. */
+		is_zcopy = req->internal.is_zcopy;
+		if (!is_zcopy) {
+			len = 0;
+			for (i = 0; i < iovcnt; i++) {
+				len += iovs[i].iov_len;
+			}
+			/* Pinning pages and waiting for the notification costs more than
+			 * copying small sends into the kernel. */
+			is_zcopy = len >= g_spdk_posix_sock_impl_opts.zerocopy_threshold;
+		}
+	}
+#endif
+
 	/* Perform the vectored write */
 	msg.msg_iov = iovs;
 	msg.msg_iovlen = iovcnt;
 #ifdef SPDK_ZEROCOPY
-	if (psock->zcopy) {
+	if (is_zcopy) {
 		flags = MSG_ZEROCOPY;
 	} else
 #endif
@@ -777,18 +797,20 @@ _sock_flush(struct spdk_sock *sock)
 	}
 	rc = sendmsg(psock->fd, &msg, flags);
 	if (rc <= 0) {
-		if (errno == EAGAIN || errno == EWOULDBLOCK || (errno == ENOBUFS && psock->zcopy)) {
+		if (errno == EAGAIN || errno == EWOULDBLOCK || (errno == ENOBUFS && is_zcopy)) {
 			return 0;
 		}
 		return rc;
 	}
 
-	/* Handling overflow case, because we use psock->sendmsg_idx - 1 for the
-	 * req->internal.offset, so sendmsg_idx should not be zero  */
-	if (spdk_unlikely(psock->sendmsg_idx == UINT32_MAX)) {
-		psock->sendmsg_idx = 1;
-	} else {
-		psock->sendmsg_idx++;
+	if (is_zcopy) {
+		/* Handling overflow case, because we use psock->sendmsg_idx - 1 for the
+		 * req->internal.offset, so sendmsg_idx should not be zero  */
+		if (spdk_unlikely(psock->sendmsg_idx == UINT32_MAX)) {
+			psock->sendmsg_idx = 1;
+		} else {
+			psock->sendmsg_idx++;
+		}
 	}
 
 	/* Consume the requests that were actually written */
@@ -809,6 +831,7 @@ _sock_flush(struct spdk_sock *sock)
 			if (len > (size_t)rc) {
 				/* This element was partially sent. */
 				req->internal.offset += rc;
+				req->internal.is_zcopy |= is_zcopy;
 				return 0;
 			}
 
@@ -820,7 +843,7 @@ _sock_flush(struct spdk_sock *sock)
 		/* Handled a full request. */
 		spdk_sock_request_pend(sock, req);
 
-		if (!psock->zcopy) {
+		if (!is_zcopy) {
 			/* The sendmsg syscall above isn't currently asynchronous,
 			* so it's already done. */
 			retval = spdk_sock_request_put(sock, req, 0);
@@ -832,6 +855,7 @@ _sock_flush(struct spdk_sock *sock)
 			 * index is 0 based, so subtract one here because we've already
 			 * incremented above. */
 			req->internal.offset = psock->sendmsg_idx - 1;
+			req->internal.is_zcopy = true;
 		}
 
 		if (rc == 0) {
@@ -1373,6 +1397,7 @@ posix_sock_impl_get_opts(struct spdk_sock_impl_opts *opts, size_t *len)
 	GET_FIELD(enable_zerocopy_send);
 	GET_FIELD(enable_quickack);
 	GET_FIELD(enable_placement_id);
+	GET_FIELD(zerocopy_threshold);
 
 #undef GET_FIELD
 #undef FIELD_OK
@@ -1403,6 +1428,7 @@ posix_sock_impl_set_opts(const struct spdk_sock_impl_opts *opts, size_t len)
 	SET_FIELD(enable_zerocopy_send);
 	SET_FIELD(enable_quickack);
 	SET_FIELD(enable_placement_id);
+	SET_FIELD(zerocopy_threshold);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -160,12 +160,24 @@ if __name__ == "__main__":
     def framework_set_scheduler(args):
         rpc.app.framework_set_scheduler(args.client,
                                         name=args.name,
-                                        period=args.period)
+                                        period=args.period,
+                                        load_limit=args.load_limit,
+                                        load_hysteresis=args.load_hysteresis,
+                                        load_weight=args.load_weight,
+                                        max_migrations=args.max_migrations)
 
     p = subparsers.add_parser(
         'framework_set_scheduler', help='Select thread scheduler that will be activated and its period (experimental)')
     p.add_argument('name', help="Name of a scheduler")
     p.add_argument('-p', '--period', help="Scheduler period in microseconds", type=int)
+    p.add_argument('--load-limit', help="Thread load in percent above which a thread is busy (dynamic scheduler)",
+                   type=int)
+    p.add_argument('--load-hysteresis', help="Band in percent around load limit in which threads keep their placement (dynamic scheduler)",
+                   type=int)
+    p.add_argument('--load-weight', help="Weight in percent of the latest period in the smoothed thread load (dynamic scheduler)",
+                   type=int)
+    p.add_argument('--max-migrations', help="Maximum number of thread moves per period, 0 for unlimited (dynamic scheduler)",
+                   type=int)
     p.set_defaults(func=framework_set_scheduler)
 
     def framework_get_scheduler(args):
@@ -182,7 +194,9 @@ if __name__ == "__main__":
                                   bdev_io_cache_size=args.bdev_io_cache_size,
                                   bdev_auto_examine=args.bdev_auto_examine,
                                   small_buf_pool_size=args.small_buf_pool_size,
-                                  large_buf_pool_size=args.large_buf_pool_size)
+                                  large_buf_pool_size=args.large_buf_pool_size,
+                                  small_buf_cache_size=args.small_buf_cache_size,
+                                  large_buf_cache_size=args.large_buf_cache_size)
 
     p = subparsers.add_parser('bdev_set_options', aliases=['set_bdev_options'],
                               help="""Set options of bdev subsystem""")
@@ -190,6 +204,8 @@ if __name__ == "__main__":
     p.add_argument('-c', '--bdev-io-cache-size', help='Maximum number of bdev_io structures cached per thread', type=int)
     p.add_argument('-s', '--small-buf-pool-size', help='Maximum number of small buf (i.e., 8KB) pool size', type=int)
     p.add_argument('-l', '--large-buf-pool-size', help='Maximum number of large buf (i.e., 64KB) pool size', type=int)
+    p.add_argument('--small-buf-cache-size', help='Maximum number of small bufs cached per thread', type=int)
+    p.add_argument('--large-buf-cache-size', help='Maximum number of large bufs cached per thread', type=int)
     group = p.add_mutually_exclusive_group()
     group.add_argument('-e', '--enable-auto-examine', dest='bdev_auto_examine', help='Allow to auto examine', action='store_true')
     group.add_argument('-d', '--disable-auto-examine', dest='bdev_auto_examine', help='Not allow to auto examine', action='store_false')
@@ -422,6 +438,27 @@ if __name__ == "__main__":
     p.add_argument('name', help='aio bdev name')
     p.set_defaults(func=bdev_aio_delete)
 
+    def bdev_uring_set_options(args):
+        rpc.bdev.bdev_uring_set_options(args.client,
+                                        fixed_files=args.fixed_files,
+                                        fixed_buffers=args.fixed_buffers,
+                                        sqpoll=args.sqpoll,
+                                        sqpoll_cpu=args.sqpoll_cpu,
+                                        sqpoll_idle_ms=args.sqpoll_idle_ms)
+
+    p = subparsers.add_parser('bdev_uring_set_options',
+                              help='Set options for the uring bdev module. Must be called before creating uring bdevs.')
+    p.add_argument('--fixed-files', help='Register the fds of uring bdevs with io_uring',
+                   action='store_true', default=None)
+    p.add_argument('--fixed-buffers', help='Register SPDK memory with io_uring and use fixed reads/writes',
+                   action='store_true', default=None)
+    p.add_argument('--sqpoll', help='Poll the submission queues from kernel threads',
+                   action='store_true', default=None)
+    p.add_argument('--sqpoll-cpu', help='CPU to pin the SQPOLL kernel threads to, -1 for no affinity', type=int)
+    p.add_argument('--sqpoll-idle-ms', help='Idle time in milliseconds before a SQPOLL kernel thread sleeps',
+                   type=int)
+    p.set_defaults(func=bdev_uring_set_options)
+
     def bdev_uring_create(args):
         print_json(rpc.bdev.bdev_uring_create(args.client,
                                               filename=args.filename,
@@ -829,6 +866,24 @@ if __name__ == "__main__":
     p.add_argument('name', help='bdev name')
     p.set_defaults(func=bdev_get_histogram)
 
+    def bdev_enable_stage_histogram(args):
+        rpc.bdev.bdev_enable_stage_histogram(args.client, name=args.name, enable=args.enable)
+
+    p = subparsers.add_parser('bdev_enable_stage_histogram',
+                              help='Enable or disable per-stage latency histograms for specified bdev')
+    p.add_argument('-e', '--enable', default=True, dest='enable', action='store_true', help='Enable histograms on specified device')
+    p.add_argument('-d', '--disable', dest='enable', action='store_false', help='Disable histograms on specified device')
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_enable_stage_histogram)
+
+    def bdev_get_stage_histogram(args):
+        print_dict(rpc.bdev.bdev_get_stage_histogram(args.client, name=args.name))
+
+    p = subparsers.add_parser('bdev_get_stage_histogram',
+                              help='Get per-stage latency histograms for specified bdev')
+    p.add_argument('name', help='bdev name')
+    p.set_defaults(func=bdev_get_stage_histogram)
+
     def bdev_set_qd_sampling_period(args):
         rpc.bdev.bdev_set_qd_sampling_period(args.client,
                                              name=args.name,
@@ -1662,7 +1717,7 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-n', '--name', help='raid bdev name', required=True)
     p.add_argument('-s', '--strip-size', help='strip size in KB (deprecated)', type=int)
     p.add_argument('-z', '--strip-size_kb', help='strip size in KB', type=int)
-    p.add_argument('-r', '--raid-level', help='raid level, only raid level 0 is supported', required=True)
+    p.add_argument('-r', '--raid-level', help='raid level, raid levels 0, 1, 10 and 5 are supported', required=True)
     p.add_argument('-b', '--base-bdevs', help='base bdevs name, whitespace separated list in quotes', required=True)
     p.set_defaults(func=bdev_raid_create)
 
@@ -1674,6 +1729,24 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('name', help='raid bdev name')
     p.set_defaults(func=bdev_raid_delete)
 
+    def bdev_raid_add_base_bdev(args):
+        rpc.bdev.bdev_raid_add_base_bdev(args.client,
+                                         raid_bdev=args.raid_bdev,
+                                         base_bdev=args.base_bdev)
+    p = subparsers.add_parser('bdev_raid_add_base_bdev',
+                              help='Add a base bdev to a raid bdev in place of a removed one and rebuild it')
+    p.add_argument('raid_bdev', help='raid bdev name')
+    p.add_argument('base_bdev', help='base bdev name')
+    p.set_defaults(func=bdev_raid_add_base_bdev)
+
+    def bdev_raid_set_options(args):
+        rpc.bdev.bdev_raid_set_options(args.client,
+                                       rebuild_max_bandwidth_mb_sec=args.rebuild_max_bandwidth_mb_sec)
+    p = subparsers.add_parser('bdev_raid_set_options', help='Set options of the raid bdev module')
+    p.add_argument('-w', '--rebuild-max-bandwidth-mb-sec',
+                   help='maximum rebuild bandwidth in MiB/s, 0 for no limit', type=int)
+    p.set_defaults(func=bdev_raid_set_options)
+
     # split
     def bdev_split_create(args):
         print_array(rpc.bdev.bdev_split_create(args.client,
@@ -1838,7 +1911,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
         rpc.nvmf.nvmf_set_config(args.client,
                                  acceptor_poll_rate=args.acceptor_poll_rate,
                                  conn_sched=args.conn_sched,
-                                 passthru_identify_ctrlr=args.passthru_identify_ctrlr)
+                                 passthru_identify_ctrlr=args.passthru_identify_ctrlr,
+                                 qpair_placement=args.qpair_placement)
 
     p = subparsers.add_parser('nvmf_set_config', aliases=['set_nvmf_target_config'],
                               help='Set NVMf target config')
@@ -1846,6 +1920,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-s', '--conn-sched', help='(Deprecated). Ignored.')
     p.add_argument('-i', '--passthru-identify-ctrlr', help="""Passthrough fields like serial number and model number
     when the controller has a single namespace that is an NVMe bdev""", action='store_true')
+    p.add_argument('-p', '--qpair-placement', help="""How new qpairs are assigned to poll groups: round_robin
+    (default) or least_loaded""", choices=['round_robin', 'least_loaded'])
     p.set_defaults(func=nvmf_set_config)
 
     def nvmf_create_transport(args):
@@ -1870,7 +1946,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        acceptor_backlog=args.acceptor_backlog,
                                        abort_timeout_sec=args.abort_timeout_sec,
                                        no_wr_batching=args.no_wr_batching,
-                                       control_msg_num=args.control_msg_num)
+                                       control_msg_num=args.control_msg_num,
+                                       zcopy=args.zcopy)
 
     p = subparsers.add_parser('nvmf_create_transport', help='Create NVMf transport')
     p.add_argument('-t', '--trtype', help='Transport type (ex. RDMA)', type=str, required=True)
@@ -1897,6 +1974,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-w', '--no-wr-batching', action='store_true', help='Disable work requests batching. Relevant only for RDMA transport')
     p.add_argument('-e', '--control_msg_num', help="""The number of control messages per poll group.
     Relevant only for TCP transport""", type=int)
+    p.add_argument('-z', '--zcopy', action='store_true', help="""Use zero-copy buffers provided by the bdev for reads
+    and writes. Relevant only for TCP transport""")
     p.set_defaults(func=nvmf_create_transport)
 
     def nvmf_get_transports(args):
@@ -2581,7 +2660,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        enable_recv_pipe=args.enable_recv_pipe,
                                        enable_zerocopy_send=args.enable_zerocopy_send,
                                        enable_quickack=args.enable_quickack,
-                                       enable_placement_id=args.enable_placement_id)
+                                       enable_placement_id=args.enable_placement_id,
+                                       zerocopy_threshold=args.zerocopy_threshold)
 
     p = subparsers.add_parser('sock_impl_set_options', help="""Set options of socket layer implementation""")
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
@@ -2596,6 +2676,7 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    action='store_true', dest='enable_zerocopy_send')
     p.add_argument('--disable-zerocopy-send', help='Disable zerocopy on send',
                    action='store_false', dest='enable_zerocopy_send')
+    p.add_argument('--zerocopy-threshold', help='Minimum size of a send in bytes to use zerocopy', type=int)
     p.add_argument('--enable-quickack', help='Enable quick ACK',
                    action='store_true', dest='enable_quickack')
     p.add_argument('--disable-quickack', help='Disable quick ACK',
@@ -37,18 +37,31 @@ def framework_get_reactors(client):
     return client.call('framework_get_reactors')
 
 
-def framework_set_scheduler(client, name, period=None):
+def framework_set_scheduler(client, name, period=None, load_limit=None, load_hysteresis=None,
+                            load_weight=None, max_migrations=None):
     """Select threads scheduler that will be activated and its period.
 
     Args:
         name: Name of a scheduler
         period: Scheduler period in microseconds
+        load_limit: Thread load in percent above which a thread is considered busy (dynamic scheduler)
+        load_hysteresis: Band in percent around load_limit in which threads keep their placement (dynamic scheduler)
+        load_weight: Weight in percent of the latest period in the smoothed thread load (dynamic scheduler)
+        max_migrations: Maximum number of thread moves per scheduler period, 0 for unlimited (dynamic scheduler)
     Returns:
         True or False
     """
     params = {'name': name}
     if period is not None:
         params['period'] = period
+    if load_limit is not None:
+        params['load_limit'] = load_limit
+    if load_hysteresis is not None:
+        params['load_hysteresis'] = load_hysteresis
+    if load_weight is not None:
+        params['load_weight'] = load_weight
+    if max_migrations is not None:
+        params['max_migrations'] = max_migrations
     return client.call('framework_set_scheduler', params)
 
 
@@ -3,7 +3,8 @@ from .helpers import deprecated_alias
 
 @deprecated_alias('set_bdev_options')
 def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bdev_auto_examine=None,
-                     small_buf_pool_size=None, large_buf_pool_size=None):
+                     small_buf_pool_size=None, large_buf_pool_size=None,
+                     small_buf_cache_size=None, large_buf_cache_size=None):
     """Set parameters for the bdev subsystem.
 
     Args:
@@ -12,6 +13,8 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bd
         bdev_auto_examine: if set to false, the bdev layer will not examine every disks automatically (optional)
         small_buf_pool_size: maximum number of small buffer (8KB buffer) pool size (optional)
         large_buf_pool_size: maximum number of large buffer (64KB buffer) pool size (optional)
+        small_buf_cache_size: maximum number of small buffers cached per thread (optional)
+        large_buf_cache_size: maximum number of large buffers cached per thread (optional)
     """
     params = {}
 
@@ -25,6 +28,10 @@ def bdev_set_options(client, bdev_io_pool_size=None, bdev_io_cache_size=None, bd
         params['small_buf_pool_size'] = small_buf_pool_size
     if large_buf_pool_size:
         params['large_buf_pool_size'] = large_buf_pool_size
+    if small_buf_cache_size is not None:
+        params['small_buf_cache_size'] = small_buf_cache_size
+    if large_buf_cache_size is not None:
+        params['large_buf_cache_size'] = large_buf_cache_size
     return client.call('bdev_set_options', params)
 
 
@@ -313,7 +320,7 @@ def bdev_raid_create(client, name, raid_level, base_bdevs, strip_size=None, stri
         name: user defined raid bdev name
         strip_size (deprecated): strip size of raid bdev in KB, supported values like 8, 16, 32, 64, 128, 256, etc
         strip_size_kb: strip size of raid bdev in KB, supported values like 8, 16, 32, 64, 128, 256, etc
-        raid_level: raid level of raid bdev, supported values 0
+        raid_level: raid level of raid bdev, supported values 0, 1 and 10
         base_bdevs: Space separated names of Nvme bdevs in double quotes, like "Nvme0n1 Nvme1n1 Nvme2n1"
 
     Returns:
@@ -344,6 +351,38 @@ def bdev_raid_delete(client, name):
     return client.call('bdev_raid_delete', params)
 
 
+def bdev_raid_add_base_bdev(client, raid_bdev, base_bdev):
+    """Add a base bdev to a raid bdev in place of a removed one. The base bdev
+    is rebuilt if the raid bdev is online.
+
+    Args:
+        raid_bdev: raid bdev name
+        base_bdev: base bdev name
+
+    Returns:
+        None
+    """
+    params = {'raid_bdev': raid_bdev, 'base_bdev': base_bdev}
+    return client.call('bdev_raid_add_base_bdev', params)
+
+
+def bdev_raid_set_options(client, rebuild_max_bandwidth_mb_sec=None):
+    """Set options for the raid bdev module.
+
+    Args:
+        rebuild_max_bandwidth_mb_sec: maximum rebuild bandwidth in MiB/s, 0 for no limit (optional)
+
+    Returns:
+        None
+    """
+    params = {}
+
+    if rebuild_max_bandwidth_mb_sec is not None:
+        params['rebuild_max_bandwidth_mb_sec'] = rebuild_max_bandwidth_mb_sec
+
+    return client.call('bdev_raid_set_options', params)
+
+
 @deprecated_alias('construct_aio_bdev')
 def bdev_aio_create(client, filename, name, block_size=None):
     """Construct a Linux AIO block device.
@@ -376,6 +415,33 @@ def bdev_aio_delete(client, name):
     return client.call('bdev_aio_delete', params)
 
 
+def bdev_uring_set_options(client, fixed_files=None, fixed_buffers=None, sqpoll=None,
+                           sqpoll_cpu=None, sqpoll_idle_ms=None):
+    """Set options for the uring bdev module. Only allowed before any uring bdev is created.
+
+    Args:
+        fixed_files: register the fds of uring bdevs with io_uring (optional)
+        fixed_buffers: register SPDK memory with io_uring and use fixed reads/writes (optional)
+        sqpoll: poll the submission queues from kernel threads (optional)
+        sqpoll_cpu: CPU to pin the SQPOLL kernel threads to, -1 for no affinity (optional)
+        sqpoll_idle_ms: idle time in milliseconds before a SQPOLL kernel thread sleeps (optional)
+    """
+    params = {}
+
+    if fixed_files is not None:
+        params['fixed_files'] = fixed_files
+    if fixed_buffers is not None:
+        params['fixed_buffers'] = fixed_buffers
+    if sqpoll is not None:
+        params['sqpoll'] = sqpoll
+    if sqpoll_cpu is not None:
+        params['sqpoll_cpu'] = sqpoll_cpu
+    if sqpoll_idle_ms is not None:
+        params['sqpoll_idle_ms'] = sqpoll_idle_ms
+
+    return client.call('bdev_uring_set_options', params)
+
+
 def bdev_uring_create(client, filename, name, block_size=None):
     """Create a bdev with Linux io_uring backend.
 
@@ -1107,6 +1173,27 @@ def bdev_get_histogram(client, name):
     return client.call('bdev_get_histogram', params)
 
 
+def bdev_enable_stage_histogram(client, name, enable):
+    """Control whether per-stage latency histograms are enabled for specified bdev.
+
+    Args:
+        name: name of bdev
+        enable: enable or disable the histograms
+    """
+    params = {'name': name, "enable": enable}
+    return client.call('bdev_enable_stage_histogram', params)
+
+
+def bdev_get_stage_histogram(client, name):
+    """Get per-stage latency histograms for specified bdev.
+
+    Args:
+        name: name of bdev
+    """
+    params = {'name': name}
+    return client.call('bdev_get_stage_histogram', params)
+
+
 @deprecated_alias('bdev_inject_error')
 def bdev_error_inject_error(client, name, io_type, error_type, num=1):
     """Inject an error via an error bdev.
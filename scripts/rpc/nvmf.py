@@ -22,12 +22,14 @@ def nvmf_set_max_subsystems(client,
 def nvmf_set_config(client,
                     acceptor_poll_rate=None,
                     conn_sched=None,
-                    passthru_identify_ctrlr=None):
+                    passthru_identify_ctrlr=None,
+                    qpair_placement=None):
     """Set NVMe-oF target subsystem configuration.
 
     Args:
         acceptor_poll_rate: Acceptor poll period in microseconds (optional)
         conn_sched: (Deprecated) Ignored
+        qpair_placement: How new qpairs are assigned to poll groups: round_robin or least_loaded (optional)
 
     Returns:
         True or False
@@ -42,6 +44,8 @@ def nvmf_set_config(client,
         admin_cmd_passthru = {}
         admin_cmd_passthru['identify_ctrlr'] = passthru_identify_ctrlr
         params['admin_cmd_passthru'] = admin_cmd_passthru
+    if qpair_placement:
+        params['qpair_placement'] = qpair_placement
 
     return client.call('nvmf_set_config', params)
 
@@ -112,7 +116,8 @@ def nvmf_create_transport(client,
                           acceptor_backlog=None,
                           abort_timeout_sec=None,
                           no_wr_batching=None,
-                          control_msg_num=None):
+                          control_msg_num=None,
+                          zcopy=None):
     """NVMf Transport Create options.
 
     Args:
@@ -135,6 +140,7 @@ def nvmf_create_transport(client,
         abort_timeout_sec: Abort execution timeout value, in seconds (optional)
         no_wr_batching: Boolean flag to disable work requests batching - RDMA specific (optional)
         control_msg_num: The number of control messages per poll group - TCP specific (optional)
+        zcopy: Boolean flag to use the bdev's zero-copy buffers for I/O - TCP specific (optional)
     Returns:
         True or False
     """
@@ -182,6 +188,8 @@ def nvmf_create_transport(client,
         params['no_wr_batching'] = no_wr_batching
     if control_msg_num is not None:
         params['control_msg_num'] = control_msg_num
+    if zcopy is not None:
+        params['zcopy'] = zcopy
     return client.call('nvmf_create_transport', params)
 
 
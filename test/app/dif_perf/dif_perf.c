@@ -0,0 +1,288 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/dif.h"
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+
+/*
+ * This application measures the throughput of the DIF generate and verify
+ *  functions in lib/util, with and without copying the data to or from a
+ *  bounce buffer. Splitting the buffer into iovecs whose size is not a multiple
+ *  of the block size exercises the path taken for blocks that cross iovec
+ *  boundaries, as seen with NVMe/TCP and vhost payloads.
+ *
+ * The reported throughput is the amount of block data processed per second.
+ */
+
+enum dif_perf_workload {
+	DIF_PERF_GENERATE,
+	DIF_PERF_VERIFY,
+	DIF_PERF_GENERATE_COPY,
+	DIF_PERF_VERIFY_COPY,
+};
+
+static const char *g_workload_names[] = {
+	[DIF_PERF_GENERATE] = "generate",
+	[DIF_PERF_VERIFY] = "verify",
+	[DIF_PERF_GENERATE_COPY] = "generate_copy",
+	[DIF_PERF_VERIFY_COPY] = "verify_copy",
+};
+
+static enum dif_perf_workload g_workload = DIF_PERF_GENERATE;
+static uint32_t g_block_size = 4096;
+static uint32_t g_md_size = 8;
+static uint32_t g_num_blocks = 32;
+static uint32_t g_iov_size;
+static uint32_t g_time_in_sec = 5;
+
+#define DIF_PERF_MAX_IOVS	1024
+
+static void
+usage(const char *prog)
+{
+	printf("usage: %s [options]\n", prog);
+	printf("Options:\n");
+	printf("\t[-w workload: generate, verify, generate_copy or verify_copy (default: %s)]\n",
+	       g_workload_names[g_workload]);
+	printf("\t[-b data block size in bytes (default: %u)]\n", g_block_size);
+	printf("\t[-m metadata size in bytes (default: %u)]\n", g_md_size);
+	printf("\t[-n number of blocks per operation (default: %u)]\n", g_num_blocks);
+	printf("\t[-i split the interleaved buffer into iovecs of this size in bytes"
+	       " (default: a single iovec)]\n");
+	printf("\t[-t time in seconds (default: %u)]\n", g_time_in_sec);
+}
+
+static int
+parse_args(int argc, char **argv)
+{
+	long val;
+	int ch;
+	size_t i;
+
+	while ((ch = getopt(argc, argv, "w:b:m:n:i:t:")) != -1) {
+		switch (ch) {
+		case 'w':
+			for (i = 0; i < SPDK_COUNTOF(g_workload_names); i++) {
+				if (strcmp(optarg, g_workload_names[i]) == 0) {
+					g_workload = i;
+					break;
+				}
+			}
+			if (i == SPDK_COUNTOF(g_workload_names)) {
+				fprintf(stderr, "Invalid workload: %s\n", optarg);
+				return -EINVAL;
+			}
+			break;
+		case 'b':
+		case 'm':
+		case 'n':
+		case 'i':
+		case 't':
+			val = spdk_strtol(optarg, 10);
+			if (val < 0) {
+				fprintf(stderr, "Invalid value for -%c: %s\n", ch, optarg);
+				return -EINVAL;
+			}
+			if (ch == 'b') {
+				g_block_size = val;
+			} else if (ch == 'm') {
+				g_md_size = val;
+			} else if (ch == 'n') {
+				g_num_blocks = val;
+			} else if (ch == 'i') {
+				g_iov_size = val;
+			} else {
+				g_time_in_sec = val;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return -EINVAL;
+		}
+	}
+
+	if (g_block_size == 0 || g_num_blocks == 0) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Describe buf with iovecs of g_iov_size bytes, or a single one if it is 0. */
+static int
+build_iovs(struct iovec *iovs, uint8_t *buf, size_t len)
+{
+	size_t iov_size = g_iov_size != 0 ? g_iov_size : len;
+	int iovcnt = 0;
+
+	while (len > 0) {
+		if (iovcnt == DIF_PERF_MAX_IOVS) {
+			return -E2BIG;
+		}
+		iovs[iovcnt].iov_base = buf;
+		iovs[iovcnt].iov_len = spdk_min(len, iov_size);
+		buf += iovs[iovcnt].iov_len;
+		len -= iovs[iovcnt].iov_len;
+		iovcnt++;
+	}
+
+	return iovcnt;
+}
+
+static int
+run_once(struct iovec *iovs, int iovcnt, struct iovec *bounce_iov,
+	 const struct spdk_dif_ctx *ctx)
+{
+	struct spdk_dif_error err_blk;
+
+	switch (g_workload) {
+	case DIF_PERF_GENERATE:
+		return spdk_dif_generate(iovs, iovcnt, g_num_blocks, ctx);
+	case DIF_PERF_VERIFY:
+		return spdk_dif_verify(iovs, iovcnt, g_num_blocks, ctx, &err_blk);
+	case DIF_PERF_GENERATE_COPY:
+		return spdk_dif_generate_copy(iovs, iovcnt, bounce_iov, g_num_blocks, ctx);
+	case DIF_PERF_VERIFY_COPY:
+		return spdk_dif_verify_copy(iovs, iovcnt, bounce_iov, g_num_blocks, ctx, &err_blk);
+	default:
+		assert(false);
+		return -EINVAL;
+	}
+}
+
+int
+main(int argc, char **argv)
+{
+	struct spdk_env_opts opts;
+	struct spdk_dif_ctx ctx;
+	struct iovec *iovs = NULL, bounce_iov;
+	uint8_t *ext_buf = NULL, *data_buf = NULL;
+	uint32_t ext_block_size;
+	uint64_t start_tsc, end_tsc, count = 0;
+	double seconds;
+	bool copy;
+	int iovcnt, rc = 0;
+
+	if (parse_args(argc, argv) != 0) {
+		return 1;
+	}
+
+	spdk_env_opts_init(&opts);
+	opts.name = "dif_perf";
+	if (spdk_env_init(&opts)) {
+		printf("Err: Unable to initialize SPDK env\n");
+		return 1;
+	}
+
+	ext_block_size = g_block_size + g_md_size;
+	rc = spdk_dif_ctx_init(&ctx, ext_block_size, g_md_size, true, false, SPDK_DIF_TYPE1,
+			       SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+			       SPDK_DIF_FLAGS_REFTAG_CHECK, 0, 0xFFFF, 0x22, 0, 0);
+	if (rc != 0) {
+		printf("Err: Unable to initialize DIF context: %s\n", spdk_strerror(-rc));
+		return 1;
+	}
+
+	copy = g_workload == DIF_PERF_GENERATE_COPY || g_workload == DIF_PERF_VERIFY_COPY;
+
+	iovs = calloc(DIF_PERF_MAX_IOVS, sizeof(*iovs));
+	ext_buf = malloc((size_t)ext_block_size * g_num_blocks);
+	data_buf = malloc((size_t)g_block_size * g_num_blocks);
+	if (iovs == NULL || ext_buf == NULL || data_buf == NULL) {
+		printf("Err: Unable to allocate buffers\n");
+		rc = 1;
+		goto cleanup;
+	}
+	memset(ext_buf, 0xA5, (size_t)ext_block_size * g_num_blocks);
+	memset(data_buf, 0x5A, (size_t)g_block_size * g_num_blocks);
+
+	bounce_iov.iov_base = ext_buf;
+	bounce_iov.iov_len = (size_t)ext_block_size * g_num_blocks;
+
+	/* The copy workloads take the data without metadata in iovs and the
+	 * interleaved data in the bounce buffer. */
+	if (copy) {
+		iovcnt = build_iovs(iovs, data_buf, (size_t)g_block_size * g_num_blocks);
+	} else {
+		iovcnt = build_iovs(iovs, ext_buf, (size_t)ext_block_size * g_num_blocks);
+	}
+	if (iovcnt < 0) {
+		printf("Err: Too many iovecs, at most %d are supported\n", DIF_PERF_MAX_IOVS);
+		rc = 1;
+		goto cleanup;
+	}
+
+	/* The verify workloads need valid protection information to check. */
+	if (g_workload == DIF_PERF_VERIFY) {
+		rc = spdk_dif_generate(iovs, iovcnt, g_num_blocks, &ctx);
+	} else if (g_workload == DIF_PERF_VERIFY_COPY) {
+		rc = spdk_dif_generate(&bounce_iov, 1, g_num_blocks, &ctx);
+	}
+	if (rc != 0) {
+		printf("Err: Unable to generate DIF: %s\n", spdk_strerror(-rc));
+		rc = 1;
+		goto cleanup;
+	}
+
+	printf("%s: %u blocks of %u+%u bytes, %d iovec(s)\n", g_workload_names[g_workload],
+	       g_num_blocks, g_block_size, g_md_size, iovcnt);
+
+	start_tsc = spdk_get_ticks();
+	end_tsc = start_tsc + g_time_in_sec * spdk_get_ticks_hz();
+	do {
+		rc = run_once(iovs, iovcnt, &bounce_iov, &ctx);
+		if (rc != 0) {
+			printf("Err: DIF %s failed: %s\n", g_workload_names[g_workload],
+			       spdk_strerror(-rc));
+			rc = 1;
+			goto cleanup;
+		}
+		count++;
+	} while (spdk_get_ticks() < end_tsc);
+
+	seconds = (double)(spdk_get_ticks() - start_tsc) / spdk_get_ticks_hz();
+	printf("count = %ju, %.2f MiB/s\n", count,
+	       (double)count * g_num_blocks * g_block_size / seconds / (1024 * 1024));
+
+cleanup:
+	free(data_buf);
+	free(ext_buf);
+	free(iovs);
+
+	return rc;
+}
@@ -0,0 +1,180 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/env.h"
+#include "spdk/string.h"
+#include "spdk/util.h"
+#include "spdk/xor.h"
+
+/*
+ * This application measures the throughput of the XOR and P+Q parity
+ *  functions in lib/util. It can be used to compare the code paths selected
+ *  at build time (isa-l, AVX-512, AVX2, NEON or plain 64-bit words) and to
+ *  measure the effect of changes to them.
+ *
+ * The reported throughput is the amount of source data processed per second.
+ */
+
+static uint32_t g_num_sources = 4;
+static size_t g_buf_size = 64 * 1024;
+static uint32_t g_time_in_sec = 5;
+static size_t g_offset;
+static bool g_pq;
+
+static void
+usage(const char *prog)
+{
+	printf("usage: %s [options]\n", prog);
+	printf("Options:\n");
+	printf("\t[-n number of source buffers (default: %u)]\n", g_num_sources);
+	printf("\t[-s size of each buffer in bytes (default: %zu)]\n", g_buf_size);
+	printf("\t[-t time in seconds (default: %u)]\n", g_time_in_sec);
+	printf("\t[-o offset of the buffers from the optimal alignment in bytes (default: 0)]\n");
+	printf("\t[-q generate P and Q syndromes instead of plain XOR]\n");
+}
+
+static int
+parse_args(int argc, char **argv)
+{
+	long val;
+	int ch;
+
+	while ((ch = getopt(argc, argv, "n:s:t:o:q")) != -1) {
+		switch (ch) {
+		case 'q':
+			g_pq = true;
+			break;
+		case 'n':
+		case 's':
+		case 't':
+		case 'o':
+			val = spdk_strtol(optarg, 10);
+			if (val < 0) {
+				fprintf(stderr, "Invalid value for -%c: %s\n", ch, optarg);
+				return -EINVAL;
+			}
+			if (ch == 'n') {
+				g_num_sources = val;
+			} else if (ch == 's') {
+				g_buf_size = val;
+			} else if (ch == 't') {
+				g_time_in_sec = val;
+			} else {
+				g_offset = val;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return -EINVAL;
+		}
+	}
+
+	if (g_num_sources == 0 || g_num_sources > SPDK_XOR_MAX_SOURCES || g_buf_size == 0) {
+		usage(argv[0]);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct spdk_env_opts opts;
+	void *sources[SPDK_XOR_MAX_SOURCES];
+	void *allocs[SPDK_XOR_MAX_SOURCES + 2] = {};
+	void *p, *q;
+	size_t align = spdk_xor_get_optimal_alignment();
+	uint64_t start_tsc, end_tsc, count = 0;
+	double seconds;
+	uint32_t i;
+	int rc = 0;
+
+	if (parse_args(argc, argv) != 0) {
+		return 1;
+	}
+
+	spdk_env_opts_init(&opts);
+	opts.name = "xor_perf";
+	if (spdk_env_init(&opts)) {
+		printf("Err: Unable to initialize SPDK env\n");
+		return 1;
+	}
+
+	for (i = 0; i < g_num_sources + 2; i++) {
+		if (posix_memalign(&allocs[i], align, g_buf_size + g_offset) != 0) {
+			printf("Err: Unable to allocate buffers\n");
+			rc = 1;
+			goto cleanup;
+		}
+		memset(allocs[i], i, g_buf_size + g_offset);
+	}
+	for (i = 0; i < g_num_sources; i++) {
+		sources[i] = (uint8_t *)allocs[i] + g_offset;
+	}
+	p = (uint8_t *)allocs[g_num_sources] + g_offset;
+	q = (uint8_t *)allocs[g_num_sources + 1] + g_offset;
+
+	printf("%s: %u sources, %zu bytes each, offset %zu, optimal alignment %zu\n",
+	       g_pq ? "P+Q" : "XOR", g_num_sources, g_buf_size, g_offset, align);
+
+	start_tsc = spdk_get_ticks();
+	end_tsc = start_tsc + g_time_in_sec * spdk_get_ticks_hz();
+	do {
+		if (g_pq) {
+			rc = spdk_xor_gen_pq(p, q, sources, g_num_sources, g_buf_size);
+		} else {
+			rc = spdk_xor_gen(p, sources, g_num_sources, g_buf_size);
+		}
+		if (rc != 0) {
+			printf("Err: Parity generation failed: %s\n", spdk_strerror(-rc));
+			rc = 1;
+			goto cleanup;
+		}
+		count++;
+	} while (spdk_get_ticks() < end_tsc);
+
+	seconds = (double)(spdk_get_ticks() - start_tsc) / spdk_get_ticks_hz();
+	printf("count = %ju, %.2f MiB/s\n", count,
+	       (double)count * g_num_sources * g_buf_size / seconds / (1024 * 1024));
+
+cleanup:
+	for (i = 0; i < g_num_sources + 2; i++) {
+		free(allocs[i]);
+	}
+
+	spdk_env_fini();
+	return rc;
+}
@@ -0,0 +1,350 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/bdev.h"
+#include "spdk/blob.h"
+#include "spdk/blob_bdev.h"
+#include "spdk/env.h"
+#include "spdk/event.h"
+#include "spdk/string.h"
+
+/*
+ * Measures the latency of opening blobs in a blobstore holding a large number
+ * of them. A fresh blobstore is created on the given bdev and filled with thin
+ * provisioned blobs, which are then opened one at a time. The first pass reads
+ * each blob's metadata, the second pass opens the already open blobs again, so
+ * it only measures the lookup of the open blob handle.
+ */
+
+enum open_perf_pass {
+	OPEN_PERF_PASS_LOAD,
+	OPEN_PERF_PASS_LOOKUP,
+	OPEN_PERF_PASS_COUNT,
+};
+
+static const char *g_pass_names[OPEN_PERF_PASS_COUNT] = {
+	"Open (load)",
+	"Open (lookup)",
+};
+
+struct open_perf_stats {
+	uint64_t	total_tsc;
+	uint64_t	min_tsc;
+	uint64_t	max_tsc;
+	uint64_t	count;
+};
+
+static const char *g_bdev_name;
+static uint32_t g_num_blobs = 10000;
+static struct spdk_blob_store *g_bs;
+static spdk_blob_id *g_blobids;
+static struct spdk_blob **g_blobs;
+static uint32_t g_index;
+static enum open_perf_pass g_pass;
+static uint32_t g_close_count;
+static uint64_t g_op_start_tsc;
+static struct open_perf_stats g_stats[OPEN_PERF_PASS_COUNT];
+static int g_rc;
+
+static void create_next_blob(void);
+static void open_next_blob(void);
+static void close_next_blob(void);
+
+static void
+unload_complete(void *cb_arg, int bserrno)
+{
+	if (bserrno) {
+		fprintf(stderr, "Failed to unload the blobstore: %d\n", bserrno);
+		if (g_rc == 0) {
+			g_rc = bserrno;
+		}
+	}
+
+	spdk_app_stop(g_rc);
+}
+
+static void
+test_finish(int rc)
+{
+	if (g_rc == 0) {
+		g_rc = rc;
+	}
+
+	if (g_bs == NULL) {
+		spdk_app_stop(g_rc);
+		return;
+	}
+
+	/* On error some blobs may still be open, the unload then fails with -EBUSY */
+	spdk_bs_unload(g_bs, unload_complete, NULL);
+}
+
+static void
+close_complete(void *cb_arg, int bserrno)
+{
+	if (bserrno) {
+		fprintf(stderr, "Failed to close blob: %d\n", bserrno);
+		test_finish(bserrno);
+		return;
+	}
+
+	close_next_blob();
+}
+
+static void
+close_next_blob(void)
+{
+	struct spdk_blob *blob;
+
+	/* Each blob was opened once per pass */
+	if (g_close_count == (uint32_t)OPEN_PERF_PASS_COUNT * g_num_blobs) {
+		test_finish(0);
+		return;
+	}
+
+	blob = g_blobs[g_close_count % g_num_blobs];
+	g_close_count++;
+	spdk_blob_close(blob, close_complete, NULL);
+}
+
+static void
+open_complete(void *cb_arg, struct spdk_blob *blob, int bserrno)
+{
+	struct open_perf_stats *stats = &g_stats[g_pass];
+	uint64_t tsc;
+
+	tsc = spdk_get_ticks() - g_op_start_tsc;
+
+	if (bserrno) {
+		fprintf(stderr, "Failed to open blob 0x%" PRIx64 ": %d\n", g_blobids[g_index], bserrno);
+		test_finish(bserrno);
+		return;
+	}
+
+	stats->total_tsc += tsc;
+	stats->min_tsc = spdk_min(stats->min_tsc, tsc);
+	stats->max_tsc = spdk_max(stats->max_tsc, tsc);
+	stats->count++;
+
+	assert(g_pass == OPEN_PERF_PASS_LOAD || g_blobs[g_index] == blob);
+	g_blobs[g_index] = blob;
+	g_index++;
+	open_next_blob();
+}
+
+static void
+open_next_blob(void)
+{
+	if (g_index == g_num_blobs) {
+		g_index = 0;
+		g_pass++;
+		if (g_pass == OPEN_PERF_PASS_COUNT) {
+			close_next_blob();
+			return;
+		}
+	}
+
+	g_op_start_tsc = spdk_get_ticks();
+	spdk_bs_open_blob(g_bs, g_blobids[g_index], open_complete, NULL);
+}
+
+static void
+create_complete(void *cb_arg, spdk_blob_id blobid, int bserrno)
+{
+	if (bserrno) {
+		fprintf(stderr, "Failed to create blob %u: %d\n", g_index, bserrno);
+		test_finish(bserrno);
+		return;
+	}
+
+	g_blobids[g_index] = blobid;
+	g_index++;
+	create_next_blob();
+}
+
+static void
+create_next_blob(void)
+{
+	struct spdk_blob_opts opts;
+
+	if (g_index == g_num_blobs) {
+		g_index = 0;
+		g_pass = OPEN_PERF_PASS_LOAD;
+		open_next_blob();
+		return;
+	}
+
+	spdk_blob_opts_init(&opts, sizeof(opts));
+	opts.thin_provision = true;
+	spdk_bs_create_blob_ext(g_bs, &opts, create_complete, NULL);
+}
+
+static void
+bs_init_complete(void *cb_arg, struct spdk_blob_store *bs, int bserrno)
+{
+	if (bserrno) {
+		fprintf(stderr, "Failed to initialize the blobstore: %d\n", bserrno);
+		spdk_app_stop(bserrno);
+		return;
+	}
+
+	g_bs = bs;
+	g_index = 0;
+	printf("Creating %u blobs\n", g_num_blobs);
+	create_next_blob();
+}
+
+static void
+base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+		   void *event_ctx)
+{
+	fprintf(stderr, "Unsupported bdev event: type %d\n", type);
+}
+
+static void
+test_start(void *arg1)
+{
+	struct spdk_bs_dev *bs_dev = NULL;
+	struct spdk_bs_opts opts;
+	uint32_t i;
+	int rc;
+
+	g_blobids = calloc(g_num_blobs, sizeof(*g_blobids));
+	g_blobs = calloc(g_num_blobs, sizeof(*g_blobs));
+	if (g_blobids == NULL || g_blobs == NULL) {
+		fprintf(stderr, "Failed to allocate blob arrays\n");
+		spdk_app_stop(-ENOMEM);
+		return;
+	}
+
+	for (i = 0; i < OPEN_PERF_PASS_COUNT; i++) {
+		g_stats[i].min_tsc = UINT64_MAX;
+	}
+
+	rc = spdk_bdev_create_bs_dev_ext(g_bdev_name, base_bdev_event_cb, NULL, &bs_dev);
+	if (rc != 0) {
+		fprintf(stderr, "Could not create blob bdev on %s: %s\n", g_bdev_name, spdk_strerror(-rc));
+		spdk_app_stop(rc);
+		return;
+	}
+
+	spdk_bs_opts_init(&opts, sizeof(opts));
+	/* One metadata page per blob, plus a few for the blobstore itself */
+	opts.num_md_pages = g_num_blobs + 16;
+	spdk_bs_init(bs_dev, &opts, bs_init_complete, NULL);
+}
+
+static void
+print_stats(void)
+{
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	struct open_perf_stats *stats;
+	int i;
+
+	printf("%-16s %10s %12s %12s %12s\n", "Operation", "Count", "Avg (us)", "Min (us)", "Max (us)");
+	for (i = 0; i < OPEN_PERF_PASS_COUNT; i++) {
+		stats = &g_stats[i];
+		if (stats->count == 0) {
+			continue;
+		}
+		printf("%-16s %10" PRIu64 " %12.3f %12.3f %12.3f\n", g_pass_names[i], stats->count,
+		       (double)stats->total_tsc * SPDK_SEC_TO_USEC / ticks_hz / stats->count,
+		       (double)stats->min_tsc * SPDK_SEC_TO_USEC / ticks_hz,
+		       (double)stats->max_tsc * SPDK_SEC_TO_USEC / ticks_hz);
+	}
+}
+
+static void
+usage(void)
+{
+	printf(" -b <bdev>                 name of the bdev to create the blobstore on\n");
+	printf(" -n <num>                  number of blobs to create and open (default: 10000)\n");
+}
+
+static int
+parse_arg(int ch, char *arg)
+{
+	long int val;
+
+	switch (ch) {
+	case 'b':
+		g_bdev_name = arg;
+		break;
+	case 'n':
+		val = spdk_strtol(arg, 10);
+		if (val <= 0 || val > UINT32_MAX / 2) {
+			fprintf(stderr, "Invalid number of blobs: %s\n", arg);
+			return -EINVAL;
+		}
+		g_num_blobs = val;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct spdk_app_opts opts;
+	int rc;
+
+	spdk_app_opts_init(&opts, sizeof(opts));
+	opts.name = "blob_open_perf";
+
+	rc = spdk_app_parse_args(argc, argv, &opts, "b:n:", NULL, parse_arg, usage);
+	if (rc != SPDK_APP_PARSE_ARGS_SUCCESS) {
+		exit(rc);
+	}
+
+	if (g_bdev_name == NULL) {
+		fprintf(stderr, "A bdev name is required\n");
+		usage();
+		exit(1);
+	}
+
+	rc = spdk_app_start(&opts, test_start, NULL);
+	if (rc == 0) {
+		print_stats();
+	}
+
+	spdk_app_fini();
+	free(g_blobids);
+	free(g_blobs);
+
+	return rc;
+}
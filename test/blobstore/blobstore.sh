@@ -24,6 +24,9 @@ dd if=/dev/urandom of=$testdir/test.pattern bs=1M count=1
 $rootdir/test/app/match/match -v $testdir/btest.out.match
 diff $testdir/test.pattern $testdir/test.pattern.blob
 
+$testdir/blob_open_perf/blob_open_perf --json $testdir/blob_open_perf/blob_open_perf.json \
+	-b Malloc0 -n 1000
+
 rm -rf $testdir/btest.out
 rm -rf $testdir/blobcli.json
 rm -rf $testdir/*.blob
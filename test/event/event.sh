@@ -41,6 +41,7 @@ function app_repeat_test() {
 run_test "event_perf" $testdir/event_perf/event_perf -m 0xF -t 1
 run_test "event_reactor" $testdir/reactor/reactor -t 1
 run_test "event_reactor_perf" $testdir/reactor_perf/reactor_perf -t 1
+run_test "event_poller_perf" $testdir/poller_perf/poller_perf -b 1000 -l 1000 -t 1
 
 if [ $(uname -s) = Linux ]; then
 	run_test "event_scheduler" $testdir/scheduler/scheduler.sh
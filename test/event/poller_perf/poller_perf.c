@@ -0,0 +1,210 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/env.h"
+#include "spdk/event.h"
+#include "spdk/string.h"
+#include "spdk/thread.h"
+
+/*
+ * Measures the cost of an iteration of the reactor loop depending on the
+ * number of timed pollers registered on the thread. The timed pollers do no
+ * work, their periods are spread between 1 us and the maximum period, so the
+ * cost is mostly the one of keeping them ordered by expiration.
+ */
+
+static int g_time_in_sec;
+static uint32_t g_num_pollers;
+static uint64_t g_max_period_us;
+static struct spdk_poller **g_timed_pollers;
+static struct spdk_poller *g_iter_poller;
+static struct spdk_poller *g_test_end_poller;
+static uint64_t g_iter_count;
+static uint64_t g_timed_run_count;
+static uint64_t g_start_tsc;
+static uint64_t g_end_tsc;
+
+static int
+__timed_poll(void *arg)
+{
+	g_timed_run_count++;
+	return SPDK_POLLER_IDLE;
+}
+
+/* Active poller, run once per iteration of the reactor loop */
+static int
+__iter_poll(void *arg)
+{
+	g_iter_count++;
+	return SPDK_POLLER_IDLE;
+}
+
+static void
+test_stop(void)
+{
+	uint32_t i;
+
+	g_end_tsc = spdk_get_ticks();
+
+	spdk_poller_unregister(&g_test_end_poller);
+	spdk_poller_unregister(&g_iter_poller);
+	if (g_timed_pollers != NULL) {
+		for (i = 0; i < g_num_pollers; i++) {
+			spdk_poller_unregister(&g_timed_pollers[i]);
+		}
+	}
+	spdk_app_stop(0);
+}
+
+static int
+__test_end(void *arg)
+{
+	printf("test_end\n");
+	test_stop();
+	return SPDK_POLLER_BUSY;
+}
+
+static void
+test_start(void *arg1)
+{
+	uint64_t period_us;
+	uint32_t i;
+
+	printf("test_start\n");
+
+	g_timed_pollers = calloc(g_num_pollers, sizeof(*g_timed_pollers));
+	if (g_timed_pollers == NULL && g_num_pollers > 0) {
+		fprintf(stderr, "Failed to allocate timed pollers\n");
+		spdk_app_stop(-ENOMEM);
+		return;
+	}
+
+	for (i = 0; i < g_num_pollers; i++) {
+		/* Spread the periods, so that the pollers expire in a different order each time */
+		period_us = 1 + ((uint64_t)i * 7919) % g_max_period_us;
+		g_timed_pollers[i] = SPDK_POLLER_REGISTER(__timed_poll, NULL, period_us);
+		if (g_timed_pollers[i] == NULL) {
+			fprintf(stderr, "Failed to register timed poller %u\n", i);
+			test_stop();
+			return;
+		}
+	}
+
+	g_iter_poller = SPDK_POLLER_REGISTER(__iter_poll, NULL, 0);
+	g_test_end_poller = SPDK_POLLER_REGISTER(__test_end, NULL, g_time_in_sec * 1000000ULL);
+	g_start_tsc = spdk_get_ticks();
+}
+
+static void
+test_cleanup(void)
+{
+	printf("test_abort\n");
+	test_stop();
+}
+
+static void
+usage(const char *program_name)
+{
+	printf("%s options\n", program_name);
+	printf("\t[-b number of timed pollers (default: 1000)]\n");
+	printf("\t[-l maximum period of the timed pollers in microseconds (default: 1000)]\n");
+	printf("\t[-t time in seconds]\n");
+}
+
+int
+main(int argc, char **argv)
+{
+	struct spdk_app_opts opts;
+	uint64_t ticks, ticks_hz;
+	int op;
+	int rc;
+	long int val;
+
+	spdk_app_opts_init(&opts, sizeof(opts));
+	opts.name = "poller_perf";
+
+	g_time_in_sec = 0;
+	g_num_pollers = 1000;
+	g_max_period_us = 1000;
+
+	while ((op = getopt(argc, argv, "b:l:t:")) != -1) {
+		if (op == '?') {
+			usage(argv[0]);
+			exit(1);
+		}
+		val = spdk_strtol(optarg, 10);
+		if (val < 0) {
+			fprintf(stderr, "Converting a string to integer failed\n");
+			exit(1);
+		}
+		switch (op) {
+		case 'b':
+			g_num_pollers = val;
+			break;
+		case 'l':
+			g_max_period_us = val;
+			break;
+		case 't':
+			g_time_in_sec = val;
+			break;
+		default:
+			usage(argv[0]);
+			exit(1);
+		}
+	}
+
+	if (!g_time_in_sec || !g_max_period_us) {
+		usage(argv[0]);
+		exit(1);
+	}
+
+	opts.shutdown_cb = test_cleanup;
+
+	rc = spdk_app_start(&opts, test_start, NULL);
+
+	spdk_app_fini();
+	free(g_timed_pollers);
+
+	ticks = g_end_tsc - g_start_tsc;
+	ticks_hz = spdk_get_ticks_hz();
+	printf("Timed pollers: %u, maximum period: %" PRIu64 " us\n", g_num_pollers, g_max_period_us);
+	if (rc == 0 && g_iter_count > 0 && ticks_hz > 0) {
+		printf("Iterations: %" PRIu64 ", %.1f ns per iteration\n", g_iter_count,
+		       (double)ticks * SPDK_SEC_TO_NSEC / ticks_hz / g_iter_count);
+		printf("Timed poller runs: %" PRIu64 " per second\n", g_timed_run_count / g_time_in_sec);
+	}
+
+	return rc;
+}
@@ -2889,6 +2889,89 @@ bdev_io_alignment(void)
 	free(buf);
 }
 
+static void
+bdev_io_buf_cache(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *io_ch;
+	struct spdk_bdev_channel *bdev_ch;
+	struct spdk_bdev_mgmt_channel *mgmt_ch;
+	struct spdk_bdev_opts bdev_opts = {};
+	size_t small_count, large_count;
+	int rc, i;
+
+	spdk_bdev_get_opts(&bdev_opts, sizeof(bdev_opts));
+	bdev_opts.bdev_io_pool_size = 20;
+	bdev_opts.bdev_io_cache_size = 2;
+	bdev_opts.small_buf_cache_size = 2;
+	bdev_opts.large_buf_cache_size = 1;
+
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev = allocate_bdev("bdev0");
+
+	rc = spdk_bdev_open_ext("bdev0", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+	io_ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(io_ch != NULL);
+	bdev_ch = spdk_io_channel_get_ctx(io_ch);
+	mgmt_ch = bdev_ch->shared_resource->mgmt_ch;
+
+	/* The caches start empty */
+	CU_ASSERT(mgmt_ch->small_buf_cache.count == 0);
+	CU_ASSERT(mgmt_ch->large_buf_cache.count == 0);
+	small_count = spdk_mempool_count(g_bdev_mgr.buf_small_pool);
+	large_count = spdk_mempool_count(g_bdev_mgr.buf_large_pool);
+
+	/* Three small buffers come from the pool, two of them stay in the cache when freed */
+	for (i = 0; i < 3; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == small_count - 3);
+	stub_complete_io(3);
+	CU_ASSERT(mgmt_ch->small_buf_cache.count == 2);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == small_count - 2);
+
+	/* The next two small buffers are served from the cache without touching the pool */
+	for (i = 0; i < 2; i++) {
+		rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 1, io_done, NULL);
+		CU_ASSERT(rc == 0);
+	}
+	CU_ASSERT(mgmt_ch->small_buf_cache.count == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == small_count - 2);
+	stub_complete_io(2);
+	CU_ASSERT(mgmt_ch->small_buf_cache.count == 2);
+
+	/* Large buffers are cached separately */
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 128, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	rc = spdk_bdev_read_blocks(desc, io_ch, NULL, 0, 128, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_large_pool) == large_count - 2);
+	stub_complete_io(2);
+	CU_ASSERT(mgmt_ch->large_buf_cache.count == 1);
+	CU_ASSERT(mgmt_ch->small_buf_cache.count == 2);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_large_pool) == large_count - 1);
+
+	/* Releasing the channels returns the cached buffers to the pools */
+	spdk_put_io_channel(io_ch);
+	spdk_bdev_close(desc);
+	poll_threads();
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_small_pool) == small_count);
+	CU_ASSERT(spdk_mempool_count(g_bdev_mgr.buf_large_pool) == large_count);
+
+	free_bdev(bdev);
+	fn_table.submit_request = stub_submit_request;
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 bdev_io_alignment_with_boundary(void)
 {
@@ -3139,6 +3222,134 @@ bdev_histograms(void)
 	poll_threads();
 }
 
+static void
+stage_histogram_data_cb(void *cb_arg, int status, struct spdk_histogram_data **histograms)
+{
+	g_status = status;
+}
+
+static void
+histogram_io_count_above(void *ctx, uint64_t start, uint64_t end, uint64_t count,
+			 uint64_t total, uint64_t so_far)
+{
+	uint64_t *threshold = ctx;
+
+	if (start >= *threshold) {
+		g_count += count;
+	}
+}
+
+static void
+bdev_stage_histograms(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *ch;
+	struct spdk_histogram_data *histograms[SPDK_BDEV_IO_NUM_STAGES];
+	uint64_t threshold;
+	uint8_t buf[4096];
+	int rc, stage;
+
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+
+	bdev = allocate_bdev("bdev");
+
+	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(desc != NULL);
+
+	ch = spdk_bdev_get_io_channel(desc);
+	CU_ASSERT(ch != NULL);
+
+	CU_ASSERT(strcmp(spdk_bdev_io_stage_get_name(SPDK_BDEV_IO_STAGE_QUEUE), "queue") == 0);
+	CU_ASSERT(strcmp(spdk_bdev_io_stage_get_name(SPDK_BDEV_IO_STAGE_MODULE), "module") == 0);
+	CU_ASSERT(strcmp(spdk_bdev_io_stage_get_name(SPDK_BDEV_IO_STAGE_COMPLETE), "complete") == 0);
+	CU_ASSERT(spdk_bdev_io_stage_get_name(SPDK_BDEV_IO_NUM_STAGES) == NULL);
+
+	/* I/O completed before the histograms are enabled is not counted */
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+	stub_complete_io(1);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_stage_histogram_enable(bdev, histogram_status_cb, NULL, true);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.stage_histogram_enabled == true);
+	/* The total latency histogram is controlled separately */
+	CU_ASSERT(bdev->internal.histogram_enabled == false);
+
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		histograms[stage] = spdk_histogram_data_alloc();
+		SPDK_CU_ASSERT_FATAL(histograms[stage] != NULL);
+	}
+
+	rc = spdk_bdev_write_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(100);
+	stub_complete_io(1);
+	poll_threads();
+
+	rc = spdk_bdev_read_blocks(desc, ch, buf, 0, 1, io_done, NULL);
+	CU_ASSERT(rc == 0);
+
+	spdk_delay_us(100);
+	stub_complete_io(1);
+	poll_threads();
+
+	g_status = -1;
+	spdk_bdev_stage_histogram_get(bdev, histograms, stage_histogram_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		g_count = 0;
+		spdk_histogram_data_iterate(histograms[stage], histogram_io_count, NULL);
+		CU_ASSERT(g_count == 2);
+	}
+
+	/* The time between submission and completion by the module is attributed to
+	 * the module stage only.
+	 */
+	threshold = spdk_get_ticks_hz() / SPDK_SEC_TO_USEC * 50;
+
+	g_count = 0;
+	spdk_histogram_data_iterate(histograms[SPDK_BDEV_IO_STAGE_MODULE],
+				    histogram_io_count_above, &threshold);
+	CU_ASSERT(g_count == 2);
+
+	g_count = 0;
+	spdk_histogram_data_iterate(histograms[SPDK_BDEV_IO_STAGE_QUEUE],
+				    histogram_io_count_above, &threshold);
+	CU_ASSERT(g_count == 0);
+
+	g_count = 0;
+	spdk_histogram_data_iterate(histograms[SPDK_BDEV_IO_STAGE_COMPLETE],
+				    histogram_io_count_above, &threshold);
+	CU_ASSERT(g_count == 0);
+
+	/* Disable histograms */
+	spdk_bdev_stage_histogram_enable(bdev, histogram_status_cb, NULL, false);
+	poll_threads();
+	CU_ASSERT(g_status == 0);
+	CU_ASSERT(bdev->internal.stage_histogram_enabled == false);
+
+	spdk_bdev_stage_histogram_get(bdev, histograms, stage_histogram_data_cb, NULL);
+	poll_threads();
+	CU_ASSERT(g_status == -EFAULT);
+
+	for (stage = 0; stage < SPDK_BDEV_IO_NUM_STAGES; stage++) {
+		spdk_histogram_data_free(histograms[stage]);
+	}
+	spdk_put_io_channel(ch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 _bdev_compare(bool emulated)
 {
@@ -3441,6 +3652,145 @@ bdev_write_zeroes(void)
 	poll_threads();
 }
 
+static void
+bdev_copy(void)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel *ioch;
+	struct ut_expected_io *expected_io;
+	uint64_t src_offset, dst_offset, num_io_blocks, num_blocks, offset;
+	uint32_t num_completed;
+	int rc;
+
+	spdk_bdev_initialize(bdev_init_cb, NULL);
+	bdev = allocate_bdev("bdev");
+
+	rc = spdk_bdev_open_ext("bdev", true, bdev_ut_event_cb, NULL, &desc);
+	CU_ASSERT_EQUAL(rc, 0);
+	SPDK_CU_ASSERT_FATAL(desc != NULL);
+	CU_ASSERT(bdev == spdk_bdev_desc_get_bdev(desc));
+	ioch = spdk_bdev_get_io_channel(desc);
+	SPDK_CU_ASSERT_FATAL(ioch != NULL);
+
+	fn_table.submit_request = stub_submit_request;
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	bdev->md_len = 0;
+	bdev->blocklen = 4096;
+	src_offset = 0;
+	dst_offset = 64;
+	num_blocks = 20;
+
+	/* Overlapping source and destination ranges are rejected */
+	ut_enable_io_type(SPDK_BDEV_IO_TYPE_COPY, true);
+	rc = spdk_bdev_copy_blocks(desc, ioch, 8, 0, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, -EINVAL);
+
+	/* If the bdev supports copy and has no limit, the request won't be split */
+	expected_io = ut_alloc_expected_io(SPDK_BDEV_IO_TYPE_COPY, dst_offset, num_blocks, 0);
+	TAILQ_INSERT_TAIL(&g_bdev_ut_channel->expected_io, expected_io, link);
+	g_io_done = false;
+	rc = spdk_bdev_copy_blocks(desc, ioch, dst_offset, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	CU_ASSERT(g_bdev_io->u.bdev.copy.src_offset_blocks == src_offset);
+	num_completed = stub_complete_io(1);
+	CU_ASSERT_EQUAL(num_completed, 1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* Copy requests larger than max_copy are split into sequential children */
+	bdev->max_copy = 8;
+	g_io_done = false;
+	rc = spdk_bdev_copy_blocks(desc, ioch, dst_offset, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	for (offset = 0; offset < num_blocks; offset += num_io_blocks) {
+		num_io_blocks = spdk_min(bdev->max_copy, num_blocks - offset);
+		CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_COPY);
+		CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == dst_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.copy.src_offset_blocks == src_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.num_blocks == num_io_blocks);
+		CU_ASSERT(g_io_done == false);
+		num_completed = stub_complete_io(1);
+		CU_ASSERT_EQUAL(num_completed, 1);
+	}
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	bdev->max_copy = 0;
+
+	/* If copy is not supported it'll be emulated with a read followed by a write */
+	ut_enable_io_type(SPDK_BDEV_IO_TYPE_COPY, false);
+	CU_ASSERT(spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_COPY) == true);
+	g_io_done = false;
+	rc = spdk_bdev_copy_blocks(desc, ioch, dst_offset, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	for (offset = 0; offset < num_blocks; offset += num_io_blocks) {
+		num_io_blocks = spdk_min(SPDK_BDEV_LARGE_BUF_MAX_SIZE / bdev->blocklen,
+					 num_blocks - offset);
+		CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_READ);
+		CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == src_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.num_blocks == num_io_blocks);
+		num_completed = stub_complete_io(1);
+		CU_ASSERT_EQUAL(num_completed, 1);
+
+		CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE);
+		CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == dst_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.num_blocks == num_io_blocks);
+		CU_ASSERT(g_io_done == false);
+		num_completed = stub_complete_io(1);
+		CU_ASSERT_EQUAL(num_completed, 1);
+	}
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+
+	/* The emulated copy leaves room in the data buffer for the required alignment, so
+	 * 4KiB blocks aligned to 4KiB are copied 15 at a time
+	 */
+	fn_table.submit_request = stub_submit_request_get_buf;
+	bdev->required_alignment = 12;
+	g_io_done = false;
+	rc = spdk_bdev_copy_blocks(desc, ioch, dst_offset, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	for (offset = 0; offset < num_blocks; offset += num_io_blocks) {
+		num_io_blocks = spdk_min(15, num_blocks - offset);
+		CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_READ);
+		CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == src_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.num_blocks == num_io_blocks);
+		num_completed = stub_complete_io(1);
+		CU_ASSERT_EQUAL(num_completed, 1);
+
+		CU_ASSERT(g_bdev_io->type == SPDK_BDEV_IO_TYPE_WRITE);
+		CU_ASSERT(g_bdev_io->u.bdev.offset_blocks == dst_offset + offset);
+		CU_ASSERT(g_bdev_io->u.bdev.num_blocks == num_io_blocks);
+		CU_ASSERT(g_bdev_io->u.bdev.iovs[0].iov_base != NULL);
+		CU_ASSERT(g_io_done == false);
+		num_completed = stub_complete_io(1);
+		CU_ASSERT_EQUAL(num_completed, 1);
+	}
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	bdev->required_alignment = 0;
+	fn_table.submit_request = stub_submit_request;
+
+	/* A failed read fails the whole copy without issuing the write */
+	g_io_done = false;
+	rc = spdk_bdev_copy_blocks(desc, ioch, dst_offset, src_offset, num_blocks, io_done, NULL);
+	CU_ASSERT_EQUAL(rc, 0);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_FAILED;
+	num_completed = stub_complete_io(1);
+	CU_ASSERT_EQUAL(num_completed, 1);
+	CU_ASSERT(g_io_done == true);
+	CU_ASSERT(g_io_status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(g_bdev_ut_channel->outstanding_io_count == 0);
+	g_io_exp_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	spdk_put_io_channel(ioch);
+	spdk_bdev_close(desc);
+	free_bdev(bdev);
+	spdk_bdev_finish(bdev_fini_cb, NULL);
+	poll_threads();
+}
+
 static void
 bdev_open_while_hotremove(void)
 {
@@ -4296,6 +4646,21 @@ bdev_set_options_test(void)
 	bdev_opts.large_buf_pool_size = BUF_LARGE_POOL_SIZE + 3;
 	rc = spdk_bdev_set_opts(&bdev_opts);
 	CU_ASSERT(rc == 0);
+
+	/* Case6: Buffer caches that do not fit into the buffer pools */
+	bdev_opts.small_buf_cache_size = bdev_opts.small_buf_pool_size;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == -1);
+
+	bdev_opts.small_buf_cache_size = BUF_SMALL_CACHE_SIZE;
+	bdev_opts.large_buf_cache_size = bdev_opts.large_buf_pool_size;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == -1);
+
+	/* Case7: Set valid buffer cache sizes */
+	bdev_opts.large_buf_cache_size = BUF_LARGE_CACHE_SIZE;
+	rc = spdk_bdev_set_opts(&bdev_opts);
+	CU_ASSERT(rc == 0);
 }
 
 int
@@ -4324,8 +4689,11 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, bdev_io_split_with_io_wait);
 	CU_ADD_TEST(suite, bdev_io_alignment_with_boundary);
 	CU_ADD_TEST(suite, bdev_io_alignment);
+	CU_ADD_TEST(suite, bdev_io_buf_cache);
 	CU_ADD_TEST(suite, bdev_histograms);
+	CU_ADD_TEST(suite, bdev_stage_histograms);
 	CU_ADD_TEST(suite, bdev_write_zeroes);
+	CU_ADD_TEST(suite, bdev_copy);
 	CU_ADD_TEST(suite, bdev_compare_and_write);
 	CU_ADD_TEST(suite, bdev_compare);
 	CU_ADD_TEST(suite, bdev_open_while_hotremove);
@@ -73,6 +73,13 @@ DEFINE_STUB(spdk_nvme_ctrlr_process_admin_completions, int32_t,
 
 DEFINE_STUB(spdk_nvme_ctrlr_get_flags, uint64_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
 
+DEFINE_STUB(spdk_nvme_qpair_get_interrupt_fd, int, (struct spdk_nvme_qpair *qpair), -ENOTSUP);
+
+DEFINE_STUB(spdk_nvme_ctrlr_get_pci_device, struct spdk_pci_device *,
+	    (struct spdk_nvme_ctrlr *ctrlr), NULL);
+
+DEFINE_STUB(spdk_pci_device_get_socket_id, int, (struct spdk_pci_device *dev), 0);
+
 void
 spdk_nvme_ctrlr_get_default_io_qpair_opts(struct spdk_nvme_ctrlr *ctrlr,
 		struct spdk_nvme_io_qpair_opts *opts, size_t opts_size)
@@ -120,6 +127,8 @@ DEFINE_STUB(spdk_nvme_ns_get_extended_sector_size, uint32_t, (struct spdk_nvme_n
 
 DEFINE_STUB(spdk_nvme_ns_get_pi_type, enum spdk_nvme_pi_type, (struct spdk_nvme_ns *ns), 0);
 
+DEFINE_STUB(spdk_nvme_ns_get_flags, uint32_t, (struct spdk_nvme_ns *ns), 0);
+
 DEFINE_STUB(spdk_nvme_ns_supports_compare, bool, (struct spdk_nvme_ns *ns), false);
 
 DEFINE_STUB(spdk_nvme_ns_get_md_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
@@ -640,6 +649,14 @@ spdk_nvme_ns_cmd_dataset_management(struct spdk_nvme_ns *ns, struct spdk_nvme_qp
 	return ut_submit_nvme_request(ns, qpair, SPDK_NVME_OPC_DATASET_MANAGEMENT, cb_fn, cb_arg);
 }
 
+int
+spdk_nvme_ns_cmd_copy(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+		      const struct spdk_nvme_scc_source_range *ranges, uint16_t num_ranges,
+		      uint64_t dest_lba, spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	return ut_submit_nvme_request(ns, qpair, SPDK_NVME_OPC_COPY, cb_fn, cb_arg);
+}
+
 struct spdk_nvme_poll_group *
 spdk_nvme_poll_group_create(void *ctx)
 {
@@ -1422,6 +1439,94 @@ test_reconnect_qpair(void)
 	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") == NULL);
 }
 
+static void
+test_socket_hint(void)
+{
+	struct spdk_nvme_transport_id trid = {};
+	struct spdk_nvme_ctrlr ctrlr1 = {}, ctrlr2 = {};
+	struct spdk_pci_device *pci_dev = (struct spdk_pci_device *)0xDEADBEEF;
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr1 = NULL, *nvme_bdev_ctrlr2 = NULL;
+	struct spdk_io_channel *ch1, *ch2;
+	int rc;
+
+	ut_init_trid(&trid);
+	TAILQ_INIT(&ctrlr1.active_io_qpairs);
+	TAILQ_INIT(&ctrlr2.active_io_qpairs);
+
+	rc = nvme_bdev_ctrlr_create(&ctrlr1, "nvme0", &trid, 0, &nvme_bdev_ctrlr1);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(nvme_bdev_ctrlr1 != NULL);
+
+	ut_init_trid2(&trid);
+	rc = nvme_bdev_ctrlr_create(&ctrlr2, "nvme1", &trid, 0, &nvme_bdev_ctrlr2);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(nvme_bdev_ctrlr2 != NULL);
+
+	/* Controllers that are not PCIe don't give a hint */
+	set_thread(0);
+	ch1 = spdk_get_io_channel(nvme_bdev_ctrlr1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == SPDK_ENV_SOCKET_ID_ANY);
+	spdk_put_io_channel(ch1);
+	poll_threads();
+
+	/* The thread polling a PCIe controller is hinted to the controller's socket and
+	 * the hint is cleared when the channel is destroyed.
+	 */
+	MOCK_SET(spdk_nvme_ctrlr_get_pci_device, pci_dev);
+	MOCK_SET(spdk_pci_device_get_socket_id, 1);
+	set_thread(1);
+	ch1 = spdk_get_io_channel(nvme_bdev_ctrlr1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == 1);
+	spdk_put_io_channel(ch1);
+	poll_threads();
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == SPDK_ENV_SOCKET_ID_ANY);
+
+	/* Channels of controllers on the same socket share the hint */
+	ch1 = spdk_get_io_channel(nvme_bdev_ctrlr1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	ch2 = spdk_get_io_channel(nvme_bdev_ctrlr2);
+	SPDK_CU_ASSERT_FATAL(ch2 != NULL);
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == 1);
+	spdk_put_io_channel(ch1);
+	poll_threads();
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == 1);
+	spdk_put_io_channel(ch2);
+	poll_threads();
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == SPDK_ENV_SOCKET_ID_ANY);
+
+	/* A thread that has a hint keeps it and a controller on another socket doesn't
+	 * hold it.
+	 */
+	ch1 = spdk_get_io_channel(nvme_bdev_ctrlr1);
+	SPDK_CU_ASSERT_FATAL(ch1 != NULL);
+	MOCK_SET(spdk_pci_device_get_socket_id, 0);
+	ch2 = spdk_get_io_channel(nvme_bdev_ctrlr2);
+	SPDK_CU_ASSERT_FATAL(ch2 != NULL);
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == 1);
+	spdk_put_io_channel(ch2);
+	poll_threads();
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == 1);
+	spdk_put_io_channel(ch1);
+	poll_threads();
+	CU_ASSERT(spdk_thread_get_socket_hint(spdk_get_thread()) == SPDK_ENV_SOCKET_ID_ANY);
+
+	MOCK_CLEAR(spdk_nvme_ctrlr_get_pci_device);
+	MOCK_CLEAR(spdk_pci_device_get_socket_id);
+
+	set_thread(0);
+	rc = bdev_nvme_delete("nvme0");
+	CU_ASSERT(rc == 0);
+	rc = bdev_nvme_delete("nvme1");
+	CU_ASSERT(rc == 0);
+
+	poll_threads();
+
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") == NULL);
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme1") == NULL);
+}
+
 static void
 test_aer_cb(void)
 {
@@ -1645,6 +1750,68 @@ test_submit_nvme_cmd(void)
 	ut_detach_ctrlr(ctrlr);
 }
 
+static void
+ut_poll_group_interrupt_done(void *ctx, const struct spdk_nvme_cpl *cpl)
+{
+}
+
+static void
+test_poll_group_interrupt(void)
+{
+	struct nvme_bdev_poll_group group = {};
+	struct spdk_nvme_qpair qpair = {};
+	struct ut_nvme_req *req;
+	uint64_t notify;
+
+	group.group = spdk_nvme_poll_group_create(&group);
+	SPDK_CU_ASSERT_FATAL(group.group != NULL);
+	TAILQ_INIT(&group.intr_chs);
+	group.poll_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	SPDK_CU_ASSERT_FATAL(group.poll_efd >= 0);
+
+	TAILQ_INIT(&qpair.outstanding_reqs);
+	qpair.is_connected = true;
+	qpair.poll_group = group.group;
+	TAILQ_INSERT_TAIL(&group.group->qpairs, &qpair, poll_group_tailq);
+
+	/* Starting to poll signals the group's event fd */
+	bdev_nvme_poll_group_start_polling(&group);
+	CU_ASSERT(group.polling == true);
+
+	/* The group keeps polling while it finds completions */
+	req = calloc(1, sizeof(*req));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	req->cb_fn = ut_poll_group_interrupt_done;
+	TAILQ_INSERT_TAIL(&qpair.outstanding_reqs, req, tailq);
+	qpair.num_outstanding_reqs++;
+
+	spdk_delay_us(BDEV_NVME_INTERRUPT_IDLE_US);
+	CU_ASSERT(bdev_nvme_poll_group_interrupt(&group) == SPDK_POLLER_BUSY);
+	CU_ASSERT(group.polling == true);
+
+	/* ... and for a while after it goes idle */
+	spdk_delay_us(BDEV_NVME_INTERRUPT_IDLE_US - 1);
+	CU_ASSERT(bdev_nvme_poll_group_interrupt(&group) == SPDK_POLLER_IDLE);
+	CU_ASSERT(group.polling == true);
+
+	/* Qpairs without completion interrupts keep the group polling */
+	spdk_delay_us(1);
+	group.num_polled_qpairs = 1;
+	CU_ASSERT(bdev_nvme_poll_group_interrupt(&group) == SPDK_POLLER_IDLE);
+	CU_ASSERT(group.polling == true);
+
+	/* Otherwise it stops polling and its event fd is no longer signalled */
+	group.num_polled_qpairs = 0;
+	CU_ASSERT(bdev_nvme_poll_group_interrupt(&group) == SPDK_POLLER_IDLE);
+	CU_ASSERT(group.polling == false);
+	CU_ASSERT(read(group.poll_efd, &notify, sizeof(notify)) < 0);
+	CU_ASSERT(errno == EAGAIN);
+
+	TAILQ_REMOVE(&group.group->qpairs, &qpair, poll_group_tailq);
+	close(group.poll_efd);
+	CU_ASSERT(spdk_nvme_poll_group_destroy(group.group) == 0);
+}
+
 int
 main(int argc, const char **argv)
 {
@@ -1663,8 +1830,10 @@ main(int argc, const char **argv)
 	CU_ADD_TEST(suite, test_pending_reset);
 	CU_ADD_TEST(suite, test_attach_ctrlr);
 	CU_ADD_TEST(suite, test_reconnect_qpair);
+	CU_ADD_TEST(suite, test_socket_hint);
 	CU_ADD_TEST(suite, test_aer_cb);
 	CU_ADD_TEST(suite, test_submit_nvme_cmd);
+	CU_ADD_TEST(suite, test_poll_group_interrupt);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
@@ -137,6 +137,20 @@ DEFINE_STUB(spdk_json_write_null, int, (struct spdk_json_write_ctx *w), 0);
 DEFINE_STUB(spdk_strerror, const char *, (int errnum), NULL);
 DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
 		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB(spdk_json_write_named_uint64, int, (struct spdk_json_write_ctx *w, const char *name,
+		uint64_t val), 0);
+DEFINE_STUB(spdk_json_decode_uint64, int, (const struct spdk_json_val *val, void *out), 0);
+DEFINE_STUB(raid_bdev_rebuild_start, int, (struct raid_bdev *raid_bdev, uint8_t idx), 0);
+DEFINE_STUB_V(raid_bdev_rebuild_dump_info_json, (struct raid_bdev *raid_bdev,
+		struct spdk_json_write_ctx *w));
+
+void
+raid_bdev_rebuild_stop(struct raid_bdev *raid_bdev, raid_bdev_rebuild_cb cb_fn, void *cb_arg)
+{
+	raid_bdev->rebuild = NULL;
+	cb_fn(cb_arg);
+}
 
 struct spdk_io_channel *
 spdk_bdev_get_io_channel(struct spdk_bdev_desc *desc)
@@ -1302,8 +1316,19 @@ test_io_channel(void)
 	for (i = 0; i < req.base_bdevs.num_base_bdevs; i++) {
 		CU_ASSERT(ch_ctx->base_channel && ch_ctx->base_channel[i] == &g_io_channel);
 	}
+	CU_ASSERT(ch_ctx->quiesce_blocks == 0);
 	raid_bdev_destroy_cb(pbdev, ch_ctx);
 	CU_ASSERT(ch_ctx->base_channel == NULL);
+
+	/* A channel created while a range is quiesced gets the range too */
+	pbdev->quiesce_offset = 64;
+	pbdev->quiesce_blocks = 32;
+	CU_ASSERT(raid_bdev_create_cb(pbdev, ch_ctx) == 0);
+	CU_ASSERT(ch_ctx->quiesce_offset == 64);
+	CU_ASSERT(ch_ctx->quiesce_blocks == 32);
+	raid_bdev_destroy_cb(pbdev, ch_ctx);
+	pbdev->quiesce_offset = 0;
+	pbdev->quiesce_blocks = 0;
 	free_test_req(&req);
 
 	create_raid_bdev_delete_req(&destroy_req, "raid1", 0);
@@ -1887,12 +1912,13 @@ test_multi_raid_with_io(void)
 	int16_t iotype;
 	struct spdk_io_channel *ch_b;
 	struct spdk_bdev_channel *ch_b_ctx;
+	size_t ch_size = sizeof(struct spdk_io_channel) + sizeof(struct raid_bdev_io_channel);
 
 	set_globals();
 	construct_req = calloc(g_max_raids, sizeof(struct rpc_bdev_raid_create));
 	SPDK_CU_ASSERT_FATAL(construct_req != NULL);
 	CU_ASSERT(raid_bdev_init() == 0);
-	ch = calloc(g_max_raids, sizeof(struct spdk_io_channel) + sizeof(struct raid_bdev_io_channel));
+	ch = calloc(g_max_raids, ch_size);
 	SPDK_CU_ASSERT_FATAL(ch != NULL);
 
 	ch_b = calloc(1, sizeof(struct spdk_io_channel) + sizeof(struct spdk_bdev_channel));
@@ -1916,7 +1942,7 @@ test_multi_raid_with_io(void)
 			}
 		}
 		CU_ASSERT(pbdev != NULL);
-		ch_ctx = spdk_io_channel_get_ctx(&ch[i]);
+		ch_ctx = spdk_io_channel_get_ctx((struct spdk_io_channel *)((uint8_t *)ch + i * ch_size));
 		SPDK_CU_ASSERT_FATAL(ch_ctx != NULL);
 		CU_ASSERT(raid_bdev_create_cb(pbdev, ch_ctx) == 0);
 		SPDK_CU_ASSERT_FATAL(ch_ctx->base_channel != NULL);
@@ -1956,7 +1982,7 @@ test_multi_raid_with_io(void)
 			}
 		}
 		CU_ASSERT(pbdev != NULL);
-		ch_ctx = spdk_io_channel_get_ctx(&ch[i]);
+		ch_ctx = spdk_io_channel_get_ctx((struct spdk_io_channel *)((uint8_t *)ch + i * ch_size));
 		SPDK_CU_ASSERT_FATAL(ch_ctx != NULL);
 		raid_bdev_destroy_cb(pbdev, ch_ctx);
 		CU_ASSERT(ch_ctx->base_channel == NULL);
@@ -2040,6 +2066,10 @@ test_raid_level_conversions(void)
 	CU_ASSERT(raid_bdev_parse_raid_level("0") == RAID0);
 	CU_ASSERT(raid_bdev_parse_raid_level("raid0") == RAID0);
 	CU_ASSERT(raid_bdev_parse_raid_level("RAID0") == RAID0);
+	CU_ASSERT(raid_bdev_parse_raid_level("1") == RAID1);
+	CU_ASSERT(raid_bdev_parse_raid_level("raid1") == RAID1);
+	CU_ASSERT(raid_bdev_parse_raid_level("10") == RAID10);
+	CU_ASSERT(raid_bdev_parse_raid_level("raid10") == RAID10);
 
 	raid_str = raid_bdev_level_to_str(INVALID_RAID_LEVEL);
 	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
@@ -2047,6 +2077,10 @@ test_raid_level_conversions(void)
 	CU_ASSERT(raid_str != NULL && strlen(raid_str) == 0);
 	raid_str = raid_bdev_level_to_str(RAID0);
 	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid0") == 0);
+	raid_str = raid_bdev_level_to_str(RAID1);
+	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid1") == 0);
+	raid_str = raid_bdev_level_to_str(RAID10);
+	CU_ASSERT(raid_str != NULL && strcmp(raid_str, "raid10") == 0);
 }
 
 int main(int argc, char **argv)
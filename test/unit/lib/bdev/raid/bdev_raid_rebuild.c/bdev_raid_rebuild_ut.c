@@ -0,0 +1,592 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE AiRE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/bdev_raid_rebuild.c"
+
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+DEFINE_STUB(spdk_json_write_named_object_begin, int, (struct spdk_json_write_ctx *w,
+		const char *name), 0);
+DEFINE_STUB(spdk_json_write_named_string, int, (struct spdk_json_write_ctx *w, const char *name,
+		const char *val), 0);
+DEFINE_STUB(spdk_json_write_named_uint64, int, (struct spdk_json_write_ctx *w, const char *name,
+		uint64_t val), 0);
+DEFINE_STUB(spdk_json_write_object_end, int, (struct spdk_json_write_ctx *w), 0);
+
+static struct raid_base_bdev_info *g_failed_base_info;
+
+void
+raid_bdev_fail_base_bdev(struct raid_base_bdev_info *base_info)
+{
+	g_failed_base_info = base_info;
+}
+
+#define TEST_BLOCKLEN		512
+#define TEST_STRIP_SIZE		128
+#define TEST_BASE_BLOCKCNT	4096
+#define TEST_MAX_BASE_BDEVS	4
+
+struct spdk_bdev_desc {
+	struct spdk_bdev *bdev;
+};
+
+/* Base bdev backed by memory */
+struct test_base_bdev {
+	struct spdk_bdev bdev;
+	struct spdk_bdev_desc desc;
+	uint8_t *data;
+	uint64_t num_reads;
+	uint64_t num_writes;
+	bool fail_reads;
+};
+
+struct test_base_io {
+	struct spdk_bdev_io bdev_io;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+	bool success;
+};
+
+static struct raid_bdev_opts g_opts;
+static struct raid_bdev g_raid_bdev;
+static struct test_base_bdev g_base_bdevs[TEST_MAX_BASE_BDEVS];
+static struct spdk_io_channel *g_base_ch;
+static uint8_t g_num_sources;
+static uint32_t g_quiesced;
+static uint32_t g_unquiesced;
+static uint64_t g_quiesce_offset;
+static uint64_t g_quiesce_blocks;
+static bool g_stop_cb_called;
+
+static void
+test_base_io_complete(void *ctx)
+{
+	struct test_base_io *io = ctx;
+
+	io->cb(&io->bdev_io, io->success, io->cb_arg);
+	free(io);
+}
+
+static int
+test_base_io_submit(struct spdk_bdev_desc *desc, void *buf, uint64_t offset_blocks,
+		    uint64_t num_blocks, bool write, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = SPDK_CONTAINEROF(desc, struct test_base_bdev, desc);
+	uint8_t *data = base->data + offset_blocks * base->bdev.blocklen;
+	uint64_t len = num_blocks * base->bdev.blocklen;
+	struct test_base_io *io;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= base->bdev.blockcnt);
+
+	/* The rebuild may only touch the quiesced range */
+	CU_ASSERT(g_quiesced == g_unquiesced + 1);
+	CU_ASSERT(offset_blocks * g_raid_bdev.data_width == g_quiesce_offset);
+	CU_ASSERT(num_blocks * g_raid_bdev.data_width == g_quiesce_blocks);
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+	io->success = true;
+
+	if (write) {
+		memcpy(data, buf, len);
+		base->num_writes++;
+	} else if (base->fail_reads) {
+		io->success = false;
+	} else {
+		memcpy(buf, data, len);
+		base->num_reads++;
+	}
+
+	/* Complete asynchronously, like the bdev layer does */
+	spdk_thread_send_msg(spdk_get_thread(), test_base_io_complete, io);
+
+	return 0;
+}
+
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, buf, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+int
+spdk_bdev_write_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, buf, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+void
+raid_bdev_get_opts(struct raid_bdev_opts *opts)
+{
+	*opts = g_opts;
+}
+
+struct test_quiesce_ctx {
+	raid_bdev_quiesce_cb cb_fn;
+	void *cb_arg;
+};
+
+static void
+test_quiesce_done(void *ctx)
+{
+	struct test_quiesce_ctx *qctx = ctx;
+
+	qctx->cb_fn(qctx->cb_arg, 0);
+	free(qctx);
+}
+
+static void
+test_quiesce_complete(raid_bdev_quiesce_cb cb_fn, void *cb_arg)
+{
+	struct test_quiesce_ctx *qctx = calloc(1, sizeof(*qctx));
+
+	SPDK_CU_ASSERT_FATAL(qctx != NULL);
+	qctx->cb_fn = cb_fn;
+	qctx->cb_arg = cb_arg;
+	spdk_thread_send_msg(spdk_get_thread(), test_quiesce_done, qctx);
+}
+
+int
+raid_bdev_quiesce_range(struct raid_bdev *raid_bdev, uint64_t offset_blocks, uint64_t num_blocks,
+			raid_bdev_quiesce_cb cb_fn, void *cb_arg)
+{
+	CU_ASSERT(raid_bdev == &g_raid_bdev);
+	CU_ASSERT(g_quiesced == g_unquiesced);
+	g_quiesced++;
+	g_quiesce_offset = offset_blocks;
+	g_quiesce_blocks = num_blocks;
+	test_quiesce_complete(cb_fn, cb_arg);
+	return 0;
+}
+
+int
+raid_bdev_unquiesce_range(struct raid_bdev *raid_bdev, raid_bdev_quiesce_cb cb_fn, void *cb_arg)
+{
+	CU_ASSERT(raid_bdev == &g_raid_bdev);
+	CU_ASSERT(g_quiesced == g_unquiesced + 1);
+	g_unquiesced++;
+	test_quiesce_complete(cb_fn, cb_arg);
+	return 0;
+}
+
+/* The last base bdev is rebuilt from the ones before it */
+static uint8_t
+test_get_rebuild_sources(struct raid_bdev *raid_bdev, uint8_t idx, uint8_t *sources)
+{
+	uint8_t i;
+
+	CU_ASSERT(idx == raid_bdev->num_base_bdevs - 1);
+	for (i = 0; i < g_num_sources; i++) {
+		sources[i] = i;
+	}
+
+	return g_num_sources;
+}
+
+static struct raid_bdev_module g_test_module = {
+	.get_rebuild_sources = test_get_rebuild_sources,
+};
+
+static int
+test_raid_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = ctx_buf;
+	uint8_t i;
+
+	raid_ch->num_channels = g_raid_bdev.num_base_bdevs;
+	raid_ch->base_channel = calloc(raid_ch->num_channels, sizeof(struct spdk_io_channel *));
+	SPDK_CU_ASSERT_FATAL(raid_ch->base_channel != NULL);
+	for (i = 0; i < raid_ch->num_channels; i++) {
+		raid_ch->base_channel[i] = g_base_ch;
+	}
+
+	return 0;
+}
+
+static void
+test_raid_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct raid_bdev_io_channel *raid_ch = ctx_buf;
+
+	free(raid_ch->base_channel);
+}
+
+static int
+test_base_ch_create_cb(void *io_device, void *ctx_buf)
+{
+	return 0;
+}
+
+static void
+test_base_ch_destroy_cb(void *io_device, void *ctx_buf)
+{
+}
+
+static void
+test_stop_cb(void *cb_arg)
+{
+	g_stop_cb_called = true;
+}
+
+/*
+ * Set up a raid bdev of num_base_bdevs base bdevs, with the last one to be
+ * rebuilt from the first num_sources ones.
+ */
+static void
+rebuild_test_init(uint8_t num_base_bdevs, uint8_t num_sources, uint8_t data_width)
+{
+	struct raid_base_bdev_info *base_info;
+	struct test_base_bdev *base;
+	uint64_t size = TEST_BASE_BLOCKCNT * TEST_BLOCKLEN;
+	uint64_t i;
+	uint8_t j;
+
+	SPDK_CU_ASSERT_FATAL(num_base_bdevs <= TEST_MAX_BASE_BDEVS);
+
+	memset(&g_opts, 0, sizeof(g_opts));
+	memset(&g_raid_bdev, 0, sizeof(g_raid_bdev));
+	g_num_sources = num_sources;
+	g_quiesced = 0;
+	g_unquiesced = 0;
+	g_stop_cb_called = false;
+
+	g_raid_bdev.bdev.name = "raid0";
+	g_raid_bdev.bdev.blocklen = TEST_BLOCKLEN;
+	g_raid_bdev.bdev.blockcnt = TEST_BASE_BLOCKCNT * data_width;
+	g_raid_bdev.strip_size = TEST_STRIP_SIZE;
+	g_raid_bdev.num_base_bdevs = num_base_bdevs;
+	g_raid_bdev.data_width = data_width;
+	g_raid_bdev.state = RAID_BDEV_STATE_ONLINE;
+	g_raid_bdev.module = &g_test_module;
+	g_raid_bdev.base_bdev_info = calloc(num_base_bdevs, sizeof(struct raid_base_bdev_info));
+	SPDK_CU_ASSERT_FATAL(g_raid_bdev.base_bdev_info != NULL);
+
+	for (j = 0; j < num_base_bdevs; j++) {
+		base = &g_base_bdevs[j];
+		memset(base, 0, sizeof(*base));
+		base->bdev.name = "base";
+		base->bdev.blocklen = TEST_BLOCKLEN;
+		base->bdev.blockcnt = TEST_BASE_BLOCKCNT;
+		base->desc.bdev = &base->bdev;
+		base->data = calloc(1, size);
+		SPDK_CU_ASSERT_FATAL(base->data != NULL);
+
+		/* The base bdev to rebuild is left zeroed */
+		if (j != num_base_bdevs - 1) {
+			for (i = 0; i < size; i++) {
+				base->data[i] = rand();
+			}
+		}
+
+		base_info = &g_raid_bdev.base_bdev_info[j];
+		base_info->raid_bdev = &g_raid_bdev;
+		base_info->bdev = &base->bdev;
+		base_info->desc = &base->desc;
+	}
+
+	base_info = &g_raid_bdev.base_bdev_info[num_base_bdevs - 1];
+	base_info->rebuilding = true;
+
+	spdk_io_device_register(&g_base_bdevs, test_base_ch_create_cb, test_base_ch_destroy_cb,
+				0, NULL);
+	g_base_ch = spdk_get_io_channel(&g_base_bdevs);
+	SPDK_CU_ASSERT_FATAL(g_base_ch != NULL);
+	spdk_io_device_register(&g_raid_bdev, test_raid_ch_create_cb, test_raid_ch_destroy_cb,
+				sizeof(struct raid_bdev_io_channel), NULL);
+}
+
+static void
+rebuild_test_fini(void)
+{
+	uint8_t j;
+
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(g_quiesced == g_unquiesced);
+
+	spdk_io_device_unregister(&g_raid_bdev, NULL);
+	spdk_put_io_channel(g_base_ch);
+	spdk_io_device_unregister(&g_base_bdevs, NULL);
+	poll_threads();
+
+	for (j = 0; j < g_raid_bdev.num_base_bdevs; j++) {
+		free(g_base_bdevs[j].data);
+	}
+	free(g_raid_bdev.base_bdev_info);
+}
+
+/* Run the rebuild until it's done, advancing the time by a poller period each time */
+static void
+rebuild_test_run(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < 100000 && g_raid_bdev.rebuild != NULL; i++) {
+		spdk_delay_us(RAID_REBUILD_TIMESLICE_USEC);
+		poll_threads();
+	}
+}
+
+static void
+test_rebuild_mirror(void)
+{
+	struct raid_base_bdev_info *target;
+
+	rebuild_test_init(2, 1, 1);
+	target = &g_raid_bdev.base_bdev_info[1];
+
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == 0);
+	CU_ASSERT(g_raid_bdev.rebuild != NULL);
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == -EBUSY);
+
+	rebuild_test_run();
+
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(target->rebuilding == false);
+	CU_ASSERT(target->rebuild_offset == g_raid_bdev.bdev.blockcnt);
+	CU_ASSERT(memcmp(g_base_bdevs[0].data, g_base_bdevs[1].data,
+			 TEST_BASE_BLOCKCNT * TEST_BLOCKLEN) == 0);
+	CU_ASSERT(g_base_bdevs[0].num_reads == g_base_bdevs[1].num_writes);
+	CU_ASSERT(g_base_bdevs[1].num_reads == 0);
+
+	rebuild_test_fini();
+}
+
+static void
+test_rebuild_xor(void)
+{
+	struct raid_base_bdev_info *target;
+	uint8_t *parity;
+	uint64_t size = TEST_BASE_BLOCKCNT * TEST_BLOCKLEN;
+	uint64_t i;
+
+	rebuild_test_init(4, 3, 3);
+	target = &g_raid_bdev.base_bdev_info[3];
+
+	parity = calloc(1, size);
+	SPDK_CU_ASSERT_FATAL(parity != NULL);
+	for (i = 0; i < size; i++) {
+		parity[i] = g_base_bdevs[0].data[i] ^ g_base_bdevs[1].data[i] ^ g_base_bdevs[2].data[i];
+	}
+
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 3) == 0);
+
+	rebuild_test_run();
+
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(target->rebuilding == false);
+	CU_ASSERT(target->rebuild_offset == g_raid_bdev.bdev.blockcnt);
+	CU_ASSERT(memcmp(parity, g_base_bdevs[3].data, size) == 0);
+
+	free(parity);
+	rebuild_test_fini();
+}
+
+static void
+test_rebuild_bandwidth_limit(void)
+{
+	struct raid_bdev_rebuild *rebuild;
+	uint64_t window_bytes, num_windows;
+	uint64_t window_usec;
+
+	rebuild_test_init(2, 1, 1);
+	g_opts.rebuild_max_bandwidth_mb_sec = 1;
+
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == 0);
+	rebuild = g_raid_bdev.rebuild;
+	SPDK_CU_ASSERT_FATAL(rebuild != NULL);
+	window_bytes = rebuild->window_blocks * TEST_BLOCKLEN;
+	num_windows = TEST_BASE_BLOCKCNT / rebuild->window_blocks;
+	SPDK_CU_ASSERT_FATAL(num_windows > 2);
+
+	/* No quota yet, nothing is rebuilt until the first time slice ends */
+	poll_threads();
+	CU_ASSERT(g_quiesced == 0);
+	CU_ASSERT(rebuild->offset_blocks == 0);
+
+	/* The first window overdraws the quota */
+	spdk_delay_us(RAID_REBUILD_TIMESLICE_USEC);
+	poll_threads();
+	CU_ASSERT(g_quiesced == 1);
+	CU_ASSERT(rebuild->offset_blocks == rebuild->window_blocks);
+
+	/* The next one waits until it's paid back, at 1 MiB/s */
+	window_usec = window_bytes * SPDK_SEC_TO_USEC / (1024 * 1024);
+	spdk_delay_us(window_usec / 2);
+	poll_threads();
+	CU_ASSERT(g_quiesced == 1);
+
+	spdk_delay_us(window_usec / 2 + RAID_REBUILD_TIMESLICE_USEC);
+	poll_threads();
+	CU_ASSERT(g_quiesced == 2);
+	CU_ASSERT(rebuild->offset_blocks == 2 * rebuild->window_blocks);
+
+	/* Without the limit the rest goes at once */
+	g_opts.rebuild_max_bandwidth_mb_sec = 0;
+	spdk_delay_us(RAID_REBUILD_TIMESLICE_USEC);
+	poll_threads();
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(g_quiesced == num_windows);
+	CU_ASSERT(memcmp(g_base_bdevs[0].data, g_base_bdevs[1].data,
+			 TEST_BASE_BLOCKCNT * TEST_BLOCKLEN) == 0);
+
+	rebuild_test_fini();
+}
+
+static void
+test_rebuild_stop(void)
+{
+	struct raid_base_bdev_info *target;
+	struct raid_bdev_rebuild *rebuild;
+	uint64_t window_blocks;
+
+	rebuild_test_init(2, 1, 1);
+	target = &g_raid_bdev.base_bdev_info[1];
+	g_failed_base_info = NULL;
+
+	/* Stop while the first window is in progress, it's completed first */
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == 0);
+	rebuild = g_raid_bdev.rebuild;
+	SPDK_CU_ASSERT_FATAL(rebuild != NULL);
+	CU_ASSERT(rebuild->busy == true);
+	window_blocks = rebuild->window_blocks;
+
+	raid_bdev_rebuild_stop(&g_raid_bdev, test_stop_cb, NULL);
+	CU_ASSERT(g_stop_cb_called == false);
+	CU_ASSERT(g_raid_bdev.rebuild != NULL);
+
+	poll_threads();
+	CU_ASSERT(g_stop_cb_called == true);
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(g_failed_base_info == NULL);
+	CU_ASSERT(target->rebuilding == true);
+	CU_ASSERT(target->rebuild_offset == window_blocks);
+	CU_ASSERT(memcmp(g_base_bdevs[0].data, g_base_bdevs[1].data,
+			 window_blocks * TEST_BLOCKLEN) == 0);
+
+	/* With no rebuild the callback is called right away */
+	g_stop_cb_called = false;
+	raid_bdev_rebuild_stop(&g_raid_bdev, test_stop_cb, NULL);
+	CU_ASSERT(g_stop_cb_called == true);
+
+	rebuild_test_fini();
+}
+
+static void
+test_rebuild_failure(void)
+{
+	struct raid_base_bdev_info *target;
+
+	/* No sources */
+	rebuild_test_init(2, 0, 1);
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == -ENODEV);
+	rebuild_test_fini();
+
+	/* Missing source */
+	rebuild_test_init(4, 3, 3);
+	g_raid_bdev.base_bdev_info[1].desc = NULL;
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 3) == -ENODEV);
+	rebuild_test_fini();
+
+	/* Failing source, the window is retried and the rebuild aborted */
+	rebuild_test_init(2, 1, 1);
+	target = &g_raid_bdev.base_bdev_info[1];
+	g_base_bdevs[0].fail_reads = true;
+	g_failed_base_info = NULL;
+
+	CU_ASSERT(raid_bdev_rebuild_start(&g_raid_bdev, 1) == 0);
+
+	rebuild_test_run();
+
+	CU_ASSERT(g_raid_bdev.rebuild == NULL);
+	CU_ASSERT(g_quiesced == RAID_REBUILD_MAX_RETRIES + 1);
+	CU_ASSERT(g_failed_base_info == target);
+	CU_ASSERT(target->rebuilding == true);
+	CU_ASSERT(target->rebuild_offset == 0);
+	CU_ASSERT(g_base_bdevs[1].num_writes == 0);
+
+	rebuild_test_fini();
+}
+
+static int
+test_setup(void)
+{
+	allocate_threads(1);
+	set_thread(0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	free_threads();
+
+	return 0;
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid_rebuild", test_setup, test_cleanup);
+	CU_ADD_TEST(suite, test_rebuild_mirror);
+	CU_ADD_TEST(suite, test_rebuild_xor);
+	CU_ADD_TEST(suite, test_rebuild_bandwidth_limit);
+	CU_ADD_TEST(suite, test_rebuild_stop);
+	CU_ADD_TEST(suite, test_rebuild_failure);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
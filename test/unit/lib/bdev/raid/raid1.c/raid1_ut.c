@@ -0,0 +1,610 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_cunit.h"
+#include "spdk/env.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/raid/raid1.c"
+
+DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB_V(raid_bdev_queue_io_wait, (struct raid_bdev_io *raid_io, struct spdk_bdev *bdev,
+		struct spdk_io_channel *ch, spdk_bdev_io_wait_cb cb_fn));
+DEFINE_STUB(raid_bdev_level_to_str, const char *, (enum raid_level level), "");
+
+SPDK_LOG_REGISTER_COMPONENT(bdev_raid)
+
+struct spdk_bdev_desc {
+	struct spdk_bdev *bdev;
+};
+
+/* Base bdev backed by memory */
+struct test_base_bdev {
+	struct spdk_bdev bdev;
+	struct spdk_bdev_desc desc;
+	uint8_t *data;
+	uint64_t num_reads;
+	uint64_t num_writes;
+	uint64_t num_unmaps;
+	uint64_t unmap_offset;
+	uint64_t unmap_blocks;
+};
+
+struct test_base_io {
+	struct spdk_bdev_io bdev_io;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+};
+
+static uint32_t g_io_completions;
+static uint32_t g_io_failures;
+
+static void
+test_base_io_complete(void *ctx)
+{
+	struct test_base_io *io = ctx;
+
+	io->cb(&io->bdev_io, true, io->cb_arg);
+	free(io);
+}
+
+static void
+test_base_io_queue(struct test_base_bdev *base, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_io *io;
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->bdev_io.bdev = &base->bdev;
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+
+	/* Complete asynchronously, like the bdev layer does */
+	spdk_thread_send_msg(spdk_get_thread(), test_base_io_complete, io);
+}
+
+static int
+test_base_io_submit(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt,
+		    uint64_t offset_blocks, uint64_t num_blocks, bool write,
+		    spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = SPDK_CONTAINEROF(desc, struct test_base_bdev, desc);
+	struct iovec buf_iov;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= base->bdev.blockcnt);
+
+	buf_iov.iov_base = base->data + offset_blocks * base->bdev.blocklen;
+	buf_iov.iov_len = num_blocks * base->bdev.blocklen;
+
+	if (write) {
+		CU_ASSERT(spdk_iovcpy(iov, iovcnt, &buf_iov, 1) == buf_iov.iov_len);
+		base->num_writes++;
+	} else {
+		CU_ASSERT(spdk_iovcpy(&buf_iov, 1, iov, iovcnt) == buf_iov.iov_len);
+		base->num_reads++;
+	}
+
+	test_base_io_queue(base, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt,
+			uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+int
+spdk_bdev_unmap_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = SPDK_CONTAINEROF(desc, struct test_base_bdev, desc);
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= base->bdev.blockcnt);
+
+	base->num_unmaps++;
+	base->unmap_offset = offset_blocks;
+	base->unmap_blocks = num_blocks;
+	test_base_io_queue(base, cb, cb_arg);
+
+	return 0;
+}
+
+int
+spdk_bdev_flush_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = SPDK_CONTAINEROF(desc, struct test_base_bdev, desc);
+
+	test_base_io_queue(base, cb, cb_arg);
+
+	return 0;
+}
+
+void
+raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	g_io_completions++;
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		g_io_failures++;
+	}
+}
+
+bool
+raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed,
+			   enum spdk_bdev_io_status status)
+{
+	SPDK_CU_ASSERT_FATAL(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_io->base_bdev_io_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_bdev_io_complete(raid_io, raid_io->base_bdev_io_status);
+		return true;
+	}
+
+	return false;
+}
+
+static char g_base_ch;
+
+struct raid1_test {
+	struct raid_bdev raid_bdev;
+	struct raid_bdev_io_channel raid_ch;
+};
+
+static int
+test_setup(void)
+{
+	allocate_threads(1);
+	set_thread(0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	free_threads();
+	return 0;
+}
+
+static void
+test_init(struct raid1_test *test, enum raid_level level, uint8_t num_base_bdevs,
+	  uint64_t blockcnt, uint32_t strip_size)
+{
+	struct raid_bdev *raid_bdev = &test->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	uint8_t i;
+
+	memset(test, 0, sizeof(*test));
+
+	raid_bdev->module = level == RAID10 ? &g_raid10_module : &g_raid1_module;
+	raid_bdev->level = level;
+	raid_bdev->num_base_bdevs = num_base_bdevs;
+	raid_bdev->base_bdev_info = calloc(num_base_bdevs, sizeof(struct raid_base_bdev_info));
+	SPDK_CU_ASSERT_FATAL(raid_bdev->base_bdev_info != NULL);
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		struct test_base_bdev *base;
+
+		base = calloc(1, sizeof(*base));
+		SPDK_CU_ASSERT_FATAL(base != NULL);
+		base->bdev.blockcnt = blockcnt;
+		base->bdev.blocklen = 512;
+		base->desc.bdev = &base->bdev;
+		base->data = calloc(blockcnt, 512);
+		SPDK_CU_ASSERT_FATAL(base->data != NULL);
+
+		base_info->bdev = &base->bdev;
+		base_info->desc = &base->desc;
+	}
+
+	raid_bdev->strip_size = strip_size;
+	raid_bdev->strip_size_shift = spdk_u32log2(strip_size);
+	raid_bdev->blocklen_shift = spdk_u32log2(512);
+	raid_bdev->bdev.blocklen = 512;
+
+	test->raid_ch.num_channels = num_base_bdevs;
+	test->raid_ch.base_channel = calloc(num_base_bdevs, sizeof(struct spdk_io_channel *));
+	SPDK_CU_ASSERT_FATAL(test->raid_ch.base_channel != NULL);
+	test->raid_ch.base_channel_outstanding = calloc(num_base_bdevs, sizeof(uint64_t));
+	SPDK_CU_ASSERT_FATAL(test->raid_ch.base_channel_outstanding != NULL);
+	for (i = 0; i < num_base_bdevs; i++) {
+		test->raid_ch.base_channel[i] = (struct spdk_io_channel *)&g_base_ch;
+	}
+
+	g_io_completions = 0;
+	g_io_failures = 0;
+}
+
+static void
+test_fini(struct raid1_test *test)
+{
+	struct raid_bdev *raid_bdev = &test->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+		free(base->data);
+		free(base);
+	}
+	free(test->raid_bdev.base_bdev_info);
+	free(test->raid_ch.base_channel);
+	free(test->raid_ch.base_channel_outstanding);
+}
+
+static struct test_base_bdev *
+test_base(struct raid1_test *test, uint8_t idx)
+{
+	return SPDK_CONTAINEROF(test->raid_bdev.base_bdev_info[idx].bdev, struct test_base_bdev, bdev);
+}
+
+struct test_io {
+	struct spdk_bdev_io bdev_io;
+	struct raid_bdev_io raid_io;
+	struct iovec iov;
+};
+
+static struct test_io *
+test_io_submit(struct raid1_test *test, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	       uint64_t num_blocks, void *buf)
+{
+	struct test_io *io;
+
+	/* raid_bdev_io must directly follow the bdev_io, like the driver_ctx does */
+	SPDK_STATIC_ASSERT(offsetof(struct test_io, raid_io) == sizeof(struct spdk_bdev_io),
+			   "raid_io must be the driver_ctx");
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+
+	io->bdev_io.bdev = &test->raid_bdev.bdev;
+	io->bdev_io.type = type;
+	io->bdev_io.u.bdev.offset_blocks = offset_blocks;
+	io->bdev_io.u.bdev.num_blocks = num_blocks;
+	io->iov.iov_base = buf;
+	io->iov.iov_len = num_blocks * 512;
+	io->bdev_io.u.bdev.iovs = &io->iov;
+	io->bdev_io.u.bdev.iovcnt = 1;
+
+	io->raid_io.raid_bdev = &test->raid_bdev;
+	io->raid_io.raid_ch = &test->raid_ch;
+	io->raid_io.base_bdev_io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	if (type == SPDK_BDEV_IO_TYPE_READ || type == SPDK_BDEV_IO_TYPE_WRITE) {
+		raid1_submit_rw_request(&io->raid_io);
+	} else {
+		raid1_submit_null_payload_request(&io->raid_io);
+	}
+
+	return io;
+}
+
+static void
+test_io_run(struct raid1_test *test, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	    uint64_t num_blocks, void *buf)
+{
+	uint32_t completions = g_io_completions;
+	struct test_io *io;
+
+	io = test_io_submit(test, type, offset_blocks, num_blocks, buf);
+	poll_threads();
+	CU_ASSERT(g_io_completions == completions + 1);
+	CU_ASSERT(g_io_failures == 0);
+	free(io);
+}
+
+static void
+test_raid1_start(void)
+{
+	struct raid1_test test;
+
+	test_init(&test, RAID1, 3, 64, 8);
+	test_base(&test, 1)->bdev.blockcnt = 60;
+	CU_ASSERT(raid1_start(&test.raid_bdev) == 0);
+	CU_ASSERT(test.raid_bdev.bdev.blockcnt == 60);
+	CU_ASSERT(test.raid_bdev.bdev.split_on_optimal_io_boundary == false);
+	test_fini(&test);
+
+	test_init(&test, RAID10, 6, 64, 8);
+	test_base(&test, 1)->bdev.blockcnt = 60;
+	CU_ASSERT(raid1_start(&test.raid_bdev) == 0);
+	CU_ASSERT(test.raid_bdev.bdev.blockcnt == 56 * 3);
+	CU_ASSERT(test.raid_bdev.bdev.optimal_io_boundary == 8);
+	CU_ASSERT(test.raid_bdev.bdev.split_on_optimal_io_boundary == true);
+	test_fini(&test);
+
+	/* raid10 needs complete mirror groups */
+	test_init(&test, RAID10, 5, 64, 8);
+	CU_ASSERT(raid1_start(&test.raid_bdev) == -EINVAL);
+	test_fini(&test);
+}
+
+static void
+test_raid1_write_read(void)
+{
+	struct raid1_test test;
+	uint8_t wbuf[8 * 512], rbuf[8 * 512];
+	uint8_t i;
+
+	test_init(&test, RAID1, 3, 64, 8);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+
+	memset(wbuf, 0xa5, sizeof(wbuf));
+	test_io_run(&test, SPDK_BDEV_IO_TYPE_WRITE, 10, 8, wbuf);
+
+	/* All the mirrors hold the data */
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(test_base(&test, i)->num_writes == 1);
+		CU_ASSERT(memcmp(test_base(&test, i)->data + 10 * 512, wbuf, sizeof(wbuf)) == 0);
+		CU_ASSERT(test.raid_ch.base_channel_outstanding[i] == 0);
+	}
+
+	memset(rbuf, 0, sizeof(rbuf));
+	test_io_run(&test, SPDK_BDEV_IO_TYPE_READ, 10, 8, rbuf);
+	CU_ASSERT(memcmp(rbuf, wbuf, sizeof(wbuf)) == 0);
+	CU_ASSERT(test_base(&test, 0)->num_reads + test_base(&test, 1)->num_reads +
+		  test_base(&test, 2)->num_reads == 1);
+
+	test_fini(&test);
+}
+
+static void
+test_raid1_read_balancing(void)
+{
+	struct raid1_test test;
+	struct test_io *ios[6];
+	uint8_t buf[512];
+	uint8_t i;
+
+	test_init(&test, RAID1, 3, 64, 8);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+
+	/* Reads in flight at the same time are spread evenly over the mirrors */
+	for (i = 0; i < 6; i++) {
+		ios[i] = test_io_submit(&test, SPDK_BDEV_IO_TYPE_READ, i, 1, buf);
+	}
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(test_base(&test, i)->num_reads == 2);
+		CU_ASSERT(test.raid_ch.base_channel_outstanding[i] == 2);
+	}
+	poll_threads();
+	CU_ASSERT(g_io_completions == 6);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(test.raid_ch.base_channel_outstanding[i] == 0);
+		test_base(&test, i)->num_reads = 0;
+	}
+	for (i = 0; i < 6; i++) {
+		free(ios[i]);
+	}
+
+	/* A mirror that has a deep queue gets no reads until the others catch up */
+	test.raid_ch.base_channel_outstanding[0] = 4;
+	for (i = 0; i < 6; i++) {
+		ios[i] = test_io_submit(&test, SPDK_BDEV_IO_TYPE_READ, i, 1, buf);
+	}
+	CU_ASSERT(test_base(&test, 0)->num_reads == 0);
+	CU_ASSERT(test_base(&test, 1)->num_reads == 3);
+	CU_ASSERT(test_base(&test, 2)->num_reads == 3);
+	test.raid_ch.base_channel_outstanding[0] = 0;
+	poll_threads();
+	for (i = 0; i < 6; i++) {
+		free(ios[i]);
+	}
+
+	test_fini(&test);
+}
+
+static void
+test_raid1_read_base_bdev_removed(void)
+{
+	struct raid1_test test;
+	struct test_io *io;
+	struct spdk_bdev *bdev;
+	uint8_t buf[512];
+	uint8_t i;
+
+	test_init(&test, RAID1, 2, 64, 8);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+	test.raid_ch.base_channel_outstanding[1] = 1;
+
+	/* The read goes to mirror 0, which is removed before the read completes */
+	io = test_io_submit(&test, SPDK_BDEV_IO_TYPE_READ, 0, 1, buf);
+	CU_ASSERT(test_base(&test, 0)->num_reads == 1);
+	CU_ASSERT(test.raid_ch.base_channel_outstanding[0] == 1);
+	bdev = test.raid_bdev.base_bdev_info[0].bdev;
+	test.raid_bdev.base_bdev_info[0].bdev = NULL;
+	test.raid_bdev.base_bdev_info[0].desc = NULL;
+	test.raid_ch.base_channel[0] = NULL;
+
+	poll_threads();
+	CU_ASSERT(g_io_completions == 1);
+	for (i = 0; i < 2; i++) {
+		CU_ASSERT(test.raid_ch.base_channel_outstanding[i] == i);
+	}
+	free(io);
+
+	test.raid_bdev.base_bdev_info[0].bdev = bdev;
+	test_fini(&test);
+}
+
+static void
+test_raid1_degraded(void)
+{
+	struct raid1_test test;
+	uint8_t wbuf[4 * 512], rbuf[4 * 512];
+	uint8_t i;
+
+	test_init(&test, RAID1, 2, 64, 8);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+	test.raid_ch.base_channel[0] = NULL;
+
+	memset(wbuf, 0x5a, sizeof(wbuf));
+	test_io_run(&test, SPDK_BDEV_IO_TYPE_WRITE, 0, 4, wbuf);
+	CU_ASSERT(test_base(&test, 0)->num_writes == 0);
+	CU_ASSERT(test_base(&test, 1)->num_writes == 1);
+
+	for (i = 0; i < 4; i++) {
+		memset(rbuf, 0, sizeof(rbuf));
+		test_io_run(&test, SPDK_BDEV_IO_TYPE_READ, 0, 4, rbuf);
+		CU_ASSERT(memcmp(rbuf, wbuf, sizeof(wbuf)) == 0);
+	}
+	CU_ASSERT(test_base(&test, 0)->num_reads == 0);
+	CU_ASSERT(test_base(&test, 1)->num_reads == 4);
+
+	/* No mirror left */
+	test.raid_ch.base_channel[1] = NULL;
+	test_io_submit(&test, SPDK_BDEV_IO_TYPE_READ, 0, 4, rbuf);
+	CU_ASSERT(g_io_failures == 1);
+	test_io_submit(&test, SPDK_BDEV_IO_TYPE_WRITE, 0, 4, wbuf);
+	CU_ASSERT(g_io_failures == 2);
+	poll_threads();
+
+	test.raid_ch.base_channel[0] = (struct spdk_io_channel *)&g_base_ch;
+	test.raid_ch.base_channel[1] = (struct spdk_io_channel *)&g_base_ch;
+	test_fini(&test);
+}
+
+static void
+test_raid10_layout(void)
+{
+	struct raid1_test test;
+	uint8_t buf[4 * 512];
+	uint8_t rbuf[4 * 512];
+	uint64_t strip;
+	uint8_t group, m;
+
+	/* 3 mirror groups of 2, strip size 4 */
+	test_init(&test, RAID10, 6, 16, 4);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+	SPDK_CU_ASSERT_FATAL(test.raid_bdev.bdev.blockcnt == 48);
+
+	for (strip = 0; strip < 12; strip++) {
+		memset(buf, (int)strip + 1, sizeof(buf));
+		test_io_run(&test, SPDK_BDEV_IO_TYPE_WRITE, strip * 4, 4, buf);
+	}
+
+	/* Strips rotate over the groups and both mirrors of a group have the same data */
+	for (strip = 0; strip < 12; strip++) {
+		group = strip % 3;
+		memset(buf, (int)strip + 1, sizeof(buf));
+		for (m = 0; m < 2; m++) {
+			CU_ASSERT(memcmp(test_base(&test, group * 2 + m)->data + (strip / 3) * 4 * 512,
+					 buf, sizeof(buf)) == 0);
+		}
+
+		memset(rbuf, 0, sizeof(rbuf));
+		test_io_run(&test, SPDK_BDEV_IO_TYPE_READ, strip * 4, 4, rbuf);
+		CU_ASSERT(memcmp(rbuf, buf, sizeof(buf)) == 0);
+	}
+
+	test_fini(&test);
+}
+
+static void
+test_raid10_unmap(void)
+{
+	struct raid1_test test;
+	uint8_t i;
+
+	test_init(&test, RAID10, 6, 16, 4);
+	SPDK_CU_ASSERT_FATAL(raid1_start(&test.raid_bdev) == 0);
+
+	/* Blocks 2..13: end of strip 0 (group 0), strip 1 (group 1), strip 2 (group 2), start of strip 3 (group 0) */
+	test_io_run(&test, SPDK_BDEV_IO_TYPE_UNMAP, 2, 12, NULL);
+
+	for (i = 0; i < 6; i++) {
+		CU_ASSERT(test_base(&test, i)->num_unmaps == 1);
+		CU_ASSERT(test.raid_ch.base_channel_outstanding[i] == 0);
+	}
+	/* Group 0: offset 2 in strip 0 through offset 1 in its strip 1 */
+	CU_ASSERT(test_base(&test, 0)->unmap_offset == 2);
+	CU_ASSERT(test_base(&test, 0)->unmap_blocks == 4);
+	CU_ASSERT(test_base(&test, 1)->unmap_offset == 2);
+	CU_ASSERT(test_base(&test, 1)->unmap_blocks == 4);
+	CU_ASSERT(test_base(&test, 2)->unmap_offset == 0);
+	CU_ASSERT(test_base(&test, 2)->unmap_blocks == 4);
+	CU_ASSERT(test_base(&test, 5)->unmap_offset == 0);
+	CU_ASSERT(test_base(&test, 5)->unmap_blocks == 4);
+
+	test_fini(&test);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite suite = NULL;
+	unsigned int num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("raid1", test_setup, test_cleanup);
+	CU_ADD_TEST(suite, test_raid1_start);
+	CU_ADD_TEST(suite, test_raid1_write_read);
+	CU_ADD_TEST(suite, test_raid1_read_balancing);
+	CU_ADD_TEST(suite, test_raid1_read_base_bdev_removed);
+	CU_ADD_TEST(suite, test_raid1_degraded);
+	CU_ADD_TEST(suite, test_raid10_layout);
+	CU_ADD_TEST(suite, test_raid10_unmap);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
@@ -36,11 +36,127 @@
 #include "spdk/env.h"
 #include "spdk_internal/mock.h"
 
+#include "common/lib/ut_multithread.c"
+
 #include "bdev/raid/raid5.c"
 
 DEFINE_STUB_V(raid_bdev_module_list_add, (struct raid_bdev_module *raid_module));
-DEFINE_STUB_V(raid_bdev_io_complete, (struct raid_bdev_io *raid_io,
-				      enum spdk_bdev_io_status status));
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_queue_io_wait, int, (struct spdk_bdev *bdev, struct spdk_io_channel *ch,
+		struct spdk_bdev_io_wait_entry *entry), 0);
+
+struct spdk_bdev_desc {
+	struct spdk_bdev *bdev;
+};
+
+/* Base bdev backed by memory, used to verify the data and parity layout */
+struct test_base_bdev {
+	struct spdk_bdev bdev;
+	struct spdk_bdev_desc desc;
+	uint8_t *data;
+	uint64_t num_reads;
+	uint64_t num_writes;
+};
+
+struct test_base_io {
+	struct spdk_bdev_io bdev_io;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+};
+
+static uint32_t g_io_completions;
+static uint32_t g_io_failures;
+
+static void
+test_base_io_complete(void *ctx)
+{
+	struct test_base_io *io = ctx;
+
+	io->cb(&io->bdev_io, true, io->cb_arg);
+	free(io);
+}
+
+static int
+test_base_io_submit(struct spdk_bdev_desc *desc, struct iovec *iov, int iovcnt,
+		    uint64_t offset_blocks, uint64_t num_blocks, bool write,
+		    spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	struct test_base_bdev *base = SPDK_CONTAINEROF(desc, struct test_base_bdev, desc);
+	struct iovec buf_iov;
+	struct test_base_io *io;
+
+	SPDK_CU_ASSERT_FATAL(offset_blocks + num_blocks <= base->bdev.blockcnt);
+
+	buf_iov.iov_base = base->data + offset_blocks * base->bdev.blocklen;
+	buf_iov.iov_len = num_blocks * base->bdev.blocklen;
+
+	if (write) {
+		CU_ASSERT(spdk_iovcpy(iov, iovcnt, &buf_iov, 1) == buf_iov.iov_len);
+		base->num_writes++;
+	} else {
+		CU_ASSERT(spdk_iovcpy(&buf_iov, 1, iov, iovcnt) == buf_iov.iov_len);
+		base->num_reads++;
+	}
+
+	io = calloc(1, sizeof(*io));
+	SPDK_CU_ASSERT_FATAL(io != NULL);
+	io->cb = cb;
+	io->cb_arg = cb_arg;
+
+	/* Complete asynchronously, like the bdev layer does */
+	spdk_thread_send_msg(spdk_get_thread(), test_base_io_complete, io);
+
+	return 0;
+}
+
+int
+spdk_bdev_readv_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		       struct iovec *iov, int iovcnt,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, iov, iovcnt, offset_blocks, num_blocks, false, cb, cb_arg);
+}
+
+int
+spdk_bdev_writev_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			struct iovec *iov, int iovcnt,
+			uint64_t offset_blocks, uint64_t num_blocks,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return test_base_io_submit(desc, iov, iovcnt, offset_blocks, num_blocks, true, cb, cb_arg);
+}
+
+void
+raid_bdev_io_complete(struct raid_bdev_io *raid_io, enum spdk_bdev_io_status status)
+{
+	g_io_completions++;
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		g_io_failures++;
+	}
+
+	/* The raid_io may be freed once completed, make any later use of it crash */
+	raid_io->raid_bdev = NULL;
+}
+
+bool
+raid_bdev_io_complete_part(struct raid_bdev_io *raid_io, uint64_t completed,
+			   enum spdk_bdev_io_status status)
+{
+	SPDK_CU_ASSERT_FATAL(raid_io->base_bdev_io_remaining >= completed);
+	raid_io->base_bdev_io_remaining -= completed;
+
+	if (status != SPDK_BDEV_IO_STATUS_SUCCESS) {
+		raid_io->base_bdev_io_status = status;
+	}
+
+	if (raid_io->base_bdev_io_remaining == 0) {
+		raid_bdev_io_complete(raid_io, raid_io->base_bdev_io_status);
+		return true;
+	}
+
+	return false;
+}
 
 struct raid5_params {
 	uint8_t num_base_bdevs;
@@ -71,6 +187,9 @@ test_setup(void)
 	uint32_t *strip_size_kb;
 	struct raid5_params *params;
 
+	allocate_threads(1);
+	set_thread(0);
+
 	g_params_count = SPDK_COUNTOF(num_base_bdevs_values) *
 			 SPDK_COUNTOF(base_bdev_blockcnt_values) *
 			 SPDK_COUNTOF(base_bdev_blocklen_values) *
@@ -108,6 +227,7 @@ static int
 test_cleanup(void)
 {
 	free(g_params);
+	free_threads();
 	return 0;
 }
 
@@ -127,15 +247,22 @@ create_raid_bdev(struct raid5_params *params)
 	SPDK_CU_ASSERT_FATAL(raid_bdev->base_bdev_info != NULL);
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
-		base_info->bdev = calloc(1, sizeof(*base_info->bdev));
-		SPDK_CU_ASSERT_FATAL(base_info->bdev != NULL);
+		struct test_base_bdev *base;
 
-		base_info->bdev->blockcnt = params->base_bdev_blockcnt;
-		base_info->bdev->blocklen = params->base_bdev_blocklen;
+		base = calloc(1, sizeof(*base));
+		SPDK_CU_ASSERT_FATAL(base != NULL);
+
+		base->bdev.blockcnt = params->base_bdev_blockcnt;
+		base->bdev.blocklen = params->base_bdev_blocklen;
+		base->desc.bdev = &base->bdev;
+
+		base_info->bdev = &base->bdev;
+		base_info->desc = &base->desc;
 	}
 
 	raid_bdev->strip_size = params->strip_size;
 	raid_bdev->strip_size_shift = spdk_u32log2(raid_bdev->strip_size);
+	raid_bdev->blocklen_shift = spdk_u32log2(params->base_bdev_blocklen);
 	raid_bdev->bdev.blocklen = params->base_bdev_blocklen;
 
 	return raid_bdev;
@@ -147,7 +274,10 @@ delete_raid_bdev(struct raid_bdev *raid_bdev)
 	struct raid_base_bdev_info *base_info;
 
 	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
-		free(base_info->bdev);
+		struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+		free(base->data);
+		free(base);
 	}
 	free(raid_bdev->base_bdev_info);
 	free(raid_bdev);
@@ -169,6 +299,7 @@ delete_raid5(struct raid5_info *r5info)
 	struct raid_bdev *raid_bdev = r5info->raid_bdev;
 
 	raid5_stop(raid_bdev);
+	poll_threads();
 
 	delete_raid_bdev(raid_bdev);
 }
@@ -194,6 +325,442 @@ test_raid5_start(void)
 	}
 }
 
+/* Parameters small enough to keep the whole array in memory */
+static struct raid5_params g_io_params[] = {
+	{ .num_base_bdevs = 3, .base_bdev_blockcnt = 64, .base_bdev_blocklen = 512, .strip_size = 8 },
+	{ .num_base_bdevs = 4, .base_bdev_blockcnt = 64, .base_bdev_blocklen = 512, .strip_size = 4 },
+	{ .num_base_bdevs = 5, .base_bdev_blockcnt = 64, .base_bdev_blocklen = 4096, .strip_size = 2 },
+};
+
+struct raid5_io_test {
+	struct raid5_info *r5info;
+	struct raid_bdev_io_channel raid_ch;
+	/* Expected contents of the raid bdev */
+	uint8_t *ref;
+	uint64_t size;
+};
+
+static char g_base_ch;
+
+static void
+io_test_init(struct raid5_io_test *test, struct raid5_params *params)
+{
+	struct raid_bdev *raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	uint8_t i;
+
+	test->r5info = create_raid5(params);
+	raid_bdev = test->r5info->raid_bdev;
+
+	RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+		struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+		base->data = calloc(base->bdev.blockcnt, base->bdev.blocklen);
+		SPDK_CU_ASSERT_FATAL(base->data != NULL);
+	}
+
+	test->raid_ch.num_channels = raid_bdev->num_base_bdevs;
+	test->raid_ch.base_channel = calloc(raid_bdev->num_base_bdevs, sizeof(struct spdk_io_channel *));
+	SPDK_CU_ASSERT_FATAL(test->raid_ch.base_channel != NULL);
+	for (i = 0; i < raid_bdev->num_base_bdevs; i++) {
+		test->raid_ch.base_channel[i] = (struct spdk_io_channel *)&g_base_ch;
+	}
+	test->raid_ch.module_channel = raid5_get_io_channel(raid_bdev);
+	SPDK_CU_ASSERT_FATAL(test->raid_ch.module_channel != NULL);
+
+	test->size = raid_bdev->bdev.blockcnt * raid_bdev->bdev.blocklen;
+	test->ref = calloc(1, test->size);
+	SPDK_CU_ASSERT_FATAL(test->ref != NULL);
+}
+
+static void
+io_test_fini(struct raid5_io_test *test)
+{
+	spdk_put_io_channel(test->raid_ch.module_channel);
+	poll_threads();
+	free(test->raid_ch.base_channel);
+	free(test->ref);
+	delete_raid5(test->r5info);
+}
+
+static void
+io_test_reset_counters(struct raid5_io_test *test)
+{
+	struct raid_base_bdev_info *base_info;
+
+	RAID_FOR_EACH_BASE_BDEV(test->r5info->raid_bdev, base_info) {
+		struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+		base->num_reads = 0;
+		base->num_writes = 0;
+	}
+}
+
+/* Submit an I/O with the payload split into several uneven iovs */
+static struct spdk_bdev_io *
+io_test_start(struct raid5_io_test *test, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	      uint64_t num_blocks, uint8_t *buf)
+{
+	struct raid_bdev *raid_bdev = test->r5info->raid_bdev;
+	uint64_t len = num_blocks * raid_bdev->bdev.blocklen;
+	struct spdk_bdev_io *bdev_io;
+	struct raid_bdev_io *raid_io;
+	struct iovec *iovs;
+	int iovcnt = 0;
+	uint64_t off = 0;
+
+	bdev_io = calloc(1, sizeof(*bdev_io) + sizeof(*raid_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+	iovs = calloc(3, sizeof(*iovs));
+	SPDK_CU_ASSERT_FATAL(iovs != NULL);
+
+	bdev_io->bdev = &raid_bdev->bdev;
+	bdev_io->type = type;
+	bdev_io->u.bdev.offset_blocks = offset_blocks;
+	bdev_io->u.bdev.num_blocks = num_blocks;
+
+	if (len > 3) {
+		iovs[iovcnt].iov_base = buf;
+		iovs[iovcnt].iov_len = len / 3 + 1;
+		off += iovs[iovcnt++].iov_len;
+		iovs[iovcnt].iov_base = buf + off;
+		iovs[iovcnt].iov_len = len / 3 - 1;
+		off += iovs[iovcnt++].iov_len;
+	}
+	iovs[iovcnt].iov_base = buf + off;
+	iovs[iovcnt++].iov_len = len - off;
+
+	bdev_io->u.bdev.iovs = iovs;
+	bdev_io->u.bdev.iovcnt = iovcnt;
+
+	raid_io = (struct raid_bdev_io *)bdev_io->driver_ctx;
+	raid_io->raid_bdev = raid_bdev;
+	raid_io->raid_ch = &test->raid_ch;
+	raid_io->base_bdev_io_status = SPDK_BDEV_IO_STATUS_SUCCESS;
+
+	raid5_submit_rw_request(raid_io);
+
+	return bdev_io;
+}
+
+static void
+io_test_free(struct spdk_bdev_io *bdev_io)
+{
+	free(bdev_io->u.bdev.iovs);
+	free(bdev_io);
+}
+
+static void
+io_test_submit(struct raid5_io_test *test, enum spdk_bdev_io_type type, uint64_t offset_blocks,
+	       uint64_t num_blocks, uint8_t *buf)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	g_io_completions = 0;
+	g_io_failures = 0;
+
+	bdev_io = io_test_start(test, type, offset_blocks, num_blocks, buf);
+	poll_threads();
+
+	CU_ASSERT(g_io_completions == 1);
+	CU_ASSERT(g_io_failures == 0);
+
+	io_test_free(bdev_io);
+}
+
+static void
+io_test_write(struct raid5_io_test *test, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint32_t blocklen = test->r5info->raid_bdev->bdev.blocklen;
+	uint8_t *buf = test->ref + offset_blocks * blocklen;
+	uint64_t i;
+
+	for (i = 0; i < num_blocks * blocklen; i++) {
+		buf[i] = rand();
+	}
+
+	io_test_submit(test, SPDK_BDEV_IO_TYPE_WRITE, offset_blocks, num_blocks, buf);
+}
+
+static void
+io_test_verify_read(struct raid5_io_test *test, uint64_t offset_blocks, uint64_t num_blocks)
+{
+	uint32_t blocklen = test->r5info->raid_bdev->bdev.blocklen;
+	uint8_t *buf;
+
+	buf = malloc(num_blocks * blocklen);
+	SPDK_CU_ASSERT_FATAL(buf != NULL);
+
+	io_test_submit(test, SPDK_BDEV_IO_TYPE_READ, offset_blocks, num_blocks, buf);
+	CU_ASSERT(memcmp(buf, test->ref + offset_blocks * blocklen, num_blocks * blocklen) == 0);
+
+	free(buf);
+}
+
+static void
+io_test_verify_all(struct raid5_io_test *test)
+{
+	uint64_t stripe;
+
+	for (stripe = 0; stripe < test->r5info->total_stripes; stripe++) {
+		io_test_verify_read(test, stripe * test->r5info->stripe_blocks,
+				    test->r5info->stripe_blocks);
+	}
+}
+
+/* The xor of all the chunks of a stripe, parity included, must be zero */
+static void
+io_test_verify_parity(struct raid5_io_test *test)
+{
+	struct raid_bdev *raid_bdev = test->r5info->raid_bdev;
+	struct raid_base_bdev_info *base_info;
+	uint64_t chunk_len = raid_bdev->strip_size * raid_bdev->bdev.blocklen;
+	uint64_t stripe;
+	uint64_t i;
+	uint8_t *xor;
+
+	xor = malloc(chunk_len);
+	SPDK_CU_ASSERT_FATAL(xor != NULL);
+
+	for (stripe = 0; stripe < test->r5info->total_stripes; stripe++) {
+		memset(xor, 0, chunk_len);
+		RAID_FOR_EACH_BASE_BDEV(raid_bdev, base_info) {
+			struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+			for (i = 0; i < chunk_len; i++) {
+				xor[i] ^= base->data[stripe * chunk_len + i];
+			}
+		}
+		for (i = 0; i < chunk_len; i++) {
+			if (xor[i] != 0) {
+				break;
+			}
+		}
+		CU_ASSERT(i == chunk_len);
+	}
+
+	free(xor);
+}
+
+static void
+test_raid5_full_stripe_write(void)
+{
+	struct raid5_params *params;
+	struct raid_base_bdev_info *base_info;
+
+	ARRAY_FOR_EACH(g_io_params, params) {
+		struct raid5_io_test test;
+		uint64_t stripe;
+
+		io_test_init(&test, params);
+
+		for (stripe = 0; stripe < test.r5info->total_stripes; stripe++) {
+			io_test_reset_counters(&test);
+			io_test_write(&test, stripe * test.r5info->stripe_blocks, test.r5info->stripe_blocks);
+
+			/* Parity is calculated without reading from the base bdevs */
+			RAID_FOR_EACH_BASE_BDEV(test.r5info->raid_bdev, base_info) {
+				struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev,
+							      bdev);
+
+				CU_ASSERT(base->num_reads == 0);
+				CU_ASSERT(base->num_writes == 1);
+			}
+		}
+
+		io_test_verify_parity(&test);
+		io_test_verify_all(&test);
+
+		io_test_fini(&test);
+	}
+}
+
+static void
+io_test_partial_writes(struct raid5_io_test *test)
+{
+	uint64_t strip_size = test->r5info->raid_bdev->strip_size;
+	uint64_t stripe_blocks = test->r5info->stripe_blocks;
+	uint64_t stripe;
+
+	for (stripe = 0; stripe < test->r5info->total_stripes; stripe++) {
+		uint64_t stripe_offset = stripe * stripe_blocks;
+
+		io_test_write(test, stripe_offset, 1);
+		io_test_write(test, stripe_offset + stripe_blocks - 1, 1);
+		io_test_write(test, stripe_offset + strip_size - 1, 2);
+		io_test_write(test, stripe_offset + strip_size, strip_size);
+		io_test_write(test, stripe_offset + strip_size / 2, stripe_blocks - strip_size);
+		io_test_write(test, stripe_offset, stripe_blocks - 1);
+		io_test_write(test, stripe_offset + 1, stripe_blocks - 1);
+	}
+}
+
+static void
+test_raid5_partial_write(void)
+{
+	struct raid5_params *params;
+
+	ARRAY_FOR_EACH(g_io_params, params) {
+		struct raid5_io_test test;
+
+		io_test_init(&test, params);
+
+		io_test_partial_writes(&test);
+		io_test_verify_parity(&test);
+		io_test_verify_all(&test);
+
+		io_test_fini(&test);
+	}
+}
+
+static void
+test_raid5_read(void)
+{
+	struct raid5_params *params;
+	struct raid_base_bdev_info *base_info;
+
+	ARRAY_FOR_EACH(g_io_params, params) {
+		struct raid5_io_test test;
+		uint64_t stripe_blocks;
+		uint64_t offset;
+
+		io_test_init(&test, params);
+		stripe_blocks = test.r5info->stripe_blocks;
+
+		for (offset = 0; offset < test.r5info->raid_bdev->bdev.blockcnt; offset += stripe_blocks) {
+			io_test_write(&test, offset, stripe_blocks);
+		}
+
+		for (offset = 0; offset < stripe_blocks; offset++) {
+			io_test_reset_counters(&test);
+			io_test_verify_read(&test, stripe_blocks + offset, stripe_blocks - offset);
+
+			/* Healthy reads never touch the parity */
+			RAID_FOR_EACH_BASE_BDEV(test.r5info->raid_bdev, base_info) {
+				struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev,
+							      bdev);
+
+				CU_ASSERT(base->num_writes == 0);
+				CU_ASSERT(base->num_reads <= 1);
+			}
+		}
+
+		io_test_fini(&test);
+	}
+}
+
+static void
+test_raid5_degraded(void)
+{
+	struct raid5_params *params;
+
+	ARRAY_FOR_EACH(g_io_params, params) {
+		struct raid5_io_test test;
+		uint64_t stripe_blocks;
+		uint64_t offset;
+		uint8_t i;
+
+		io_test_init(&test, params);
+		stripe_blocks = test.r5info->stripe_blocks;
+
+		for (i = 0; i < params->num_base_bdevs; i++) {
+			for (offset = 0; offset < test.r5info->raid_bdev->bdev.blockcnt; offset += stripe_blocks) {
+				io_test_write(&test, offset, stripe_blocks);
+			}
+
+			test.raid_ch.base_channel[i] = NULL;
+
+			/* Reads reconstruct the data of the missing base bdev */
+			io_test_verify_all(&test);
+			for (offset = 0; offset < stripe_blocks; offset++) {
+				io_test_verify_read(&test, offset, 1);
+			}
+
+			/* Writes keep the data readable without the missing base bdev */
+			io_test_partial_writes(&test);
+			io_test_write(&test, 0, stripe_blocks);
+			io_test_verify_all(&test);
+
+			test.raid_ch.base_channel[i] = (struct spdk_io_channel *)&g_base_ch;
+		}
+
+		io_test_fini(&test);
+	}
+}
+
+static uint64_t
+io_test_base_ios(struct raid5_io_test *test)
+{
+	struct raid_base_bdev_info *base_info;
+	uint64_t count = 0;
+
+	RAID_FOR_EACH_BASE_BDEV(test->r5info->raid_bdev, base_info) {
+		struct test_base_bdev *base = SPDK_CONTAINEROF(base_info->bdev, struct test_base_bdev, bdev);
+
+		count += base->num_reads + base->num_writes;
+	}
+
+	return count;
+}
+
+static void
+test_raid5_stripe_lock(void)
+{
+	struct raid5_params *params;
+
+	ARRAY_FOR_EACH(g_io_params, params) {
+		struct raid5_io_test test;
+		struct spdk_bdev_io *bdev_io[3];
+		uint32_t blocklen = params->base_bdev_blocklen;
+		uint64_t stripe_blocks;
+		uint64_t base_ios;
+		uint8_t *buf[3];
+		int i;
+
+		io_test_init(&test, params);
+		stripe_blocks = test.r5info->stripe_blocks;
+
+		for (i = 0; i < 3; i++) {
+			buf[i] = malloc(stripe_blocks * blocklen);
+			SPDK_CU_ASSERT_FATAL(buf[i] != NULL);
+			memset(buf[i], i + 1, stripe_blocks * blocklen);
+		}
+
+		g_io_completions = 0;
+		g_io_failures = 0;
+		io_test_reset_counters(&test);
+
+		/* Overlapping partial writes to the same stripe are serialized */
+		bdev_io[0] = io_test_start(&test, SPDK_BDEV_IO_TYPE_WRITE, stripe_blocks, 2, buf[0]);
+		base_ios = io_test_base_ios(&test);
+		CU_ASSERT(base_ios > 0);
+		bdev_io[1] = io_test_start(&test, SPDK_BDEV_IO_TYPE_WRITE, stripe_blocks + 1, 2, buf[1]);
+		CU_ASSERT(io_test_base_ios(&test) == base_ios);
+
+		/* A different stripe is not blocked */
+		bdev_io[2] = io_test_start(&test, SPDK_BDEV_IO_TYPE_WRITE, 2 * stripe_blocks, 1, buf[2]);
+		CU_ASSERT(io_test_base_ios(&test) > base_ios);
+
+		poll_threads();
+		CU_ASSERT(g_io_completions == 3);
+		CU_ASSERT(g_io_failures == 0);
+
+		memcpy(test.ref + stripe_blocks * blocklen, buf[0], 2 * blocklen);
+		memcpy(test.ref + (stripe_blocks + 1) * blocklen, buf[1], 2 * blocklen);
+		memcpy(test.ref + 2 * stripe_blocks * blocklen, buf[2], blocklen);
+
+		io_test_verify_parity(&test);
+		io_test_verify_all(&test);
+
+		for (i = 0; i < 3; i++) {
+			io_test_free(bdev_io[i]);
+			free(buf[i]);
+		}
+
+		io_test_fini(&test);
+	}
+}
+
 int
 main(int argc, char **argv)
 {
@@ -205,6 +772,11 @@ main(int argc, char **argv)
 
 	suite = CU_add_suite("raid5", test_setup, test_cleanup);
 	CU_ADD_TEST(suite, test_raid5_start);
+	CU_ADD_TEST(suite, test_raid5_full_stripe_write);
+	CU_ADD_TEST(suite, test_raid5_partial_write);
+	CU_ADD_TEST(suite, test_raid5_read);
+	CU_ADD_TEST(suite, test_raid5_degraded);
+	CU_ADD_TEST(suite, test_raid5_stripe_lock);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -361,6 +361,222 @@ blob_open(void)
 	ut_blob_close_and_delete(bs, g_blob);
 }
 
+static void
+blob_lookup_many(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts opts;
+	struct spdk_blob_opts blob_opts;
+	const int NUM_BLOBS = SPDK_BLOB_ID_HASH_MIN_BUCKETS * 3;
+	const int NUM_SNAPSHOTS = 8;
+	struct spdk_blob *blobs[NUM_BLOBS];
+	struct spdk_blob_list *snapshot_entry;
+	spdk_blob_id snapshotids[NUM_SNAPSHOTS];
+	int i;
+
+	dev = init_dev();
+	spdk_bs_opts_init(&opts, sizeof(opts));
+	opts.num_md_pages = NUM_BLOBS * 2;
+
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	CU_ASSERT(bs->blob_hash.num_buckets == SPDK_BLOB_ID_HASH_MIN_BUCKETS);
+
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.thin_provision = true;
+
+	/* Opening more blobs than there are buckets grows the table */
+	for (i = 0; i < NUM_BLOBS; i++) {
+		blobs[i] = ut_blob_create_and_open(bs, &blob_opts);
+	}
+	CU_ASSERT(bs->blob_hash.count == (uint32_t)NUM_BLOBS);
+	CU_ASSERT(bs->blob_hash.num_buckets >= (uint32_t)NUM_BLOBS);
+
+	for (i = 0; i < NUM_BLOBS; i++) {
+		CU_ASSERT(blob_lookup(bs, blobs[i]->id) == blobs[i]);
+	}
+
+	/* Opening an open blob returns the same handle */
+	spdk_bs_open_blob(bs, blobs[NUM_BLOBS / 2]->id, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blob == blobs[NUM_BLOBS / 2]);
+	spdk_blob_close(g_blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Snapshot entries are indexed as well */
+	for (i = 0; i < NUM_SNAPSHOTS; i++) {
+		spdk_bs_create_snapshot(bs, blobs[i]->id, NULL, blob_op_with_id_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+		snapshotids[i] = g_blobid;
+	}
+	CU_ASSERT(bs->snapshot_hash.count == (uint32_t)NUM_SNAPSHOTS);
+
+	for (i = 0; i < NUM_SNAPSHOTS; i++) {
+		snapshot_entry = bs_get_snapshot_entry(bs, snapshotids[i]);
+		SPDK_CU_ASSERT_FATAL(snapshot_entry != NULL);
+		CU_ASSERT(snapshot_entry->id == snapshotids[i]);
+		CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobs[i]->id) == snapshotids[i]);
+		CU_ASSERT(bs_get_snapshot_entry(bs, blobs[i]->id) == NULL);
+	}
+
+	/* Closed and deleted blobs can no longer be found */
+	for (i = 0; i < NUM_BLOBS; i++) {
+		spdk_blob_id blobid = blobs[i]->id;
+
+		ut_blob_close_and_delete(bs, blobs[i]);
+		CU_ASSERT(blob_lookup(bs, blobid) == NULL);
+	}
+	CU_ASSERT(bs->blob_hash.count == 0);
+
+	for (i = 0; i < NUM_SNAPSHOTS; i++) {
+		spdk_bs_delete_blob(bs, snapshotids[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(bs_get_snapshot_entry(bs, snapshotids[i]) == NULL);
+	}
+	CU_ASSERT(bs->snapshot_hash.count == 0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+}
+
+struct ut_md_batch_cpl {
+	spdk_blob_id	blobid;
+	uint32_t	order;
+};
+
+static uint32_t g_md_batch_num_cpls;
+
+static void
+blob_md_batch_create_cpl(void *cb_arg, spdk_blob_id blobid, int bserrno)
+{
+	struct ut_md_batch_cpl *cpl = cb_arg;
+
+	CU_ASSERT(bserrno == 0);
+	cpl->blobid = blobid;
+	cpl->order = g_md_batch_num_cpls++;
+}
+
+static uint64_t
+ut_blob_md_batch_create(uint32_t window_us)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts opts;
+	struct spdk_blob_opts blob_opts;
+	const int NUM_BLOBS = 32;
+	struct ut_md_batch_cpl cpls[NUM_BLOBS];
+	uint64_t write_ops;
+	int i;
+
+	dev = init_dev();
+	spdk_bs_opts_init(&opts, sizeof(opts));
+	opts.md_batch_window_us = window_us;
+
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	CU_ASSERT(bs->md_batch_window_us == window_us);
+
+	/* Reload so that the first persist has to mark the blobstore dirty */
+	ut_bs_reload(&bs, &opts);
+	CU_ASSERT(bs->clean == 1);
+
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.num_clusters = 1;
+
+	for (i = 0; i < NUM_BLOBS; i++) {
+		cpls[i].blobid = SPDK_BLOBID_INVALID;
+	}
+
+	g_md_batch_num_cpls = 0;
+	write_ops = g_dev_write_ops;
+	for (i = 0; i < NUM_BLOBS; i++) {
+		spdk_bs_create_blob_ext(bs, &blob_opts, blob_md_batch_create_cpl, &cpls[i]);
+	}
+	poll_threads();
+
+	if (window_us != 0) {
+		/* Nothing is written until the batch window expires */
+		CU_ASSERT(g_dev_write_ops == write_ops);
+		CU_ASSERT(g_md_batch_num_cpls == 0);
+		spdk_delay_us(window_us);
+		poll_threads();
+	}
+	write_ops = g_dev_write_ops - write_ops;
+	CU_ASSERT(bs->clean == 0);
+
+	/* Every create completed once, in the order they were started */
+	CU_ASSERT(g_md_batch_num_cpls == (uint32_t)NUM_BLOBS);
+	for (i = 0; i < NUM_BLOBS; i++) {
+		SPDK_CU_ASSERT_FATAL(cpls[i].blobid != SPDK_BLOBID_INVALID);
+		CU_ASSERT(cpls[i].order == (uint32_t)i);
+	}
+
+	/*
+	 * All of the blobs must survive a reload with their metadata intact. Batching is
+	 *  disabled from here on, as the helpers below do not advance the clock.
+	 */
+	opts.md_batch_window_us = 0;
+	ut_bs_reload(&bs, &opts);
+
+	for (i = 0; i < NUM_BLOBS; i++) {
+		spdk_bs_open_blob(bs, cpls[i].blobid, blob_op_with_handle_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+		CU_ASSERT(spdk_blob_get_num_clusters(g_blob) == 1);
+		ut_blob_close_and_delete(bs, g_blob);
+	}
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+
+	return write_ops;
+}
+
+static void
+blob_md_batch(void)
+{
+	const uint64_t NUM_BLOBS = 32;
+	uint64_t unbatched_ops, batched_ops;
+
+	unbatched_ops = ut_blob_md_batch_create(0);
+	batched_ops = ut_blob_md_batch_create(100);
+
+	if (g_use_extent_table) {
+		/*
+		 * Each create marks the blobstore dirty, as all of them start while it is
+		 *  still clean, and writes its extent page and its root page. In a batch the
+		 *  super block is written once. The root pages are not adjacent, as the
+		 *  extent pages are allocated between them, so each is still written.
+		 */
+		CU_ASSERT(unbatched_ops == 3 * NUM_BLOBS);
+		CU_ASSERT(batched_ops == 1 + 2 * NUM_BLOBS);
+	} else {
+		/*
+		 * The same without the extent pages, and the adjacent root pages of a batch
+		 *  are written with a single write.
+		 */
+		CU_ASSERT(unbatched_ops == 2 * NUM_BLOBS);
+		CU_ASSERT(batched_ops == 2);
+	}
+}
+
 static void
 blob_create(void)
 {
@@ -3740,7 +3956,7 @@ blob_insert_cluster_msg_test(void)
 	bs_allocate_cluster(blob, cluster_num, &new_cluster, &extent_page, false);
 	CU_ASSERT(blob->active.clusters[cluster_num] == 0);
 
-	blob_insert_cluster_on_md_thread(blob, cluster_num, new_cluster, extent_page,
+	blob_insert_cluster_on_md_thread(blob, cluster_num, &new_cluster, 1, extent_page,
 					 blob_op_complete, NULL);
 	poll_threads();
 
@@ -3863,6 +4079,123 @@ blob_thin_prov_rw(void)
 	g_blobid = 0;
 }
 
+static void
+blob_thin_prov_alloc_hint(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel, *channel_thread1;
+	struct spdk_blob_opts opts;
+	struct spdk_blob_open_opts open_opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint64_t pages_per_cluster;
+	uint8_t payload_read[4096];
+	uint8_t payload_write[4096];
+	uint64_t i;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	pages_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_page_size(bs);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 8;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(blob->cluster_alloc_hint == 1);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_blob_open_opts_init(&open_opts, sizeof(open_opts));
+	CU_ASSERT(open_opts.cluster_alloc_hint == 1);
+	open_opts.cluster_alloc_hint = 4;
+	spdk_bs_open_blob_ext(bs, blobid, &open_opts, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(blob->cluster_alloc_hint == 4);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+	set_thread(1);
+	channel_thread1 = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel_thread1 != NULL);
+
+	/* A first write to cluster 1 claims clusters 1-4 at once */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_write(blob, channel_thread1, payload_write, pages_per_cluster, 1,
+			   blob_op_complete, NULL);
+	CU_ASSERT(free_clusters - 4 == spdk_bs_free_cluster_count(bs));
+
+	/* A racing write to cluster 2 claims clusters 2-5. Only cluster 5 is
+	 * inserted, the others lose to the run above and are released. */
+	set_thread(0);
+	spdk_blob_io_write(blob, channel, payload_write, 2 * pages_per_cluster, 1,
+			   blob_op_complete, NULL);
+	CU_ASSERT(free_clusters - 8 == spdk_bs_free_cluster_count(bs));
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters - 5 == spdk_bs_free_cluster_count(bs));
+
+	for (i = 0; i < 8; i++) {
+		CU_ASSERT((blob->active.clusters[i] != 0) == (i >= 1 && i <= 5));
+	}
+
+	/* Writes within the run do not allocate anything */
+	spdk_blob_io_write(blob, channel, payload_write, 4 * pages_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters - 5 == spdk_bs_free_cluster_count(bs));
+
+	/* The run is bounded by the blob size */
+	spdk_blob_io_write(blob, channel, payload_write, 7 * pages_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters - 6 == spdk_bs_free_cluster_count(bs));
+
+	set_thread(1);
+	spdk_bs_free_io_channel(channel_thread1);
+	set_thread(0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* The allocated clusters and their data survive a reload */
+	ut_bs_reload(&bs, NULL);
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(free_clusters - 6 == spdk_bs_free_cluster_count(bs));
+
+	for (i = 0; i < 8; i++) {
+		CU_ASSERT((blob->active.clusters[i] != 0) == ((i >= 1 && i <= 5) || i == 7));
+	}
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+	spdk_blob_io_read(blob, channel, payload_read, 2 * pages_per_cluster, 1,
+			  blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, sizeof(payload_read)) == 0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+}
+
 static void
 blob_thin_prov_rle(void)
 {
@@ -6711,6 +7044,8 @@ int main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, blob_init);
 	CU_ADD_TEST(suite_bs, blob_open);
+	CU_ADD_TEST(suite, blob_lookup_many);
+	CU_ADD_TEST(suite, blob_md_batch);
 	CU_ADD_TEST(suite_bs, blob_create);
 	CU_ADD_TEST(suite_bs, blob_create_loop);
 	CU_ADD_TEST(suite_bs, blob_create_fail);
@@ -6754,6 +7089,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite_bs, blob_thin_prov_alloc);
 	CU_ADD_TEST(suite_bs, blob_insert_cluster_msg_test);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rw);
+	CU_ADD_TEST(suite_bs, blob_thin_prov_alloc_hint);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rle);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
 	CU_ADD_TEST(suite, bs_load_iter_test);
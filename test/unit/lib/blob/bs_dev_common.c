@@ -40,6 +40,7 @@
 #define DEV_BUFFER_BLOCKCNT (DEV_BUFFER_SIZE / DEV_BUFFER_BLOCKLEN)
 uint8_t *g_dev_buffer;
 uint64_t g_dev_write_bytes;
+uint64_t g_dev_write_ops;
 uint64_t g_dev_read_bytes;
 
 struct spdk_power_failure_counters {
@@ -191,6 +192,7 @@ dev_write(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payloa
 
 		memcpy(&g_dev_buffer[offset], payload, length);
 		g_dev_write_bytes += length;
+		g_dev_write_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -281,6 +283,7 @@ dev_writev(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
 		}
 
 		g_dev_write_bytes += length;
+		g_dev_write_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -364,6 +367,7 @@ dev_write_zeroes(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
 		SPDK_CU_ASSERT_FATAL(offset + length <= DEV_BUFFER_SIZE);
 		memset(&g_dev_buffer[offset], 0, length);
 		g_dev_write_bytes += length;
+		g_dev_write_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -853,6 +853,273 @@ test_governor(void)
 	free_cores();
 }
 
+static void
+test_scheduler_topology(void)
+{
+	struct spdk_cpuset cpuset = {};
+	struct spdk_thread *thread[4];
+	struct spdk_lw_thread *lw_thread[4];
+	struct spdk_scheduler_core_info cores_info[4] = {};
+	struct spdk_lw_thread *core0_threads[3], *core3_threads[1];
+	struct spdk_reactor *reactor;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(4);
+
+	CU_ASSERT(spdk_reactors_init() == 0);
+
+	_spdk_scheduler_set("dynamic");
+
+	/* Two sockets with two cores each, every socket sharing a single cache */
+	SPDK_CU_ASSERT_FATAL(g_cores_topology_count == 4);
+	for (i = 0; i < 4; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+		g_cores_topology[i].socket_id = i / 2;
+		spdk_cpuset_zero(&g_cores_topology[i].cache_cpus);
+		spdk_cpuset_set_cpu(&g_cores_topology[i].cache_cpus, i & ~1, true);
+		spdk_cpuset_set_cpu(&g_cores_topology[i].cache_cpus, i | 1, true);
+	}
+
+	/* Create all threads on core 0, then allow them to run anywhere */
+	spdk_cpuset_set_cpu(&cpuset, 0, true);
+	for (i = 0; i < 4; i++) {
+		thread[i] = spdk_thread_create(NULL, &cpuset);
+		SPDK_CU_ASSERT_FATAL(thread[i] != NULL);
+		spdk_cpuset_copy(spdk_thread_get_cpumask(thread[i]), &g_reactor_core_mask);
+		CU_ASSERT(spdk_thread_get_socket_hint(thread[i]) == SPDK_ENV_SOCKET_ID_ANY);
+		lw_thread[i] = spdk_thread_get_ctx(thread[i]);
+
+		/* Every thread is fully busy */
+		lw_thread[i]->last_stats.busy_tsc = 1;
+		lw_thread[i]->last_stats.idle_tsc = 1;
+		lw_thread[i]->snapshot_stats.busy_tsc = 101;
+		lw_thread[i]->snapshot_stats.idle_tsc = 1;
+	}
+
+	reactor = spdk_reactor_get(0);
+	CU_ASSERT(event_queue_run_batch(reactor) == 4);
+
+	/* Threads 0 and 1 poll devices attached to socket 1, thread 3 to socket 0 */
+	spdk_set_thread(thread[0]);
+	CU_ASSERT(spdk_thread_set_socket_hint(1) == 0);
+	spdk_set_thread(thread[1]);
+	CU_ASSERT(spdk_thread_set_socket_hint(1) == 0);
+	spdk_set_thread(thread[3]);
+	CU_ASSERT(spdk_thread_set_socket_hint(0) == 0);
+	CU_ASSERT(spdk_thread_set_socket_hint(-2) == -EINVAL);
+	CU_ASSERT(spdk_thread_get_socket_hint(thread[3]) == 0);
+	spdk_set_thread(NULL);
+
+	/* Threads 0-2 run on the main core, thread 3 on core 3 of the wrong socket */
+	core0_threads[0] = lw_thread[2];
+	core0_threads[1] = lw_thread[0];
+	core0_threads[2] = lw_thread[1];
+	core3_threads[0] = lw_thread[3];
+	lw_thread[3]->lcore = 3;
+	for (i = 0; i < 4; i++) {
+		cores_info[i].lcore = i;
+	}
+	cores_info[0].threads_count = 3;
+	cores_info[0].threads = core0_threads;
+	cores_info[3].threads_count = 1;
+	cores_info[3].threads = core3_threads;
+	/* The main core has no idle time left for busy threads */
+	cores_info[0].core_busy_tsc = UINT32_MAX;
+
+	balance(cores_info, 4, &governor);
+
+	/* The thread without a hint goes to the idle core sharing the main core's cache */
+	CU_ASSERT(lw_thread[2]->new_lcore == 1);
+
+	/* Threads with a socket hint are placed on cores of that socket */
+	CU_ASSERT(lw_thread[0]->new_lcore == 2);
+	CU_ASSERT(lw_thread[1]->new_lcore == 2 || lw_thread[1]->new_lcore == 3);
+
+	/* The thread on the wrong socket is moved to the only other core of its socket */
+	CU_ASSERT(lw_thread[3]->new_lcore == 1);
+
+	CU_ASSERT(g_placement_stats.moves == 4);
+	CU_ASSERT(g_placement_stats.local_moves == 3);
+	CU_ASSERT(g_placement_stats.remote_moves == 0);
+
+	/* Destroy threads */
+	lw_thread[3]->lcore = 0;
+	g_reactor_state = SPDK_REACTOR_STATE_INITIALIZED;
+	reactor_run(reactor);
+
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+
+	free_cores();
+}
+
+static void
+ut_set_thread_load(struct spdk_lw_thread *lw_thread, uint64_t load)
+{
+	lw_thread->snapshot_stats.busy_tsc = lw_thread->last_stats.busy_tsc + load;
+	lw_thread->snapshot_stats.idle_tsc = lw_thread->last_stats.idle_tsc + 100 - load;
+}
+
+static int
+ut_scheduler_set_opts(const char *opts)
+{
+	struct spdk_json_val values[16];
+	char buf[256];
+	ssize_t rc;
+
+	snprintf(buf, sizeof(buf), "%s", opts);
+	rc = spdk_json_parse(buf, strlen(buf), values, SPDK_COUNTOF(values), NULL, 0);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	return scheduler_dynamic.set_opts(values);
+}
+
+static void
+ut_balance_threads(struct spdk_scheduler_core_info *cores_info, struct spdk_lw_thread **lw_thread,
+		   struct spdk_lw_thread *threads[][2], int num_threads)
+{
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		cores_info[i].lcore = i;
+		cores_info[i].threads_count = 0;
+		cores_info[i].threads = threads[i];
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		threads[lw_thread[i]->lcore][cores_info[lw_thread[i]->lcore].threads_count++] = lw_thread[i];
+	}
+
+	balance(cores_info, 3, &governor);
+
+	/* Apply the decisions as the reactors would */
+	for (i = 0; i < num_threads; i++) {
+		lw_thread[i]->lcore = lw_thread[i]->new_lcore;
+	}
+}
+
+static void
+test_scheduler_load_model(void)
+{
+	struct spdk_cpuset cpuset = {};
+	struct spdk_thread *thread[2];
+	struct spdk_lw_thread *lw_thread[2];
+	struct spdk_lw_thread *threads[3][2];
+	struct spdk_scheduler_core_info cores_info[3] = {};
+	struct spdk_reactor *reactor;
+	int i;
+
+	MOCK_SET(spdk_env_get_current_core, 0);
+
+	allocate_cores(3);
+
+	CU_ASSERT(spdk_reactors_init() == 0);
+
+	_spdk_scheduler_set("dynamic");
+
+	/* All cores share a cache, so only the load decides */
+	SPDK_CU_ASSERT_FATAL(g_cores_topology_count == 3);
+	for (i = 0; i < 3; i++) {
+		spdk_cpuset_set_cpu(&g_reactor_core_mask, i, true);
+		g_cores_topology[i].socket_id = 0;
+		spdk_cpuset_copy(&g_cores_topology[i].cache_cpus, &g_reactor_core_mask);
+	}
+
+	CU_ASSERT(ut_scheduler_set_opts("{\"load_weight\": 0}") == -EINVAL);
+	CU_ASSERT(ut_scheduler_set_opts("{\"load_limit\": 101}") == -EINVAL);
+	CU_ASSERT(g_opts.load_weight == SCHEDULER_LOAD_WEIGHT);
+	CU_ASSERT(ut_scheduler_set_opts("{\"load_hysteresis\": 20, \"load_weight\": 50, "
+					"\"max_migrations\": 1}") == 0);
+	CU_ASSERT(g_opts.load_limit == SCHEDULER_LOAD_LIMIT);
+	CU_ASSERT(g_opts.load_hysteresis == 20);
+	CU_ASSERT(g_opts.load_weight == 50);
+	CU_ASSERT(g_opts.max_migrations == 1);
+
+	spdk_cpuset_set_cpu(&cpuset, 0, true);
+	for (i = 0; i < 2; i++) {
+		thread[i] = spdk_thread_create(NULL, &cpuset);
+		SPDK_CU_ASSERT_FATAL(thread[i] != NULL);
+		spdk_cpuset_copy(spdk_thread_get_cpumask(thread[i]), &g_reactor_core_mask);
+		lw_thread[i] = spdk_thread_get_ctx(thread[i]);
+		lw_thread[i]->last_stats.busy_tsc = 1;
+		lw_thread[i]->last_stats.idle_tsc = 1;
+	}
+
+	reactor = spdk_reactor_get(0);
+	CU_ASSERT(event_queue_run_batch(reactor) == 2);
+
+	/* The main core always has time for a thread */
+	cores_info[0].core_idle_tsc = UINT32_MAX;
+
+	/* A single busy period is smoothed out and does not move anything */
+	ut_set_thread_load(lw_thread[0], 100);
+	ut_set_thread_load(lw_thread[1], 100);
+	ut_balance_threads(cores_info, lw_thread, threads, 2);
+	CU_ASSERT(lw_thread[0]->load_avg == 50);
+	CU_ASSERT(lw_thread[1]->load_avg == 50);
+	CU_ASSERT(lw_thread[0]->lcore == 0);
+	CU_ASSERT(lw_thread[1]->lcore == 0);
+
+	/* Both threads are busy now, but only one migration fits into the budget */
+	ut_set_thread_load(lw_thread[0], 100);
+	ut_set_thread_load(lw_thread[1], 100);
+	ut_balance_threads(cores_info, lw_thread, threads, 2);
+	CU_ASSERT(lw_thread[0]->load_avg == 75);
+	CU_ASSERT(lw_thread[1]->load_avg == 75);
+	CU_ASSERT(lw_thread[0]->lcore == 1);
+	CU_ASSERT(lw_thread[1]->lcore == 0);
+	CU_ASSERT(g_placement_stats.moves == 1);
+	CU_ASSERT(g_placement_stats.deferred_moves == 1);
+
+	/* The first thread calms down, but stays above the lower threshold. The second
+	 * thread gets the budget of this period. */
+	ut_set_thread_load(lw_thread[0], 40);
+	ut_set_thread_load(lw_thread[1], 100);
+	ut_balance_threads(cores_info, lw_thread, threads, 2);
+	CU_ASSERT(lw_thread[0]->load_avg == 58);
+	CU_ASSERT(lw_thread[0]->lcore == 1);
+	CU_ASSERT(lw_thread[1]->lcore == 2);
+	CU_ASSERT(g_placement_stats.moves == 2);
+
+	/* Once the average drops below load_limit - load_hysteresis the thread returns */
+	ut_set_thread_load(lw_thread[0], 0);
+	ut_set_thread_load(lw_thread[1], 100);
+	ut_balance_threads(cores_info, lw_thread, threads, 2);
+	CU_ASSERT(lw_thread[0]->load_avg == 29);
+	CU_ASSERT(lw_thread[0]->lcore == 0);
+	CU_ASSERT(lw_thread[1]->lcore == 2);
+	CU_ASSERT(g_placement_stats.moves == 3);
+	CU_ASSERT(g_placement_stats.deferred_moves == 1);
+
+	/* The options are kept when the scheduler is switched */
+	_spdk_scheduler_set("static");
+	_spdk_scheduler_set("dynamic");
+	CU_ASSERT(g_opts.load_hysteresis == 20);
+	CU_ASSERT(g_opts.load_weight == 50);
+	CU_ASSERT(ut_scheduler_set_opts("{\"load_hysteresis\": 0, \"load_weight\": 100, "
+					"\"max_migrations\": 0}") == 0);
+
+	/* Destroy threads */
+	for (i = 0; i < 2; i++) {
+		lw_thread[i]->lcore = 0;
+	}
+	g_reactor_state = SPDK_REACTOR_STATE_INITIALIZED;
+	reactor_run(reactor);
+
+	spdk_set_thread(NULL);
+
+	MOCK_CLEAR(spdk_env_get_current_core);
+
+	spdk_reactors_fini();
+
+	free_cores();
+}
+
 int
 main(int argc, char **argv)
 {
@@ -873,6 +1140,8 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_reactor_stats);
 	CU_ADD_TEST(suite, test_scheduler);
 	CU_ADD_TEST(suite, test_governor);
+	CU_ADD_TEST(suite, test_scheduler_topology);
+	CU_ADD_TEST(suite, test_scheduler_load_model);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
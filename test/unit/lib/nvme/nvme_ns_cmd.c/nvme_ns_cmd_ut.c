@@ -680,6 +680,57 @@ test_nvme_ns_cmd_dataset_management(void)
 	cleanup_after_test(&qpair);
 }
 
+static void
+test_nvme_ns_cmd_copy(void)
+{
+	struct spdk_nvme_ns	ns;
+	struct spdk_nvme_ctrlr	ctrlr;
+	struct spdk_nvme_qpair	qpair;
+	spdk_nvme_cmd_cb	cb_fn = NULL;
+	void			*cb_arg = NULL;
+	struct spdk_nvme_scc_source_range	ranges[256] = {};
+	uint16_t			i;
+	int			rc = 0;
+
+	prepare_for_test(&ns, &ctrlr, &qpair, 512, 0, 128 * 1024, 0, false);
+
+	for (i = 0; i < 256; i++) {
+		ranges[i].slba = i;
+		ranges[i].nlb = 0;
+	}
+
+	/* Copy one LBA */
+	rc = spdk_nvme_ns_cmd_copy(&ns, &qpair, ranges, 1, 0x1000, cb_fn, cb_arg);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request != NULL);
+	CU_ASSERT(g_request->cmd.opc == SPDK_NVME_OPC_COPY);
+	CU_ASSERT(g_request->cmd.nsid == ns.id);
+	CU_ASSERT(g_request->cmd.cdw10 == 0x1000);
+	CU_ASSERT(g_request->cmd.cdw11 == 0);
+	CU_ASSERT(g_request->cmd.cdw12 == 0);
+	CU_ASSERT(g_request->payload_size == sizeof(struct spdk_nvme_scc_source_range));
+	spdk_free(g_request->payload.contig_or_cb_arg);
+	nvme_free_request(g_request);
+
+	/* Copy 256 ranges */
+	rc = spdk_nvme_ns_cmd_copy(&ns, &qpair, ranges, 256, 0x100000000ULL, cb_fn, cb_arg);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	SPDK_CU_ASSERT_FATAL(g_request != NULL);
+	CU_ASSERT(g_request->cmd.opc == SPDK_NVME_OPC_COPY);
+	CU_ASSERT(g_request->cmd.cdw10 == 0);
+	CU_ASSERT(g_request->cmd.cdw11 == 1);
+	CU_ASSERT(g_request->cmd.cdw12 == 255u);
+	CU_ASSERT(g_request->payload_size == 256 * sizeof(struct spdk_nvme_scc_source_range));
+	spdk_free(g_request->payload.contig_or_cb_arg);
+	nvme_free_request(g_request);
+
+	rc = spdk_nvme_ns_cmd_copy(&ns, &qpair, ranges, 0, 0, cb_fn, cb_arg);
+	CU_ASSERT(rc == -EINVAL);
+	rc = spdk_nvme_ns_cmd_copy(&ns, &qpair, NULL, 1, 0, cb_fn, cb_arg);
+	CU_ASSERT(rc == -EINVAL);
+	cleanup_after_test(&qpair);
+}
+
 static void
 test_nvme_ns_cmd_readv(void)
 {
@@ -1914,6 +1965,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, split_test4);
 	CU_ADD_TEST(suite, test_nvme_ns_cmd_flush);
 	CU_ADD_TEST(suite, test_nvme_ns_cmd_dataset_management);
+	CU_ADD_TEST(suite, test_nvme_ns_cmd_copy);
 	CU_ADD_TEST(suite, test_io_flags);
 	CU_ADD_TEST(suite, test_nvme_ns_cmd_write_zeroes);
 	CU_ADD_TEST(suite, test_nvme_ns_cmd_write_uncorrectable);
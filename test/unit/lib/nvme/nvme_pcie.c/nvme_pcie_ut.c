@@ -70,12 +70,39 @@ DEFINE_STUB_V(spdk_pci_device_detach, (struct spdk_pci_device *device));
 DEFINE_STUB(spdk_pci_device_allow, int, (struct spdk_pci_addr *pci_addr), 0);
 DEFINE_STUB(spdk_pci_device_cfg_write16, int, (struct spdk_pci_device *dev, uint16_t value,
 		uint32_t offset), 0);
-DEFINE_STUB(spdk_pci_device_cfg_read16, int, (struct spdk_pci_device *dev, uint16_t *value,
-		uint32_t offset), 0);
 DEFINE_STUB(spdk_pci_device_get_id, struct spdk_pci_id, (struct spdk_pci_device *dev), {0})
+DEFINE_STUB(spdk_pci_device_disable_interrupts, int, (struct spdk_pci_device *dev), 0);
+DEFINE_STUB(spdk_pci_device_get_interrupt_efd_by_index, int, (struct spdk_pci_device *dev,
+		uint32_t index), 0);
 
 DEFINE_STUB(nvme_uevent_connect, int, (void), 0);
 
+static uint8_t g_pci_cfg[256];
+static uint32_t g_pci_efd_count;
+
+int
+spdk_pci_device_cfg_read8(struct spdk_pci_device *dev, uint8_t *value, uint32_t offset)
+{
+	SPDK_CU_ASSERT_FATAL(offset < sizeof(g_pci_cfg));
+	*value = g_pci_cfg[offset];
+	return 0;
+}
+
+int
+spdk_pci_device_cfg_read16(struct spdk_pci_device *dev, uint16_t *value, uint32_t offset)
+{
+	SPDK_CU_ASSERT_FATAL(offset + sizeof(*value) <= sizeof(g_pci_cfg));
+	memcpy(value, &g_pci_cfg[offset], sizeof(*value));
+	return 0;
+}
+
+int
+spdk_pci_device_enable_interrupts(struct spdk_pci_device *dev, uint32_t efd_count)
+{
+	g_pci_efd_count = efd_count;
+	return 0;
+}
+
 SPDK_LOG_REGISTER_COMPONENT(nvme)
 
 struct nvme_driver *g_spdk_nvme_driver = NULL;
@@ -477,6 +504,126 @@ test_build_contig_hw_sgl_request(void)
 	memset(&tr, 0, sizeof(tr));
 }
 
+static void
+test_nvme_pcie_qpair_submit_batch(void)
+{
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct spdk_nvme_cmd cmd[8] __attribute__((aligned(64))) = {};
+	struct nvme_request req = {};
+	struct nvme_tracker tr = {};
+	uint32_t sq_tdbl = 0;
+
+	pqpair.qpair.ctrlr = &pctrlr.ctrlr;
+	pqpair.cmd = cmd;
+	pqpair.num_entries = SPDK_COUNTOF(cmd);
+	pqpair.sq_tdbl = &sq_tdbl;
+	req.cmd.opc = SPDK_NVME_OPC_READ;
+	tr.req = &req;
+
+	/* Without a batch the doorbell is rung for every command */
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 1);
+
+	/* Within a batch the doorbell is only rung when the batch is flushed */
+	pqpair.qpair.submit_batch = 1;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(pqpair.sq_tail == 3);
+	CU_ASSERT(sq_tdbl == 1);
+
+	pqpair.qpair.submit_batch = 0;
+	nvme_pcie_qpair_flush_submissions(&pqpair.qpair);
+	CU_ASSERT(sq_tdbl == 3);
+
+	/* Nothing is left to submit, so the doorbell isn't written again */
+	sq_tdbl = 0;
+	nvme_pcie_qpair_flush_submissions(&pqpair.qpair);
+	CU_ASSERT(sq_tdbl == 0);
+
+	/* Fused cmds within a batch are submitted together when it's flushed */
+	pqpair.qpair.submit_batch = 1;
+	req.cmd.fuse = SPDK_NVME_IO_FLAGS_FUSE_FIRST;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	req.cmd.fuse = SPDK_NVME_IO_FLAGS_FUSE_SECOND;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 0);
+
+	pqpair.qpair.submit_batch = 0;
+	nvme_pcie_qpair_flush_submissions(&pqpair.qpair);
+	CU_ASSERT(sq_tdbl == 5);
+	CU_ASSERT(pqpair.qpair.first_fused_submitted == 0);
+
+	/* Without a batch the doorbell is rung once the second fused cmd is queued */
+	req.cmd.fuse = SPDK_NVME_IO_FLAGS_FUSE_FIRST;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 5);
+	req.cmd.fuse = SPDK_NVME_IO_FLAGS_FUSE_SECOND;
+	nvme_pcie_qpair_submit_tracker(&pqpair.qpair, &tr);
+	CU_ASSERT(sq_tdbl == 7);
+}
+
+static void
+test_nvme_pcie_ctrlr_enable_interrupts(void)
+{
+	struct nvme_pcie_ctrlr pctrlr = {};
+	struct nvme_pcie_qpair padminq = {};
+	struct nvme_pcie_qpair pqpair = {};
+	struct nvme_request req = {};
+	int rc;
+
+	pctrlr.ctrlr.opts.num_io_queues = 16;
+
+	/* No capability list, so no MSI-X */
+	memset(g_pci_cfg, 0, sizeof(g_pci_cfg));
+	rc = nvme_pcie_ctrlr_enable_interrupts(&pctrlr.ctrlr, 1);
+	CU_ASSERT(rc == -ENOTSUP);
+	CU_ASSERT(pctrlr.num_io_intr_vectors == 0);
+
+	/* An MSI capability followed by an 8 vector MSI-X capability */
+	g_pci_cfg[NVME_PCIE_CFG_STATUS] = NVME_PCIE_CFG_STATUS_CAP_LIST;
+	g_pci_cfg[NVME_PCIE_CFG_CAP_PTR] = 0x40;
+	g_pci_cfg[0x40] = 0x05;
+	g_pci_cfg[0x41] = 0x50;
+	g_pci_cfg[0x50] = NVME_PCIE_CAP_ID_MSIX;
+	g_pci_cfg[0x51] = 0;
+	g_pci_cfg[0x52] = 7;
+
+	/* Vector 0 is kept for the admin queue */
+	rc = nvme_pcie_ctrlr_enable_interrupts(&pctrlr.ctrlr, 1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(pctrlr.num_io_intr_vectors == 7);
+	CU_ASSERT(g_pci_efd_count == 7);
+
+	/* Queues beyond the enabled vectors can't use interrupts */
+	g_pci_efd_count = 0;
+	CU_ASSERT(nvme_pcie_ctrlr_enable_interrupts(&pctrlr.ctrlr, 7) == 0);
+	CU_ASSERT(nvme_pcie_ctrlr_enable_interrupts(&pctrlr.ctrlr, 8) == -ENOSPC);
+	CU_ASSERT(g_pci_efd_count == 0);
+
+	/* The number of vectors is bounded by the number of I/O queues */
+	pctrlr.num_io_intr_vectors = 0;
+	pctrlr.ctrlr.opts.num_io_queues = 2;
+	rc = nvme_pcie_ctrlr_enable_interrupts(&pctrlr.ctrlr, 1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(pctrlr.num_io_intr_vectors == 2);
+	CU_ASSERT(g_pci_efd_count == 2);
+
+	/* The completion queue is created with interrupts on vector qid */
+	pctrlr.ctrlr.adminq = &padminq.qpair;
+	STAILQ_INIT(&padminq.qpair.free_req);
+	STAILQ_INSERT_HEAD(&padminq.qpair.free_req, &req, stailq);
+	pqpair.qpair.id = 2;
+	pqpair.num_entries = 32;
+	pqpair.flags.enable_interrupts = 1;
+	rc = nvme_pcie_ctrlr_cmd_create_io_cq(&pctrlr.ctrlr, &pqpair.qpair, NULL, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req.cmd.opc == SPDK_NVME_OPC_CREATE_IO_CQ);
+	CU_ASSERT(req.cmd.cdw11_bits.create_io_cq.pc == 1);
+	CU_ASSERT(req.cmd.cdw11_bits.create_io_cq.ien == 1);
+	CU_ASSERT(req.cmd.cdw11_bits.create_io_cq.iv == 2);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -490,6 +637,8 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_hotplug_monitor);
 	CU_ADD_TEST(suite, test_shadow_doorbell_update);
 	CU_ADD_TEST(suite, test_build_contig_hw_sgl_request);
+	CU_ADD_TEST(suite, test_nvme_pcie_qpair_submit_batch);
+	CU_ADD_TEST(suite, test_nvme_pcie_ctrlr_enable_interrupts);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
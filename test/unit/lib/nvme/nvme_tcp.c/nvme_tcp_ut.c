@@ -890,6 +890,51 @@ test_nvme_tcp_parse_addr(void)
 	CU_ASSERT(dst_addr.ss_family == AF_INET);
 }
 
+static void
+test_nvme_tcp_pdu_update_data_digest(void)
+{
+	struct nvme_tcp_pdu pdu = {};
+	uint8_t buf[1001];
+	uint32_t crc32c, offset, len, i;
+
+	for (i = 0; i < sizeof(buf); i++) {
+		buf[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	/* The payload is spread over several buffers and isn't digest aligned */
+	pdu.data_iov[0].iov_base = buf;
+	pdu.data_iov[0].iov_len = 100;
+	pdu.data_iov[1].iov_base = buf + 100;
+	pdu.data_iov[1].iov_len = 1;
+	pdu.data_iov[2].iov_base = buf + 101;
+	pdu.data_iov[2].iov_len = 900;
+	pdu.data_iovcnt = 3;
+	pdu.data_len = sizeof(buf);
+
+	crc32c = nvme_tcp_pdu_calc_data_digest(&pdu);
+
+	/* Receive the payload followed by its digest in uneven chunks */
+	offset = 0;
+	len = 7;
+	while (offset < pdu.data_len + SPDK_NVME_TCP_DIGEST_LEN) {
+		len = spdk_min(len, pdu.data_len + SPDK_NVME_TCP_DIGEST_LEN - offset);
+		nvme_tcp_pdu_update_data_digest(&pdu, offset, len);
+		offset += len;
+		len = len * 3 + 1;
+	}
+	CU_ASSERT(nvme_tcp_pdu_get_data_digest(&pdu) == crc32c);
+
+	/* Receiving the payload again restarts the digest */
+	nvme_tcp_pdu_update_data_digest(&pdu, 0, 0);
+	nvme_tcp_pdu_update_data_digest(&pdu, 0, pdu.data_len);
+	CU_ASSERT(nvme_tcp_pdu_get_data_digest(&pdu) == crc32c);
+
+	/* A single byte changes the digest */
+	buf[500] ^= 1;
+	nvme_tcp_pdu_update_data_digest(&pdu, 0, pdu.data_len);
+	CU_ASSERT(nvme_tcp_pdu_get_data_digest(&pdu) != crc32c);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -912,6 +957,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_tcp_qpair_set_recv_state);
 	CU_ADD_TEST(suite, test_nvme_tcp_alloc_reqs);
 	CU_ADD_TEST(suite, test_nvme_tcp_parse_addr);
+	CU_ADD_TEST(suite, test_nvme_tcp_pdu_update_data_digest);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
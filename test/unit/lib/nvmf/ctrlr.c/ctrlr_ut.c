@@ -94,6 +94,11 @@ DEFINE_STUB(nvmf_ctrlr_write_zeroes_supported,
 	    (struct spdk_nvmf_ctrlr *ctrlr),
 	    false);
 
+DEFINE_STUB(nvmf_ctrlr_copy_supported,
+	    bool,
+	    (struct spdk_nvmf_ctrlr *ctrlr),
+	    false);
+
 DEFINE_STUB_V(nvmf_get_discovery_log_page,
 	      (struct spdk_nvmf_tgt *tgt, const char *hostnqn, struct iovec *iov,
 	       uint32_t iovcnt, uint64_t offset, uint32_t length));
@@ -126,6 +131,14 @@ DEFINE_STUB(nvmf_bdev_ctrlr_write_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_zcopy_start,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB_V(nvmf_bdev_ctrlr_zcopy_end, (struct spdk_nvmf_request *req, bool commit));
+
 DEFINE_STUB(nvmf_bdev_ctrlr_compare_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -156,12 +169,21 @@ DEFINE_STUB(nvmf_bdev_ctrlr_dsm_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_copy_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
 DEFINE_STUB(nvmf_bdev_ctrlr_nvme_passthru_io,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(spdk_bdev_io_type_supported, bool,
+	    (struct spdk_bdev *bdev, enum spdk_bdev_io_type io_type), false);
+
 DEFINE_STUB(nvmf_transport_req_complete,
 	    int,
 	    (struct spdk_nvmf_request *req),
@@ -1998,6 +2020,115 @@ test_rae(void)
 	cleanup_pending_async_events(&ctrlr);
 }
 
+static void
+test_zcopy_read(void)
+{
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	struct spdk_nvmf_subsystem_listener listener = {};
+	struct spdk_bdev bdev = {};
+
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+
+	ns.bdev = &bdev;
+
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+
+	listener.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	/* Enable controller */
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = (struct spdk_nvmf_subsystem *)&subsystem;
+	ctrlr.listener = &listener;
+
+	group.thread = spdk_get_thread();
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	group.sgroups = &sgroups;
+	TAILQ_INIT(&qpair.outstanding);
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+
+	cmd.nsid = 1;
+	cmd.opc = SPDK_NVME_OPC_READ;
+
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+
+	/* The bdev doesn't support zcopy */
+	MOCK_SET(spdk_bdev_io_type_supported, false);
+	CU_ASSERT(nvmf_ctrlr_use_zcopy(&req) == false);
+
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+	CU_ASSERT(nvmf_ctrlr_use_zcopy(&req) == true);
+
+	/* Only reads and writes on I/O queues use zcopy */
+	cmd.opc = SPDK_NVME_OPC_FLUSH;
+	CU_ASSERT(nvmf_ctrlr_use_zcopy(&req) == false);
+	cmd.opc = SPDK_NVME_OPC_READ;
+
+	qpair.qid = 0;
+	CU_ASSERT(nvmf_ctrlr_use_zcopy(&req) == false);
+	qpair.qid = 1;
+
+	cmd.fuse = SPDK_NVME_CMD_FUSE_FIRST;
+	CU_ASSERT(nvmf_ctrlr_use_zcopy(&req) == false);
+	cmd.fuse = SPDK_NVME_CMD_FUSE_NONE;
+
+	/* Request the buffers. The request is outstanding until they are released. */
+	MOCK_SET(nvmf_bdev_ctrlr_zcopy_start, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	spdk_nvmf_request_zcopy_start(&req);
+	CU_ASSERT(TAILQ_FIRST(&qpair.outstanding) == &req);
+	CU_ASSERT(ns_info.io_outstanding == 1);
+
+	/* The bdev provided the buffers */
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+	spdk_nvmf_request_complete(&req);
+	CU_ASSERT(TAILQ_FIRST(&qpair.outstanding) == &req);
+	CU_ASSERT(ns_info.io_outstanding == 1);
+
+	/* Executing the read completes it without touching the bdev again */
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE);
+	CU_ASSERT(TAILQ_FIRST(&qpair.outstanding) == &req);
+	CU_ASSERT(ns_info.io_outstanding == 1);
+
+	/* Release the buffers once the data was sent */
+	spdk_nvmf_request_zcopy_end(&req, false);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING);
+
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_COMPLETE;
+	spdk_nvmf_request_complete(&req);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_zcopy_start);
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -2026,6 +2157,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_get_ana_log_page);
 	CU_ADD_TEST(suite, test_multi_async_events);
 	CU_ADD_TEST(suite, test_rae);
+	CU_ADD_TEST(suite, test_zcopy_read);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -42,7 +42,14 @@
 
 SPDK_LOG_REGISTER_COMPONENT(nvmf)
 
-DEFINE_STUB(spdk_nvmf_request_complete, int, (struct spdk_nvmf_request *req), -1);
+static uint32_t g_num_request_complete;
+
+int
+spdk_nvmf_request_complete(struct spdk_nvmf_request *req)
+{
+	g_num_request_complete++;
+	return 0;
+}
 
 DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), "test");
 
@@ -136,6 +143,92 @@ DEFINE_STUB(spdk_bdev_unmap_blocks, int,
 	     spdk_bdev_io_completion_cb cb, void *cb_arg),
 	    0);
 
+#define UT_MAX_COPY_CALLS 4
+
+static struct {
+	uint64_t dst_offset_blocks;
+	uint64_t src_offset_blocks;
+	uint64_t num_blocks;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+} g_copy_calls[UT_MAX_COPY_CALLS];
+static uint32_t g_num_copy_calls;
+
+int
+spdk_bdev_copy_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      uint64_t dst_offset_blocks, uint64_t src_offset_blocks,
+		      uint64_t num_blocks, spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	SPDK_CU_ASSERT_FATAL(g_num_copy_calls < UT_MAX_COPY_CALLS);
+
+	g_copy_calls[g_num_copy_calls].dst_offset_blocks = dst_offset_blocks;
+	g_copy_calls[g_num_copy_calls].src_offset_blocks = src_offset_blocks;
+	g_copy_calls[g_num_copy_calls].num_blocks = num_blocks;
+	g_copy_calls[g_num_copy_calls].cb = cb;
+	g_copy_calls[g_num_copy_calls].cb_arg = cb_arg;
+	g_num_copy_calls++;
+
+	return 0;
+}
+
+static struct {
+	uint64_t offset_blocks;
+	uint64_t num_blocks;
+	bool populate;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+} g_zcopy_start_call;
+static int g_zcopy_start_rc;
+
+int
+spdk_bdev_zcopy_start(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+		      uint64_t offset_blocks, uint64_t num_blocks, bool populate,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	if (g_zcopy_start_rc != 0) {
+		return g_zcopy_start_rc;
+	}
+
+	g_zcopy_start_call.offset_blocks = offset_blocks;
+	g_zcopy_start_call.num_blocks = num_blocks;
+	g_zcopy_start_call.populate = populate;
+	g_zcopy_start_call.cb = cb;
+	g_zcopy_start_call.cb_arg = cb_arg;
+
+	return 0;
+}
+
+static struct {
+	struct spdk_bdev_io *bdev_io;
+	bool commit;
+	spdk_bdev_io_completion_cb cb;
+	void *cb_arg;
+} g_zcopy_end_call;
+static uint32_t g_num_zcopy_end_calls;
+
+int
+spdk_bdev_zcopy_end(struct spdk_bdev_io *bdev_io, bool commit,
+		    spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	g_zcopy_end_call.bdev_io = bdev_io;
+	g_zcopy_end_call.commit = commit;
+	g_zcopy_end_call.cb = cb;
+	g_zcopy_end_call.cb_arg = cb_arg;
+	g_num_zcopy_end_calls++;
+
+	return 0;
+}
+
+static struct iovec g_zcopy_iovs[NVMF_REQ_MAX_BUFFERS + 1];
+static int g_zcopy_iovcnt;
+
+void
+spdk_bdev_io_get_iovec(struct spdk_bdev_io *bdev_io, struct iovec **iovp, int *iovcntp)
+{
+	*iovp = g_zcopy_iovs;
+	*iovcntp = g_zcopy_iovcnt;
+}
+
 DEFINE_STUB(spdk_bdev_io_type_supported, bool,
 	    (struct spdk_bdev *bdev, enum spdk_bdev_io_type io_type), false);
 
@@ -206,8 +299,14 @@ spdk_nvmf_subsystem_get_next_ns(struct spdk_nvmf_subsystem *subsystem, struct sp
 	return NULL;
 }
 
-DEFINE_STUB_V(spdk_bdev_io_get_nvme_status,
-	      (const struct spdk_bdev_io *bdev_io, uint32_t *cdw0, int *sct, int *sc));
+void
+spdk_bdev_io_get_nvme_status(const struct spdk_bdev_io *bdev_io, uint32_t *cdw0, int *sct,
+			     int *sc)
+{
+	*cdw0 = 0;
+	*sct = SPDK_NVME_SCT_GENERIC;
+	*sc = SPDK_NVME_SC_SUCCESS;
+}
 
 int
 spdk_dif_ctx_init(struct spdk_dif_ctx *ctx, uint32_t block_size, uint32_t md_size,
@@ -412,6 +511,284 @@ test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(void)
 	CU_ASSERT(write_rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
 }
 
+static void
+test_nvmf_bdev_ctrlr_copy_cmd(void)
+{
+	int rc;
+	uint32_t i;
+	struct spdk_bdev bdev = {};
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel ch = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvme_cmd cmd = {};
+	struct spdk_nvme_scc_source_range ranges[2] = {};
+
+	bdev.blocklen = 512;
+	bdev.num_blocks = 100;
+
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+	req.data = ranges;
+	req.length = sizeof(ranges);
+
+	cmd.opc = SPDK_NVME_OPC_COPY;
+	cmd.cdw10 = 50;		/* SDLBA: CDW10 and CDW11 */
+	cmd.cdw12 = 1;		/* NR: CDW12 bits 07:00, 0's based */
+	ranges[0].slba = 0;
+	ranges[0].nlb = 9;	/* 0's based */
+	ranges[1].slba = 20;
+	ranges[1].nlb = 4;	/* 0's based */
+
+	/* 1. SUCCESS - each range is copied to consecutive destination blocks */
+	g_num_copy_calls = 0;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(g_num_copy_calls == 2);
+	CU_ASSERT(g_copy_calls[0].dst_offset_blocks == 50);
+	CU_ASSERT(g_copy_calls[0].src_offset_blocks == 0);
+	CU_ASSERT(g_copy_calls[0].num_blocks == 10);
+	CU_ASSERT(g_copy_calls[1].dst_offset_blocks == 60);
+	CU_ASSERT(g_copy_calls[1].src_offset_blocks == 20);
+	CU_ASSERT(g_copy_calls[1].num_blocks == 5);
+	for (i = 0; i < g_num_copy_calls; i++) {
+		g_copy_calls[i].cb(NULL, true, g_copy_calls[i].cb_arg);
+	}
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+
+	/* 2. SPDK_NVME_SC_LBA_OUT_OF_RANGE - source range past the end of the bdev */
+	g_num_copy_calls = 0;
+	ranges[1].slba = 98;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+	CU_ASSERT(g_num_copy_calls == 0);
+	ranges[1].slba = 20;
+
+	/* 3. SPDK_NVME_SC_LBA_OUT_OF_RANGE - destination past the end of the bdev */
+	cmd.cdw10 = 90;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+	CU_ASSERT(g_num_copy_calls == 0);
+	cmd.cdw10 = 50;
+
+	/* 4. SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID */
+	req.length = sizeof(ranges[0]);
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+	CU_ASSERT(g_num_copy_calls == 0);
+	req.length = sizeof(ranges);
+
+	/* 5. SPDK_NVME_SC_INVALID_FIELD - unsupported descriptor format */
+	cmd.cdw12 = 1 | (1 << 8);
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+	CU_ASSERT(g_num_copy_calls == 0);
+	cmd.cdw12 = 1;
+
+	/* 6. SPDK_NVME_SC_INVALID_FIELD - the second source range overlaps the blocks the
+	 * first one is copied to, nothing is copied */
+	ranges[1].slba = 55;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+	CU_ASSERT(g_num_copy_calls == 0);
+
+	/* 7. SPDK_NVME_SC_INVALID_FIELD - the second source range overlaps its own destination */
+	ranges[1].slba = 62;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+	CU_ASSERT(g_num_copy_calls == 0);
+
+	/* 8. SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED - a source range longer than MSSRL */
+	bdev.num_blocks = 0x20000;
+	ranges[1].slba = 0x10000;
+	ranges[1].nlb = 0xFFFF;	/* 65536 blocks */
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_COMMAND_SPECIFIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_CMD_SIZE_LIMIT_EXCEEDED);
+	CU_ASSERT(g_num_copy_calls == 0);
+	bdev.num_blocks = 100;
+	ranges[1].nlb = 4;
+
+	/* A source range right after the destination doesn't overlap it */
+	ranges[1].slba = 65;
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(g_num_copy_calls == 2);
+	for (i = 0; i < g_num_copy_calls; i++) {
+		g_copy_calls[i].cb(NULL, true, g_copy_calls[i].cb_arg);
+	}
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+}
+
+static void
+test_nvmf_bdev_ctrlr_zcopy(void)
+{
+	int rc, i;
+	struct spdk_bdev bdev = {};
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel ch = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvme_cmd cmd = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_bdev_io *bdev_io = (struct spdk_bdev_io *)0xDEADBEEF;
+
+	bdev.blocklen = 512;
+	bdev.num_blocks = 100;
+
+	qpair.group = &group;
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+	req.length = 4096;
+
+	cmd.opc = SPDK_NVME_OPC_READ;
+	cmd.cdw10 = 10;		/* SLBA: CDW10 and CDW11 */
+	cmd.cdw12 = 7;		/* NLB: CDW12 bits 15:00, 0's based */
+
+	for (i = 0; i < NVMF_REQ_MAX_BUFFERS + 1; i++) {
+		g_zcopy_iovs[i].iov_base = (void *)(uintptr_t)(0x10000 + i * 0x1000);
+		g_zcopy_iovs[i].iov_len = 512;
+	}
+
+	/* 1. SUCCESS - a read gets populated buffers from the bdev */
+	g_num_request_complete = 0;
+	g_zcopy_iovcnt = 2;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(g_zcopy_start_call.offset_blocks == 10);
+	CU_ASSERT(g_zcopy_start_call.num_blocks == 8);
+	CU_ASSERT(g_zcopy_start_call.populate == true);
+	CU_ASSERT(g_num_request_complete == 0);
+
+	g_zcopy_start_call.cb(bdev_io, true, g_zcopy_start_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE);
+	CU_ASSERT(req.zcopy_bdev_io == bdev_io);
+	CU_ASSERT(req.iovcnt == 2);
+	CU_ASSERT(req.iov[0].iov_base == g_zcopy_iovs[0].iov_base);
+	CU_ASSERT(req.iov[1].iov_base == g_zcopy_iovs[1].iov_base);
+	CU_ASSERT(req.data == g_zcopy_iovs[0].iov_base);
+	CU_ASSERT(g_num_request_complete == 1);
+
+	/* Releasing the buffers completes the request with the status of the bdev_io */
+	g_num_zcopy_end_calls = 0;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_END_PENDING;
+	rsp.nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	nvmf_bdev_ctrlr_zcopy_end(&req, false);
+	CU_ASSERT(g_num_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_call.bdev_io == bdev_io);
+	CU_ASSERT(g_zcopy_end_call.commit == false);
+	CU_ASSERT(g_num_request_complete == 1);
+
+	g_zcopy_end_call.cb(bdev_io, true, g_zcopy_end_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_COMPLETE);
+	CU_ASSERT(req.zcopy_bdev_io == NULL);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(g_num_request_complete == 2);
+
+	/* 2. SUCCESS - a write doesn't need the buffers populated and commits them */
+	cmd.opc = SPDK_NVME_OPC_WRITE;
+	g_num_request_complete = 0;
+	g_num_zcopy_end_calls = 0;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(g_zcopy_start_call.populate == false);
+	g_zcopy_start_call.cb(bdev_io, true, g_zcopy_start_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE);
+
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_END_PENDING;
+	nvmf_bdev_ctrlr_zcopy_end(&req, true);
+	CU_ASSERT(g_num_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_call.commit == true);
+	g_zcopy_end_call.cb(bdev_io, true, g_zcopy_end_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_COMPLETE);
+	CU_ASSERT(g_num_request_complete == 2);
+
+	/* 3. FAILURE - the bdev fails to get the buffers */
+	g_num_request_complete = 0;
+	g_num_zcopy_end_calls = 0;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	req.zcopy_bdev_io = NULL;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	g_zcopy_start_call.cb(bdev_io, false, g_zcopy_start_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT_FAILED);
+	CU_ASSERT(req.zcopy_bdev_io == NULL);
+	CU_ASSERT(g_num_zcopy_end_calls == 0);
+	CU_ASSERT(g_num_request_complete == 1);
+
+	/* 4. SPDK_NVME_SC_INTERNAL_DEVICE_ERROR - the buffers need more iovecs than the
+	 * request can hold, so they are released right away */
+	g_num_request_complete = 0;
+	g_zcopy_iovcnt = NVMF_REQ_MAX_BUFFERS + 1;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	req.iovcnt = 0;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	g_zcopy_start_call.cb(bdev_io, true, g_zcopy_start_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT_FAILED);
+	CU_ASSERT(req.iovcnt == 0);
+	CU_ASSERT(g_num_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_call.bdev_io == bdev_io);
+	CU_ASSERT(g_zcopy_end_call.commit == false);
+	CU_ASSERT(g_num_request_complete == 0);
+
+	/* The request completes with the error once the buffers are released */
+	g_zcopy_end_call.cb(bdev_io, true, g_zcopy_end_call.cb_arg);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT_FAILED);
+	CU_ASSERT(req.zcopy_bdev_io == NULL);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+	CU_ASSERT(g_num_request_complete == 1);
+	g_zcopy_iovcnt = 2;
+
+	/* 5. ENOMEM - the request is queued and resubmitted once a bdev_io is available */
+	memset(&req.bdev_io_wait, 0, sizeof(req.bdev_io_wait));
+	g_zcopy_start_rc = -ENOMEM;
+	req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(req.bdev_io_wait.bdev == &bdev);
+	CU_ASSERT(req.bdev_io_wait.cb_fn == nvmf_ctrlr_process_io_cmd_resubmit);
+	CU_ASSERT(req.bdev_io_wait.cb_arg == &req);
+	CU_ASSERT(req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
+	CU_ASSERT(group.stat.pending_bdev_io == 1);
+
+	/* 6. SPDK_NVME_SC_INTERNAL_DEVICE_ERROR - any other error fails the request */
+	g_zcopy_start_rc = -EINVAL;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+	g_zcopy_start_rc = 0;
+
+	/* 7. SPDK_NVME_SC_LBA_OUT_OF_RANGE */
+	cmd.cdw10 = 95;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+	cmd.cdw10 = 10;
+
+	/* 8. SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID */
+	req.length = 2048;
+	rc = nvmf_bdev_ctrlr_zcopy_start(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -427,6 +804,8 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_get_dif_ctx);
 
 	CU_ADD_TEST(suite, test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd);
+	CU_ADD_TEST(suite, test_nvmf_bdev_ctrlr_copy_cmd);
+	CU_ADD_TEST(suite, test_nvmf_bdev_ctrlr_zcopy);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -0,0 +1,179 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+#include "spdk_internal/mock.h"
+
+#include "common/lib/ut_multithread.c"
+#include "nvmf/nvmf.c"
+
+DEFINE_STUB_V(nvmf_ctrlr_destruct, (struct spdk_nvmf_ctrlr *ctrlr));
+DEFINE_STUB_V(nvmf_qpair_free_aer, (struct spdk_nvmf_qpair *qpair));
+DEFINE_STUB(nvmf_transport_get_optimal_poll_group, struct spdk_nvmf_transport_poll_group *,
+	    (struct spdk_nvmf_transport *transport, struct spdk_nvmf_qpair *qpair), NULL);
+DEFINE_STUB(nvmf_transport_poll_group_add, int, (struct spdk_nvmf_transport_poll_group *group,
+		struct spdk_nvmf_qpair *qpair), 0);
+DEFINE_STUB(nvmf_transport_poll_group_remove, int, (struct spdk_nvmf_transport_poll_group *group,
+		struct spdk_nvmf_qpair *qpair), 0);
+DEFINE_STUB(nvmf_transport_req_free, int, (struct spdk_nvmf_request *req), 0);
+DEFINE_STUB_V(nvmf_transport_qpair_fini, (struct spdk_nvmf_qpair *qpair,
+		spdk_nvmf_transport_qpair_fini_cb cb_fn, void *cb_arg));
+DEFINE_STUB_V(nvmf_transport_qpair_abort_zcopy, (struct spdk_nvmf_qpair *qpair));
+
+static void
+test_poll_group_less_loaded(void)
+{
+	struct spdk_nvmf_poll_group a = {}, b = {};
+
+	/* The busy percentage decides first, in steps */
+	a.busy_pct = 35;
+	b.busy_pct = 41;
+	a.outstanding_io = 100;
+	CU_ASSERT(nvmf_poll_group_less_loaded(&a, &b) == true);
+	CU_ASSERT(nvmf_poll_group_less_loaded(&b, &a) == false);
+
+	/* Within the same step the outstanding I/O decides */
+	b.busy_pct = 39;
+	CU_ASSERT(nvmf_poll_group_less_loaded(&a, &b) == false);
+	CU_ASSERT(nvmf_poll_group_less_loaded(&b, &a) == true);
+
+	/* Then the qpairs, including the ones not added yet */
+	b.outstanding_io = 100;
+	a.num_qpairs = 2;
+	b.num_qpairs = 1;
+	CU_ASSERT(nvmf_poll_group_less_loaded(&a, &b) == false);
+	b.pending_qpairs = 2;
+	CU_ASSERT(nvmf_poll_group_less_loaded(&a, &b) == true);
+
+	/* Equal load is not less */
+	a.num_qpairs = 3;
+	CU_ASSERT(nvmf_poll_group_less_loaded(&a, &b) == false);
+	CU_ASSERT(nvmf_poll_group_less_loaded(&b, &a) == false);
+}
+
+static void
+test_tgt_new_qpair_least_loaded(void)
+{
+	struct spdk_nvmf_tgt tgt = {};
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_transport_poll_group tgroup[3] = {};
+	struct spdk_nvmf_poll_group group[3] = {};
+	struct spdk_nvmf_qpair qpair[3] = {};
+	int i;
+
+	pthread_mutex_init(&tgt.mutex, NULL);
+	TAILQ_INIT(&tgt.poll_groups);
+	tgt.qpair_placement = SPDK_NVMF_TGT_QPAIR_PLACEMENT_LEAST_LOADED;
+
+	for (i = 0; i < 3; i++) {
+		group[i].thread = spdk_get_thread();
+		TAILQ_INIT(&group[i].tgroups);
+		TAILQ_INIT(&group[i].qpairs);
+		tgroup[i].transport = &transport;
+		TAILQ_INSERT_TAIL(&group[i].tgroups, &tgroup[i], link);
+		TAILQ_INSERT_TAIL(&tgt.poll_groups, &group[i], link);
+		qpair[i].transport = &transport;
+	}
+
+	CU_ASSERT(nvmf_tgt_get_least_loaded_poll_group(&tgt) == &group[0]);
+
+	/* The least busy group wins, whatever its position */
+	group[0].busy_pct = 60;
+	group[1].busy_pct = 20;
+	group[2].busy_pct = 25;
+	CU_ASSERT(nvmf_tgt_get_least_loaded_poll_group(&tgt) == &group[1]);
+
+	/* Qpairs assigned in the same poll are spread, as the pending ones count before
+	 * they are added.
+	 */
+	group[2].busy_pct = 20;
+	spdk_nvmf_tgt_new_qpair(&tgt, &qpair[0]);
+	CU_ASSERT(group[1].pending_qpairs == 1);
+	spdk_nvmf_tgt_new_qpair(&tgt, &qpair[1]);
+	CU_ASSERT(group[2].pending_qpairs == 1);
+	spdk_nvmf_tgt_new_qpair(&tgt, &qpair[2]);
+	CU_ASSERT(group[1].pending_qpairs == 2);
+	CU_ASSERT(group[0].pending_qpairs == 0);
+
+	/* Once added, the qpairs move from pending to the qpair count */
+	poll_threads();
+	CU_ASSERT(group[1].pending_qpairs == 0);
+	CU_ASSERT(group[1].num_qpairs == 2);
+	CU_ASSERT(group[2].pending_qpairs == 0);
+	CU_ASSERT(group[2].num_qpairs == 1);
+	CU_ASSERT(qpair[0].group == &group[1]);
+	CU_ASSERT(qpair[1].group == &group[2]);
+	CU_ASSERT(qpair[2].group == &group[1]);
+	CU_ASSERT(nvmf_tgt_get_least_loaded_poll_group(&tgt) == &group[2]);
+
+	pthread_mutex_destroy(&tgt.mutex);
+}
+
+static int
+test_setup(void)
+{
+	allocate_threads(1);
+	set_thread(0);
+
+	return 0;
+}
+
+static int
+test_cleanup(void)
+{
+	free_threads();
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvmf", test_setup, test_cleanup);
+
+	CU_ADD_TEST(suite, test_poll_group_less_loaded);
+	CU_ADD_TEST(suite, test_tgt_new_qpair_least_loaded);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+	CU_basic_run_tests();
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+	return num_failures;
+}
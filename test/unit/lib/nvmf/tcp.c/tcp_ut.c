@@ -43,6 +43,11 @@
 #include "nvmf/ctrlr.c"
 #include "nvmf/tcp.c"
 
+/* nvmf.c has a static function of the same name as ctrlr.c */
+#define _nvmf_ctrlr_destruct _nvmf_tgt_ctrlr_destruct
+#include "nvmf/nvmf.c"
+#undef _nvmf_ctrlr_destruct
+
 #define UT_IPV4_ADDR "192.168.0.1"
 #define UT_PORT "4420"
 #define UT_NVMF_ADRFAM_INVALID 0xf
@@ -55,13 +60,6 @@
 #define UT_SQ_HEAD_MAX 128
 #define UT_NUM_SHARED_BUFFERS 128
 
-SPDK_LOG_REGISTER_COMPONENT(nvmf)
-
-DEFINE_STUB(spdk_nvmf_qpair_get_listen_trid,
-	    int,
-	    (struct spdk_nvmf_qpair *qpair, struct spdk_nvme_transport_id *trid),
-	    0);
-
 DEFINE_STUB(nvmf_subsystem_add_ctrlr,
 	    int,
 	    (struct spdk_nvmf_subsystem *subsystem, struct spdk_nvmf_ctrlr *ctrlr),
@@ -72,11 +70,6 @@ DEFINE_STUB(nvmf_subsystem_get_ctrlr,
 	    (struct spdk_nvmf_subsystem *subsystem, uint16_t cntlid),
 	    NULL);
 
-DEFINE_STUB(spdk_nvmf_tgt_find_subsystem,
-	    struct spdk_nvmf_subsystem *,
-	    (struct spdk_nvmf_tgt *tgt, const char *subnqn),
-	    NULL);
-
 DEFINE_STUB(spdk_nvmf_subsystem_listener_allowed,
 	    bool,
 	    (struct spdk_nvmf_subsystem *subsystem, const struct spdk_nvme_transport_id *trid),
@@ -120,6 +113,11 @@ DEFINE_STUB(nvmf_ctrlr_write_zeroes_supported,
 	    (struct spdk_nvmf_ctrlr *ctrlr),
 	    false);
 
+DEFINE_STUB(nvmf_ctrlr_copy_supported,
+	    bool,
+	    (struct spdk_nvmf_ctrlr *ctrlr),
+	    false);
+
 DEFINE_STUB(nvmf_bdev_ctrlr_read_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -132,6 +130,22 @@ DEFINE_STUB(nvmf_bdev_ctrlr_write_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_zcopy_start,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+static uint32_t g_zcopy_end_calls;
+static bool g_zcopy_end_commit;
+
+void
+nvmf_bdev_ctrlr_zcopy_end(struct spdk_nvmf_request *req, bool commit)
+{
+	g_zcopy_end_calls++;
+	g_zcopy_end_commit = commit;
+}
+
 DEFINE_STUB(nvmf_bdev_ctrlr_compare_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -162,6 +176,12 @@ DEFINE_STUB(nvmf_bdev_ctrlr_dsm_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_copy_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
 DEFINE_STUB(nvmf_bdev_ctrlr_nvme_passthru_io,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -174,6 +194,9 @@ DEFINE_STUB(spdk_nvmf_bdev_ctrlr_abort_cmd,
 	     struct spdk_nvmf_request *req, struct spdk_nvmf_request *req_to_abort),
 	    0);
 
+DEFINE_STUB(spdk_bdev_io_type_supported, bool,
+	    (struct spdk_bdev *bdev, enum spdk_bdev_io_type io_type), false);
+
 DEFINE_STUB(nvmf_bdev_ctrlr_get_dif_ctx,
 	    bool,
 	    (struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd, struct spdk_dif_ctx *dif_ctx),
@@ -209,11 +232,47 @@ DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id
 		enum spdk_nvme_transport_type trtype));
 DEFINE_STUB_V(spdk_nvmf_transport_register, (const struct spdk_nvmf_transport_ops *ops));
 
-DEFINE_STUB_V(spdk_nvmf_tgt_new_qpair, (struct spdk_nvmf_tgt *tgt, struct spdk_nvmf_qpair *qpair));
-
 DEFINE_STUB_V(nvmf_transport_qpair_abort_request,
 	      (struct spdk_nvmf_qpair *qpair, struct spdk_nvmf_request *req));
 
+DEFINE_STUB(nvmf_transport_get_optimal_poll_group,
+	    struct spdk_nvmf_transport_poll_group *,
+	    (struct spdk_nvmf_transport *transport, struct spdk_nvmf_qpair *qpair),
+	    NULL);
+
+DEFINE_STUB(nvmf_transport_poll_group_add,
+	    int,
+	    (struct spdk_nvmf_transport_poll_group *group, struct spdk_nvmf_qpair *qpair),
+	    0);
+
+DEFINE_STUB(nvmf_transport_poll_group_remove,
+	    int,
+	    (struct spdk_nvmf_transport_poll_group *group, struct spdk_nvmf_qpair *qpair),
+	    0);
+
+DEFINE_STUB(nvmf_transport_qpair_get_listen_trid,
+	    int,
+	    (struct spdk_nvmf_qpair *qpair, struct spdk_nvme_transport_id *trid),
+	    0);
+
+void
+nvmf_transport_qpair_abort_zcopy(struct spdk_nvmf_qpair *qpair)
+{
+	nvmf_tcp_qpair_abort_zcopy(qpair);
+}
+
+static uint32_t g_qpair_fini_calls;
+
+void
+nvmf_transport_qpair_fini(struct spdk_nvmf_qpair *qpair,
+			  spdk_nvmf_transport_qpair_fini_cb cb_fn, void *cb_arg)
+{
+	g_qpair_fini_calls++;
+	if (cb_fn) {
+		cb_fn(cb_arg);
+	}
+}
+
 DEFINE_STUB_V(spdk_nvme_print_command, (uint16_t qid, struct spdk_nvme_cmd *cmd));
 DEFINE_STUB_V(spdk_nvme_print_completion, (uint16_t qid, struct spdk_nvme_cpl *cpl));
 
@@ -309,12 +368,6 @@ spdk_nvme_transport_id_populate_trstring(struct spdk_nvme_transport_id *trid, co
 	return 0;
 }
 
-int
-spdk_nvmf_qpair_disconnect(struct spdk_nvmf_qpair *qpair, nvmf_qpair_disconnect_cb cb_fn, void *ctx)
-{
-	return 0;
-}
-
 int
 spdk_nvmf_request_get_buffers(struct spdk_nvmf_request *req,
 			      struct spdk_nvmf_transport_poll_group *group,
@@ -721,6 +774,284 @@ test_nvmf_tcp_incapsule_data_handle(void)
 	CU_ASSERT(tqpair.pdu_in_progress.req == (void *)&tcp_req2);
 }
 
+static void
+ut_tcp_zcopy_capsule_in(struct spdk_nvmf_tcp_qpair *tqpair, uint8_t opc)
+{
+	struct spdk_nvme_tcp_cmd *capsule_data = &tqpair->pdu_in_progress.hdr.capsule_cmd;
+	struct spdk_nvme_sgl_descriptor *sgl = &capsule_data->ccsqe.dptr.sgl1;
+
+	/* A capsule without in-capsule data, as if its header was just received */
+	tqpair->recv_state = NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH;
+	capsule_data->common.pdu_type = SPDK_NVME_TCP_PDU_TYPE_CAPSULE_CMD;
+	capsule_data->common.hlen = sizeof(*capsule_data);
+	capsule_data->common.plen = sizeof(*capsule_data);
+	capsule_data->ccsqe.opc = opc;
+	capsule_data->ccsqe.nsid = 1;
+	sgl->unkeyed.subtype = SPDK_NVME_SGL_SUBTYPE_TRANSPORT;
+	sgl->generic.type = SPDK_NVME_SGL_TYPE_TRANSPORT_DATA_BLOCK;
+	sgl->unkeyed.length = UT_MAX_IO_SIZE;
+}
+
+static void
+ut_tcp_qpair_disconnect_done(void *ctx)
+{
+	bool *disconnected = ctx;
+
+	*disconnected = true;
+}
+
+static void
+test_nvmf_tcp_zcopy(void)
+{
+	struct spdk_thread *thread;
+	struct spdk_nvmf_tcp_transport ttransport = {};
+	struct spdk_nvmf_tcp_poll_group tcp_group = {};
+	struct spdk_sock_group grp = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct spdk_nvmf_tcp_req tcp_req = {};
+	struct nvme_tcp_pdu pdu = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	struct spdk_nvmf_subsystem_listener listener = {};
+	struct spdk_bdev bdev = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+	struct spdk_io_channel io_ch = {};
+	bool disconnected;
+	int rc;
+
+	thread = spdk_thread_create(NULL, NULL);
+	SPDK_CU_ASSERT_FATAL(thread != NULL);
+	spdk_set_thread(thread);
+
+	ttransport.transport.opts.max_io_size = UT_MAX_IO_SIZE;
+	ttransport.transport.opts.io_unit_size = UT_IO_UNIT_SIZE;
+	ttransport.tcp_opts.zcopy = true;
+	ttransport.tcp_opts.c2h_success = true;
+
+	tcp_group.sock_group = &grp;
+	TAILQ_INIT(&tcp_group.qpairs);
+	tcp_group.group.transport = &ttransport.transport;
+	STAILQ_INIT(&tcp_group.group.pending_buf_queue);
+
+	/* An I/O qpair of an enabled controller with one namespace */
+	ns.bdev = &bdev;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+	listener.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+
+	group.thread = thread;
+	TAILQ_INIT(&group.tgroups);
+	TAILQ_INIT(&group.qpairs);
+	group.num_sgroups = 1;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	ns_info.channel = &io_ch;
+	sgroups.ns_info = &ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	group.sgroups = &sgroups;
+
+	tqpair.group = &tcp_group;
+	tqpair.state = NVME_TCP_QPAIR_STATE_RUNNING;
+	tqpair.qpair.transport = &ttransport.transport;
+	tqpair.qpair.ctrlr = &ctrlr;
+	tqpair.qpair.group = &group;
+	tqpair.qpair.qid = 1;
+	tqpair.qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	TAILQ_INIT(&tqpair.qpair.outstanding);
+
+	TAILQ_INIT(&tqpair.tcp_req_free_queue);
+	TAILQ_INIT(&tqpair.tcp_req_working_queue);
+	TAILQ_INSERT_TAIL(&tqpair.tcp_req_free_queue, &tcp_req, state_link);
+	tqpair.state_cntr[TCP_REQUEST_STATE_FREE]++;
+
+	tcp_req.pdu = &pdu;
+	tcp_req.req.qpair = &tqpair.qpair;
+	tcp_req.req.cmd = (union nvmf_h2c_msg *)&tcp_req.cmd;
+	tcp_req.req.rsp = &rsp;
+
+	/* The bdev supports zcopy and its buffers are provided asynchronously */
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+	MOCK_SET(nvmf_bdev_ctrlr_zcopy_start, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* 1. A read waits for the bdev's buffers instead of the shared pool */
+	g_zcopy_end_calls = 0;
+	ut_tcp_zcopy_capsule_in(&tqpair, SPDK_NVME_OPC_READ);
+	CU_ASSERT(nvmf_tcp_req_get(&tqpair) == &tcp_req);
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_INIT);
+	CU_ASSERT(tcp_req.req.length == UT_MAX_IO_SIZE);
+	CU_ASSERT(STAILQ_EMPTY(&tcp_group.group.pending_buf_queue));
+	CU_ASSERT(TAILQ_FIRST(&tqpair.qpair.outstanding) == &tcp_req.req);
+
+	/* Nothing happens until the bdev calls back */
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+
+	/* The bdev provided the buffers and the read completes without another bdev I/O */
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+	tcp_req.req.iov[0].iov_base = (void *)0xDEADBEEF;
+	tcp_req.req.iov[0].iov_len = UT_MAX_IO_SIZE;
+	tcp_req.req.iovcnt = 1;
+	tcp_req.req.data = tcp_req.req.iov[0].iov_base;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_EXECUTING);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_EXECUTE);
+
+	/* The data is sent straight from the bdev's buffers */
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(pdu.hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_C2H_DATA);
+	CU_ASSERT(pdu.data_iovcnt == 1);
+	CU_ASSERT((uint64_t)pdu.data_iov[0].iov_base == 0xDEADBEEF);
+	CU_ASSERT(g_zcopy_end_calls == 0);
+
+	/* Once the data was sent, the buffers are released without committing them */
+	pdu.cb_fn(pdu.cb_arg);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING);
+	CU_ASSERT(g_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_commit == false);
+
+	/* The request is freed when the bdev released the buffers */
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_COMPLETE;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_NONE);
+	CU_ASSERT(tqpair.state_cntr[TCP_REQUEST_STATE_FREE] == 1);
+
+	/* The completions to the nvmf layer are stubbed out, drop the request from it */
+	TAILQ_INIT(&tqpair.qpair.outstanding);
+	ns_info.io_outstanding = 0;
+
+	/* 2. The bdev fails to provide the buffers, only the response is sent */
+	g_zcopy_end_calls = 0;
+	ut_tcp_zcopy_capsule_in(&tqpair, SPDK_NVME_OPC_READ);
+	CU_ASSERT(nvmf_tcp_req_get(&tqpair) == &tcp_req);
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_INIT_FAILED;
+	rsp.nvme_cpl.status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp.nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST);
+	CU_ASSERT(pdu.hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_CAPSULE_RESP);
+	CU_ASSERT(pdu.hdr.capsule_resp.rccqe.status.sc == SPDK_NVME_SC_INTERNAL_DEVICE_ERROR);
+
+	pdu.cb_fn(pdu.cb_arg);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_NONE);
+	CU_ASSERT(g_zcopy_end_calls == 0);
+
+	TAILQ_INIT(&tqpair.qpair.outstanding);
+	ns_info.io_outstanding = 0;
+
+	/* 3. The qpair is disconnected while the request waits for the buffers */
+	g_zcopy_end_calls = 0;
+	ut_tcp_zcopy_capsule_in(&tqpair, SPDK_NVME_OPC_READ);
+	CU_ASSERT(nvmf_tcp_req_get(&tqpair) == &tcp_req);
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+
+	/* The request can't be freed before the bdev calls back */
+	tqpair.qpair.state = SPDK_NVMF_QPAIR_DEACTIVATING;
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+	CU_ASSERT(g_zcopy_end_calls == 0);
+
+	/* The buffers it gets are released right away */
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING);
+	CU_ASSERT(g_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_commit == false);
+
+	/* And the request waits for them to be released */
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE);
+	CU_ASSERT(g_zcopy_end_calls == 1);
+
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_COMPLETE;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tqpair.state_cntr[TCP_REQUEST_STATE_FREE] == 1);
+
+	tqpair.qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	TAILQ_INIT(&tqpair.qpair.outstanding);
+	ns_info.io_outstanding = 0;
+
+	/* 4. The qpair is disconnected while a write holds the buffers, waiting for the data */
+	g_zcopy_end_calls = 0;
+	g_qpair_fini_calls = 0;
+	ut_tcp_zcopy_capsule_in(&tqpair, SPDK_NVME_OPC_WRITE);
+	CU_ASSERT(nvmf_tcp_req_get(&tqpair) == &tcp_req);
+	nvmf_tcp_req_process(&ttransport, &tcp_req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_START);
+
+	/* The host is asked for the data once the buffers are provided */
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_EXECUTE;
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_R2T_ACK);
+	CU_ASSERT(pdu.hdr.common.pdu_type == SPDK_NVME_TCP_PDU_TYPE_R2T);
+	CU_ASSERT(pdu.hdr.r2t.r2tl == UT_MAX_IO_SIZE);
+
+	pdu.cb_fn(pdu.cb_arg);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_TRANSFERRING_HOST_TO_CONTROLLER);
+	CU_ASSERT(TAILQ_FIRST(&tqpair.qpair.outstanding) == &tcp_req.req);
+
+	/* The disconnect stops receiving and releases the buffers without committing the
+	 * partial data.
+	 */
+	TAILQ_INSERT_TAIL(&group.qpairs, &tqpair.qpair, link);
+	group.num_qpairs = 1;
+	disconnected = false;
+	rc = spdk_nvmf_qpair_disconnect(&tqpair.qpair, ut_tcp_qpair_disconnect_done, &disconnected);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.state == NVME_TCP_QPAIR_STATE_EXITING);
+	CU_ASSERT(tqpair.recv_state == NVME_TCP_PDU_RECV_STATE_ERROR);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_AWAITING_ZCOPY_RELEASE);
+	CU_ASSERT(tcp_req.req.zcopy_phase == NVMF_ZCOPY_PHASE_END_PENDING);
+	CU_ASSERT(g_zcopy_end_calls == 1);
+	CU_ASSERT(g_zcopy_end_commit == false);
+	CU_ASSERT(g_qpair_fini_calls == 0);
+
+	/* The qpair is destroyed once the bdev released the buffers */
+	tcp_req.req.zcopy_phase = NVMF_ZCOPY_PHASE_COMPLETE;
+	spdk_nvmf_request_complete(&tcp_req.req);
+	CU_ASSERT(TAILQ_EMPTY(&tqpair.qpair.outstanding));
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(g_qpair_fini_calls == 1);
+	CU_ASSERT(tqpair.qpair.group == NULL);
+	CU_ASSERT(TAILQ_EMPTY(&group.qpairs));
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(disconnected == true);
+
+	/* The transport completion is stubbed out, finish the request by hand */
+	nvmf_tcp_req_complete(&tcp_req.req);
+	CU_ASSERT(tcp_req.state == TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tqpair.state_cntr[TCP_REQUEST_STATE_FREE] == 1);
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_zcopy_start);
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+
+	spdk_thread_exit(thread);
+	while (!spdk_thread_is_exited(thread)) {
+		spdk_thread_poll(thread, 0, 0);
+	}
+	spdk_thread_destroy(thread);
+}
 
 int main(int argc, char **argv)
 {
@@ -738,6 +1069,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_tcp_send_c2h_data);
 	CU_ADD_TEST(suite, test_nvmf_tcp_h2c_data_hdr_handle);
 	CU_ADD_TEST(suite, test_nvmf_tcp_incapsule_data_handle);
+	CU_ADD_TEST(suite, test_nvmf_tcp_zcopy);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
@@ -150,6 +150,85 @@ flush(void)
 	free(req2);
 }
 
+static void
+flush_zcopy_threshold(void)
+{
+	struct spdk_posix_sock_group_impl group = {};
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+	struct spdk_sock_request *req;
+	bool cb_arg;
+	int rc;
+
+	TAILQ_INIT(&sock->queued_reqs);
+	TAILQ_INIT(&sock->pending_reqs);
+	sock->group_impl = &group.base;
+	psock.zcopy = true;
+
+	req = calloc(1, sizeof(struct spdk_sock_request) + 2 * sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_base = (void *)100;
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_len = 32;
+	SPDK_SOCK_REQUEST_IOV(req, 1)->iov_base = (void *)200;
+	SPDK_SOCK_REQUEST_IOV(req, 1)->iov_len = 32;
+	req->iovcnt = 2;
+	req->cb_fn = _req_cb;
+	req->cb_arg = &cb_arg;
+
+	/* Below the threshold the data is copied and the request completes immediately */
+	g_spdk_posix_sock_impl_opts.zerocopy_threshold = 65;
+	spdk_sock_request_queue(sock, req);
+	MOCK_SET(sendmsg, 64);
+	cb_arg = false;
+	rc = _sock_flush(sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == true);
+	CU_ASSERT(psock.sendmsg_idx == 0);
+	CU_ASSERT(TAILQ_EMPTY(&sock->queued_reqs));
+	CU_ASSERT(TAILQ_EMPTY(&sock->pending_reqs));
+
+	/* At the threshold the request waits for the zero copy notification */
+	g_spdk_posix_sock_impl_opts.zerocopy_threshold = 64;
+	spdk_sock_request_queue(sock, req);
+	cb_arg = false;
+	rc = _sock_flush(sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == false);
+	CU_ASSERT(psock.sendmsg_idx == 1);
+	CU_ASSERT(req->internal.is_zcopy == true);
+	CU_ASSERT(req->internal.offset == 0);
+	CU_ASSERT(TAILQ_FIRST(&sock->pending_reqs) == req);
+	rc = spdk_sock_request_put(sock, req, 0);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == true);
+	CU_ASSERT(req->internal.is_zcopy == false);
+
+	/* A request partially sent with zero copy finishes with zero copy, even
+	 * though the remainder is below the threshold */
+	spdk_sock_request_queue(sock, req);
+	MOCK_SET(sendmsg, 40);
+	cb_arg = false;
+	rc = _sock_flush(sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == false);
+	CU_ASSERT(psock.sendmsg_idx == 2);
+	CU_ASSERT(TAILQ_FIRST(&sock->queued_reqs) == req);
+
+	MOCK_SET(sendmsg, 24);
+	rc = _sock_flush(sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == false);
+	CU_ASSERT(psock.sendmsg_idx == 3);
+	CU_ASSERT(req->internal.offset == 2);
+	CU_ASSERT(TAILQ_FIRST(&sock->pending_reqs) == req);
+	rc = spdk_sock_request_put(sock, req, 0);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(cb_arg == true);
+
+	g_spdk_posix_sock_impl_opts.zerocopy_threshold = 0;
+	free(req);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -162,6 +241,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("posix", NULL, NULL);
 
 	CU_ADD_TEST(suite, flush);
+	CU_ADD_TEST(suite, flush_zcopy_threshold);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
@@ -172,6 +172,78 @@ thread_send_msg(void)
 	free_threads();
 }
 
+static void
+count_msg_cb(void *ctx)
+{
+	uint32_t *count = ctx;
+
+	(*count)++;
+}
+
+static void
+thread_msg_batch(void)
+{
+	struct spdk_thread *thread;
+	struct spdk_thread_stats stats;
+	uint32_t count = 0, expected = 0, backlog = 0;
+	uint32_t batch_size, i;
+
+	allocate_threads(1);
+	set_thread(0);
+	thread = spdk_get_thread();
+	CU_ASSERT(thread->msg_batch_size == SPDK_MSG_BATCH_SIZE);
+
+	/* The batch doubles while messages pile up */
+	for (i = 0; i < 1000; i++) {
+		CU_ASSERT(spdk_thread_send_msg(thread, count_msg_cb, &count) == 0);
+	}
+
+	batch_size = SPDK_MSG_BATCH_SIZE;
+	while (expected < 1000) {
+		if (1000 - expected > batch_size) {
+			batch_size = spdk_min(batch_size * 2, SPDK_MSG_BATCH_SIZE_MAX);
+		}
+		CU_ASSERT(spdk_thread_poll(thread, 0, 0) > 0);
+		backlog = 1000 - expected;
+		expected = spdk_min(expected + batch_size, 1000);
+		CU_ASSERT(count == expected);
+		CU_ASSERT(thread->msg_batch_size == batch_size);
+	}
+	CU_ASSERT(batch_size == SPDK_MSG_BATCH_SIZE_MAX);
+
+	/* The backlog is visible in the stats of the thread */
+	CU_ASSERT(spdk_thread_get_stats(&stats) == 0);
+	CU_ASSERT(stats.msg_count == 1000);
+	CU_ASSERT(stats.msg_backlog == backlog);
+	CU_ASSERT(stats.msg_backlog_max == 1000);
+
+	/* And it goes back down once the ring is shallow */
+	while (batch_size > SPDK_MSG_BATCH_SIZE) {
+		CU_ASSERT(spdk_thread_send_msg(thread, count_msg_cb, &count) == 0);
+		spdk_thread_poll(thread, 0, 0);
+		batch_size /= 2;
+		CU_ASSERT(thread->msg_batch_size == batch_size);
+	}
+
+	spdk_thread_poll(thread, 0, 0);
+	CU_ASSERT(thread->msg_batch_size == SPDK_MSG_BATCH_SIZE);
+	CU_ASSERT(spdk_thread_get_stats(&stats) == 0);
+	CU_ASSERT(stats.msg_backlog == 0);
+	CU_ASSERT(stats.msg_backlog_max == 1000);
+
+	/* The limit of the caller still applies */
+	for (i = 0; i < 100; i++) {
+		CU_ASSERT(spdk_thread_send_msg(thread, count_msg_cb, &count) == 0);
+	}
+	count = 0;
+	spdk_thread_poll(thread, 3, 0);
+	CU_ASSERT(count == 3);
+	poll_threads();
+	CU_ASSERT(count == 100);
+
+	free_threads();
+}
+
 static int
 poller_run_done(void *ctx)
 {
@@ -391,6 +463,137 @@ poller_pause(void)
 	free_threads();
 }
 
+#define TIMED_POLLER_COUNT 64
+
+struct timed_poller_ctx {
+	struct spdk_poller *poller;
+	uint64_t period_us;
+	uint64_t run_count;
+	uint64_t last_run_tick;
+	/* Poller to unregister when this one runs */
+	struct spdk_poller **unregister;
+};
+
+static uint64_t g_timed_poller_last_tick;
+static uint64_t g_timed_poller_last_seq;
+
+static int
+timed_poller_run(void *arg)
+{
+	struct timed_poller_ctx *ctx = arg;
+
+	/* Pollers run in the order they expire, ties in the order they were scheduled */
+	CU_ASSERT(ctx->poller->next_run_tick >= g_timed_poller_last_tick);
+	if (ctx->poller->next_run_tick == g_timed_poller_last_tick) {
+		CU_ASSERT(ctx->poller->timer_seq > g_timed_poller_last_seq);
+	}
+	g_timed_poller_last_tick = ctx->poller->next_run_tick;
+	g_timed_poller_last_seq = ctx->poller->timer_seq;
+
+	ctx->run_count++;
+	ctx->last_run_tick = spdk_get_ticks();
+
+	if (ctx->unregister != NULL) {
+		spdk_poller_unregister(ctx->unregister);
+		ctx->unregister = NULL;
+	}
+
+	return 0;
+}
+
+static void
+timed_poller_order(void)
+{
+	struct timed_poller_ctx ctx[TIMED_POLLER_COUNT] = {};
+	struct spdk_thread *thread;
+	uint64_t expiration, now;
+	unsigned int i, j;
+
+	allocate_threads(1);
+	set_thread(0);
+	thread = spdk_get_thread();
+
+	for (i = 0; i < TIMED_POLLER_COUNT; i++) {
+		ctx[i].period_us = ((i * 7) % 13 + 1) * 100;
+		ctx[i].poller = spdk_poller_register(timed_poller_run, &ctx[i], ctx[i].period_us);
+		SPDK_CU_ASSERT_FATAL(ctx[i].poller != NULL);
+	}
+	CU_ASSERT(thread->num_timed_pollers == TIMED_POLLER_COUNT);
+	CU_ASSERT(thread->num_registered_timed_pollers == TIMED_POLLER_COUNT);
+
+	for (j = 1; j <= 100; j++) {
+		now = spdk_get_ticks();
+
+		/* The next expiration is the earliest of all the timed pollers */
+		expiration = UINT64_MAX;
+		for (i = 0; i < TIMED_POLLER_COUNT; i++) {
+			if (ctx[i].poller != NULL && ctx[i].poller->state == SPDK_POLLER_STATE_WAITING) {
+				expiration = spdk_min(expiration, ctx[i].poller->next_run_tick);
+			}
+		}
+		CU_ASSERT(spdk_thread_next_poller_expiration(thread) == expiration);
+
+		if (j == 30) {
+			/* Pause every third poller, and unregister every fifth */
+			for (i = 0; i < TIMED_POLLER_COUNT; i += 3) {
+				spdk_poller_pause(ctx[i].poller);
+			}
+			for (i = 1; i < TIMED_POLLER_COUNT; i += 5) {
+				spdk_poller_unregister(&ctx[i].poller);
+			}
+			/* Pollers unregistering themselves and each other */
+			ctx[2].unregister = &ctx[2].poller;
+			ctx[4].unregister = &ctx[8].poller;
+		} else if (j == 60) {
+			for (i = 0; i < TIMED_POLLER_COUNT; i += 3) {
+				if (ctx[i].poller != NULL) {
+					spdk_poller_resume(ctx[i].poller);
+				}
+			}
+		}
+
+		g_timed_poller_last_tick = 0;
+		g_timed_poller_last_seq = 0;
+		spdk_delay_us(100);
+		poll_threads();
+
+		for (i = 0; i < TIMED_POLLER_COUNT; i++) {
+			if (ctx[i].poller == NULL || ctx[i].poller->state != SPDK_POLLER_STATE_WAITING) {
+				continue;
+			}
+			/* A waiting poller never falls behind by a whole period */
+			CU_ASSERT(ctx[i].poller->next_run_tick > now + 100);
+			CU_ASSERT(ctx[i].poller->next_run_tick <= now + 100 + ctx[i].period_us);
+		}
+	}
+
+	/* Pollers that weren't paused or unregistered run once per period */
+	CU_ASSERT(ctx[5].run_count == 100 * 100 / ctx[5].period_us);
+	CU_ASSERT(ctx[7].run_count == 100 * 100 / ctx[7].period_us);
+
+	/* Unregistered pollers stopped running, paused ones skipped 30 rounds */
+	for (i = 1; i < TIMED_POLLER_COUNT; i += 5) {
+		CU_ASSERT(ctx[i].poller == NULL);
+		CU_ASSERT(ctx[i].run_count <= 30 * 100 / ctx[i].period_us);
+	}
+	CU_ASSERT(ctx[2].poller == NULL);
+	CU_ASSERT(ctx[8].poller == NULL);
+	CU_ASSERT(ctx[3].last_run_tick > ctx[8].last_run_tick);
+	CU_ASSERT(ctx[9].run_count < 100 * 100 / ctx[9].period_us);
+	CU_ASSERT(ctx[9].run_count >= 70 * 100 / ctx[9].period_us - 1);
+
+	for (i = 0; i < TIMED_POLLER_COUNT; i++) {
+		spdk_poller_unregister(&ctx[i].poller);
+	}
+	CU_ASSERT(thread->num_timed_pollers == 0);
+	CU_ASSERT(thread->num_registered_timed_pollers == 0);
+
+	poll_threads();
+	CU_ASSERT(spdk_thread_has_pollers(thread) == false);
+
+	free_threads();
+}
+
 static void
 for_each_cb(void *ctx)
 {
@@ -1342,8 +1545,10 @@ main(int argc, char **argv)
 
 	CU_ADD_TEST(suite, thread_alloc);
 	CU_ADD_TEST(suite, thread_send_msg);
+	CU_ADD_TEST(suite, thread_msg_batch);
 	CU_ADD_TEST(suite, thread_poller);
 	CU_ADD_TEST(suite, poller_pause);
+	CU_ADD_TEST(suite, timed_poller_order);
 	CU_ADD_TEST(suite, thread_for_each);
 	CU_ADD_TEST(suite, for_each_channel_remove);
 	CU_ADD_TEST(suite, for_each_channel_unreg);
@@ -646,6 +646,60 @@ dif_sec_4096_md_128_prchk_7_multi_iovs_complex_splits_test(void)
 	}
 }
 
+static void
+dif_sec_512_md_8_prchk_7_multi_iovs_whole_and_split_blocks_test(void)
+{
+	struct spdk_dif_ctx ctx = {};
+	struct iovec iovs[3], iov;
+	uint32_t dif_flags;
+	uint8_t *buf;
+	int rc;
+
+	dif_flags = SPDK_DIF_FLAGS_GUARD_CHECK | SPDK_DIF_FLAGS_APPTAG_CHECK |
+		    SPDK_DIF_FLAGS_REFTAG_CHECK;
+
+	/* Runs of whole blocks are processed together and only the blocks crossing an
+	 * iovec boundary are split. The iovecs describe a single buffer, so the result
+	 * can be checked against the same buffer described as one iovec.
+	 */
+	_iov_alloc_buf(&iov, (512 + 8) * 8);
+	buf = iov.iov_base;
+
+	/* block[0], block[1], block[2][259:0] */
+	_iov_set_buf(&iovs[0], buf, (512 + 8) * 2 + 260);
+
+	/* block[2][519:260], block[3], block[4], block[5][99:0] */
+	_iov_set_buf(&iovs[1], buf + (512 + 8) * 2 + 260, 260 + (512 + 8) * 2 + 100);
+
+	/* block[5][519:100], block[6], block[7] */
+	_iov_set_buf(&iovs[2], buf + (512 + 8) * 5 + 100, 420 + (512 + 8) * 2);
+
+	rc = ut_data_pattern_generate(iovs, 3, 512 + 8, 8, 8);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_ctx_init(&ctx, 512 + 8, 8, true, false, SPDK_DIF_TYPE1, dif_flags,
+			       22, 0xFFFF, 0x22, 0, GUARD_SEED);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_generate(iovs, 3, 8, &ctx);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_verify(&iov, 1, 8, &ctx, NULL);
+	CU_ASSERT(rc == 0);
+
+	memset(buf, 0, (512 + 8) * 8);
+	rc = ut_data_pattern_generate(&iov, 1, 512 + 8, 8, 8);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_generate(&iov, 1, 8, &ctx);
+	CU_ASSERT(rc == 0);
+
+	rc = spdk_dif_verify(iovs, 3, 8, &ctx, NULL);
+	CU_ASSERT(rc == 0);
+
+	_iov_free_buf(&iov);
+}
+
 static void
 _dif_inject_error_and_verify(struct iovec *iovs, int iovcnt,
 			     uint32_t block_size, uint32_t md_size, uint32_t num_blocks,
@@ -2620,6 +2674,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, dif_sec_512_md_8_prchk_7_multi_iovs_split_reftag_test);
 	CU_ADD_TEST(suite, dif_sec_512_md_8_prchk_7_multi_iovs_complex_splits_test);
 	CU_ADD_TEST(suite, dif_sec_4096_md_128_prchk_7_multi_iovs_complex_splits_test);
+	CU_ADD_TEST(suite, dif_sec_512_md_8_prchk_7_multi_iovs_whole_and_split_blocks_test);
 	CU_ADD_TEST(suite, dif_sec_4096_md_128_inject_1_2_4_8_multi_iovs_test);
 	CU_ADD_TEST(suite, dif_sec_4096_md_128_inject_1_2_4_8_multi_iovs_split_data_and_md_test);
 	CU_ADD_TEST(suite, dif_sec_4096_md_128_inject_1_2_4_8_multi_iovs_split_data_test);
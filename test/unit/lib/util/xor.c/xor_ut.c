@@ -0,0 +1,283 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk_cunit.h"
+#include "spdk/string.h"
+
+#include "util/xor.c"
+
+#define TEST_MAX_SOURCES	8
+#define TEST_BUF_LEN		(4096 + 64 + 1)
+
+static uint8_t g_src[TEST_MAX_SOURCES][TEST_BUF_LEN];
+static uint8_t g_p[TEST_BUF_LEN];
+static uint8_t g_q[TEST_BUF_LEN];
+static uint8_t g_ref_p[TEST_BUF_LEN];
+static uint8_t g_ref_q[TEST_BUF_LEN];
+
+static void
+fill_sources(uint32_t n)
+{
+	uint32_t i;
+	size_t j;
+
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < TEST_BUF_LEN; j++) {
+			g_src[i][j] = rand();
+		}
+	}
+}
+
+/* Multiply in GF(2^8) with the polynomial 0x11d one bit at a time. */
+static uint8_t
+gf_mul(uint8_t a, uint8_t b)
+{
+	uint8_t r = 0;
+
+	while (b) {
+		if (b & 1) {
+			r ^= a;
+		}
+		a = (a << 1) ^ ((a & 0x80) ? 0x1d : 0);
+		b >>= 1;
+	}
+
+	return r;
+}
+
+static void
+ref_pq(uint32_t n, size_t off, size_t len)
+{
+	uint8_t coef;
+	uint32_t i;
+	size_t j;
+
+	for (j = off; j < off + len; j++) {
+		g_ref_p[j] = 0;
+		g_ref_q[j] = 0;
+		coef = 1;
+		for (i = 0; i < n; i++) {
+			g_ref_p[j] ^= g_src[i][j];
+			g_ref_q[j] ^= gf_mul(coef, g_src[i][j]);
+			coef = gf_mul(coef, 2);
+		}
+	}
+}
+
+static void
+test_xor_gen(void)
+{
+	void *sources[TEST_MAX_SOURCES];
+	size_t lens[] = { 0, 1, 7, 8, 31, 64, 100, 255, 512, 4096 };
+	size_t offs[] = { 0, 1, 3, 64 };
+	uint32_t n, i, l, o;
+	int rc;
+
+	for (n = 1; n <= TEST_MAX_SOURCES; n++) {
+		fill_sources(n);
+		for (o = 0; o < SPDK_COUNTOF(offs); o++) {
+			for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+				for (i = 0; i < n; i++) {
+					sources[i] = &g_src[i][offs[o]];
+				}
+				ref_pq(n, offs[o], lens[l]);
+				memset(g_p, 0xa5, sizeof(g_p));
+
+				rc = spdk_xor_gen(&g_p[offs[o]], sources, n, lens[l]);
+				CU_ASSERT(rc == 0);
+				CU_ASSERT(memcmp(&g_p[offs[o]], &g_ref_p[offs[o]], lens[l]) == 0);
+				/* Nothing outside of the range may be touched */
+				CU_ASSERT(g_p[offs[o] + lens[l]] == 0xa5);
+			}
+		}
+	}
+
+	/* The destination may be one of the sources */
+	fill_sources(3);
+	ref_pq(3, 0, TEST_BUF_LEN);
+	sources[0] = g_src[0];
+	sources[1] = g_src[1];
+	sources[2] = g_src[2];
+	rc = spdk_xor_gen(g_src[0], sources, 3, TEST_BUF_LEN);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(g_src[0], g_ref_p, TEST_BUF_LEN) == 0);
+
+	rc = spdk_xor_gen(g_p, sources, 0, TEST_BUF_LEN);
+	CU_ASSERT(rc == -EINVAL);
+}
+
+static void
+test_xor_gen_pq(void)
+{
+	void *sources[TEST_MAX_SOURCES];
+	size_t lens[] = { 0, 1, 9, 32, 100, 128, 4096 };
+	size_t offs[] = { 0, 5, 64 };
+	uint32_t n, i, l, o;
+	int rc;
+
+	for (n = 1; n <= TEST_MAX_SOURCES; n++) {
+		fill_sources(n);
+		for (o = 0; o < SPDK_COUNTOF(offs); o++) {
+			for (l = 0; l < SPDK_COUNTOF(lens); l++) {
+				for (i = 0; i < n; i++) {
+					sources[i] = &g_src[i][offs[o]];
+				}
+				ref_pq(n, offs[o], lens[l]);
+
+				rc = spdk_xor_gen_pq(&g_p[offs[o]], &g_q[offs[o]], sources, n, lens[l]);
+				CU_ASSERT(rc == 0);
+				CU_ASSERT(memcmp(&g_p[offs[o]], &g_ref_p[offs[o]], lens[l]) == 0);
+				CU_ASSERT(memcmp(&g_q[offs[o]], &g_ref_q[offs[o]], lens[l]) == 0);
+			}
+		}
+	}
+
+	rc = spdk_xor_gen_pq(g_p, g_q, sources, 0, TEST_BUF_LEN);
+	CU_ASSERT(rc == -EINVAL);
+	rc = spdk_xor_gen_pq(g_p, g_q, sources, SPDK_XOR_MAX_SOURCES + 1, TEST_BUF_LEN);
+	CU_ASSERT(rc == -EINVAL);
+}
+
+/* Split buf into iovecs of varying sizes, starting with the given one. */
+static int
+split_iovs(struct iovec *iovs, int max_iovcnt, uint8_t *buf, size_t len, size_t first)
+{
+	size_t size = first;
+	int iovcnt = 0;
+
+	while (len > 0) {
+		SPDK_CU_ASSERT_FATAL(iovcnt < max_iovcnt);
+		if (iovcnt == max_iovcnt - 1) {
+			size = len;
+		}
+		iovs[iovcnt].iov_base = buf;
+		iovs[iovcnt].iov_len = spdk_min(size, len);
+		buf += iovs[iovcnt].iov_len;
+		len -= iovs[iovcnt].iov_len;
+		iovcnt++;
+		size = size * 3 + 1;
+	}
+
+	return iovcnt;
+}
+
+static void
+test_xor_gen_iov(void)
+{
+	struct iovec src_iov_bufs[TEST_MAX_SOURCES][8];
+	struct iovec *src_iovs[TEST_MAX_SOURCES];
+	int src_iovcnts[TEST_MAX_SOURCES];
+	struct iovec p_iovs[8], q_iovs[8];
+	int p_iovcnt, q_iovcnt;
+	uint32_t n = 5, i;
+	size_t len = 4096;
+	int rc;
+
+	fill_sources(n);
+	ref_pq(n, 0, len);
+
+	for (i = 0; i < n; i++) {
+		src_iovs[i] = src_iov_bufs[i];
+		src_iovcnts[i] = split_iovs(src_iov_bufs[i], 8, g_src[i], len, i * 13 + 1);
+	}
+	p_iovcnt = split_iovs(p_iovs, 8, g_p, len, 100);
+	q_iovcnt = split_iovs(q_iovs, 8, g_q, len, 7);
+
+	memset(g_p, 0, sizeof(g_p));
+	rc = spdk_xor_gen_iov(p_iovs, p_iovcnt, src_iovs, src_iovcnts, n, len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(g_p, g_ref_p, len) == 0);
+
+	memset(g_p, 0, sizeof(g_p));
+	memset(g_q, 0, sizeof(g_q));
+	rc = spdk_xor_gen_pq_iov(p_iovs, p_iovcnt, q_iovs, q_iovcnt, src_iovs, src_iovcnts, n, len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(g_p, g_ref_p, len) == 0);
+	CU_ASSERT(memcmp(g_q, g_ref_q, len) == 0);
+
+	/* Only part of the iovecs */
+	memset(g_p, 0, sizeof(g_p));
+	rc = spdk_xor_gen_iov(p_iovs, p_iovcnt, src_iovs, src_iovcnts, n, 1000);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(g_p, g_ref_p, 1000) == 0);
+	CU_ASSERT(spdk_mem_all_zero(&g_p[1000], len - 1000));
+
+	/* Zero length iovecs are skipped */
+	p_iovs[0].iov_len = 0;
+	p_iovs[1].iov_base = g_p;
+	p_iovs[1].iov_len = len;
+	memset(g_p, 0, sizeof(g_p));
+	rc = spdk_xor_gen_iov(&p_iovs[0], 2, src_iovs, src_iovcnts, n, len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(memcmp(g_p, g_ref_p, len) == 0);
+
+	/* A source that is too short */
+	src_iovcnts[2]--;
+	rc = spdk_xor_gen_iov(p_iovs, p_iovcnt, src_iovs, src_iovcnts, n, len);
+	CU_ASSERT(rc == -EINVAL);
+	src_iovcnts[2]++;
+
+	/* A destination that is too short */
+	rc = spdk_xor_gen_iov(p_iovs, 1, src_iovs, src_iovcnts, n, len);
+	CU_ASSERT(rc == -EINVAL);
+
+	rc = spdk_xor_gen_iov(p_iovs, p_iovcnt, src_iovs, src_iovcnts, 0, len);
+	CU_ASSERT(rc == -EINVAL);
+}
+
+int
+main(int argc, char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("xor", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_xor_gen);
+	CU_ADD_TEST(suite, test_xor_gen_pq);
+	CU_ADD_TEST(suite, test_xor_gen_iov);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+
+	CU_basic_run_tests();
+
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
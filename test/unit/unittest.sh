@@ -17,6 +17,8 @@ function unittest_bdev() {
 	$valgrind $testdir/lib/bdev/nvme/bdev_ocssd.c/bdev_ocssd_ut
 	$valgrind $testdir/lib/bdev/nvme/bdev_nvme.c/bdev_nvme_ut
 	$valgrind $testdir/lib/bdev/raid/bdev_raid.c/bdev_raid_ut
+	$valgrind $testdir/lib/bdev/raid/bdev_raid_rebuild.c/bdev_raid_rebuild_ut
+	$valgrind $testdir/lib/bdev/raid/raid1.c/raid1_ut
 	$valgrind $testdir/lib/bdev/bdev_zone.c/bdev_zone_ut
 	$valgrind $testdir/lib/bdev/gpt/gpt.c/gpt_ut
 	$valgrind $testdir/lib/bdev/part.c/part_ut
@@ -92,6 +94,7 @@ function unittest_nvmf() {
 	$valgrind $testdir/lib/nvmf/ctrlr.c/ctrlr_ut
 	$valgrind $testdir/lib/nvmf/ctrlr_bdev.c/ctrlr_bdev_ut
 	$valgrind $testdir/lib/nvmf/ctrlr_discovery.c/ctrlr_discovery_ut
+	$valgrind $testdir/lib/nvmf/nvmf.c/nvmf_ut
 	$valgrind $testdir/lib/nvmf/subsystem.c/subsystem_ut
 	$valgrind $testdir/lib/nvmf/tcp.c/tcp_ut
 }
@@ -125,6 +128,7 @@ function unittest_util() {
 	$valgrind $testdir/lib/util/iov.c/iov_ut
 	$valgrind $testdir/lib/util/math.c/math_ut
 	$valgrind $testdir/lib/util/pipe.c/pipe_ut
+	$valgrind $testdir/lib/util/xor.c/xor_ut
 }
 
 # if ASAN is enabled, use it.  If not use valgrind if installed but allow